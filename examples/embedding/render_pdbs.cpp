@@ -0,0 +1,161 @@
+/**
+ * @file
+ * Render structure files to PNG images with the Python-free C API
+ *
+ * Example for embedding PyMOL in a rendering service: worker threads lease
+ * started instances from a pymol::InstancePool, so every file is rendered by
+ * a warm instance and no Python interpreter is involved. The file format is
+ * derived from the file name extension. By default one worker renders at a
+ * time. More workers (-j) render concurrently, see the thread safety note in
+ * InstancePool.h.
+ *
+ * Build with -DPYMOL_NOPY=ON (target "render_pdbs"), then:
+ *
+ * @verbatim
+   render_pdbs [-j workers] [-W width] [-H height] outdir file.pdb ...
+   @endverbatim
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "InstancePool.h"
+#include "PyMOL.h"
+
+namespace
+{
+
+struct Options {
+  unsigned workers = 1; // see the thread safety note in InstancePool.h
+  int width = 640;
+  int height = 480;
+  std::string outdir;
+  std::vector<std::string> files;
+};
+
+void usage(const char* argv0)
+{
+  std::fprintf(stderr,
+      "usage: %s [-j workers] [-W width] [-H height] outdir file ...\n",
+      argv0);
+  std::exit(2);
+}
+
+Options parse_args(int argc, char* argv[])
+{
+  Options options;
+  int i = 1;
+
+  for (; i < argc && argv[i][0] == '-'; ++i) {
+    if (i + 1 == argc) {
+      usage(argv[0]);
+    }
+    if (!strcmp(argv[i], "-j")) {
+      options.workers = std::max(1, atoi(argv[++i]));
+    } else if (!strcmp(argv[i], "-W")) {
+      options.width = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-H")) {
+      options.height = atoi(argv[++i]);
+    } else {
+      usage(argv[0]);
+    }
+  }
+
+  if (argc - i < 2) {
+    usage(argv[0]);
+  }
+
+  options.outdir = argv[i++];
+  options.files.assign(argv + i, argv + argc);
+  return options;
+}
+
+/// "path/to/1abc.pdb" -> "outdir/1abc.png"
+std::string png_filename(const std::string& outdir, const std::string& file)
+{
+  auto start = file.find_last_of("/\\");
+  auto base = file.substr(start == std::string::npos ? 0 : start + 1);
+  return outdir + "/" + base.substr(0, base.find('.')) + ".png";
+}
+
+bool ok(PyMOLreturn_status result)
+{
+  return result.status == PyMOLstatus_SUCCESS;
+}
+
+bool render(CPyMOL* I, const Options& options, const std::string& file)
+{
+  return ok(PyMOL_CmdLoad(I, file.c_str(), "filename", "auto", "", 0, false,
+             true, true, -1, false)) &&
+         ok(PyMOL_CmdHide(I, "everything", "all", true)) &&
+         ok(PyMOL_CmdShow(I, "cartoon", "polymer", true)) &&
+         ok(PyMOL_CmdShow(I, "sticks", "organic", true)) &&
+         ok(PyMOL_CmdOrient(I, "all", 0.f, 0, false, 0.f, true)) &&
+         ok(PyMOL_CmdRay(I, options.width, options.height, -1, 0.f, 0.f, -1,
+             false, true)) &&
+         ok(PyMOL_CmdPNG(I, png_filename(options.outdir, file).c_str(), -1.f,
+             true));
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  auto const options = parse_args(argc, argv);
+  auto const n_workers = std::min<std::size_t>(
+      options.workers, options.files.size());
+
+  pymol::InstancePool pool(n_workers);
+  pool.prestart(n_workers);
+
+  // split the cores between the concurrent ray traces
+  auto const ray_threads = std::to_string(std::max<std::size_t>(
+      1, std::thread::hardware_concurrency() / n_workers));
+
+  std::atomic<std::size_t> next{0};
+  std::atomic<int> n_failed{0};
+
+  auto worker = [&]() {
+    for (std::size_t i; (i = next++) < options.files.size();) {
+      auto lease = pool.acquire();
+      auto const& file = options.files[i];
+
+      if (!lease) {
+        std::fprintf(stderr, "failed to start instance: %s\n", file.c_str());
+        ++n_failed;
+        continue;
+      }
+      auto const t0 = std::chrono::steady_clock::now();
+
+      PyMOL_CmdSet(lease.get(), "max_threads", ray_threads.c_str(), "", 0,
+          true, true);
+
+      if (!render(lease.get(), options, file)) {
+        std::fprintf(stderr, "failed: %s\n", file.c_str());
+        ++n_failed;
+        continue;
+      }
+
+      std::chrono::duration<double> seconds =
+          std::chrono::steady_clock::now() - t0;
+      std::printf("%s %.3fs\n", file.c_str(), seconds.count());
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < n_workers; ++i) {
+    threads.emplace_back(worker);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  return n_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
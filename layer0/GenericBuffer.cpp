@@ -380,6 +380,7 @@ bool GenericBuffer::genBuffer(GLuint& id, size_t size, const void* ptr)
   glBufferData(bufferType(), size, ptr, GL_STATIC_DRAW);
   if (!CheckGLErrorOK(nullptr, "GenericBuffer::bufferData failed\n"))
     return false;
+  m_memory_size += size;
   return true;
 }
 
@@ -238,6 +238,8 @@ public:
   virtual ~gpuBuffer_t() {};
   virtual size_t get_hash_id() { return _hashid; }
   virtual void bind() const = 0;
+  /// Bytes of GPU memory held by this buffer (if known)
+  virtual size_t get_memory_size() const { return 0; }
 protected:
   virtual void set_hash_id(size_t id) { _hashid = id; }
 private:
@@ -325,6 +327,8 @@ public:
    */
   void bufferReplaceData(size_t offset, size_t len, const void* data);
 
+  size_t get_memory_size() const override { return m_memory_size; }
+
 protected:
 
   /**
@@ -374,6 +378,7 @@ protected:
   const GLenum m_buffer_usage{GL_STATIC_DRAW};
   const buffer_layout m_layout{ buffer_layout::SEPARATE };
   size_t m_stride{0};
+  size_t m_memory_size{0};
   BufferDataDesc m_desc;
   std::vector<GLuint> desc_glIDs; // m_desc's gl buffer IDs
 };
@@ -31,6 +31,7 @@ Z* -------------------------------------------------------------------
 #include"PConv.h"
 #include"P.h"
 #include"Util.h"
+#include "Trace.h"
 
 #define Trace_OFF
 
@@ -793,6 +794,7 @@ int IsosurfVolume(PyMOLGlobals* G, CSetting* set1, CSetting* set2,
     Isofield* field, float level, pymol::vla<int>& num, pymol::vla<float>& vert,
     int* range, cIsomeshMode mode, int skip, float alt_level)
 {
+  PYMOL_TRACE_SCOPE("IsosurfVolume", "map");
   int ok = true;
   CIsosurf *I;
   if(PIsGlutThread()) {
@@ -13,6 +13,7 @@
 
 #define LexDec(G, i) OVLexicon_DecRef(G->Lexicon, i)
 #define LexInc(G, i) OVLexicon_IncRef(G->Lexicon, i)
+#define LexIncN(G, i, n) OVLexicon_IncRefN(G->Lexicon, i, n)
 #define LexNumeric(i) (i)
 
 /**
@@ -0,0 +1,153 @@
+/*
+ * This file contains source code for the PyMOL computer program
+ * Copyright (c) Schrodinger, LLC.
+ *
+ * Interning strings into PyMOLGlobals::Lexicon from multiple threads
+ */
+
+#include "LexConcurrent.h"
+
+#include <cassert>
+#include <exception>
+#include <functional>
+#include <string_view>
+
+namespace pymol
+{
+
+LexInterner::Table::Table(std::size_t capacity)
+    : mask(capacity - 1)
+    , slots(new std::atomic<const Entry*>[capacity])
+{
+  for (std::size_t i = 0; i < capacity; ++i) {
+    slots[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+const LexInterner::Entry* LexInterner::Table::find(
+    std::size_t hash, const char* key) const
+{
+  // low bits select the shard
+  for (std::size_t i = (hash / N_SHARDS) & mask;; i = (i + 1) & mask) {
+    auto entry = slots[i].load(std::memory_order_acquire);
+    if (!entry || (entry->hash == hash && entry->key == key)) {
+      return entry;
+    }
+  }
+}
+
+/// Not thread-safe, but concurrent find() is fine
+void LexInterner::Table::insert(const Entry* entry)
+{
+  std::size_t i = (entry->hash / N_SHARDS) & mask;
+  while (slots[i].load(std::memory_order_relaxed)) {
+    i = (i + 1) & mask;
+  }
+  slots[i].store(entry, std::memory_order_release);
+}
+
+LexInterner::LexInterner(PyMOLGlobals* G)
+    : m_G(G)
+{
+}
+
+LexInterner::~LexInterner()
+{
+  for (auto& shard : m_shards) {
+    for (auto& entry : shard.entries) {
+      LexDec(m_G, entry->id);
+    }
+  }
+}
+
+lexidx_t LexInterner::borrow(pymol::zstring_view s)
+{
+  if (!s || s.empty()) {
+    return 0;
+  }
+
+  auto const key = s.c_str();
+  auto const hash = std::hash<std::string_view>()(key);
+  auto& shard = m_shards[hash % N_SHARDS];
+
+  // lock-free lookup
+  auto table = shard.table.load(std::memory_order_acquire);
+  if (table) {
+    if (auto entry = table->find(hash, key)) {
+      return entry->id;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  // inserted by another thread in the meantime?
+  table = shard.table.load(std::memory_order_relaxed);
+  if (table) {
+    if (auto entry = table->find(hash, key)) {
+      return entry->id;
+    }
+  }
+
+  lexidx_t id;
+  {
+    // the interner's own reference
+    std::lock_guard<std::mutex> lexicon_lock(m_lexicon_mutex);
+    id = LexIdx(m_G, s);
+  }
+
+  shard.entries.emplace_back(new Entry{key, hash, id});
+
+  // load factor at most 1/2, grow into a new table
+  if (!table || 2 * shard.entries.size() > table->mask + 1) {
+    auto grown = std::make_unique<Table>(table ? 2 * (table->mask + 1) : 16);
+    for (auto const& entry : shard.entries) {
+      grown->insert(entry.get());
+    }
+    shard.table.store(grown.get(), std::memory_order_release);
+    shard.tables.push_back(std::move(grown));
+  } else {
+    // current table is the last one
+    shard.tables.back()->insert(shard.entries.back().get());
+  }
+
+  return id;
+}
+
+LexStaging::~LexStaging()
+{
+  // staged references are discarded when unwinding from a failed load
+  assert((m_slots.empty() || std::uncaught_exceptions()) &&
+         "LexStaging::merge() not called");
+}
+
+lexidx_t LexStaging::idx(pymol::zstring_view s)
+{
+  if (!s || s.empty()) {
+    return 0;
+  }
+
+  std::string key(s.c_str());
+  auto it = m_index.find(key);
+  if (it != m_index.end()) {
+    auto& slot = m_slots[it->second];
+    ++slot.count;
+    return slot.id;
+  }
+
+  lexidx_t id = m_interner.borrow(s);
+  m_index.emplace(std::move(key), int(m_slots.size()));
+  m_slots.push_back({id, 1});
+  return id;
+}
+
+void LexStaging::merge()
+{
+  auto G = m_interner.G();
+  for (auto const& slot : m_slots) {
+    LexIncN(G, slot.id, slot.count);
+  }
+  m_slots.clear();
+  m_index.clear();
+}
+
+} // namespace pymol
@@ -0,0 +1,127 @@
+/*
+ * This file contains source code for the PyMOL computer program
+ * Copyright (c) Schrodinger, LLC.
+ *
+ * Interning strings into PyMOLGlobals::Lexicon from multiple threads
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Lex.h"
+
+namespace pymol
+{
+
+/**
+ * Thread-safe front end to the (not thread-safe) global lexicon, shared by
+ * all threads of a parallel load.
+ *
+ * Strings are cached in lock-striped shards. Lookups of cached strings are
+ * lock-free: each shard is an open addressing table whose slots are
+ * published with release stores, and which is replaced (not modified in
+ * place) when it grows. Replaced tables are kept until destruction, so
+ * readers never see freed memory. Only strings which are new to the load
+ * take the shard lock and the global lock, and go to the lexicon. The
+ * interner holds one lexicon reference per string and releases it on
+ * destruction.
+ *
+ * While an interner is in use, no other code may access the lexicon (not
+ * even LexStr), since inserting can reallocate the lexicon storage.
+ */
+class LexInterner
+{
+public:
+  explicit LexInterner(PyMOLGlobals* G);
+  ~LexInterner();
+
+  LexInterner(const LexInterner&) = delete;
+  LexInterner& operator=(const LexInterner&) = delete;
+
+  /**
+   * Lookup or insert `s`. Thread-safe. The returned reference is borrowed
+   * from the interner, see LexStaging for counted references.
+   */
+  lexidx_t borrow(pymol::zstring_view s);
+
+  PyMOLGlobals* G() const { return m_G; }
+
+private:
+  static constexpr int N_SHARDS = 64;
+
+  struct Entry {
+    std::string key;
+    std::size_t hash;
+    lexidx_t id;
+  };
+
+  struct Table {
+    explicit Table(std::size_t capacity);
+    std::size_t mask; // capacity - 1
+    std::unique_ptr<std::atomic<const Entry*>[]> slots;
+
+    const Entry* find(std::size_t hash, const char* key) const;
+    void insert(const Entry* entry);
+  };
+
+  struct alignas(64) Shard {
+    std::atomic<const Table*> table{nullptr};
+    std::mutex mutex; // for inserting
+    std::vector<std::unique_ptr<Entry>> entries;
+    std::vector<std::unique_ptr<Table>> tables; // current and replaced
+  };
+
+  PyMOLGlobals* m_G;
+  std::mutex m_lexicon_mutex;
+  Shard m_shards[N_SHARDS];
+};
+
+/**
+ * Per-thread staging buffer with a lock-free lookup for strings which this
+ * thread has seen before. Reference counts are collected locally and
+ * applied to the lexicon with merge(), which must run serially (e.g. at the
+ * end of a load) and before the interner is destroyed.
+ *
+ * If the load fails with an exception, the staged references are discarded
+ * on destruction and the ids returned by idx() must not be used.
+ */
+class LexStaging
+{
+public:
+  explicit LexStaging(LexInterner& interner) : m_interner(interner) {}
+  ~LexStaging();
+
+  LexStaging(const LexStaging&) = delete;
+  LexStaging& operator=(const LexStaging&) = delete;
+  LexStaging(LexStaging&&) = default;
+
+  /**
+   * Like LexIdx: Lookup or insert `s` and return a counted reference (the
+   * count is staged until merge()). Returns 0 for the empty string.
+   */
+  lexidx_t idx(pymol::zstring_view s);
+
+  /**
+   * Apply the staged reference counts to the lexicon. Not thread-safe.
+   */
+  void merge();
+
+private:
+  struct Slot {
+    lexidx_t id;
+    int count;
+  };
+
+  LexInterner& m_interner;
+  std::unordered_map<std::string, int> m_index; // string -> m_slots index
+  std::vector<Slot> m_slots;
+};
+
+} // namespace pymol
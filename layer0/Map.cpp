@@ -28,6 +28,8 @@ Z* ------------------------------------------------------------------- */
 
 #include "pymol/algorithm.h"
 
+#include <numeric>
+
 static MapType *_MapNew(PyMOLGlobals * G, float range, const float *vert, int nVert,
                         const float *extent, const int *flag, int group_id, int block_id);
 
@@ -598,6 +600,74 @@ int MapSetupExpress(MapType * I)
   return ok;
 }
 
+/**
+ * Setup the compressed sparse row layout: all hashed points sorted by cell
+ * into one contiguous array, with per-cell offsets. Needs one int per cell
+ * and per point, versus up to 27 ints per point for the express list.
+ *
+ * @param vert If not null, also store the point coordinates in cell order
+ * (CellCoord), for cache friendly distance checks
+ */
+int MapSetupCSR(MapType * I, const float *vert)
+{
+  PyMOLGlobals *G = I->G;
+  const int mapSize = I->Dim[0] * I->D1D2;
+  const int *head = I->Head;
+  const int *link = I->Link;
+
+  PRINTFD(G, FB_Map)
+    " MapSetupCSR-Debug: entered.\n" ENDFD;
+
+  I->CellStart.resize(mapSize + 1);
+  int *start = I->CellStart.data();
+  start[0] = 0;
+
+  /* count, then prefix sum */
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for schedule(static) if(mapSize > 0xFFFF)
+#endif
+  for(int h = 0; h < mapSize; h++) {
+    int n = 0;
+    for(int i = head[h]; i >= 0; i = link[i])
+      n++;
+    start[h + 1] = n;
+  }
+
+  std::partial_sum(start, start + mapSize + 1, start);
+
+  I->CellItems.resize(start[mapSize]);
+  int *items = I->CellItems.data();
+
+  /* fill, preserving the list order of each cell */
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for schedule(static) if(mapSize > 0xFFFF)
+#endif
+  for(int h = 0; h < mapSize; h++) {
+    int *out = items + start[h];
+    for(int i = head[h]; i >= 0; i = link[i])
+      *(out++) = i;
+  }
+
+  const int nItems = I->CellItems.size();
+
+  if(vert) {
+    I->CellCoord.resize(3 * nItems);
+    float *coord = I->CellCoord.data();
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for schedule(static) if(nItems > 0xFFFF)
+#endif
+    for(int j = 0; j < nItems; j++)
+      copy3f(vert + 3 * items[j], coord + 3 * j);
+  } else {
+    I->CellCoord.clear();
+  }
+
+  PRINTFB(G, FB_Map, FB_Blather)
+    " MapSetupCSR: %d cells, %d points\n", mapSize, nItems ENDFB(G);
+
+  return true;
+}
+
 /**
  * Get the grid indices for a 3D query point. If the point is outside the grid,
  * get the indices of the closest grid cell (clamp `v` to grid boundary).
@@ -979,10 +1049,48 @@ static MapType *_MapNew(PyMOLGlobals * G, float range, const float *vert, int nV
   return (I);
 }
 
+/**
+ * Get the CSR start cells of the 9 runs of 3 consecutive cells (along the
+ * third dimension) which make up the neighborhood of `v`.
+ *
+ * @param excl If true, return false if `v` is outside the grid
+ * @param[out] cells
+ */
+static bool MapCSRCells(MapType* I, const float* v, bool excl, int* cells)
+{
+  int a, b, c;
+  if (excl) {
+    if (!MapExclLocus(I, v, &a, &b, &c))
+      return false;
+  } else {
+    MapLocus(I, v, &a, &b, &c);
+  }
+
+  const int dim2 = I->Dim[2];
+  int n = 0;
+  for (int d = a - 1; d <= a + 1; ++d) {
+    for (int e = b - 1; e <= b + 1; ++e) {
+      cells[n++] = d * I->D1D2 + e * dim2 + (c - 1);
+    }
+  }
+  return true;
+}
+
 MapEIter::MapEIter(MapType& map, const float* v, bool excl)
 {
-  if (!map.EList) {
-    MapSetupExpress(&map);
+  if (map.CellStart.empty() && !map.EList) {
+    MapSetupCSR(&map);
+  }
+
+  if (!map.CellStart.empty()) {
+    m_elist = map.CellItems.data();
+    m_start = map.CellStart.data();
+    if (MapCSRCells(&map, v, excl, m_cells)) {
+      m_n_cells = 9;
+    }
+    m_i = m_end = 0;
+    nextRun();
+    return;
   }
 
   m_elist = map.EList;
@@ -992,6 +1100,27 @@ MapEIter::MapEIter(MapType& map, const float* v, bool excl)
   } else {
     m_i = *MapLocusEStart(&map, v);
   }
+
+  if (!m_i) {
+    m_i = -1;
+  }
+}
+
+/**
+ * Advance to the first point of the next non-empty run of cells, or to the
+ * end.
+ */
+void MapEIter::nextRun()
+{
+  while (m_n_cells) {
+    const int cell = m_cells[9 - m_n_cells--];
+    m_i = m_start[cell];
+    m_end = m_start[cell + 3];
+    if (m_i != m_end) {
+      return;
+    }
+  }
+  m_i = -1;
 }
 
 /**
@@ -1005,6 +1134,24 @@ MapEIter::MapEIter(MapType& map, const float* v, bool excl)
 bool MapAnyWithin(
     MapType& map, const float* v_map, const float* v_query, float cutoff)
 {
+  if (!map.CellCoord.empty()) {
+    // scan the sorted coordinates, no indirection through the indices
+    int cells[9];
+    if (!MapCSRCells(&map, v_query, true, cells))
+      return false;
+    const int* start = map.CellStart.data();
+    for (const int cell : cells) {
+      const float* v = map.CellCoord.data() + 3 * start[cell];
+      const float* v_end = map.CellCoord.data() + 3 * start[cell + 3];
+      for (; v != v_end; v += 3) {
+        if (within3f(v, v_query, cutoff)) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
   for (const auto j : MapEIter(map, v_query)) {
     if (within3f(v_map + 3 * j, v_query, cutoff)) {
       return true;
@@ -21,6 +21,8 @@ Z* -------------------------------------------------------------------
 
 /* Map - a 3-D hash object for optimizing neighbor searches */
 
+#include<vector>
+
 #include"Vector.h"
 #include"PyMOLGlobals.h"
 
@@ -38,6 +40,15 @@ struct MapType {
   int* EMask = nullptr;
   int NVert;
   int NEElem = 0;
+
+  /* compressed sparse row layout (MapSetupCSR): the points of cell `h` are
+   * CellItems[CellStart[h]] ... CellItems[CellStart[h + 1] - 1], in the same
+   * order as the Head/Link list. CellCoord optionally holds their
+   * coordinates in that order. */
+  std::vector<int> CellStart;
+  std::vector<int> CellItems;
+  std::vector<float> CellCoord;
+
   Vector3f Max, Min;
   int group_id;
   int block_base;
@@ -63,6 +74,7 @@ using MapFlag_t = int;
 MapType *MapNewFlagged(PyMOLGlobals * G, float range, const float *vert, int nVert,
                        const float *extent, const MapFlag_t *flag);
 int MapSetupExpress(MapType * I);
+int MapSetupCSR(MapType * I, const float *vert = nullptr);
 int MapSetupExpressPerp(MapType * I, const float *vert, float front, int nVertHint,
 			int negative_start, const int *spanner);
 
@@ -96,12 +108,22 @@ int MapSetupExpressXY(MapType * I, int n_vert, int negative_start);
 int MapSetupExpressXYVert(MapType * I, float *vert, int n_vert, int negative_start);
 
 /**
- * Range iteration over points in proximity of a 3D query point
+ * Range iteration over points in proximity of a 3D query point.
+ *
+ * Iterates over the CSR layout if available, otherwise over the express
+ * list. If the map has neither, the CSR layout is set up (not thread safe,
+ * call MapSetupCSR before iterating from multiple threads).
  */
 class MapEIter
 {
   const int* m_elist = nullptr;
-  int m_i = 0;
+  const int* m_start = nullptr; // CSR cell offsets (null for express list)
+  int m_cells[9];               // CSR start cells of the 3-cell runs
+  int m_n_cells = 0;
+  int m_i = -1;
+  int m_end = 0;
+
+  void nextRun();
 
 public:
   MapEIter() = default;
@@ -119,8 +141,12 @@ public:
 
   MapEIter& operator++()
   {
-    if (m_elist[++m_i] < 0) {
-      m_i = 0;
+    if (m_start) {
+      if (++m_i == m_end) {
+        nextRun();
+      }
+    } else if (m_elist[++m_i] < 0) {
+      m_i = -1;
     }
     return *this;
   }
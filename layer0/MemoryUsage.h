@@ -4,10 +4,60 @@
 
 #pragma once
 
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "vla.h"
+
 namespace pymol
 {
 
 size_t memory_usage();
 size_t memory_available();
 
+/**
+ * Memory held by a data structure, in main memory and in GPU buffers
+ * (bytes). See MemoryAccounting.h
+ */
+struct MemorySize {
+  std::size_t host = 0;
+  std::size_t gpu = 0;
+
+  MemorySize& operator+=(const MemorySize& other)
+  {
+    host += other.host;
+    gpu += other.gpu;
+    return *this;
+  }
+
+  std::size_t total() const { return host + gpu; }
+};
+
+/// Allocated bytes of a container
+template <typename T> std::size_t memory_size(const std::vector<T>& v)
+{
+  return v.capacity() * sizeof(T);
+}
+
+template <typename T> std::size_t memory_size(const vla<T>& v)
+{
+  return v.size() * sizeof(T);
+}
+
+/// Approximate bytes of a hash map (nodes and bucket array)
+template <typename K, typename V, typename... Args>
+std::size_t memory_size(const std::unordered_map<K, V, Args...>& m)
+{
+  using value_type = typename std::unordered_map<K, V, Args...>::value_type;
+  return m.size() * (sizeof(value_type) + 2 * sizeof(void*)) +
+         m.bucket_count() * sizeof(void*);
+}
+
+/// Allocated bytes of a (raw) VLA
+template <typename T> std::size_t memory_size(const T* v)
+{
+  return v ? VLAGetSize(v) * sizeof(T) : 0;
+}
+
 } // namespace pymol
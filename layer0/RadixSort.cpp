@@ -0,0 +1,122 @@
+/**
+ * @file
+ * Stable LSD radix sort of an index by packed 128 bit integer keys
+ */
+
+#include "RadixSort.h"
+
+#include <algorithm>
+#include <numeric>
+
+#ifdef PYMOL_OPENMP
+#include <omp.h>
+#endif
+
+// bits per pass
+#define RADIX_BITS 16
+#define RADIX_SIZE (1 << RADIX_BITS)
+
+// inputs smaller than this are sorted by a single thread
+#define RADIX_PARALLEL_MIN 65536
+
+namespace pymol
+{
+
+static unsigned radix_digit(const SortKey& key, int shift)
+{
+  std::uint64_t bits;
+  if (shift >= 64) {
+    bits = key.hi >> (shift - 64);
+  } else if (shift == 0) {
+    bits = key.lo;
+  } else {
+    bits = (key.lo >> shift) | (key.hi << (64 - shift));
+  }
+  return unsigned(bits) & (RADIX_SIZE - 1);
+}
+
+void RadixSortIndex(int n, const SortKey* keys, int nbits, int* index)
+{
+  std::iota(index, index + n, 0);
+
+  if (n < 2)
+    return;
+
+  int n_threads = 1;
+#ifdef PYMOL_OPENMP
+  if (n >= RADIX_PARALLEL_MIN)
+    n_threads = omp_get_max_threads();
+#endif
+
+  // keys travel with the indices, for sequential memory access
+  struct Item {
+    SortKey key;
+    int index;
+  };
+
+  std::vector<Item> items(n), tmp(n);
+  for (int i = 0; i < n; ++i)
+    items[i] = {keys[i], i};
+
+  std::vector<int> counts(n_threads * RADIX_SIZE);
+  Item* src = items.data();
+  Item* dst = tmp.data();
+
+  for (int shift = 0; shift < nbits; shift += RADIX_BITS) {
+    std::fill(counts.begin(), counts.end(), 0);
+
+    // histograms of contiguous blocks, one per thread (keeps the sort stable)
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for schedule(static, 1) num_threads(n_threads)
+#endif
+    for (int t = 0; t < n_threads; ++t) {
+      int const begin = int(std::int64_t(n) * t / n_threads);
+      int const end = int(std::int64_t(n) * (t + 1) / n_threads);
+      int* count = counts.data() + t * RADIX_SIZE;
+      for (int i = begin; i < end; ++i)
+        ++count[radix_digit(src[i].key, shift)];
+    }
+
+    // all keys have the same digit, nothing to do for this pass
+    bool skip = false;
+    for (int d = 0; d < RADIX_SIZE && !skip; ++d) {
+      int sum = 0;
+      for (int t = 0; t < n_threads; ++t)
+        sum += counts[t * RADIX_SIZE + d];
+      if (sum == n)
+        skip = true;
+      else if (sum)
+        break;
+    }
+    if (skip)
+      continue;
+
+    // exclusive prefix sum in (digit, thread) order
+    int offset = 0;
+    for (int d = 0; d < RADIX_SIZE; ++d) {
+      for (int t = 0; t < n_threads; ++t) {
+        int const c = counts[t * RADIX_SIZE + d];
+        counts[t * RADIX_SIZE + d] = offset;
+        offset += c;
+      }
+    }
+
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for schedule(static, 1) num_threads(n_threads)
+#endif
+    for (int t = 0; t < n_threads; ++t) {
+      int const begin = int(std::int64_t(n) * t / n_threads);
+      int const end = int(std::int64_t(n) * (t + 1) / n_threads);
+      int* pos = counts.data() + t * RADIX_SIZE;
+      for (int i = begin; i < end; ++i)
+        dst[pos[radix_digit(src[i].key, shift)]++] = src[i];
+    }
+
+    std::swap(src, dst);
+  }
+
+  for (int i = 0; i < n; ++i)
+    index[i] = src[i].index;
+}
+
+} // namespace pymol
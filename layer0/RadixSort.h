@@ -0,0 +1,47 @@
+/**
+ * @file
+ * Stable LSD radix sort of an index by packed 128 bit integer keys
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace pymol
+{
+
+/**
+ * Fixed width integer key, filled from the most significant field to the
+ * least significant one with push().
+ */
+struct SortKey {
+  std::uint64_t hi = 0;
+  std::uint64_t lo = 0;
+
+  /// Append `nbits` bits (`value` must fit)
+  void push(std::uint64_t value, int nbits)
+  {
+    if (nbits == 0)
+      return;
+    hi = (nbits >= 64) ? lo : ((hi << nbits) | (lo >> (64 - nbits)));
+    lo = (nbits >= 64) ? value : ((lo << nbits) | value);
+  }
+
+  bool operator<(const SortKey& other) const
+  {
+    return hi != other.hi ? hi < other.hi : lo < other.lo;
+  }
+
+  bool operator<=(const SortKey& other) const { return !(other < *this); }
+};
+
+/**
+ * Stable sort of the indices `0..n-1` by `keys`. Only the lowest `nbits`
+ * bits of the keys are considered. Large inputs are sorted in parallel.
+ *
+ * @param[out] index Permutation which sorts `keys` (n elements)
+ */
+void RadixSortIndex(int n, const SortKey* keys, int nbits, int* index);
+
+} // namespace pymol
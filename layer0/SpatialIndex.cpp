@@ -0,0 +1,117 @@
+/**
+ * @file
+ * Uniform grid over a point set, for radius queries at any cutoff
+ */
+
+#include "SpatialIndex.h"
+
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+
+// cell edge length in Angstrom, about the size of a contact query
+#define SPATIAL_INDEX_CELL 4.f
+
+// upper bound for the number of cells, relative to the number of points
+#define SPATIAL_INDEX_CELLS_PER_POINT 8
+
+namespace pymol
+{
+
+SpatialIndex::SpatialIndex(const float* coord, int n, unsigned version)
+    : m_size(std::max(0, n))
+    , m_version(version)
+{
+  auto const is_finite = [coord](int i) {
+    return std::isfinite(coord[i * 3]) && std::isfinite(coord[i * 3 + 1]) &&
+           std::isfinite(coord[i * 3 + 2]);
+  };
+
+  int n_finite = 0;
+  float hi[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+  std::fill_n(m_min, 3, FLT_MAX);
+  for (int i = 0; i < n; ++i) {
+    if (!is_finite(i))
+      continue;
+    ++n_finite;
+    for (int d = 0; d < 3; ++d) {
+      m_min[d] = std::min(m_min[d], coord[i * 3 + d]);
+      hi[d] = std::max(hi[d], coord[i * 3 + d]);
+    }
+  }
+
+  if (!n_finite)
+    return;
+
+  // coarsen the grid for sparse point sets
+  double const max_cells =
+      double(n_finite) * SPATIAL_INDEX_CELLS_PER_POINT + 4096.;
+  double cell = SPATIAL_INDEX_CELL;
+  double n_cells;
+  for (;;) {
+    n_cells = 1.;
+    for (int d = 0; d < 3; ++d) {
+      n_cells *= std::floor((double(hi[d]) - m_min[d]) / cell) + 1.;
+    }
+    if (n_cells <= max_cells)
+      break;
+    cell *= std::max(1.26, std::cbrt(n_cells / max_cells));
+  }
+
+  m_recip = float(1. / cell);
+  for (int d = 0; d < 3; ++d) {
+    m_dim[d] = int(std::floor((double(hi[d]) - m_min[d]) / cell)) + 1;
+  }
+
+  // counting sort by cell
+  std::vector<int> cell_of(n, -1);
+  m_start.assign(int(n_cells) + 1, 0);
+  for (int i = 0; i < n; ++i) {
+    if (!is_finite(i))
+      continue;
+    int c[3];
+    for (int d = 0; d < 3; ++d) {
+      double const f = (double(coord[i * 3 + d]) - m_min[d]) * m_recip;
+      c[d] = int(std::min(double(m_dim[d] - 1), std::max(0., f)));
+    }
+    cell_of[i] = (c[0] * m_dim[1] + c[1]) * m_dim[2] + c[2];
+    ++m_start[cell_of[i] + 1];
+  }
+
+  std::partial_sum(m_start.begin(), m_start.end(), m_start.begin());
+
+  m_items.resize(n_finite);
+  m_coord.resize(3 * n_finite);
+  std::vector<int> fill(m_start.begin(), m_start.end() - 1);
+  for (int i = 0; i < n; ++i) {
+    if (cell_of[i] < 0)
+      continue;
+    int const k = fill[cell_of[i]]++;
+    m_items[k] = i;
+    std::copy_n(coord + i * 3, 3, m_coord.data() + k * 3);
+  }
+}
+
+/**
+ * Range of cells which overlap the axis aligned box around `v`.
+ * @return False if the box doesn't overlap the grid
+ */
+bool SpatialIndex::cellRange(
+    const float* v, float cutoff, int* lo, int* hi) const
+{
+  if (m_items.empty() || !(cutoff >= 0.f))
+    return false;
+
+  for (int d = 0; d < 3; ++d) {
+    float const flo = std::floor((v[d] - cutoff - m_min[d]) * m_recip);
+    float const fhi = std::floor((v[d] + cutoff - m_min[d]) * m_recip);
+    if (!(fhi >= 0.f) || !(flo < float(m_dim[d])))
+      return false;
+    lo[d] = flo < 0.f ? 0 : int(flo);
+    hi[d] = fhi >= float(m_dim[d]) ? m_dim[d] - 1 : int(fhi);
+  }
+
+  return true;
+}
+
+} // namespace pymol
@@ -0,0 +1,95 @@
+/**
+ * @file
+ * Uniform grid over a point set, for radius queries at any cutoff
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+namespace pymol
+{
+
+/**
+ * Points counting-sorted by grid cell (compressed sparse row layout), with a
+ * copy of the coordinates in cell order.
+ *
+ * Unlike MapType, the cell size does not depend on the query cutoff. Queries
+ * visit as many cells as the cutoff needs, so one index serves any cutoff and
+ * can be kept for as long as the coordinates don't change.
+ */
+class SpatialIndex
+{
+public:
+  /**
+   * @param coord Coordinates (3 * n). Points with non-finite coordinates
+   * are not indexed (never within any cutoff).
+   * @param n Number of points
+   * @param version Version tag of the coordinates, see version()
+   */
+  SpatialIndex(const float* coord, int n, unsigned version = 0);
+
+  /// Version tag of the coordinates this index was built from
+  unsigned version() const { return m_version; }
+
+  /// Number of points (as passed to the constructor)
+  int size() const { return m_size; }
+
+  /**
+   * Call `func(i)` for each point `i` within `cutoff` of `v`.
+   */
+  template <typename Func>
+  void forEachWithin(const float* v, float cutoff, Func&& func) const
+  {
+    int lo[3], hi[3];
+    if (!cellRange(v, cutoff, lo, hi))
+      return;
+
+    float const cutoff2 = cutoff * cutoff;
+
+    for (int i = lo[0]; i <= hi[0]; ++i) {
+      for (int j = lo[1]; j <= hi[1]; ++j) {
+        int const row = (i * m_dim[1] + j) * m_dim[2];
+        // cells along the last dimension are contiguous
+        int const begin = m_start[row + lo[2]];
+        int const end = m_start[row + hi[2] + 1];
+        const float* p = m_coord.data() + 3 * begin;
+        for (int k = begin; k != end; ++k, p += 3) {
+          float const dx = p[0] - v[0];
+          float const dy = p[1] - v[1];
+          float const dz = p[2] - v[2];
+          if (dx * dx + dy * dy + dz * dz <= cutoff2) {
+            func(m_items[k]);
+          }
+        }
+      }
+    }
+  }
+
+  /**
+   * Points within `cutoff` of `v`, in ascending order.
+   */
+  std::vector<int> within(const float* v, float cutoff) const
+  {
+    std::vector<int> result;
+    forEachWithin(v, cutoff, [&](int i) { result.push_back(i); });
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+
+private:
+  bool cellRange(const float* v, float cutoff, int* lo, int* hi) const;
+
+  float m_min[3] = {0.f, 0.f, 0.f};
+  float m_recip = 1.f; // 1 / cell size
+  int m_dim[3] = {0, 0, 0};
+  int m_size = 0;
+  unsigned m_version = 0;
+
+  std::vector<int> m_start; // cell offsets into m_items (size = cells + 1)
+  std::vector<int> m_items; // point indices in cell order
+  std::vector<float> m_coord; // point coordinates in cell order
+};
+
+} // namespace pymol
@@ -0,0 +1,444 @@
+/**
+ * @file
+ * Batched least-squares superposition (QCP) of coordinate frames
+ *
+ * The QCP method is described in:
+ * Theobald DL (2005) Acta Cryst A61:478-480
+ * Liu P, Agrafiotis DK, Theobald DL (2010) J Comput Chem 31:1561-1563
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "Superposition.h"
+
+namespace pymol
+{
+
+namespace
+{
+
+/**
+ * Frames translated to their centers, in structure-of-arrays layout
+ * (all x, then all y, then all z of a frame) so that the inner product
+ * loops are unit-stride and vectorize.
+ */
+struct CenteredFrames {
+  std::size_t nFrames = 0;
+  std::size_t nAtoms = 0;
+  std::vector<float> soa;
+  std::vector<double> centers;
+  std::vector<double> sumSq; //!< sum of squared norms, per frame
+
+  explicit CenteredFrames(const CoordFrames& frames)
+      : nFrames(frames.nFrames)
+      , nAtoms(frames.nAtoms)
+      , soa(frames.nFrames * frames.nAtoms * 3)
+      , centers(frames.nFrames * 3)
+      , sumSq(frames.nFrames)
+  {
+    int const n_frames = nFrames;
+
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for
+#endif
+    for (int f = 0; f < n_frames; ++f) {
+      const float* src = frames.frame(f);
+      double* center = centers.data() + f * 3;
+
+      for (std::size_t i = 0; i < nAtoms; ++i) {
+        for (int d = 0; d < 3; ++d) {
+          center[d] += src[i * 3 + d];
+        }
+      }
+
+      for (int d = 0; d < 3; ++d) {
+        center[d] /= nAtoms ? nAtoms : 1;
+      }
+
+      double sum = 0.0;
+      for (int d = 0; d < 3; ++d) {
+        float* dst = soa.data() + (f * 3 + d) * nAtoms;
+        for (std::size_t i = 0; i < nAtoms; ++i) {
+          dst[i] = float(src[i * 3 + d] - center[d]);
+          sum += double(dst[i]) * dst[i];
+        }
+      }
+      sumSq[f] = sum;
+    }
+  }
+
+  const float* coord(std::size_t f, int d) const
+  {
+    return soa.data() + (f * 3 + d) * nAtoms;
+  }
+};
+
+/**
+ * Inner product matrix A[i * 3 + j] = sum(a_i * b_j) of two centered frames
+ */
+void innerProduct(const CenteredFrames& frames, std::size_t fa,
+    std::size_t fb, double* A)
+{
+  const float* ax = frames.coord(fa, 0);
+  const float* ay = frames.coord(fa, 1);
+  const float* az = frames.coord(fa, 2);
+  const float* bx = frames.coord(fb, 0);
+  const float* by = frames.coord(fb, 1);
+  const float* bz = frames.coord(fb, 2);
+
+  double xx = 0, xy = 0, xz = 0, yx = 0, yy = 0, yz = 0, zx = 0, zy = 0,
+         zz = 0;
+  int const n = frames.nAtoms;
+
+#ifdef PYMOL_OPENMP
+#pragma omp simd reduction(+ : xx, xy, xz, yx, yy, yz, zx, zy, zz)
+#endif
+  for (int i = 0; i < n; ++i) {
+    double const x1 = ax[i], y1 = ay[i], z1 = az[i];
+    double const x2 = bx[i], y2 = by[i], z2 = bz[i];
+    xx += x1 * x2;
+    xy += x1 * y2;
+    xz += x1 * z2;
+    yx += y1 * x2;
+    yy += y1 * y2;
+    yz += y1 * z2;
+    zx += z1 * x2;
+    zy += z1 * y2;
+    zz += z1 * z2;
+  }
+
+  A[0] = xx, A[1] = xy, A[2] = xz;
+  A[3] = yx, A[4] = yy, A[5] = yz;
+  A[6] = zx, A[7] = zy, A[8] = zz;
+}
+
+/**
+ * QCP core: RMSD from the inner product matrix and, optionally, the
+ * rotation (row-major 3x3) which superposes b onto a.
+ *
+ * @param A inner product matrix of a (rows) and b (columns)
+ * @param E0 (sum(|a|^2) + sum(|b|^2)) / 2
+ * @param n Number of atoms
+ * @param[out] rot Rotation matrix or null
+ */
+double qcpRMSD(const double* A, double E0, std::size_t n, double* rot)
+{
+  const double evecprec = 1e-6;
+  const double evalprec = 1e-11;
+
+  double const Sxx = A[0], Sxy = A[1], Sxz = A[2];
+  double const Syx = A[3], Syy = A[4], Syz = A[5];
+  double const Szx = A[6], Szy = A[7], Szz = A[8];
+
+  double const Sxx2 = Sxx * Sxx, Syy2 = Syy * Syy, Szz2 = Szz * Szz;
+  double const Sxy2 = Sxy * Sxy, Syz2 = Syz * Syz, Sxz2 = Sxz * Sxz;
+  double const Syx2 = Syx * Syx, Szy2 = Szy * Szy, Szx2 = Szx * Szx;
+
+  double const SyzSzymSyySzz2 = 2.0 * (Syz * Szy - Syy * Szz);
+  double const Sxx2Syy2Szz2Syz2Szy2 = Syy2 + Szz2 - Sxx2 + Syz2 + Szy2;
+
+  double const SxzpSzx = Sxz + Szx, SyzpSzy = Syz + Szy, SxypSyx = Sxy + Syx;
+  double const SyzmSzy = Syz - Szy, SxzmSzx = Sxz - Szx, SxymSyx = Sxy - Syx;
+  double const SxxpSyy = Sxx + Syy, SxxmSyy = Sxx - Syy;
+  double const Sxy2Sxz2Syx2Szx2 = Sxy2 + Sxz2 - Syx2 - Szx2;
+
+  // characteristic polynomial of the key matrix: x^4 + C2 x^2 + C1 x + C0
+  double const C2 =
+      -2.0 * (Sxx2 + Syy2 + Szz2 + Sxy2 + Syx2 + Sxz2 + Szx2 + Syz2 + Szy2);
+  double const C1 =
+      8.0 * (Sxx * Syz * Szy + Syy * Szx * Sxz + Szz * Sxy * Syx -
+                Sxx * Syy * Szz - Syz * Szx * Sxy - Szy * Syx * Sxz);
+  double const C0 =
+      Sxy2Sxz2Syx2Szx2 * Sxy2Sxz2Syx2Szx2 +
+      (Sxx2Syy2Szz2Syz2Szy2 + SyzSzymSyySzz2) *
+          (Sxx2Syy2Szz2Syz2Szy2 - SyzSzymSyySzz2) +
+      (-(SxzpSzx) * (SyzmSzy) + (SxymSyx) * (SxxmSyy - Szz)) *
+          (-(SxzmSzx) * (SyzpSzy) + (SxymSyx) * (SxxmSyy + Szz)) +
+      (-(SxzpSzx) * (SyzpSzy) - (SxypSyx) * (SxxpSyy - Szz)) *
+          (-(SxzmSzx) * (SyzmSzy) - (SxypSyx) * (SxxpSyy + Szz)) +
+      (+(SxypSyx) * (SyzpSzy) + (SxzpSzx) * (SxxmSyy + Szz)) *
+          (-(SxymSyx) * (SyzmSzy) + (SxzpSzx) * (SxxpSyy + Szz)) +
+      (+(SxypSyx) * (SyzmSzy) + (SxzmSzx) * (SxxmSyy - Szz)) *
+          (-(SxymSyx) * (SyzpSzy) + (SxzmSzx) * (SxxpSyy - Szz));
+
+  // Newton-Raphson for the largest eigenvalue, starting from its upper bound
+  double lambda = E0;
+  for (int i = 0; i < 50; ++i) {
+    double const old = lambda;
+    double const x2 = lambda * lambda;
+    double const b = (x2 + C2) * lambda;
+    double const a = b + C1;
+    double const denom = 2.0 * x2 * lambda + b + a;
+    if (denom == 0.0)
+      break;
+    lambda -= (a * lambda + C0) / denom;
+    if (std::fabs(lambda - old) < std::fabs(evalprec * lambda))
+      break;
+  }
+
+  double const rmsd = std::sqrt(std::fabs(2.0 * (E0 - lambda) / (n ? n : 1)));
+
+  if (!rot)
+    return rmsd;
+
+  // eigenvector of the largest eigenvalue from the adjoint of (K - lambda I)
+  double const a11 = SxxpSyy + Szz - lambda, a12 = SyzmSzy, a13 = -SxzmSzx,
+               a14 = SxymSyx;
+  double const a21 = SyzmSzy, a22 = SxxmSyy - Szz - lambda, a23 = SxypSyx,
+               a24 = SxzpSzx;
+  double const a31 = a13, a32 = a23, a33 = Syy - Sxx - Szz - lambda,
+               a34 = SyzpSzy;
+  double const a41 = a14, a42 = a24, a43 = a34,
+               a44 = Szz - SxxpSyy - lambda;
+
+  double const a3344_4334 = a33 * a44 - a43 * a34;
+  double const a3244_4234 = a32 * a44 - a42 * a34;
+  double const a3243_4233 = a32 * a43 - a42 * a33;
+  double const a3143_4133 = a31 * a43 - a41 * a33;
+  double const a3144_4134 = a31 * a44 - a41 * a34;
+  double const a3142_4132 = a31 * a42 - a41 * a32;
+
+  double q1 = a22 * a3344_4334 - a23 * a3244_4234 + a24 * a3243_4233;
+  double q2 = -a21 * a3344_4334 + a23 * a3144_4134 - a24 * a3143_4133;
+  double q3 = a21 * a3244_4234 - a22 * a3144_4134 + a24 * a3142_4132;
+  double q4 = -a21 * a3243_4233 + a22 * a3143_4133 - a23 * a3142_4132;
+  double qsqr = q1 * q1 + q2 * q2 + q3 * q3 + q4 * q4;
+
+  // if the first column is degenerate, try the other ones
+  if (qsqr < evecprec) {
+    q1 = a12 * a3344_4334 - a13 * a3244_4234 + a14 * a3243_4233;
+    q2 = -a11 * a3344_4334 + a13 * a3144_4134 - a14 * a3143_4133;
+    q3 = a11 * a3244_4234 - a12 * a3144_4134 + a14 * a3142_4132;
+    q4 = -a11 * a3243_4233 + a12 * a3143_4133 - a13 * a3142_4132;
+    qsqr = q1 * q1 + q2 * q2 + q3 * q3 + q4 * q4;
+
+    if (qsqr < evecprec) {
+      double const a1324_1423 = a13 * a24 - a14 * a23;
+      double const a1224_1422 = a12 * a24 - a14 * a22;
+      double const a1223_1322 = a12 * a23 - a13 * a22;
+      double const a1124_1421 = a11 * a24 - a14 * a21;
+      double const a1123_1321 = a11 * a23 - a13 * a21;
+      double const a1122_1221 = a11 * a22 - a12 * a21;
+
+      q1 = a42 * a1324_1423 - a43 * a1224_1422 + a44 * a1223_1322;
+      q2 = -a41 * a1324_1423 + a43 * a1124_1421 - a44 * a1123_1321;
+      q3 = a41 * a1224_1422 - a42 * a1124_1421 + a44 * a1122_1221;
+      q4 = -a41 * a1223_1322 + a42 * a1123_1321 - a43 * a1122_1221;
+      qsqr = q1 * q1 + q2 * q2 + q3 * q3 + q4 * q4;
+
+      if (qsqr < evecprec) {
+        q1 = a32 * a1324_1423 - a33 * a1224_1422 + a34 * a1223_1322;
+        q2 = -a31 * a1324_1423 + a33 * a1124_1421 - a34 * a1123_1321;
+        q3 = a31 * a1224_1422 - a32 * a1124_1421 + a34 * a1122_1221;
+        q4 = -a31 * a1223_1322 + a32 * a1123_1321 - a33 * a1122_1221;
+        qsqr = q1 * q1 + q2 * q2 + q3 * q3 + q4 * q4;
+
+        if (qsqr < evecprec) {
+          // no unique rotation (e.g. identical or collinear coordinates)
+          std::fill_n(rot, 9, 0.0);
+          rot[0] = rot[4] = rot[8] = 1.0;
+          return rmsd;
+        }
+      }
+    }
+  }
+
+  double const normq = std::sqrt(qsqr);
+  q1 /= normq;
+  q2 /= normq;
+  q3 /= normq;
+  q4 /= normq;
+
+  double const a2 = q1 * q1, x2 = q2 * q2, y2 = q3 * q3, z2 = q4 * q4;
+  double const xy = q2 * q3, az = q1 * q4, zx = q4 * q2;
+  double const ay = q1 * q3, yz = q3 * q4, ax = q1 * q2;
+
+  rot[0] = a2 + x2 - y2 - z2;
+  rot[1] = 2 * (xy + az);
+  rot[2] = 2 * (zx - ay);
+  rot[3] = 2 * (xy - az);
+  rot[4] = a2 - x2 + y2 - z2;
+  rot[5] = 2 * (yz + ax);
+  rot[6] = 2 * (zx + ay);
+  rot[7] = 2 * (yz - ax);
+  rot[8] = a2 - x2 - y2 + z2;
+
+  return rmsd;
+}
+
+/**
+ * Superposition of frame `fb` (mobile) onto frame `fa` (target)
+ *
+ * @param[out] ttt TTT matrix or null
+ */
+float fitPair(const CenteredFrames& frames, std::size_t fa, std::size_t fb,
+    float* ttt)
+{
+  double A[9], rot[9];
+  innerProduct(frames, fa, fb, A);
+
+  double const E0 = 0.5 * (frames.sumSq[fa] + frames.sumSq[fb]);
+  double rmsd = qcpRMSD(A, E0, frames.nAtoms, ttt ? rot : nullptr);
+
+  if (ttt) {
+    const double* ca = frames.centers.data() + fa * 3;
+    const double* cb = frames.centers.data() + fb * 3;
+    for (int i = 0; i < 3; ++i) {
+      ttt[i * 4 + 0] = rot[i * 3 + 0];
+      ttt[i * 4 + 1] = rot[i * 3 + 1];
+      ttt[i * 4 + 2] = rot[i * 3 + 2];
+      ttt[i * 4 + 3] = ca[i];
+      ttt[12 + i] = -cb[i];
+    }
+    ttt[15] = 1.f;
+  }
+
+  // same threshold as MatrixFitRMSTTTf
+  return rmsd < 1e-4 ? 0.f : float(rmsd);
+}
+
+/**
+ * Plain RMSD of two frames, without superposition
+ */
+float rmsPair(const CoordFrames& frames, std::size_t fa, std::size_t fb)
+{
+  const float* a = frames.frame(fa);
+  const float* b = frames.frame(fb);
+  int const n = frames.nAtoms * 3;
+  double sum = 0.0;
+
+#ifdef PYMOL_OPENMP
+#pragma omp simd reduction(+ : sum)
+#endif
+  for (int i = 0; i < n; ++i) {
+    double const d = double(a[i]) - b[i];
+    sum += d * d;
+  }
+
+  return float(std::sqrt(sum / (frames.nAtoms ? frames.nAtoms : 1)));
+}
+
+} // namespace
+
+float QCPFitRMSTTTf(
+    std::size_t n, const float* mobile, const float* target, float* ttt)
+{
+  CoordFrames frames(2, n);
+  std::copy_n(target, n * 3, frames.frame(0));
+  std::copy_n(mobile, n * 3, frames.frame(1));
+  return fitPair(CenteredFrames(frames), 0, 1, ttt);
+}
+
+std::vector<float> SuperposeFrames(const CoordFrames& frames, std::size_t ref,
+    bool fit, std::vector<float>* ttts)
+{
+  int const n_frames = frames.nFrames;
+  std::vector<float> rms(n_frames);
+
+  if (ttts) {
+    ttts->assign(16 * n_frames, 0.f);
+  }
+
+  if (!fit) {
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for
+#endif
+    for (int f = 0; f < n_frames; ++f) {
+      rms[f] = rmsPair(frames, ref, f);
+    }
+    return rms;
+  }
+
+  CenteredFrames const centered(frames);
+
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for
+#endif
+  for (int f = 0; f < n_frames; ++f) {
+    rms[f] = fitPair(centered, ref, f, ttts ? ttts->data() + 16 * f : nullptr);
+  }
+
+  return rms;
+}
+
+std::vector<float> RMSMatrix(const CoordFrames& frames, bool fit)
+{
+  int const n = frames.nFrames;
+  std::vector<float> matrix(std::size_t(n) * n, 0.f);
+
+  if (!n)
+    return matrix;
+
+  std::vector<CenteredFrames> centered;
+  if (fit) {
+    centered.emplace_back(frames);
+  }
+
+  // upper triangle, rows get shorter so schedule dynamically
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for schedule(dynamic, 4)
+#endif
+  for (int i = 0; i < n; ++i) {
+    for (int j = i + 1; j < n; ++j) {
+      float const rms = fit ? fitPair(centered[0], i, j, nullptr)
+                            : rmsPair(frames, i, j);
+      matrix[std::size_t(i) * n + j] = rms;
+      matrix[std::size_t(j) * n + i] = rms;
+    }
+  }
+
+  return matrix;
+}
+
+std::vector<std::vector<int>> ClusterRMSMatrix(
+    const std::vector<float>& matrix, std::size_t n, float cutoff)
+{
+  std::vector<std::vector<int>> clusters;
+  std::vector<bool> taken(n, false);
+  std::vector<int> count(n, 0);
+
+  auto const neighbors = [&](std::size_t i, std::size_t j) {
+    return matrix[i * n + j] <= cutoff;
+  };
+
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = 0; j < n; ++j) {
+      count[i] += neighbors(i, j);
+    }
+  }
+
+  for (std::size_t remaining = n; remaining;) {
+    std::size_t center = n;
+    for (std::size_t i = 0; i < n; ++i) {
+      if (!taken[i] && (center == n || count[i] > count[center])) {
+        center = i;
+      }
+    }
+
+    std::vector<int> members{int(center)};
+    taken[center] = true;
+    for (std::size_t j = 0; j < n; ++j) {
+      if (!taken[j] && neighbors(center, j)) {
+        members.push_back(j);
+        taken[j] = true;
+      }
+    }
+
+    // update neighbor counts of the frames which are left
+    for (int k : members) {
+      for (std::size_t i = 0; i < n; ++i) {
+        if (!taken[i] && neighbors(i, k)) {
+          --count[i];
+        }
+      }
+    }
+
+    remaining -= members.size();
+    clusters.push_back(std::move(members));
+  }
+
+  return clusters;
+}
+
+} // namespace pymol
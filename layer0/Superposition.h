@@ -0,0 +1,81 @@
+/**
+ * @file
+ * Batched least-squares superposition (QCP) of coordinate frames
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace pymol
+{
+
+/**
+ * Coordinates of the same atoms in several frames (e.g. object states),
+ * stored as one contiguous frames x atoms x 3 buffer.
+ */
+struct CoordFrames {
+  std::size_t nFrames = 0;
+  std::size_t nAtoms = 0;
+  std::vector<float> xyz;
+
+  CoordFrames() = default;
+  CoordFrames(std::size_t frames, std::size_t atoms)
+      : nFrames(frames)
+      , nAtoms(atoms)
+      , xyz(frames * atoms * 3)
+  {
+  }
+
+  float* frame(std::size_t f) { return xyz.data() + f * nAtoms * 3; }
+  const float* frame(std::size_t f) const
+  {
+    return xyz.data() + f * nAtoms * 3;
+  }
+};
+
+/**
+ * Optimal superposition of `mobile` onto `target` with the quaternion
+ * characteristic polynomial (QCP) method. Unweighted.
+ *
+ * @param n Number of atoms
+ * @param mobile Flat Nx3 coordinates
+ * @param target Flat Nx3 coordinates
+ * @param[out] ttt If not null, TTT matrix which maps mobile onto target
+ * @return RMSD after superposition
+ */
+float QCPFitRMSTTTf(std::size_t n, const float* mobile, const float* target,
+    float* ttt = nullptr);
+
+/**
+ * RMSD of every frame to frame `ref`.
+ *
+ * @param fit If true, compute the RMSD after optimal superposition and
+ * (if `ttts` is not null) the TTT matrix for each frame
+ * @param[out] ttts If not null, resized to 16 * nFrames
+ */
+std::vector<float> SuperposeFrames(const CoordFrames& frames, std::size_t ref,
+    bool fit = true, std::vector<float>* ttts = nullptr);
+
+/**
+ * All-vs-all RMSD matrix.
+ *
+ * @param fit If true, RMSD after optimal superposition of each pair
+ * @return Symmetric nFrames x nFrames matrix (row-major)
+ */
+std::vector<float> RMSMatrix(const CoordFrames& frames, bool fit = true);
+
+/**
+ * Clusters frames with the algorithm from Daura et al. (1999): The frame
+ * with the most neighbors within `cutoff` becomes a cluster center, it's
+ * removed together with its neighbors, and this is repeated until no
+ * frames are left.
+ *
+ * @param matrix n x n RMSD matrix
+ * @return Clusters (largest first), each with its center as the first member
+ */
+std::vector<std::vector<int>> ClusterRMSMatrix(
+    const std::vector<float>& matrix, std::size_t n, float cutoff);
+
+} // namespace pymol
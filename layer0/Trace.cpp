@@ -0,0 +1,191 @@
+/**
+ * @file
+ * Lightweight tracing of hot paths (scoped spans and counters)
+ */
+
+#include "Trace.h"
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+namespace pymol
+{
+namespace trace
+{
+
+// don't let a forgotten capture eat all memory
+#define TRACE_MAX_EVENTS (1 << 22)
+
+namespace
+{
+struct Event {
+  char phase; // 'X' (complete span) or 'C' (counter)
+  int tid;
+  const char* name;
+  const char* category;
+  std::int64_t start;
+  std::int64_t duration;
+  double value;
+  std::string detail;
+};
+
+struct Capture {
+  std::mutex mutex;
+  std::vector<Event> events;
+  std::int64_t epoch = 0;
+  std::size_t dropped = 0;
+  int n_threads = 0;
+};
+
+Capture& capture()
+{
+  static Capture instance;
+  return instance;
+}
+
+/// Small sequential id of the calling thread
+int thread_id()
+{
+  thread_local int tid = 0;
+  if (!tid) {
+    auto& I = capture();
+    std::lock_guard<std::mutex> lock(I.mutex);
+    tid = ++I.n_threads;
+  }
+  return tid;
+}
+
+void add(Event&& event)
+{
+  auto& I = capture();
+  std::lock_guard<std::mutex> lock(I.mutex);
+  if (!enabled()) {
+    return;
+  }
+  if (I.events.size() >= TRACE_MAX_EVENTS) {
+    ++I.dropped;
+    return;
+  }
+  I.events.push_back(std::move(event));
+}
+
+void write_json_string(FILE* f, const char* s)
+{
+  fputc('"', f);
+  for (; *s; ++s) {
+    auto c = static_cast<unsigned char>(*s);
+    if (c == '"' || c == '\\') {
+      fputc('\\', f);
+      fputc(c, f);
+    } else if (c < 0x20) {
+      fprintf(f, "\\u%04x", c);
+    } else {
+      fputc(c, f);
+    }
+  }
+  fputc('"', f);
+}
+} // namespace
+
+namespace detail
+{
+std::atomic<bool> enabled{false};
+
+std::int64_t now()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void complete(const char* name, const char* category, std::int64_t start,
+    std::int64_t end, std::string&& detail)
+{
+  add({'X', thread_id(), name, category, start, end - start, 0.0,
+      std::move(detail)});
+}
+} // namespace detail
+
+void start()
+{
+  auto& I = capture();
+  std::lock_guard<std::mutex> lock(I.mutex);
+  I.events.clear();
+  I.dropped = 0;
+  I.epoch = detail::now();
+  detail::enabled = true;
+}
+
+void stop()
+{
+  auto& I = capture();
+  std::lock_guard<std::mutex> lock(I.mutex);
+  detail::enabled = false;
+}
+
+std::size_t size()
+{
+  auto& I = capture();
+  std::lock_guard<std::mutex> lock(I.mutex);
+  return I.events.size();
+}
+
+void counter(const char* name, double value)
+{
+  if (!enabled()) {
+    return;
+  }
+  add({'C', thread_id(), name, "counter", detail::now(), 0, value, {}});
+}
+
+bool write(const char* filename)
+{
+  FILE* f = fopen(filename, "wb");
+  if (!f) {
+    return false;
+  }
+
+  auto& I = capture();
+  std::lock_guard<std::mutex> lock(I.mutex);
+
+  fputs("{\"traceEvents\":[\n", f);
+  for (int tid = 1; tid <= I.n_threads; ++tid) {
+    fprintf(f,
+        "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%d,"
+        "\"args\":{\"name\":\"thread %d\"}},\n",
+        tid, tid);
+  }
+  for (auto const& event : I.events) {
+    fputs("{\"name\":", f);
+    write_json_string(f, event.name);
+    fputs(",\"cat\":", f);
+    write_json_string(f, event.category);
+    fprintf(f, ",\"ph\":\"%c\",\"pid\":1,\"tid\":%d,\"ts\":%lld", event.phase,
+        event.tid, static_cast<long long>(event.start - I.epoch));
+    if (event.phase == 'X') {
+      fprintf(f, ",\"dur\":%lld", static_cast<long long>(event.duration));
+      if (!event.detail.empty()) {
+        fputs(",\"args\":{\"detail\":", f);
+        write_json_string(f, event.detail.c_str());
+        fputc('}', f);
+      }
+    } else {
+      fputs(",\"args\":{", f);
+      write_json_string(f, event.name);
+      fprintf(f, ":%.17g}", event.value);
+    }
+    fputs("},\n", f);
+  }
+  fprintf(f,
+      "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,"
+      "\"args\":{\"name\":\"PyMOL\"}}\n],\n"
+      "\"otherData\":{\"dropped_events\":%zu}}\n",
+      I.dropped);
+
+  return fclose(f) == 0;
+}
+
+} // namespace trace
+} // namespace pymol
@@ -0,0 +1,110 @@
+/**
+ * @file
+ * Lightweight tracing of hot paths (scoped spans and counters)
+ *
+ * Events are only recorded while a capture is running (see `trace` command),
+ * otherwise a span costs one relaxed atomic load. The capture is process
+ * wide and thread safe, and is written in the Chrome trace event format,
+ * which can be opened in chrome://tracing or https://ui.perfetto.dev
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace pymol
+{
+namespace trace
+{
+
+namespace detail
+{
+extern std::atomic<bool> enabled;
+
+std::int64_t now();
+void complete(const char* name, const char* category, std::int64_t start,
+    std::int64_t end, std::string&& detail);
+} // namespace detail
+
+/// True while a capture is running
+inline bool enabled()
+{
+  return detail::enabled.load(std::memory_order_relaxed);
+}
+
+/// Discard all events and start a new capture
+void start();
+
+/// Stop recording, the events are kept until the next start()
+void stop();
+
+/// Number of recorded events
+std::size_t size();
+
+/**
+ * Write the recorded events as Chrome trace JSON.
+ * @return false if the file couldn't be written
+ */
+bool write(const char* filename);
+
+/// Record the value of a counter (shown as a track over time)
+void counter(const char* name, double value);
+
+/**
+ * Records the time from construction to destruction (or end()) as a span
+ * on the current thread. `name` and `category` must be string literals (or
+ * otherwise outlive the capture), `detail` is copied.
+ */
+class Span
+{
+  const char* m_name;
+  const char* m_category;
+  std::int64_t m_start = -1;
+  std::string m_detail;
+
+public:
+  explicit Span(const char* name, const char* category = "pymol")
+      : m_name(name)
+      , m_category(category)
+  {
+    if (enabled()) {
+      m_start = detail::now();
+    }
+  }
+
+  Span(const char* name, const char* category, const char* detail)
+      : Span(name, category)
+  {
+    if (m_start >= 0 && detail) {
+      m_detail = detail;
+    }
+  }
+
+  Span(const Span&) = delete;
+  Span& operator=(const Span&) = delete;
+
+  ~Span() { end(); }
+
+  /// End the span before the end of the scope
+  void end()
+  {
+    if (m_start >= 0) {
+      detail::complete(
+          m_name, m_category, m_start, detail::now(), std::move(m_detail));
+      m_start = -1;
+    }
+  }
+};
+
+} // namespace trace
+} // namespace pymol
+
+#define PYMOL_TRACE_CAT2(a, b) a##b
+#define PYMOL_TRACE_CAT(a, b) PYMOL_TRACE_CAT2(a, b)
+
+/// Trace the enclosing scope, e.g. PYMOL_TRACE_SCOPE("SceneUpdate", "scene")
+#define PYMOL_TRACE_SCOPE(...)                                                 \
+  pymol::trace::Span PYMOL_TRACE_CAT(_pymol_trace_span_, __LINE__)(__VA_ARGS__)
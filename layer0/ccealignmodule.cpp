@@ -30,10 +30,16 @@
 //
 //////////////////////////////////////////////////////////////////////////////
 
-#ifndef _PYMOL_NOPY
 #include "os_python.h"
 #include "os_std.h"
 
+#include <algorithm>
+#include <cassert>
+
+#ifdef PYMOL_OPENMP
+#include <omp.h>
+#endif
+
 #include "ce_types.h"
 
 #include "tnt/tnt.h"
@@ -52,199 +58,273 @@ TA2<double> transpose(const TA2<double>& v);
 /////////////////////////////////////////////////////////////////////////////
 // CE Specific
 /////////////////////////////////////////////////////////////////////////////
-double** calcDM(pcePoint coords, int len)
+ceMatrix calcDM(const cePoint* coords, int len)
 {
-  int i = 0;
-
-  double** dm = (double**) malloc(sizeof(double*)*len);
-  for (i = 0; i < len; i++)
-    dm[i] = (double*) malloc( sizeof(double)*len);
-
-  int row=0, col=0;
-  for (row = 0; row < len; row++) {
-    for (col = 0; col < len; col++) {
-      dm[row][col] = sqrt(pow(coords[row].x - coords[col].x,2) +
-			  pow(coords[row].y - coords[col].y,2) +
-			  pow(coords[row].z - coords[col].z,2) );
+  ceMatrix dm(len, len);
+
+  // symmetric, only compute the upper triangle
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+  for (int row = 0; row < len; row++) {
+    dm[row][row] = 0.f;
+    for (int col = row + 1; col < len; col++) {
+      double dx = coords[row].x - coords[col].x;
+      double dy = coords[row].y - coords[col].y;
+      double dz = coords[row].z - coords[col].z;
+      dm[row][col] = dm[col][row] = (float) sqrt(dx * dx + dy * dy + dz * dz);
     }
   }
   return dm;
 }
 
-double** calcS(double** d1, double** d2, int lenA, int lenB, int wSize)
+ceMatrix calcS(const ceMatrix& d1, const ceMatrix& d2, int wSize)
 {
-  int i;
-  double winSize = (double) wSize;
+  int lenA = d1.rows;
+  int lenB = d2.rows;
+
   // initialize the 2D similarity matrix
-  double** S = (double**) malloc(sizeof(double*)*lenA);
-  for (i = 0; i < lenA; i++)
-    S[i] = (double*) malloc( sizeof(double)*lenB);
-  
-  double sumSize = (winSize-1.0)*(winSize-2.0) / 2.0;
+  ceMatrix S(lenA, lenB, -1.f);
+
+  if (lenA < wSize || lenB < wSize)
+    return S;
+
+  double sumSize = (wSize-1.0)*(wSize-2.0) / 2.0;
+  int lastA = lenA - wSize;
+  int lastB = lenB - wSize;
   //
   // This is where the magic of CE comes out.  In the similarity matrix,
   // for each i and j, the value of ceSIM[i][j] is how well the residues
   // i - i+winSize in protein A, match to residues j - j+winSize in protein
   // B.  A value of 0 means absolute match; a value >> 1 means bad match.
   //
-  int iA, iB, row, col;
-  for (iA = 0; iA < lenA; iA++) {
-    for (iB = 0; iB < lenB; iB++) {
-      S[iA][iB] = -1.0;
-      if (iA > lenA - wSize || iB > lenB - wSize)
-	continue;
-		
-      double score = 0.0;
-
-      //
-      // We always skip the calculation of the distance from THIS
-      // residue, to the next residue.  This is a time-saving heur-
-      // istic decision.  Almost all alpha carbon bonds of neighboring
-      // residues is 3.8 Angstroms.  Due to entropy, S = -k ln pi * pi,
-      // this tell us nothing, so it doesn't help so ignore it.
-      //
-      for (row = 0; row <  wSize - 2; row++) {
-	for (col = row + 2; col <  wSize; col++) {
-	  score += fabs( d1[iA+row][iA+col] - d2[iB+row][iB+col] );
-	}
+  // We always skip the calculation of the distance from THIS
+  // residue, to the next residue.  This is a time-saving heur-
+  // istic decision.  Almost all alpha carbon bonds of neighboring
+  // residues is 3.8 Angstroms.  Due to entropy, S = -k ln pi * pi,
+  // this tell us nothing, so it doesn't help so ignore it.
+  //
+  // Moving from (iA, iB) to (iA+1, iB+1) only drops the pairs which start
+  // at iA and adds the pairs which end at iA+wSize, so every diagonal is
+  // one sliding window with O(wSize) work per cell instead of O(wSize^2).
+  //
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for schedule(dynamic, 8)
+#endif
+  for (int diag = -lastA; diag <= lastB; diag++) {
+    int iA = (diag < 0) ? -diag : 0;
+    int iB = (diag < 0) ? 0 : diag;
+
+    double score = 0.0;
+    for (int row = 0; row < wSize - 2; row++) {
+      for (int col = row + 2; col < wSize; col++) {
+        score += fabs( (double) d1[iA+row][iA+col] - d2[iB+row][iB+col] );
       }
-
-      S[iA][iB] = score / sumSize;
+    }
+    S[iA][iB] = (float) (score / sumSize);
+
+    for (; iA < lastA && iB < lastB; iA++, iB++) {
+      const float* outA = d1[iA];
+      const float* outB = d2[iB];
+      const float* inA = d1[iA + wSize];
+      const float* inB = d2[iB + wSize];
+      for (int k = 2; k < wSize; k++) {
+        score -= fabs( (double) outA[iA+k] - outB[iB+k] );
+        score += fabs( (double) inA[iA+wSize-k] - inB[iB+wSize-k] );
+      }
+      S[iA+1][iB+1] = (float) (score / sumSize);
     }
   }
   return S;
 }
 
 
+namespace {
 
-pcePoint getCoords(PyObject* L, int length)
-{
-  // make space for the current coords
-  pcePoint coords = (pcePoint) malloc(sizeof(cePoint)*length);
+// CE-specific cutoffs
+const int MAX_KEPT = 20;
 
-  if (!coords)
-    return nullptr;
+/*
+// Outcome of the path search from one (iA, iB) starting point
+*/
+struct ceStart {
+  int iA, iB;
+  int len;      // length of the longest path found from here (0 if none)
+  double score;
+  int pathIdx;  // index into ceChunk::paths, or -1 if not stored
+};
+
+/*
+// Search results for a block of consecutive iA rows
+*/
+struct ceChunk {
+  std::vector<ceStart> starts;
+  std::vector<std::vector<afp>> paths;
+};
+
+/*
+// Replays the starting points in serial order, applying the global pruning
+// and keeping the (up to) 20 most recent best paths in a ring buffer.
+*/
+struct ceReplay {
+  int lenA, lenB, winSize;
 
-  // loop through the arguments, pulling out the
-  // XYZ coordinates.
-  int i;
-  for ( i = 0; i < length; i++ ) {
-    PyObject* curCoord = PyList_GetItem(L,i);
-    Py_INCREF(curCoord);
+  double bestPathScore = 1e6;
+  int bestPathLength = 0;
+  const std::vector<afp>* bestPath = nullptr;
+  bool finished = false;
 
-    PyObject* curVal = PyList_GetItem(curCoord,0);
-    Py_INCREF(curVal);
-    coords[i].x = PyFloat_AsDouble(curVal);
-    Py_DECREF(curVal);
+  int bufferIndex = 0, bufferSize = 0;
+  int lenBuffer[MAX_KEPT];
+  double scoreBuffer[MAX_KEPT];
+  const std::vector<afp>* pathBuffer[MAX_KEPT];
+
+  ceReplay(int lenA_, int lenB_, int winSize_)
+      : lenA(lenA_), lenB(lenB_), winSize(winSize_)
+  {
+    for (int i = 0; i < MAX_KEPT; i++ ) {
+      // initialize the paths
+      scoreBuffer[i] = 1e6;
+      lenBuffer[i] = 0;
+      pathBuffer[i] = nullptr;
+    }
+  }
 
-    curVal = PyList_GetItem(curCoord,1);
-    Py_INCREF(curVal);
-    coords[i].y = PyFloat_AsDouble(curVal);
-    Py_DECREF(curVal);
+  void add(const ceChunk& chunk)
+  {
+    int curRow = -1;
+    bool rowDone = false;
+
+    for (const auto& start : chunk.starts) {
+      if (finished)
+        return;
+
+      if (start.iA != curRow) {
+        curRow = start.iA;
+        rowDone = false;
+        if ( curRow > lenA - winSize*(bestPathLength-1) ) {
+          finished = true;
+          return;
+        }
+      }
 
-    curVal = PyList_GetItem(curCoord,2);
-    Py_INCREF(curVal);
-    coords[i].z = PyFloat_AsDouble(curVal);
-    Py_DECREF(curVal);
+      if (rowDone)
+        continue;
 
-    Py_DECREF(curCoord);
-  }
+      if ( start.iB > lenB - winSize*(bestPathLength-1) ) {
+        rowDone = true;
+        continue;
+      }
 
-  return coords;
-}
+      if ( start.len > bestPathLength ||
+           (start.len && start.len == bestPathLength && start.score < bestPathScore )) {
+        // improves on the global best, so it also improved on its block's
+        // best and was stored
+        assert(start.pathIdx != -1);
+        bestPathLength = start.len;
+        bestPathScore = start.score;
+        bestPath = &chunk.paths[start.pathIdx];
+      }
 
+      if ( bestPathLength > lenBuffer[bufferIndex] ||
+           ( bestPathLength == lenBuffer[bufferIndex] &&
+             bestPathScore < scoreBuffer[bufferIndex] )) {
+
+        // we're going to add an entry to the ring-buffer.
+        // Adjust maxSize values and curIndex accordingly.
+        bufferIndex = ( bufferIndex == MAX_KEPT-1 ) ? 0 : bufferIndex+1;
+        bufferSize = ( bufferSize < MAX_KEPT ) ? bufferSize+1 : MAX_KEPT;
+
+        int slot = ( bufferIndex == 0 && bufferSize == MAX_KEPT ) ?
+          MAX_KEPT-1 : bufferIndex-1;
+        pathBuffer[slot] = bestPath;
+        scoreBuffer[slot] = bestPathScore;
+        lenBuffer[slot] = bestPathLength;
+      }
+    }
+  }
+};
 
+} // namespace
 
-pathCache findPath( double** S, double** dA, double** dB, int lenA, int lenB, float D0, float D1, int winSize, int gapMax, int * bufferSize )
+/*
+// Runs the CE path search for all starting points iA in [iABegin, iAEnd).
+//
+// Apart from pruning, the search from each starting point is independent of
+// all other starting points, so blocks of rows can be searched concurrently.
+// Pruning starts from `bestPathLength`, the global best length of all
+// preceding blocks which have already been replayed, and otherwise only uses
+// paths seen within this block. This is never larger than what the serial
+// search would have seen at that point. Paths are stored for every start that
+// improves on the block's best, which is a superset of the starts that improve
+// on the global best.
+*/
+static void findPathChunk(const ceMatrix& S, const ceMatrix& dA,
+    const ceMatrix& dB, float D0, float D1, int winSize, int gapMax,
+    int iABegin, int iAEnd, int bestPathLength, ceChunk& chunk)
 {
-  // CE-specific cutoffs
-  const int MAX_KEPT = 20;
+  int lenA = dA.rows;
+  int lenB = dB.rows;
 
   // the best Path's score
   double bestPathScore = 1e6;
-  int bestPathLength = 0;
 
   // length of longest possible alignment
   int smaller = ( lenA < lenB ) ? lenA : lenB;
   int winSum = (winSize-1)*(winSize-2)/2;
-
-  path bestPath = (path) malloc(sizeof(afp)*smaller);
-
-  // index variable for below
-  int i, j;
-  for ( i = 0; i < smaller; i++ ) {
-    bestPath[i].first = -1;
-    bestPath[i].second = -1;
-  }
-
-  //======================================================================
-  // for storing the best 20 paths
-  int bufferIndex = 0; //, bufferSize = 0;
-  int lenBuffer[MAX_KEPT];
-  double scoreBuffer[MAX_KEPT];
-  pathCache pathBuffer = (pathCache) malloc(sizeof(path*)*MAX_KEPT);
-
-  for ( i = 0; i < MAX_KEPT; i++ ) {
-    // initialize the paths
-    scoreBuffer[i] = 1e6;
-    lenBuffer[i] = 0;
-    pathBuffer[i] = 0;
-  }
+  int nGap = gapMax*2+1;
 
   // winCache
   // this array stores a list of residues seen.  We use it to calculate the
   // total score of a path from 1..M and then add it to M+1..N.
-  int* winCache = (int*) malloc(sizeof(int)*smaller);
-  for ( i = 0; i < smaller; i++ )
+  std::vector<int> winCache(smaller);
+  for (int i = 0; i < smaller; i++ )
     winCache[i] = (i+1)*i*winSize/2 + (i+1)*winSum;
 
   // allScoreBuffer
   // this 2D array keeps track of all partial gapped scores
-  double** allScoreBuffer = (double**) malloc(sizeof(double*)*smaller);
-  for ( i = 0; i < smaller; i++ ) {
-    allScoreBuffer[i] = (double*) malloc( (gapMax*2+1) * sizeof(double));
-    // initialize the ASB
-    for ( j = 0; j < gapMax*2+1; j++ )
-      allScoreBuffer[i][j] = 1e6;
-  }
-	
-  int* tIndex = (int*) malloc(sizeof(int)*smaller);
+  std::vector<double> allScoreBuffer(size_t(smaller) * nGap, 1e6);
+  auto ASB = [&](int i, int g) -> double& {
+    return allScoreBuffer[size_t(i) * nGap + g];
+  };
+
+  std::vector<int> tIndex(smaller);
+  std::vector<afp> curPath(smaller);
   int gapBestIndex = -1;
 
   //======================================================================
   // Start the search through the CE matrix.
   //
-  int iA, iB;
-  for ( iA = 0; iA < lenA; iA++ ) {
+  for (int iA = iABegin; iA < iAEnd; iA++ ) {
     if ( iA > lenA - winSize*(bestPathLength-1) )
       break;
 
-    for ( iB = 0; iB < lenB; iB++ ) {
-      if ( S[iA][iB] >= D0 )
+    const float* S_iA = S[iA];
+
+    for (int iB = 0; iB < lenB; iB++ ) {
+      if ( S_iA[iB] >= D0 )
 	continue;
-			
-      if ( S[iA][iB] == -1.0 )
+
+      if ( S_iA[iB] == -1.0 )
 	continue;
-			
+
       if ( iB > lenB - winSize*(bestPathLength-1) )
 	break;
 
       //
       // Restart curPath here.
       //
-      path curPath = (path) malloc( sizeof(afp)*smaller );
-
-      int i;
-      for ( i = 0; i < smaller; i++ ) {
-	curPath[i].first = -1;
-	curPath[i].second = -1;
-      }
+      std::fill(curPath.begin(), curPath.end(), afp{-1, -1});
       curPath[0].first = iA;
       curPath[0].second = iB;
       int curPathLength = 1;
       tIndex[curPathLength-1] = 0;
       double curTotalScore = 0.0;
 
+      // longest path (and its score) reached from iA, iB
+      int candLength = 0;
+      double candScore = 1e6;
+
       //
       // Check all possible paths starting from iA, iB
       //
@@ -252,12 +332,11 @@ pathCache findPath( double** S, double** dA, double** dB, int lenA, int lenB, fl
       while ( ! done ) {
 	double gapBestScore = 1e6;
 	gapBestIndex = -1;
-	int g;
 
 	//
 	// Check all possible gaps [1..gapMax] from here
 	//
-	for ( g = 0; g < (gapMax*2)+1; g++ ) {
+	for (int g = 0; g < nGap; g++ ) {
 	  int jA = curPath[curPathLength-1].first + winSize;
 	  int jB = curPath[curPathLength-1].second + winSize;
 
@@ -272,7 +351,7 @@ pathCache findPath( double** S, double** dA, double** dB, int lenA, int lenB, fl
 	  // Following are three heuristics to ensure high quality
 	  // long paths and make sure we don't run over the end of
 	  // the S, matrix.
-					
+
 	  // 1st: If jA and jB are at the end of the matrix
 	  if ( jA > lenA-winSize || jB > lenB-winSize ){
 	    // FIXME, was: jA > lenA-winSize-1 || jB > lenB-winSize-1
@@ -284,35 +363,35 @@ pathCache findPath( double** S, double** dA, double** dB, int lenA, int lenB, fl
 	  // 3rd: if too close to end, ignore it.
 	  if ( S[jA][jB] == -1.0 )
 	    continue;
-					
+
 	  double curScore = 0.0;
-	  int s;
-	  for ( s = 0; s < curPathLength; s++ ) {
-	    curScore += fabs( dA[curPath[s].first][jA] - dB[curPath[s].second][jB] );
-	    curScore += fabs( dA[curPath[s].first  + (winSize-1)][jA+(winSize-1)] - 
-			      dB[curPath[s].second + (winSize-1)][jB+(winSize-1)] );
-	    int k;
-	    for ( k = 1; k < winSize-1; k++ )
-	      curScore += fabs( dA[curPath[s].first  + k][ jA + (winSize-1) - k ] - 
-				dB[curPath[s].second + k][ jB + (winSize-1) - k ] );
+	  for (int s = 0; s < curPathLength; s++ ) {
+	    int pA = curPath[s].first;
+	    int pB = curPath[s].second;
+	    curScore += fabs( (double) dA[pA][jA] - dB[pB][jB] );
+	    curScore += fabs( (double) dA[pA + (winSize-1)][jA+(winSize-1)] -
+			      dB[pB + (winSize-1)][jB+(winSize-1)] );
+	    for (int k = 1; k < winSize-1; k++ )
+	      curScore += fabs( (double) dA[pA + k][ jA + (winSize-1) - k ] -
+				dB[pB + k][ jB + (winSize-1) - k ] );
 	  }
-					
+
 	  curScore /= (double) winSize * (double) curPathLength;
 
 	  if ( curScore >= D1 ) {
 	    continue;
 	  }
 
-	  // store GAPPED best					
+	  // store GAPPED best
 	  if ( curScore < gapBestScore ) {
 	    curPath[curPathLength].first = jA;
 	    curPath[curPathLength].second = jB;
 	    gapBestScore = curScore;
 	    gapBestIndex = g;
-	    allScoreBuffer[curPathLength-1][g] = curScore;
+	    ASB(curPathLength-1, g) = curScore;
 	  }
 	} /// ROF -- END GAP SEARCHING
-				
+
 	//
 	// DONE GAPPING:
 	//
@@ -321,7 +400,7 @@ pathCache findPath( double** S, double** dA, double** dB, int lenA, int lenB, fl
 	curTotalScore = 0.0;
 	int jGap, gA, gB;
 	double score1=0.0, score2=0.0;
-				
+
 	if ( gapBestIndex != -1 ) {
 	  jGap = (gapBestIndex + 1 ) / 2;
 	  if ((gapBestIndex + 1 ) % 2 == 0) {
@@ -334,13 +413,13 @@ pathCache findPath( double** S, double** dA, double** dB, int lenA, int lenB, fl
 	  }
 
 	  // perfect
-	  score1 = (allScoreBuffer[curPathLength-1][gapBestIndex] * winSize * curPathLength
+	  score1 = (ASB(curPathLength-1, gapBestIndex) * winSize * curPathLength
 		    + S[gA][gB]*winSum)/(winSize*curPathLength+winSum);
 
 	  // perfect
-	  score2 = ((curPathLength > 1 ? (allScoreBuffer[curPathLength-2][tIndex[curPathLength-1]])
-		     : S[iA][iB])
-		    * winCache[curPathLength-1] 
+	  score2 = ((curPathLength > 1 ? ASB(curPathLength-2, tIndex[curPathLength-1])
+		     : S_iA[iB])
+		    * winCache[curPathLength-1]
 		    + score1 * (winCache[curPathLength] - winCache[curPathLength-1]))
 	    / winCache[curPathLength];
 
@@ -352,7 +431,7 @@ pathCache findPath( double** S, double** dA, double** dB, int lenA, int lenB, fl
 	    break;
 	  }
 	  else {
-	    allScoreBuffer[curPathLength-1][gapBestIndex] = curTotalScore;
+	    ASB(curPathLength-1, gapBestIndex) = curTotalScore;
 	    tIndex[curPathLength] = gapBestIndex;
 	    curPathLength++;
 	  }
@@ -365,85 +444,96 @@ pathCache findPath( double** S, double** dA, double** dB, int lenA, int lenB, fl
 	  break;
 	}
 
-	//
-	// test this gapped path against the best seen
-	// starting from iA, iB
-	// 
-
-	// if our currently best gapped path from iA and iB is LONGER
-	// than the current best; or, it's equal length and the score's
-	// better, keep the new path.
-	if ( curPathLength > bestPathLength ||
-	     (curPathLength == bestPathLength && curTotalScore < bestPathScore )) {
-	  bestPathLength = curPathLength;
-	  bestPathScore = curTotalScore;
-	  // deep copy curPath
-	  path tempPath = (path) malloc( sizeof(afp)*smaller );
-
-	  int i;
-	  for ( i = 0; i < smaller; i++ ) {
-	    tempPath[i].first = curPath[i].first;
-	    tempPath[i].second = curPath[i].second;
-	  }
-
-	  free(bestPath);
-	  bestPath = tempPath;
-	}
+	candLength = curPathLength;
+	candScore = curTotalScore;
       } /// END WHILE
 
       //
       // At this point, we've found the best path starting at iA, iB.
       //
-      if ( bestPathLength > lenBuffer[bufferIndex] ||
-	   ( bestPathLength == lenBuffer[bufferIndex] &&
-	     bestPathScore < scoreBuffer[bufferIndex] )) {
-
-	// we're going to add an entry to the ring-buffer.
-	// Adjust maxSize values and curIndex accordingly.
-	bufferIndex = ( bufferIndex == MAX_KEPT-1 ) ? 0 : bufferIndex+1;
-	*bufferSize = ( *bufferSize < MAX_KEPT ) ? (*bufferSize)+1 : MAX_KEPT;
-	path pathCopy = (path) malloc( sizeof(afp)*smaller );
-
-	int i;
-	for ( i = 0; i < smaller; i++ ) {
-	  pathCopy[i].first = bestPath[i].first;
-	  pathCopy[i].second = bestPath[i].second;
-	}
-
-	if ( bufferIndex == 0 && (*bufferSize) == MAX_KEPT ) {
-	  if ( pathBuffer[MAX_KEPT-1] )
-	    free(pathBuffer[MAX_KEPT-1]); 
-	  pathBuffer[MAX_KEPT-1] = pathCopy;
-	  scoreBuffer[MAX_KEPT-1] = bestPathScore;
-	  lenBuffer[MAX_KEPT-1] = bestPathLength;
-	}
-	else {	
-	  if ( pathBuffer[bufferIndex-1] )
-	    free(pathBuffer[bufferIndex-1]);
-	  pathBuffer[bufferIndex-1] = pathCopy;
-	  scoreBuffer[bufferIndex-1] = bestPathScore;
-	  lenBuffer[bufferIndex-1] = bestPathLength;
-	}
+      ceStart start{iA, iB, candLength, candScore, -1};
+
+      // if this path is LONGER than the best seen in this block; or, it's
+      // equal length and the score's better, keep the new path.
+      if ( candLength > bestPathLength ||
+	   (candLength && candLength == bestPathLength && candScore < bestPathScore )) {
+	bestPathLength = candLength;
+	bestPathScore = candScore;
+	start.pathIdx = chunk.paths.size();
+	chunk.paths.emplace_back(curPath.begin(), curPath.begin() + candLength);
       }
-      free(curPath); curPath=0;
+
+      chunk.starts.push_back(start);
     } // ROF -- end for iB
   } // ROF -- end for iA
+}
+
+std::vector<std::vector<afp>> findPath(const ceMatrix& S, const ceMatrix& dA,
+    const ceMatrix& dB, float D0, float D1, int winSize, int gapMax)
+{
+  int lenA = dA.rows;
+  int lenB = dB.rows;
+
+  //======================================================================
+  // Search all starting points, in blocks of rows. Finished blocks are
+  // replayed in order as soon as all preceding blocks are done, and the
+  // resulting best length is used to prune the blocks started after that.
+  //
+  const int CHUNK_ROWS = 16;
+  int nChunks = (lenA + CHUNK_ROWS - 1) / CHUNK_ROWS;
+  std::vector<ceChunk> chunks(nChunks);
+  std::vector<char> chunkDone(nChunks, false);
+  int nextChunk = 0;
+
+  ceReplay replay(lenA, lenB, winSize);
+  int committedLength = 0;
+
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+  for (int c = 0; c < nChunks; c++) {
+    int iABegin = c * CHUNK_ROWS;
+    int iAEnd = std::min(iABegin + CHUNK_ROWS, lenA);
+    int bestPathLength;
+
+#ifdef PYMOL_OPENMP
+#pragma omp atomic read
+#endif
+    bestPathLength = committedLength;
 
-  // free memory
-  for ( i = 0; i < smaller; i++ )
-    free(allScoreBuffer[i]);
-  free(allScoreBuffer);
-  free(tIndex);
-  free(winCache);
-  free(bestPath);
+    findPathChunk(S, dA, dB, D0, D1, winSize, gapMax, iABegin, iAEnd,
+        bestPathLength, chunks[c]);
 
-  return pathBuffer;
+#ifdef PYMOL_OPENMP
+#pragma omp critical(cealign_replay)
+#endif
+    {
+      chunkDone[c] = true;
+      for (; nextChunk < nChunks && chunkDone[nextChunk]; ++nextChunk) {
+        replay.add(chunks[nextChunk]);
+        // no longer needed, paths are still referenced by the ring buffer
+        chunks[nextChunk].starts = std::vector<ceStart>();
+      }
+#ifdef PYMOL_OPENMP
+#pragma omp atomic write
+#endif
+      committedLength = replay.bestPathLength;
+    }
+  }
+
+  std::vector<std::vector<afp>> paths;
+  for (int i = 0; i < replay.bufferSize; ++i) {
+    auto const* p = replay.pathBuffer[i];
+    paths.push_back(p ? *p : std::vector<afp>());
+  }
+  return paths;
 }
 
 
 
 
-PyObject* findBest( pcePoint coordsA, pcePoint coordsB, pathCache paths, int bufferSize, int smaller, int winSize )
+bool findBest(const cePoint* coordsA, const cePoint* coordsB,
+    const std::vector<std::vector<afp>>& paths, int winSize, ceResult& result)
 {
   // keep the best values
   double bestRMSD = 1e6;
@@ -451,62 +541,46 @@ PyObject* findBest( pcePoint coordsA, pcePoint coordsB, pathCache paths, int buf
   TA1<double> bestCOM1, bestCOM2;
   int bestLen = 0;
   int bestO = -1;
-	
+
   // loop through the buffer
-  for ( int o = 0; o < bufferSize; o++ ) {
-
-    // grab the current path
-    TA2<double> c1(smaller, 3, 0.0);
-    TA2<double> c2(smaller, 3, 0.0);
-    int curLen = 0;
-	
-    int j = 0; int it = 0;
-    while ( j < smaller ) {
-			
-      // rebuild the coordinate lists for this path
-      if ( paths[o][j].first != -1 )
-	{
-	  for ( int k = 0; k < winSize; k++ )
-	    {
-	      double t1[] = { coordsA[ paths[o][j].first +k ].x, 
-			      coordsA[ paths[o][j].first +k ].y, 
-			      coordsA[ paths[o][j].first +k ].z };
-
-	      double t2[] = { coordsB[ paths[o][j].second+k ].x, 
-			      coordsB[ paths[o][j].second+k ].y, 
-			      coordsB[ paths[o][j].second+k ].z };
-
-	      for ( int d = 0; d < c1.dim2(); d++ ) {
-		c1[it][d] =  t1[d];
-		c2[it][d] =  t2[d];
-	      }
-	      it++;
-	    }
-	  j++;
-	}
-      else {
-	curLen = it;
-	break;
-      }
-    }
+  for (int o = 0; o < (int) paths.size(); o++ ) {
+    const auto& curPath = paths[o];
 
     //
     // For convenience, let there be M points of N dimensions
-    //	
-    int m = curLen;
-    int n = c2.dim2();
-	
+    //
+    int m = curPath.size() * winSize;
+    int n = 3;
+
+    if (!m)
+      continue;
+
+    // rebuild the coordinate lists for this path
+    TA2<double> c1(m, n, 0.0);
+    TA2<double> c2(m, n, 0.0);
+
+    int it = 0;
+    for (const auto& frag : curPath) {
+      for ( int k = 0; k < winSize; k++ ) {
+	const cePoint& t1 = coordsA[ frag.first + k ];
+	const cePoint& t2 = coordsB[ frag.second + k ];
+	c1[it][0] = t1.x; c1[it][1] = t1.y; c1[it][2] = t1.z;
+	c2[it][0] = t2.x; c2[it][1] = t2.y; c2[it][2] = t2.z;
+	it++;
+      }
+    }
+
     //==========================================================================
-    //	
-    // Superpose the two proteins	
-    //	
+    //
+    // Superpose the two proteins
+    //
     //==========================================================================
-	
+
     // centers of mass for c1 and c2
     TA1<double> c1COM(n,0.0);
     TA1<double> c2COM(n,0.0);
-		
-    // Calc CsOM	
+
+    // Calc CsOM
     for (int i = 0; i < m; i++ )
       {
 	for (int j = 0; j < n; j++ )
@@ -516,7 +590,7 @@ PyObject* findBest( pcePoint coordsA, pcePoint coordsB, pathCache paths, int buf
 	  }
       }
 
-    // Move the two vectors to the origin	
+    // Move the two vectors to the origin
     for (int i = 0; i < m; i++ )
       {
 	for (int j = 0; j < n; j++ )
@@ -527,15 +601,15 @@ PyObject* findBest( pcePoint coordsA, pcePoint coordsB, pathCache paths, int buf
       }
 
     //==========================================================================
-    //	
-    // Calculate U and RMSD.  This is broken down to the super-silly-easy	
-    // math of: U = Wt * V, where Wt and V are NxN matrices from the SVD of 	
-    // R, the correlation matrix between the two origin-based vector sets.	
-    //	
-    //==========================================================================	
-		
-    // Calculate the initial residual, E0	
-    // E0 = sum( Yn*Yn + Xn*Xn ) -- sum of squares	
+    //
+    // Calculate U and RMSD.  This is broken down to the super-silly-easy
+    // math of: U = Wt * V, where Wt and V are NxN matrices from the SVD of
+    // R, the correlation matrix between the two origin-based vector sets.
+    //
+    //==========================================================================
+
+    // Calculate the initial residual, E0
+    // E0 = sum( Yn*Yn + Xn*Xn ) -- sum of squares
     double E0 = 0.0;
     for (int i = 0; i < m; i++ )
       {
@@ -544,107 +618,204 @@ PyObject* findBest( pcePoint coordsA, pcePoint coordsB, pathCache paths, int buf
 	    E0 += (c1[i][j]*c1[i][j])+(c2[i][j]*c2[i][j]);
 	  }
       }
-		
-    //		
-    // SVD is the SVD of the correlation matrix Xt*Y	
-    // R = c2' * c1 = W * S * Vt	
+
+    //
+    // SVD is the SVD of the correlation matrix Xt*Y
+    // R = c2' * c1 = W * S * Vt
     JAMA::SVD<double> svd = JAMA::SVD<double>( TNT::matmult(transpose(c2), c1 ) );
-	
+
     // left singular vectors
     TA2<double> W = TA2<double>(n,n);
     // right singular vectors
     TA2<double> Vt = TA2<double>(n,n);
-    // singular values		
+    // singular values
     TA1<double> sigmas = TA1<double>(n);
-		
+
     svd.getU(W);
     svd.getV(Vt);
     Vt = transpose(Vt);
     svd.getSingularValues(sigmas);
-		
-    //	
-    // Check any reflections before rotation of the points;			
-    // if det(W)*det(V) == -1 then we just reflect		
-    // the principal axis corresponding to the smallest eigenvalue by -1	
-    //		
+
+    //
+    // Check any reflections before rotation of the points;
+    // if det(W)*det(V) == -1 then we just reflect
+    // the principal axis corresponding to the smallest eigenvalue by -1
+    //
     JAMA::LU<double> LU_Vt(Vt);
     JAMA::LU<double> LU_W(W);
-		
+
     if ( LU_W.det() * LU_Vt.det() < 0.0 )
       {
-	//std::cout << "_________REFLECTION_________" << std::endl;	
-			
-	// revese the smallest axes and last sigma	
-			
+	// revese the smallest axes and last sigma
+
 	for ( int i = 0; i < n; i++ )
 	  W[n-1][i] = -W[n-1][i];
-			
+
 	sigmas[n-1] = -sigmas[n-1];
       }
-		
-    // calculate the rotation matrix, U.	
-    // U = W * Vt	
+
+    // calculate the rotation matrix, U.
+    // U = W * Vt
     TA2<double> U = TA2<double>(TNT::matmult(W, Vt));
 
-    //	
-    // Now calculate the RMSD	
-    //	
+    //
+    // Now calculate the RMSD
+    //
     double sig = 0.0;
     for ( int i = 0; i < (int) n; i++ )
       sig += sigmas[i];
-		
+
     double curRMSD = sqrt(fabs((E0 - 2*sig) / (double) m ));
 
     //
     // Save the best
     //
-    if ( curRMSD < bestRMSD || ( curRMSD == bestRMSD && c1.dim1() > bestLen )) {
+    if ( curRMSD < bestRMSD || ( curRMSD == bestRMSD && m > bestLen )) {
       bestU = U.copy();
       bestRMSD = curRMSD;
       bestCOM1 = c1COM.copy();
       bestCOM2 = c2COM.copy();
-      bestLen = curLen;
+      bestLen = m;
       bestO = o;
     }
   }
 
   if ( bestRMSD == 1e6 ) {
-    std::cout << "ERROR: Best RMSD found was 1e6.  Broken.\n";
-    return nullptr;
+    result.ok = false;
+    return false;
+  }
+
+  double ttt[16] = {
+    bestU[0][0], bestU[1][0], bestU[2][0], bestCOM1[0],
+    bestU[0][1], bestU[1][1], bestU[2][1], bestCOM1[1],
+    bestU[0][2], bestU[1][2], bestU[2][2], bestCOM1[2],
+    -bestCOM2[0], -bestCOM2[1], -bestCOM2[2], 1.};
+
+  result.ok = true;
+  result.alignLen = bestLen;
+  result.rmsd = bestRMSD;
+  std::copy(ttt, ttt + 16, result.ttt);
+  result.pathA.clear();
+  result.pathB.clear();
+  for (const auto& frag : paths[bestO]) {
+    result.pathA.push_back(frag.first);
+    result.pathB.push_back(frag.second);
   }
 
+  return true;
+}
+
+
+/*
+// Aligns B onto A, with A's distance matrix already computed
+*/
+static ceResult ceAlignToDM(const cePoint* coordsA, const ceMatrix& dmA,
+    const cePoint* coordsB, int lenB, float D0, float D1, int winSize,
+    int gapMax)
+{
+  ceResult result;
+
+  /* calculate the distance matrix for the mobile protein */
+  ceMatrix dmB = calcDM(coordsB, lenB);
+
+  /* calculate the CE Similarity matrix */
+  ceMatrix S = calcS(dmA, dmB, winSize);
+
+  /* find the best path through the CE Sim. matrix */
+  auto paths = findPath(S, dmA, dmB, D0, D1, winSize, gapMax);
+
+  /* Get the optimal superposition here... */
+  findBest(coordsA, coordsB, paths, winSize, result);
+
+  return result;
+}
+
+ceResult ceAlign(const cePoint* coordsA, int lenA, const cePoint* coordsB,
+    int lenB, float D0, float D1, int winSize, int gapMax)
+{
+  ceMatrix dmA = calcDM(coordsA, lenA);
+  return ceAlignToDM(coordsA, dmA, coordsB, lenB, D0, D1, winSize, gapMax);
+}
+
+std::vector<ceResult> ceAlignBatch(const std::vector<cePoint>& coordsA,
+    const std::vector<std::vector<cePoint>>& mobiles, float D0, float D1,
+    int winSize, int gapMax)
+{
+  // the target's distance matrix is shared by all pairs
+  ceMatrix dmA = calcDM(coordsA.data(), coordsA.size());
+
+  std::vector<ceResult> results(mobiles.size());
+
+  // one pair per thread (nested parallel regions run serially)
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+  for (int i = 0; i < (int) mobiles.size(); i++) {
+    const auto& coordsB = mobiles[i];
+    if (coordsA.size() < size_t(2 * winSize) ||
+        coordsB.size() < size_t(2 * winSize))
+      continue;
+    results[i] = ceAlignToDM(coordsA.data(), dmA, coordsB.data(),
+        coordsB.size(), D0, D1, winSize, gapMax);
+  }
+
+  return results;
+}
+
+
+#ifndef _PYMOL_NOPY
+std::vector<cePoint> getCoords(PyObject* L, int length)
+{
+  // make space for the current coords
+  std::vector<cePoint> coords(length);
+
+  // loop through the arguments, pulling out the
+  // XYZ coordinates.
+  for (int i = 0; i < length; i++ ) {
+    PyObject* curCoord = PyList_GetItem(L,i);
+    coords[i].x = PyFloat_AsDouble(PyList_GetItem(curCoord,0));
+    coords[i].y = PyFloat_AsDouble(PyList_GetItem(curCoord,1));
+    coords[i].z = PyFloat_AsDouble(PyList_GetItem(curCoord,2));
+  }
+
+  return coords;
+}
+
+PyObject* ceResultAsPyList(const ceResult& result)
+{
+  const double* ttt = result.ttt;
   PyObject* pyU = Py_BuildValue( "[f,f,f,f, f,f,f,f, f,f,f,f, f,f,f,f]",
-				 bestU[0][0], bestU[1][0], bestU[2][0], bestCOM1[0],
-				 bestU[0][1], bestU[1][1], bestU[2][1], bestCOM1[1],
-				 bestU[0][2], bestU[1][2], bestU[2][2], bestCOM1[2],
-				 -bestCOM2[0], -bestCOM2[1], -bestCOM2[2], 1.);
-	
+				 ttt[0], ttt[1], ttt[2], ttt[3],
+				 ttt[4], ttt[5], ttt[6], ttt[7],
+				 ttt[8], ttt[9], ttt[10], ttt[11],
+				 ttt[12], ttt[13], ttt[14], ttt[15]);
+
   PyObject* pyPathA = PyList_New(0);
   PyObject* pyPathB = PyList_New(0);
-  for (int j = 0; j < smaller && paths[bestO][j].first != -1; j++) {
-    PyObject* v = Py_BuildValue("i", paths[bestO][j].first);
+  for (size_t j = 0; j < result.pathA.size(); j++) {
+    PyObject* v = Py_BuildValue("i", result.pathA[j]);
     PyList_Append(pyPathA, v);
     Py_DECREF(v);
-    v = Py_BuildValue("i", paths[bestO][j].second);
+    v = Py_BuildValue("i", result.pathB[j]);
     PyList_Append(pyPathB, v);
     Py_DECREF(v);
   }
 
-  return Py_BuildValue("[ifNNN]", bestLen, bestRMSD, pyU, pyPathA, pyPathB);
+  return Py_BuildValue("[ifNNN]", result.alignLen, result.rmsd, pyU, pyPathA, pyPathB);
 }
+#endif
 
 
 TA2<double> transpose(const TA2<double>& v)
 {
   int m = (int) v.dim1();
   int n = (int) v.dim2();
-	
+
   TA2<double> rVal(n,m);
-	
+
   for ( int i = 0; i < m; i++ )
     for ( int j = 0; j < n; j++ )
       rVal[j][i] = v[i][j];
-		
+
   return rVal;
 }
-#endif
@@ -1,6 +1,8 @@
 #ifndef _CE_TYPES_H
 #define _CE_TYPES_H
 
+#include <vector>
+
 #include"os_python.h"
 
 /*
@@ -20,22 +22,73 @@ typedef struct {
 	int second;
 } afp, *path, **pathCache;
 
+/*
+// Dense row-major matrix of floats. Used for the distance matrices and the
+// CE similarity matrix, so that rows are contiguous in memory.
+*/
+struct ceMatrix {
+  int rows = 0;
+  int cols = 0;
+  std::vector<float> data;
+
+  ceMatrix() = default;
+  ceMatrix(int r, int c, float value = 0.f)
+      : rows(r), cols(c), data(size_t(r) * c, value)
+  {
+  }
+
+  float* operator[](int row) { return data.data() + size_t(row) * cols; }
+  const float* operator[](int row) const
+  {
+    return data.data() + size_t(row) * cols;
+  }
+};
+
+/*
+// Outcome of aligning one (mobile) structure onto a target
+*/
+struct ceResult {
+  bool ok = false;
+  int alignLen = 0;
+  double rmsd = 0.0;
+  // TTT matrix in PyMOL's row-major convention (see transform_object)
+  double ttt[16] = {};
+  // first residue of each aligned fragment
+  std::vector<int> pathA, pathB;
+};
+
 /////////////////////////////////////////////////////////////////////////////
 // Function Declarations
 /////////////////////////////////////////////////////////////////////////////
 // Calculates the CE Similarity Matrix
-double** calcS(double** d1, double** d2, int lenA, int lenB, int wSize);
+ceMatrix calcS(const ceMatrix& d1, const ceMatrix& d2, int wSize);
 
 // calculates a simple distance matrix
-double** calcDM(pcePoint coords, int len);
+ceMatrix calcDM(const cePoint* coords, int len);
 
-// Converter: Python Object -> C Structs
-pcePoint getCoords( PyObject* L, int len );
-
-// Optimal path finding algorithm (CE).
-pathCache findPath(double** S, double** dA, double**dB, int lenA, int lenB, float D0, float D1, int winSize, int gapMax, int* bufferSize);
+// Optimal path finding algorithm (CE). Returns up to 20 candidate paths.
+std::vector<std::vector<afp>> findPath(const ceMatrix& S, const ceMatrix& dA,
+    const ceMatrix& dB, float D0, float D1, int winSize, int gapMax);
 
 // filter through the results and find the best
-PyObject* findBest( pcePoint coordsA, pcePoint coordsB, pathCache paths, int bufferSize, int smaller, int winSize );
+bool findBest(const cePoint* coordsA, const cePoint* coordsB,
+    const std::vector<std::vector<afp>>& paths, int winSize, ceResult& result);
+
+// Full CE alignment of B (mobile) onto A (target)
+ceResult ceAlign(const cePoint* coordsA, int lenA, const cePoint* coordsB,
+    int lenB, float D0, float D1, int winSize, int gapMax);
+
+// Aligns many mobiles onto one target, in parallel over the mobiles
+std::vector<ceResult> ceAlignBatch(const std::vector<cePoint>& coordsA,
+    const std::vector<std::vector<cePoint>>& mobiles, float D0, float D1,
+    int winSize, int gapMax);
+
+#ifndef _PYMOL_NOPY
+// Converter: Python Object -> C Structs
+std::vector<cePoint> getCoords( PyObject* L, int len );
+
+// Converter: C Structs -> [alignLen, RMSD, TTT, pathA, pathB]
+PyObject* ceResultAsPyList(const ceResult& result);
+#endif
 
 #endif
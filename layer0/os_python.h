@@ -21,9 +21,30 @@ Z* -------------------------------------------------------------------
 #include "os_predef.h"
 
 #include <memory>
+#include <string.h>
+
+/**
+ * For compatibility with the pickletools, this type represents
+ * an optionally owned C string and has to be returned by value.
+ */
+class SomeString {
+  const char * m_str;
+  mutable int m_length;
+public:
+  SomeString(const char * s, int len=-1) : m_str(s), m_length(len) {}
+  inline const char * data()    const { return m_str; }
+  inline const char * c_str()   const { return m_str; }
+  operator const char * ()      const { return m_str; } // allows assignment to std::string
+  inline size_t length()        const {
+    if (m_length == -1) {
+      m_length = m_str ? strlen(m_str) : 0;
+    }
+    return m_length;
+  }
+};
 
 #ifdef _PYMOL_NOPY
-typedef int PyObject;
+#include "os_python_nopy.h"
 #undef _PYMOL_NUMPY
 #else
 
@@ -34,8 +55,6 @@ typedef int PyObject;
 #include"Python.h"
 #include<pythread.h>
 
-#include <string.h>
-
 # define PyInt_Check            PyLong_Check
 # define PyInt_FromLong         PyLong_FromLong
 # define PyInt_AsLong           PyLong_AsLong
@@ -52,25 +71,7 @@ typedef int PyObject;
 # define PyString_AsString              PyUnicode_AsUTF8
 # define PyString_AS_STRING             PyUnicode_AsUTF8
 
-/**
- * For compatibility with the pickletools, this type represents
- * an optionally owned C string and has to be returned by value.
- */
-class SomeString {
-  const char * m_str;
-  mutable int m_length;
-public:
-  SomeString(const char * s, int len=-1) : m_str(s), m_length(len) {}
-  inline const char * data()    const { return m_str; }
-  inline const char * c_str()   const { return m_str; }
-  operator const char * ()      const { return m_str; } // allows assignment to std::string
-  inline size_t length()        const {
-    if (m_length == -1) {
-      m_length = m_str ? strlen(m_str) : 0;
-    }
-    return m_length;
-  }
-};
+#endif
 
 inline SomeString PyString_AsSomeString(PyObject * o) {
   return PyString_AsString(o);
@@ -80,6 +81,8 @@ inline SomeString PyBytes_AsSomeString(PyObject * o) {
   return SomeString(PyBytes_AsString(o), PyBytes_Size(o));
 }
 
+#ifndef _PYMOL_NOPY
+
 namespace pymol {
 /**
  * Destruction policy for unique_ptr<PyObject, pymol::pyobject_delete>
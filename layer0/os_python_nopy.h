@@ -0,0 +1,118 @@
+/**
+ * @file
+ * Inert Python C API for the Python-free build (_PYMOL_NOPY)
+ *
+ * Session (de)serialization and other converters are written against the
+ * Python C API. Without Python there are no Python objects: constructors
+ * return NULL, type checks fail and accessors return zero values, so those
+ * code paths fail gracefully instead of having to be excluded one by one.
+ *
+ * Only include through os_python.h.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+typedef int PyObject;
+typedef std::ptrdiff_t Py_ssize_t;
+typedef int PyGILState_STATE;
+
+#define Py_None (static_cast<PyObject*>(nullptr))
+
+// reference counting and errors
+
+inline void Py_INCREF(PyObject*) {}
+inline void Py_XINCREF(PyObject*) {}
+inline void Py_DECREF(PyObject*) {}
+inline void Py_XDECREF(PyObject*) {}
+inline PyObject* PyErr_Occurred() { return nullptr; }
+inline void PyErr_Print() {}
+inline void PyErr_Clear() {}
+inline int PyGILState_Check() { return 1; }
+inline PyGILState_STATE PyGILState_Ensure() { return 0; }
+inline void PyGILState_Release(PyGILState_STATE) {}
+
+// type checks
+
+inline bool PyBool_Check(PyObject*) { return false; }
+inline bool PyBytes_Check(PyObject*) { return false; }
+inline bool PyCapsule_CheckExact(PyObject*) { return false; }
+inline bool PyDict_Check(PyObject*) { return false; }
+inline bool PyFloat_Check(PyObject*) { return false; }
+inline bool PyInt_Check(PyObject*) { return false; }
+inline bool PyList_Check(PyObject*) { return false; }
+inline bool PyLong_Check(PyObject*) { return false; }
+inline bool PySequence_Check(PyObject*) { return false; }
+inline bool PyString_Check(PyObject*) { return false; }
+inline bool PyTuple_Check(PyObject*) { return false; }
+
+// constructors
+
+inline PyObject* PyBool_FromLong(long) { return nullptr; }
+inline PyObject* PyBytes_FromStringAndSize(const char*, Py_ssize_t)
+{
+  return nullptr;
+}
+inline PyObject* PyDict_New() { return nullptr; }
+inline PyObject* PyFloat_FromDouble(double) { return nullptr; }
+inline PyObject* PyInt_FromLong(long) { return nullptr; }
+inline PyObject* PyList_New(Py_ssize_t) { return nullptr; }
+inline PyObject* PyLong_FromLong(long) { return nullptr; }
+inline PyObject* PyString_FromString(const char*) { return nullptr; }
+inline PyObject* PyString_FromStringAndSize(const char*, Py_ssize_t)
+{
+  return nullptr;
+}
+inline PyObject* PyTuple_New(Py_ssize_t) { return nullptr; }
+
+// accessors
+
+inline double PyFloat_AsDouble(PyObject*) { return -1.0; }
+inline long PyInt_AsLong(PyObject*) { return -1; }
+inline long long PyLong_AsLongLong(PyObject*) { return -1; }
+inline Py_ssize_t PyBytes_Size(PyObject*) { return 0; }
+inline Py_ssize_t PyString_Size(PyObject*) { return 0; }
+inline const char* PyString_AsString(PyObject*) { return nullptr; }
+inline const char* PyBytes_AsString(PyObject*) { return nullptr; }
+inline void* PyCapsule_GetPointer(PyObject*, const char*) { return nullptr; }
+
+inline Py_ssize_t PyList_Size(PyObject*) { return 0; }
+inline PyObject* PyList_GetItem(PyObject*, Py_ssize_t) { return nullptr; }
+inline int PyList_SetItem(PyObject*, Py_ssize_t, PyObject*) { return -1; }
+inline int PyList_Append(PyObject*, PyObject*) { return -1; }
+#define PyList_GET_ITEM PyList_GetItem
+#define PyList_SET_ITEM PyList_SetItem
+
+inline Py_ssize_t PyTuple_Size(PyObject*) { return 0; }
+inline PyObject* PyTuple_GetItem(PyObject*, Py_ssize_t) { return nullptr; }
+inline int PyTuple_SetItem(PyObject*, Py_ssize_t, PyObject*) { return -1; }
+#define PyTuple_GET_ITEM PyTuple_GetItem
+#define PyTuple_SET_ITEM PyTuple_SetItem
+
+inline PyObject* PyDict_GetItemString(PyObject*, const char*)
+{
+  return nullptr;
+}
+inline int PyDict_SetItemString(PyObject*, const char*, PyObject*)
+{
+  return -1;
+}
+
+inline bool PyObject_HasAttrString(PyObject*, const char*) { return false; }
+inline PyObject* PyObject_GetAttrString(PyObject*, const char*)
+{
+  return nullptr;
+}
+inline int PyObject_SetAttrString(PyObject*, const char*, PyObject*)
+{
+  return -1;
+}
+inline PyObject* PyObject_Str(PyObject*) { return nullptr; }
+inline PyObject* PyNumber_Int(PyObject*) { return nullptr; }
+inline PyObject* PyNumber_Float(PyObject*) { return nullptr; }
+inline PyObject* PyImport_ImportModule(const char*) { return nullptr; }
+inline PyObject* PyObject_CallMethod(PyObject*, const char*, const char*, ...)
+{
+  return nullptr;
+}
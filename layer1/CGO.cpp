@@ -1919,6 +1919,73 @@ void CGOFreeVBOs(CGO* I)
   }
 }
 
+pymol::MemorySize CGO::memory_size() const
+{
+  pymol::MemorySize size;
+  size.host = sizeof(CGO) + pymol::memory_size(op) +
+              _data_heap_size * sizeof(float) + i_size * sizeof(int);
+
+  if (!G->ShaderMgr) {
+    return size;
+  }
+
+  auto add_gpu = [&](size_t hashid) {
+    if (hashid) {
+      if (auto buf = G->ShaderMgr->getGPUBuffer<gpuBuffer_t>(hashid)) {
+        size.gpu += buf->get_memory_size();
+      }
+    }
+  };
+
+  for (auto it = begin(); !it.is_stop(); ++it) {
+    switch (it.op_code()) {
+    case CGO_DRAW_CUSTOM: {
+      auto sp = it.cast<cgo::draw::custom>();
+      add_gpu(sp->vboid);
+      add_gpu(sp->iboid);
+      add_gpu(sp->pickvboid);
+    } break;
+    case CGO_DRAW_SPHERE_BUFFERS: {
+      auto sp = it.cast<cgo::draw::sphere_buffers>();
+      add_gpu(sp->vboid);
+      add_gpu(sp->pickvboid);
+    } break;
+    case CGO_DRAW_LABELS: {
+      auto sp = it.cast<cgo::draw::labels>();
+      add_gpu(sp->vboid);
+      add_gpu(sp->pickvboid);
+    } break;
+    case CGO_DRAW_TEXTURES:
+      add_gpu(it.cast<cgo::draw::textures>()->vboid);
+      break;
+    case CGO_DRAW_SCREEN_TEXTURES_AND_POLYGONS:
+      add_gpu(it.cast<cgo::draw::screen_textures>()->vboid);
+      break;
+    case CGO_DRAW_CYLINDER_BUFFERS: {
+      auto sp = it.cast<cgo::draw::cylinder_buffers>();
+      add_gpu(sp->vboid);
+      add_gpu(sp->iboid);
+      add_gpu(sp->pickvboid);
+    } break;
+    case CGO_DRAW_BUFFERS_NOT_INDEXED: {
+      auto sp = it.cast<cgo::draw::buffers_not_indexed>();
+      add_gpu(sp->vboid);
+      add_gpu(sp->pickvboid);
+    } break;
+    case CGO_DRAW_BUFFERS_INDEXED: {
+      auto sp = it.cast<cgo::draw::buffers_indexed>();
+      add_gpu(sp->vboid);
+      add_gpu(sp->iboid);
+      add_gpu(sp->pickvboid);
+    } break;
+    case CGO_DRAW_CONNECTORS:
+      add_gpu(it.cast<cgo::draw::connectors>()->vboid);
+      break;
+    }
+  }
+  return size;
+}
+
 #define set_min_max(mn, mx, pt)                                                \
   {                                                                            \
     if (mn[0] > *pt)                                                           \
@@ -2856,14 +2923,16 @@ static bool CGOProcessScreenCGOtoArrays(PyMOLGlobals* G, CGO* cgo,
   return true;
 }
 
-static bool OptimizeVertsToVBONotIndexed(const CGO* I, CGO* cgo,
-    const CGOCount& count, float* min, float* max, short* has_draw_buffer,
-    bool addshaders)
+/**
+ * Fill the client side triangle arrays (first half of
+ * OptimizeVertsToVBONotIndexed)
+ *
+ * @param cgo Receives the current state and the pass-through operations
+ */
+static bool CGOProcessCGOtoTriangleArrays(const CGO* I, CGO* cgo,
+    int num_total_indexes, float* min, float* max, CGOTriangleArrays& arrays)
 {
   auto G = I->G;
-  bool ok = true;
-  uchar* colorValsUC = 0;
-  uchar* normalValsC = 0;
 
   cgo->alpha = 1.f;
   cgo->color[0] = 1.f;
@@ -2878,33 +2947,67 @@ static bool OptimizeVertsToVBONotIndexed(const CGO* I, CGO* cgo,
   mul += SettingGet<bool>(G, cSetting_cgo_shader_ub_color)
               ? 1
               : VERTEX_COLOR_SIZE;
-  auto const tot = size_t(count.num_total_indexes) * mul;
+  auto const tot = size_t(num_total_indexes) * mul;
 
-  std::vector<float> vertexValsVec(tot);
-  auto* vertexVals = vertexValsVec.data();
-  auto* normalVals = vertexVals + 3 * count.num_total_indexes;
+  arrays = CGOTriangleArrays();
+  arrays.nverts = num_total_indexes;
+  arrays.data.resize(tot);
+  auto* vertexVals = arrays.vertexVals = arrays.data.data();
+  auto* normalVals = arrays.normalVals = vertexVals + 3 * num_total_indexes;
   unsigned nxtn = VERTEX_NORMAL_SIZE;
   if (SettingGet<int>(G, cSetting_cgo_shader_ub_normal)) {
-    normalValsC = (uchar*) normalVals;
+    arrays.normalValsC = (uchar*) normalVals;
+    arrays.normalVals = nullptr;
     nxtn = 1;
   }
-  auto* colorVals = normalVals + nxtn * count.num_total_indexes;
+  auto* colorVals = arrays.colorVals = normalVals + nxtn * num_total_indexes;
   if (SettingGet<int>(G, cSetting_cgo_shader_ub_color)) {
-    colorValsUC = (uchar*) colorVals;
+    arrays.colorValsUC = (uchar*) colorVals;
+    arrays.colorVals = nullptr;
     nxtn = 1;
   } else {
     nxtn = 4;
   }
-  auto* pickColorVals = (colorVals + nxtn * count.num_total_indexes);
+  auto* pickColorVals = arrays.pickColorVals =
+      (colorVals + nxtn * num_total_indexes);
   nxtn = 3;
-  auto* accessibilityVals = pickColorVals + nxtn * count.num_total_indexes;
+  arrays.accessibilityVals = pickColorVals + nxtn * num_total_indexes;
 
-  bool has_normals = false, has_colors = false, has_accessibility = false;
   int ambient_occlusion{};
-  ok = CGOProcessCGOtoArrays(I, cgo, cgo, min, max, &ambient_occlusion,
-      vertexVals, normalVals, normalValsC, colorVals, colorValsUC,
-      pickColorVals, accessibilityVals, has_normals, has_colors,
-      has_accessibility);
+  bool ok = CGOProcessCGOtoArrays(I, cgo, cgo, min, max, &ambient_occlusion,
+      vertexVals, normalVals, arrays.normalValsC, colorVals,
+      arrays.colorValsUC, pickColorVals, arrays.accessibilityVals,
+      arrays.has_normals, arrays.has_colors, arrays.has_accessibility);
+  arrays.ambient_occlusion = ambient_occlusion;
+  return ok;
+}
+
+bool CGOGetTriangleArraysNotIndexed(const CGO* I, CGOTriangleArrays& arrays)
+{
+  std::unique_ptr<CGO> I_begin_end_combined;
+  if (I->has_begin_end) {
+    I_begin_end_combined.reset(CGOCombineBeginEnd(I));
+    I = I_begin_end_combined.get();
+  }
+
+  float min[3] = {FLT_MAX, FLT_MAX, FLT_MAX},
+        max[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+  CGO state(I->G);
+  auto const count = CGOCountNumVertices(I);
+  return CGOProcessCGOtoTriangleArrays(
+      I, &state, count.num_total_indexes, min, max, arrays);
+}
+
+static bool OptimizeVertsToVBONotIndexed(const CGO* I, CGO* cgo,
+    const CGOCount& count, float* min, float* max, short* has_draw_buffer,
+    bool addshaders)
+{
+  auto G = I->G;
+  bool ok = true;
+
+  CGOTriangleArrays vals;
+  ok = CGOProcessCGOtoTriangleArrays(
+      I, cgo, count.num_total_indexes, min, max, vals);
   if (!ok) {
     if (!G->Interrupt)
       PRINTFB(G, FB_CGO, FB_Errors)
@@ -2914,22 +3017,27 @@ static bool OptimizeVertsToVBONotIndexed(const CGO* I, CGO* cgo,
   }
   if (ok) {
     auto fmt = GetNormalColorFormatSize(G);
+    const void* normalVals = vals.normalValsC
+                                 ? (const void*) vals.normalValsC
+                                 : (const void*) vals.normalVals;
+    const void* colorVals = vals.colorValsUC ? (const void*) vals.colorValsUC
+                                             : (const void*) vals.colorVals;
 
     VertexBuffer* vbo =
         G->ShaderMgr->newGPUBuffer<VertexBuffer>(buffer_layout::SEQUENTIAL);
     BufferDataDesc bufData = {{"a_Vertex", VertexFormat::Float3,
-        sizeof(float) * count.num_total_indexes * 3, vertexVals}};
-    if (has_normals) {
+        sizeof(float) * count.num_total_indexes * 3, vals.vertexVals}};
+    if (vals.has_normals) {
       bufData.push_back({"a_Normal", fmt.normalFormat,
           count.num_total_indexes * fmt.normalSize, normalVals});
     }
-    if (has_colors) {
+    if (vals.has_colors) {
       bufData.push_back({"a_Color", fmt.colorFormat,
           count.num_total_indexes * fmt.colorSize, colorVals});
     }
-    if (has_accessibility) {
+    if (vals.has_accessibility) {
       bufData.push_back({"a_Accessibility", VertexFormat::Float,
-          sizeof(float) * count.num_total_indexes, accessibilityVals});
+          sizeof(float) * count.num_total_indexes, vals.accessibilityVals});
     }
     ok = vbo->bufferData(std::move(bufData));
 
@@ -2948,7 +3056,7 @@ static bool OptimizeVertsToVBONotIndexed(const CGO* I, CGO* cgo,
       float* newPickColorVals;
       int arrays = CGO_VERTEX_ARRAY | CGO_NORMAL_ARRAY | CGO_COLOR_ARRAY |
                     CGO_PICK_COLOR_ARRAY;
-      if (ambient_occlusion) {
+      if (vals.ambient_occlusion) {
         arrays |= CGO_ACCESSIBILITY_ARRAY;
       }
       if (addshaders)
@@ -2969,7 +3077,7 @@ static bool OptimizeVertsToVBONotIndexed(const CGO* I, CGO* cgo,
             G);
         return false;
       }
-      memcpy(newPickColorVals + count.num_total_indexes, pickColorVals,
+      memcpy(newPickColorVals + count.num_total_indexes, vals.pickColorVals,
           count.num_total_indexes * 2 * sizeof(float));
       *has_draw_buffer = true;
     } else {
@@ -4365,9 +4473,11 @@ CGO* CGOOptimizeBezier(const CGO* I)
  *                     (if -1, defaults to cgo_sphere_quality)
  * stick_round_nub: if true, a round cap is generated, otherwise, it generates
  *                  the old "pointed" caps
+ * stick_quality:   number of edges of the cylinders generated by this
+ *                     function (if -1, defaults to stick_quality)
  */
-CGO* CGOSimplify(
-    const CGO* I, int est, short sphere_quality, bool stick_round_nub)
+CGO* CGOSimplify(const CGO* I, int est, short sphere_quality,
+    bool stick_round_nub, short stick_quality)
 {
   auto G = I->G;
   int ok = true;
@@ -4379,6 +4489,7 @@ CGO* CGOSimplify(
   std::unique_ptr<CGO> cgo_managed(CGONew(G, I->c + est));
   auto* const cgo = cgo_managed.get();
   RETURN_VAL_IF_FAIL(cgo, nullptr);
+  cgo->stick_quality = stick_quality;
 
   for (auto it = I->begin(); !it.is_stop(); ++it) {
     const auto op = it.op_code();
@@ -6424,7 +6535,8 @@ static int CGOSimpleCylinder(CGO* I, const float* v1, const float* v2,
     pickcolor[1].bond = pickcolor[0].bond;
   }
   v = v_buf;
-  nEdge = SettingGetGlobal_i(I->G, cSetting_stick_quality);
+  nEdge = (I->stick_quality > 0) ? I->stick_quality
+                                 : SettingGetGlobal_i(I->G, cSetting_stick_quality);
   overlap = tube_size * SettingGetGlobal_f(I->G, cSetting_stick_overlap);
   nub = tube_size * SettingGetGlobal_f(I->G, cSetting_stick_nub);
 
@@ -6918,6 +7030,8 @@ void CGO::move_append(CGO&& src_)
     _data_heap.emplace_back(std::move(ref));
   }
   src->_data_heap.clear();
+  _data_heap_size += src->_data_heap_size;
+  src->_data_heap_size = 0;
 
   // copy boolean flags
   has_draw_buffers |= src->has_draw_buffers;
@@ -6979,6 +7093,53 @@ int CGOCountNumberOfOperationsOfTypeN(
   return (numops);
 }
 
+static std::size_t CGOTrianglesForMode(int mode, int nverts)
+{
+  switch (mode) {
+  case GL_TRIANGLES:
+    return nverts / 3;
+  case GL_TRIANGLE_STRIP:
+  case GL_TRIANGLE_FAN:
+    return std::max(nverts - 2, 0);
+  }
+  return 0;
+}
+
+std::size_t CGOCountTriangles(const CGO* I)
+{
+  std::size_t ntri = 0;
+  int mode = -1, nverts = 0;
+  for (auto it = I->begin(); !it.is_stop(); ++it) {
+    switch (it.op_code()) {
+    case CGO_BEGIN:
+      mode = CGO_get_int(it.data());
+      nverts = 0;
+      break;
+    case CGO_VERTEX:
+      ++nverts;
+      break;
+    case CGO_END:
+      ntri += CGOTrianglesForMode(mode, nverts);
+      mode = -1;
+      break;
+    case CGO_DRAW_ARRAYS: {
+      auto sp = it.cast<cgo::draw::arrays>();
+      ntri += CGOTrianglesForMode(sp->mode, sp->nverts);
+    } break;
+    case CGO_DRAW_BUFFERS_INDEXED: {
+      auto sp = it.cast<cgo::draw::buffers_indexed>();
+      ntri += CGOTrianglesForMode(
+          sp->mode, sp->nindices ? sp->nindices : sp->nverts);
+    } break;
+    case CGO_DRAW_BUFFERS_NOT_INDEXED: {
+      auto sp = it.cast<cgo::draw::buffers_not_indexed>();
+      ntri += CGOTrianglesForMode(sp->mode, sp->nverts);
+    } break;
+    }
+  }
+  return ntri;
+}
+
 bool CGOHasOperationsOfType(const CGO* I, int optype)
 {
   std::set<int> ops = {optype};
@@ -29,6 +29,7 @@ Z* -------------------------------------------------------------------
 #include <type_traits>
 #include <memory>
 #include "GenericBuffer.h"
+#include "MemoryUsage.h"
 #include <set>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
@@ -789,6 +790,7 @@ public:
                        // 2 : render both CGOSetZVector/CGORenderGLAlpha and rest of object
                        // calcDepth=1 by default
   short sphere_quality { 0 }; // quality of spheres when simplified or rendered in immediate mode
+  short stick_quality { -1 }; // edges of cylinders simplified into this CGO, -1 for stick_quality
   bool interpolated { false };
   /***********************************************************************
    * CGO iterator
@@ -883,6 +885,7 @@ public:
     std::unique_ptr<float[]> uni(new float[size]);
     float * ptr = uni.get();
     _data_heap.emplace_back(std::move(uni));
+    _data_heap_size += size;
     return ptr;
   }
 
@@ -932,8 +935,12 @@ public:
   // Pretty prints a table with the layout of this CGO
   void print_table() const;
 
+  // Memory of the op buffer, data pool and the GPU buffers it references
+  pymol::MemorySize memory_size() const;
+
 private:
   std::vector<std::unique_ptr<float[]>> _data_heap;
+  size_t _data_heap_size = 0; // in floats
 };
 
 #define CGONew new CGO
@@ -944,10 +951,15 @@ int CGOHasNormals(const CGO * I);
 void CGOFree(CGO * &I, bool withVBOs=true);
 #define CGOFreeWithoutVBOs(I) CGOFree(I, false)
 
+inline pymol::MemorySize CGOGetMemorySize(const CGO* I)
+{
+  return I ? I->memory_size() : pymol::MemorySize();
+}
+
 CGO *CGODrawText(const CGO * I, int est, float *camera);
 
 CGO* CGOSimplify(const CGO* I, int est = 0, short sphere_quality = -1,
-    bool stick_round_nub = true);
+    bool stick_round_nub = true, short stick_quality = -1);
 CGO *CGOSimplifyNoCompress(const CGO * I, int est, short sphere_quality = -1, bool stick_round_nub = true);
 
 // -1 - no lines, 0 - some no interpolation, 1 - all interpolation, 2 - all no interpolation
@@ -967,6 +979,39 @@ CGO* CGOOptimizeToVBONotIndexed(
 
 #define CGOOptimizeToVBONotIndexedNoShader(I) CGOOptimizeToVBONotIndexed(I, 0, false)
 
+/**
+ * Client side triangle arrays of CGOOptimizeToVBONotIndexed, before they are
+ * uploaded. Normals and colors are either float or, with
+ * cgo_shader_ub_normal/cgo_shader_ub_color, normalized bytes.
+ */
+struct CGOTriangleArrays {
+  int nverts = 0;
+  bool has_normals = false;
+  bool has_colors = false;
+  bool has_accessibility = false;
+  bool ambient_occlusion = false; // from CGO_ACCESSIBILITY_ARRAY draw arrays
+  float* vertexVals = nullptr;
+  float* normalVals = nullptr;
+  uchar* normalValsC = nullptr;
+  float* colorVals = nullptr;
+  uchar* colorValsUC = nullptr;
+  float* pickColorVals = nullptr; // (index, bond) pairs
+  float* accessibilityVals = nullptr;
+  std::vector<float> data;
+
+  CGOTriangleArrays() = default;
+  CGOTriangleArrays(CGOTriangleArrays&&) = default;
+  CGOTriangleArrays& operator=(CGOTriangleArrays&&) = default;
+};
+
+/**
+ * Triangle packing of CGOOptimizeToVBONotIndexed without the upload (no GL
+ * context needed). Other geometry is ignored.
+ *
+ * @return false if interrupted
+ */
+bool CGOGetTriangleArraysNotIndexed(const CGO* I, CGOTriangleArrays& arrays);
+
 
 CGO *CGOOptimizeSpheresToVBONonIndexed(const CGO * I, int est=0, bool addshaders=false, CGO *leftOverCGO=nullptr);
 #define CGOOptimizeSpheresToVBONonIndexedNoShader(I, est) CGOOptimizeSpheresToVBONonIndexed(I, est, false, nullptr)
@@ -1107,6 +1152,8 @@ inline int CGOAppendNoStop(CGO *dest, const CGO *source) {
 int CGOCountNumberOfOperationsOfType(const CGO *I, int op);
 int CGOCountNumberOfOperationsOfTypeN(const CGO *I, const std::set<int> &optype);
 int CGOCountNumberOfOperationsOfTypeN(const CGO *I, const std::map<int, int> &optype);
+/// Number of triangles of tessellated geometry (immediate mode and buffers)
+std::size_t CGOCountTriangles(const CGO *I);
 bool CGOHasOperations(const CGO *I);
 bool CGOHasOperationsOfType(const CGO *I, int optype);
 bool CGOHasOperationsOfTypeN(const CGO *I, const std::set<int> &optype);
@@ -0,0 +1,427 @@
+/*
+ * This file contains source code for the PyMOL computer program
+ * Copyright (c) Schrodinger, LLC.
+ *
+ * Single pass construction of non-indexed triangle draw buffers
+ */
+
+#include "CGOStreamBuilder.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+
+#include "CGO.h"
+#include "Feedback.h"
+#include "PyMOLGlobals.h"
+#include "Setting.h"
+#include "ShaderMgr.h"
+
+namespace pymol
+{
+
+CGOStreamBuilder::CGOStreamBuilder(PyMOLGlobals* G)
+    : m_G(G)
+    , m_ub_normal(SettingGet<bool>(G, cSetting_cgo_shader_ub_normal))
+    , m_ub_color(SettingGet<bool>(G, cSetting_cgo_shader_ub_color))
+{
+  resetState();
+  m_min[0] = m_min[1] = m_min[2] = FLT_MAX;
+  m_max[0] = m_max[1] = m_max[2] = -FLT_MAX;
+}
+
+void CGOStreamBuilder::resetState()
+{
+  m_cur = Vertex{};
+  m_cur.normal[2] = 1.f;
+  m_cur.color[0] = m_cur.color[1] = m_cur.color[2] = m_cur.color[3] = 1.f;
+  m_cur.accessibility = 1.f;
+  m_cur.pick_index = 0;
+  m_cur.pick_bond = cPickableNoPick;
+  m_mode = -1;
+  m_nprim = 0;
+}
+
+void CGOStreamBuilder::reserve(std::size_t nverts)
+{
+  m_pos.reserve(nverts * 3);
+  if (m_ub_normal) {
+    m_normal_c.reserve(nverts * 3);
+  } else {
+    m_normal.reserve(nverts * 3);
+  }
+  if (m_ub_color) {
+    m_color_uc.reserve(nverts * 4);
+  } else {
+    m_color.reserve(nverts * 4);
+  }
+  m_pick.reserve(nverts * 2);
+}
+
+void CGOStreamBuilder::begin(int mode)
+{
+  m_mode = mode;
+  m_nprim = 0;
+}
+
+void CGOStreamBuilder::end()
+{
+  m_mode = -1;
+  m_nprim = 0;
+}
+
+void CGOStreamBuilder::normal(const float* n)
+{
+  m_cur.normal[0] = n[0];
+  m_cur.normal[1] = n[1];
+  m_cur.normal[2] = n[2];
+  m_has_normals = true;
+}
+
+void CGOStreamBuilder::color(const float* c)
+{
+  m_cur.color[0] = c[0];
+  m_cur.color[1] = c[1];
+  m_cur.color[2] = c[2];
+  m_has_colors = true;
+}
+
+void CGOStreamBuilder::accessibility(float a)
+{
+  if (!m_has_accessibility) {
+    m_has_accessibility = true;
+    m_accessibility.assign(size(), 1.f);
+  }
+  m_cur.accessibility = a;
+}
+
+void CGOStreamBuilder::pickColor(unsigned index, int bond)
+{
+  // see CGOPickColor
+  if (index == (unsigned) -1) {
+    bond = cPickableNoPick;
+  }
+  m_cur.pick_index = index;
+  m_cur.pick_bond = bond;
+}
+
+void CGOStreamBuilder::vertex(const float* v)
+{
+  auto& cur = m_cur;
+  cur.pos[0] = v[0];
+  cur.pos[1] = v[1];
+  cur.pos[2] = v[2];
+  for (int i = 0; i < 3; ++i) {
+    m_min[i] = std::min(m_min[i], v[i]);
+    m_max[i] = std::max(m_max[i], v[i]);
+  }
+
+  // same triangle winding as CGOProcessCGOtoArrays
+  switch (m_mode) {
+  case GL_TRIANGLES:
+    if (m_nprim == 2) {
+      emitTriangle(m_prim[0], m_prim[1], cur);
+      m_nprim = 0;
+    } else {
+      m_prim[m_nprim++] = cur;
+    }
+    break;
+  case GL_TRIANGLE_STRIP:
+    if (m_nprim < 2) {
+      m_prim[m_nprim] = cur;
+    } else {
+      if (m_nprim % 2) {
+        emitTriangle(cur, m_prim[1], m_prim[0]);
+      } else {
+        emitTriangle(m_prim[0], m_prim[1], cur);
+      }
+      m_prim[0] = m_prim[1];
+      m_prim[1] = cur;
+    }
+    ++m_nprim;
+    break;
+  case GL_TRIANGLE_FAN:
+    if (m_nprim < 2) {
+      m_prim[m_nprim] = cur;
+    } else {
+      emitTriangle(m_prim[0], m_prim[1], cur);
+      m_prim[1] = cur;
+    }
+    ++m_nprim;
+    break;
+  default:
+    break;
+  }
+}
+
+void CGOStreamBuilder::emitTriangle(Vertex a, Vertex b, Vertex c)
+{
+  // one pick color per triangle, see FixPickColorsForTriangle
+  auto same = [](const Vertex& u, const Vertex& v) {
+    return u.pick_index == v.pick_index && u.pick_bond == v.pick_bond;
+  };
+  auto copy_pick = [](Vertex& dst, const Vertex& src) {
+    dst.pick_index = src.pick_index;
+    dst.pick_bond = src.pick_bond;
+  };
+  if (!same(a, b) || !same(a, c)) {
+    if (same(a, b)) {
+      copy_pick(c, a);
+    } else if (same(a, c)) {
+      copy_pick(b, a);
+    } else if (same(b, c)) {
+      copy_pick(a, b);
+    } else {
+      copy_pick(b, a);
+      copy_pick(c, a);
+    }
+  }
+
+  emit(a);
+  emit(b);
+  emit(c);
+}
+
+void CGOStreamBuilder::emit(const Vertex& v)
+{
+  m_pos.insert(m_pos.end(), v.pos, v.pos + 3);
+
+  if (m_ub_normal) {
+    for (int i = 0; i < 3; ++i)
+      m_normal_c.push_back(CLIP_NORMAL_VALUE(v.normal[i]));
+  } else {
+    m_normal.insert(m_normal.end(), v.normal, v.normal + 3);
+  }
+
+  if (m_ub_color) {
+    for (int i = 0; i < 4; ++i)
+      m_color_uc.push_back(CLIP_COLOR_VALUE(v.color[i]));
+  } else {
+    m_color.insert(m_color.end(), v.color, v.color + 4);
+  }
+
+  m_pick.push_back(v.pick_index);
+  m_pick.push_back(std::uint32_t(v.pick_bond));
+
+  if (m_has_accessibility) {
+    m_accessibility.push_back(v.accessibility);
+  }
+}
+
+static bool is_triangle_mode(int mode)
+{
+  return mode == GL_TRIANGLES || mode == GL_TRIANGLE_STRIP ||
+         mode == GL_TRIANGLE_FAN;
+}
+
+bool CGOStreamBuilder::append(const CGO* src, CGO* leftover)
+{
+  auto G = m_G;
+  bool in_leftover_block = false;
+
+  resetState();
+
+  for (auto it = src->begin(); !it.is_stop(); ++it) {
+    const auto op = it.op_code();
+    const auto pc = it.data();
+
+    switch (op) {
+    case CGO_NORMAL:
+      normal(pc);
+      break;
+    case CGO_COLOR:
+      color(pc);
+      break;
+    case CGO_ALPHA:
+      alpha(*pc);
+      break;
+    case CGO_ACCESSIBILITY:
+      accessibility(*pc);
+      break;
+    case CGO_PICK_COLOR:
+      pickColor(CGO_get_uint(pc), CGO_get_int(pc + 1));
+      break;
+    case CGO_BEGIN: {
+      int mode = it.cast<cgo::draw::begin>()->mode;
+      if (is_triangle_mode(mode)) {
+        begin(mode);
+        continue;
+      }
+      in_leftover_block = true;
+      if (leftover) {
+        leftover->has_begin_end = true;
+      }
+    } break;
+    case CGO_END:
+      if (!in_leftover_block) {
+        end();
+        continue;
+      }
+      in_leftover_block = false;
+      break;
+    case CGO_VERTEX:
+      if (!in_leftover_block) {
+        vertex(pc);
+        continue;
+      }
+      break;
+    case CGO_DRAW_ARRAYS: {
+      const auto sp = it.cast<cgo::draw::arrays>();
+      if (!is_triangle_mode(sp->mode) || !(sp->arraybits & CGO_VERTEX_ARRAY))
+        break;
+
+      const float* vals = sp->floatdata;
+      const float *vertexVals = vals, *normalVals = nullptr,
+                  *colorVals = nullptr, *pickVals = nullptr,
+                  *accessibilityVals = nullptr;
+      vals += sp->nverts * 3;
+      if (sp->arraybits & CGO_NORMAL_ARRAY) {
+        normalVals = vals;
+        vals += sp->nverts * 3;
+      }
+      if (sp->arraybits & CGO_COLOR_ARRAY) {
+        colorVals = vals;
+        vals += sp->nverts * 4;
+      }
+      if (sp->arraybits & CGO_PICK_COLOR_ARRAY) {
+        // skip the RGBA pick colors
+        vals += sp->nverts;
+        pickVals = vals;
+        vals += sp->nverts * 2;
+      }
+      if (sp->arraybits & CGO_ACCESSIBILITY_ARRAY) {
+        accessibilityVals = vals;
+      }
+
+      // per-vertex arrays don't change the current state (except picking)
+      auto const saved = m_cur;
+      begin(sp->mode);
+      for (int i = 0; i < sp->nverts; ++i) {
+        if (normalVals)
+          normal(normalVals + i * 3);
+        if (colorVals) {
+          color(colorVals + i * 4);
+          alpha(colorVals[i * 4 + 3]);
+        }
+        if (pickVals) {
+          m_cur.pick_index = CGO_get_uint(pickVals + i * 2);
+          m_cur.pick_bond = CGO_get_int(pickVals + i * 2 + 1);
+        }
+        if (accessibilityVals)
+          accessibility(accessibilityVals[i]);
+        vertex(vertexVals + i * 3);
+      }
+      end();
+      auto const pick_index = m_cur.pick_index;
+      auto const pick_bond = m_cur.pick_bond;
+      m_cur = saved;
+      m_cur.pick_index = pick_index;
+      m_cur.pick_bond = pick_bond;
+
+      if (G->Interrupt)
+        return false;
+      continue;
+    }
+    }
+
+    if (leftover) {
+      leftover->add_to_cgo(op, pc);
+    }
+  }
+
+  return !G->Interrupt;
+}
+
+CGO* CGOStreamBuilder::finish(bool addshaders)
+{
+  auto G = m_G;
+  auto const nverts = size();
+
+  if (!nverts) {
+    return nullptr;
+  }
+
+  auto const nverts_sz = static_cast<std::size_t>(nverts);
+  bool ok = true;
+
+  VertexFormat const normalFormat =
+      m_ub_normal ? VertexFormat::Byte3Norm : VertexFormat::Float3;
+  VertexFormat const colorFormat =
+      m_ub_color ? VertexFormat::UByte4Norm : VertexFormat::Float4;
+
+  VertexBuffer* vbo =
+      G->ShaderMgr->newGPUBuffer<VertexBuffer>(buffer_layout::SEQUENTIAL);
+  BufferDataDesc bufData = {{"a_Vertex", VertexFormat::Float3,
+      sizeof(float) * nverts_sz * 3, m_pos.data()}};
+  if (m_has_normals) {
+    bufData.push_back({"a_Normal", normalFormat,
+        nverts_sz * GetSizeOfVertexFormat(normalFormat),
+        m_ub_normal ? (const void*) m_normal_c.data()
+                    : (const void*) m_normal.data()});
+  }
+  if (m_has_colors) {
+    bufData.push_back({"a_Color", colorFormat,
+        nverts_sz * GetSizeOfVertexFormat(colorFormat),
+        m_ub_color ? (const void*) m_color_uc.data()
+                   : (const void*) m_color.data()});
+  }
+  if (m_has_accessibility) {
+    bufData.push_back({"a_Accessibility", VertexFormat::Float,
+        sizeof(float) * nverts_sz, m_accessibility.data()});
+  }
+  ok = vbo->bufferData(std::move(bufData));
+  size_t const vboid = vbo->get_hash_id();
+
+  // picking VBO: twice the size needed, for each picking pass
+  VertexBuffer* pickvbo = G->ShaderMgr->newGPUBuffer<VertexBuffer>(
+      buffer_layout::SEQUENTIAL, GL_DYNAMIC_DRAW);
+  ok = ok && pickvbo->bufferData({BufferDesc{"a_Color",
+                                      VertexFormat::UByte4Norm,
+                                      sizeof(float) * nverts_sz},
+                 BufferDesc{"a_Color", VertexFormat::UByte4Norm,
+                     sizeof(float) * nverts_sz}});
+  size_t const pickvboid = pickvbo->get_hash_id();
+
+  CGO* cgo = ok ? CGONew(G) : nullptr;
+  float* pickColorVals = nullptr;
+
+  if (cgo) {
+    int arrays = CGO_VERTEX_ARRAY | CGO_NORMAL_ARRAY | CGO_COLOR_ARRAY |
+                 CGO_PICK_COLOR_ARRAY;
+    if (m_has_accessibility) {
+      arrays |= CGO_ACCESSIBILITY_ARRAY;
+    }
+    if (addshaders)
+      CGOEnable(cgo, GL_DEFAULT_SHADER_WITH_SETTINGS);
+    pickColorVals = cgo->add<cgo::draw::buffers_not_indexed>(
+        GL_TRIANGLES, arrays, int(nverts), vboid, pickvboid);
+    if (addshaders)
+      CGODisable(cgo, GL_DEFAULT_SHADER);
+  }
+
+  if (!pickColorVals) {
+    PRINTFB(G, FB_CGO, FB_Errors)
+      " CGOStreamBuilder: ERROR: could not create draw buffers\n" ENDFB(G);
+    G->ShaderMgr->freeGPUBuffer(pickvboid);
+    G->ShaderMgr->freeGPUBuffer(vboid);
+    CGOFree(cgo);
+    return nullptr;
+  }
+
+  memcpy(pickColorVals + nverts, m_pick.data(), nverts_sz * 2 * sizeof(float));
+
+  CGOBoundingBox(cgo, m_min, m_max);
+  CGOStop(cgo);
+
+  cgo->has_draw_buffers = true;
+  cgo->use_shader = true;
+  cgo->cgo_shader_ub_color = m_ub_color;
+  cgo->cgo_shader_ub_normal = m_ub_normal;
+
+  // release the client side copies
+  *this = CGOStreamBuilder(G);
+
+  return cgo;
+}
+
+} // namespace pymol
@@ -0,0 +1,133 @@
+/*
+ * This file contains source code for the PyMOL computer program
+ * Copyright (c) Schrodinger, LLC.
+ *
+ * Single pass construction of non-indexed triangle draw buffers
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Picking.h"
+
+struct CGO;
+struct PyMOLGlobals;
+
+namespace pymol
+{
+
+/**
+ * Immediate-mode style builder which writes triangles straight into
+ * structure-of-arrays vertex buffers.
+ *
+ * Produces the same draw buffers as CGOOptimizeToVBONotIndexed, without
+ * emitting a CGO_BEGIN/CGO_VERTEX/CGO_END stream first and without the
+ * CGOCombineBeginEnd and vertex counting passes over it.
+ *
+ * Strips and fans are converted to triangles as the vertices arrive.
+ */
+class CGOStreamBuilder
+{
+public:
+  explicit CGOStreamBuilder(PyMOLGlobals* G);
+
+  /// Reserve space for `nverts` triangle vertices
+  void reserve(std::size_t nverts);
+
+  /// Start a primitive (GL_TRIANGLES, GL_TRIANGLE_STRIP or GL_TRIANGLE_FAN)
+  void begin(int mode);
+  void end();
+
+  void normal(const float* n);
+  void color(const float* c);
+  void alpha(float a) { m_cur.color[3] = a; }
+  void accessibility(float a);
+  void pickColor(unsigned index, int bond);
+  void vertex(const float* v);
+
+  /**
+   * Feed the triangle geometry of an existing CGO (immediate mode or
+   * CGO_DRAW_ARRAYS) into the builder. Everything else is copied to
+   * `leftover`, if given. State (color, normal, ...) starts out with the
+   * defaults of CGOOptimizeToVBONotIndexed.
+   *
+   * @return false if interrupted
+   */
+  bool append(const CGO* src, CGO* leftover = nullptr);
+
+  /// Number of triangle vertices
+  std::size_t size() const { return m_pos.size() / 3; }
+  bool empty() const { return m_pos.empty(); }
+
+  /**
+   * @name Client side arrays, laid out like CGOTriangleArrays
+   * (see CGOGetTriangleArraysNotIndexed). Valid until finish().
+   * @{
+   */
+  const std::vector<float>& vertexVals() const { return m_pos; }
+  const std::vector<float>& normalVals() const { return m_normal; }
+  const std::vector<std::uint8_t>& normalValsC() const { return m_normal_c; }
+  const std::vector<float>& colorVals() const { return m_color; }
+  const std::vector<std::uint8_t>& colorValsUC() const { return m_color_uc; }
+  const std::vector<std::uint32_t>& pickColorVals() const { return m_pick; }
+  const std::vector<float>& accessibilityVals() const
+  {
+    return m_accessibility;
+  }
+  bool hasNormals() const { return m_has_normals; }
+  bool hasColors() const { return m_has_colors; }
+  bool hasAccessibility() const { return m_has_accessibility; }
+  /// @}
+
+  /**
+   * Upload the buffers and return a new CGO with the draw operation and
+   * the bounding box. The builder is left empty.
+   *
+   * @param addshaders Add Enable/Disable shader operations
+   * @return nullptr if empty or on failure
+   */
+  CGO* finish(bool addshaders = true);
+
+private:
+  struct Vertex {
+    float pos[3];
+    float normal[3];
+    float color[4];
+    float accessibility;
+    unsigned pick_index;
+    int pick_bond;
+  };
+
+  void resetState();
+  void emit(const Vertex& v);
+  void emitTriangle(Vertex a, Vertex b, Vertex c);
+
+  PyMOLGlobals* m_G;
+  bool m_ub_normal;
+  bool m_ub_color;
+
+  // current state
+  Vertex m_cur{};
+  int m_mode = -1;
+  int m_nprim = 0; // vertices in the current primitive
+  Vertex m_prim[2]{};
+
+  bool m_has_normals = false;
+  bool m_has_colors = false;
+  bool m_has_accessibility = false;
+
+  float m_min[3];
+  float m_max[3];
+
+  std::vector<float> m_pos;
+  std::vector<float> m_normal;
+  std::vector<std::uint8_t> m_normal_c;
+  std::vector<float> m_color;
+  std::vector<std::uint8_t> m_color_uc;
+  std::vector<std::uint32_t> m_pick; // (index, bond) pairs
+  std::vector<float> m_accessibility;
+};
+
+} // namespace pymol
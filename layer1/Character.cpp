@@ -28,6 +28,10 @@ Z* -------------------------------------------------------------------
 #include"CGO.h"
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+#include <climits>
+#include <vector>
+
 #define HASH_MASK 0x2FFF
 
 static unsigned int get_hash(CharFngrprnt * fprnt)
@@ -119,6 +123,21 @@ int CharacterFind(PyMOLGlobals * G, CharFngrprnt * fprnt)
   return 0;
 }
 
+static void CharacterHashAdd(CCharacter * I, int id, CharFngrprnt * fprnt)
+{
+  int hash_code = get_hash(fprnt);
+  int cur_entry;
+  CharRec *rec = I->Char + id;
+  rec->Fngrprnt = *(fprnt);
+  rec->Fngrprnt.hash_code = hash_code;
+  cur_entry = I->Hash[hash_code];
+  if(cur_entry) {
+    I->Char[cur_entry].HashPrev = id;
+  }
+  rec->HashNext = I->Hash[hash_code];
+  I->Hash[hash_code] = id;
+}
+
 unsigned char *CharacterGetPixmapBuffer(PyMOLGlobals * G, int id)
 {
   CCharacter *I = G->Character;
@@ -145,18 +164,7 @@ int CharacterNewFromBitmap(PyMOLGlobals * G, int width, int height,
     rec->XOrig = x_orig * sampling;
     rec->YOrig = y_orig * sampling;
     rec->Advance = advance * sampling;
-    {                           /* add this character to the hash */
-      int hash_code = get_hash(fprnt);
-      int cur_entry;
-      rec->Fngrprnt = *(fprnt);
-      rec->Fngrprnt.hash_code = hash_code;
-      cur_entry = I->Hash[hash_code];
-      if(cur_entry) {
-        I->Char[cur_entry].HashPrev = id;
-      }
-      I->Char[id].HashNext = I->Hash[hash_code];
-      I->Hash[hash_code] = id;
-    }
+    CharacterHashAdd(I, id, fprnt);
   }
   return id;
 }
@@ -177,19 +185,71 @@ int CharacterNewFromBytemap(PyMOLGlobals * G, int width, int height,
     rec->XOrig = x_orig;
     rec->YOrig = y_orig;
     rec->Advance = advance;
-    {                           /* add this character to the hash */
-      int hash_code = get_hash(fprnt);
-      int cur_entry;
-      rec->Fngrprnt = *(fprnt);
-      rec->Fngrprnt.hash_code = hash_code;
-      cur_entry = I->Hash[hash_code];
-      if(cur_entry) {
-        I->Char[cur_entry].HashPrev = id;
+    CharacterHashAdd(I, id, fprnt);
+  }
+  return id;
+}
+
+int CharacterNewFromGlyphs(PyMOLGlobals * G, int n, const int *ids,
+                           const float *pen, CharFngrprnt * fprnt)
+{
+  CCharacter *I = G->Character;
+  std::vector<int> xy(n * 2);
+  int x0 = INT_MAX, y0 = INT_MAX, x1 = INT_MIN, y1 = INT_MIN;
+
+  /* glyph pixmaps are placed on whole pixels */
+  for(int a = 0; a < n; a++) {
+    const CharRec *rec = I->Char + ids[a];
+    if(!rec->Width || !rec->Height)
+      continue;
+    xy[a * 2] = (int) floorf(pen[a * 2] - rec->XOrig + 0.5F);
+    xy[a * 2 + 1] = (int) floorf(pen[a * 2 + 1] - rec->YOrig + 0.5F);
+    x0 = std::min(x0, xy[a * 2]);
+    y0 = std::min(y0, xy[a * 2 + 1]);
+    x1 = std::max(x1, xy[a * 2] + rec->Width);
+    y1 = std::max(y1, xy[a * 2 + 1] + rec->Height);
+  }
+
+  if(x1 <= x0 || y1 <= y0)
+    return 0;
+
+  int width = x1 - x0;
+  int height = y1 - y0;
+  std::vector<unsigned char> buffer(4 * width * height);
+
+  /* where glyphs overlap, keep the more opaque pixel */
+  for(int a = 0; a < n; a++) {
+    const CharRec *rec = I->Char + ids[a];
+    const CPixmap *pm = &rec->Pixmap;
+    if(!rec->Width || !rec->Height || !pm->buffer)
+      continue;
+    for(int y = 0; y < pm->height; y++) {
+      const unsigned char *src = pm->buffer + 4 * pm->width * y;
+      unsigned char *dst = buffer.data() +
+        4 * (width * (xy[a * 2 + 1] - y0 + y) + (xy[a * 2] - x0));
+      for(int x = 0; x < pm->width; x++, src += 4, dst += 4) {
+        if(src[3] > dst[3])
+          std::copy_n(src, 4, dst);
       }
-      I->Char[id].HashNext = I->Hash[hash_code];
-      I->Hash[hash_code] = id;
     }
   }
+
+  UtilZeroMem(fprnt, sizeof(CharFngrprnt));
+  fprnt->u.i.text_id = -1;
+  fprnt->u.i.ch = ++I->NComposite;
+
+  int id = CharacterGetNew(G);
+  if((id > 0) && (id <= I->MaxAlloc)) {
+    CharRec *rec = I->Char + id;
+    PixmapInit(G, &rec->Pixmap, width, height);
+    std::copy(buffer.begin(), buffer.end(), rec->Pixmap.buffer);
+    rec->Width = width;
+    rec->Height = height;
+    rec->XOrig = (float) -x0;
+    rec->YOrig = (float) -y0;
+    rec->Advance = 0.0F;
+    CharacterHashAdd(I, id, fprnt);
+  }
   return id;
 }
 
@@ -451,44 +511,60 @@ static void CharacterPurgeOldest(PyMOLGlobals * G)
       int id = I->OldestUsed;
 
       if(id) {
-        int next;
-
         /* trim from end of list */
+        CharacterRelease(G, id);
+      }
+    }
+  }
+}
 
-        if((next = I->Char[id].Next)) {
-          I->Char[next].Prev = 0;
-          I->OldestUsed = next;
-        }
+void CharacterRelease(PyMOLGlobals * G, int id)
+{
+  CCharacter *I = G->Character;
+  if((id <= 0) || (id > I->MaxAlloc))
+    return;
+
+  {                             /* excise character from retention list */
+    int prev = I->Char[id].Prev;
+    int next = I->Char[id].Next;
 
-        {                       /* excise character from hash table linked list */
-          int hash_code = I->Char[id].Fngrprnt.hash_code;
-          int hash_prev = I->Char[id].HashPrev;
-          int hash_next = I->Char[id].HashNext;
+    if(prev) {
+      I->Char[prev].Next = next;
+    } else {
+      I->OldestUsed = next;
+    }
+    if(next) {
+      I->Char[next].Prev = prev;
+    } else {
+      I->NewestUsed = prev;
+    }
+  }
 
-          if(hash_prev) {
-            I->Char[hash_prev].HashNext = hash_next;
-          } else {
-            I->Hash[hash_code] = hash_next;
-          }
-          if(hash_next) {
-            I->Char[hash_next].HashPrev = hash_prev;
-          }
+  {                             /* excise character from hash table linked list */
+    int hash_code = I->Char[id].Fngrprnt.hash_code;
+    int hash_prev = I->Char[id].HashPrev;
+    int hash_next = I->Char[id].HashNext;
 
-        }
+    if(hash_prev) {
+      I->Char[hash_prev].HashNext = hash_next;
+    } else {
+      I->Hash[hash_code] = hash_next;
+    }
+    if(hash_next) {
+      I->Char[hash_next].HashPrev = hash_prev;
+    }
+  }
 
-        /* free and reinitialize */
+  /* free and reinitialize */
 
-        PixmapPurge(&I->Char[id].Pixmap);
-        UtilZeroMem(I->Char + id, sizeof(CharRec));
+  PixmapPurge(&I->Char[id].Pixmap);
+  UtilZeroMem(I->Char + id, sizeof(CharRec));
 
-        /* add to free chain */
+  /* add to free chain */
 
-        I->Char[id].Prev = I->LastFree;
-        I->LastFree = id;
-        I->NUsed--;
-      }
-    }
-  }
+  I->Char[id].Prev = I->LastFree;
+  I->LastFree = id;
+  I->NUsed--;
 }
 
 int CharacterGetNew(PyMOLGlobals * G)
@@ -71,6 +71,7 @@ struct _CCharacter {
   int *Hash;
   int RetainAll;
   CharRec *Char;
+  unsigned int NComposite;      /* for unique fingerprints of composite pixmaps */
 };
 
 int CharacterInit(PyMOLGlobals * G);
@@ -96,6 +97,12 @@ int CharacterNewFromBytemap(PyMOLGlobals * G, int width, int height,
 
 int CharacterFind(PyMOLGlobals * G, CharFngrprnt * fprnt);
 
+/* combine n characters into one pixmap, glyph origins at pen (x,y pairs in
+   pixels), returns 0 if there is nothing to draw */
+int CharacterNewFromGlyphs(PyMOLGlobals * G, int n, const int *ids,
+                           const float *pen, CharFngrprnt * fprnt);
+void CharacterRelease(PyMOLGlobals * G, int id);
+
 float CharacterInterpolate(PyMOLGlobals * G, int id, float *v);
 void CharacterSetRetention(PyMOLGlobals * G, int retail_all);
 unsigned char *CharacterGetPixmapBuffer(PyMOLGlobals * G, int id);
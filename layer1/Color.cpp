@@ -14,6 +14,9 @@ I* Additional authors of this source file include:
 -*
 Z* -------------------------------------------------------------------
 */
+#include <algorithm>
+#include <numeric>
+
 #include"os_python.h"
 #include"os_predef.h"
 #include"os_std.h"
@@ -203,6 +206,71 @@ int ColorGetRamped(PyMOLGlobals * G, int index, const float *vertex, float *colo
   return (ok);
 }
 
+/**
+ * Batch version of ColorGetRamped
+ *
+ * @param n Number of vertices
+ * @param vertex Vertex coordinates (3 * n)
+ * @param[out] color Colors (3 * n)
+ */
+int ColorGetRampedN(PyMOLGlobals * G, int index, int n, const float *vertex, float *color, int state)
+{
+  CColor *I = G->Color;
+  int ok = false;
+  if (auto* ptr = ColorGetRamp(G, index)) {
+    ok = ObjectGadgetRampInterVertices(ptr, n, vertex, color, state);
+  }
+  if(!ok) {
+    std::fill_n(color, 3 * n, 1.0F);
+  } else if(I->LUTActive) {
+    for (int i = 0; i < n; ++i) {
+      lookup_color(I, color + 3 * i, color + 3 * i, I->BigEndian);
+    }
+  }
+  return (ok);
+}
+
+void ColorRampBatch::add(int index, const float* vertex, float* color)
+{
+  m_index.push_back(index);
+  m_vertex.insert(m_vertex.end(), vertex, vertex + 3);
+  m_color.push_back(color);
+}
+
+void ColorRampBatch::flush(PyMOLGlobals* G, int state)
+{
+  std::vector<int> order(m_index.size());
+  std::iota(order.begin(), order.end(), 0);
+
+  // group by ramp
+  std::stable_sort(order.begin(), order.end(),
+      [this](int i, int j) { return m_index[i] < m_index[j]; });
+
+  std::vector<float> vertex, color;
+  for (auto it = order.begin(); it != order.end();) {
+    int const index = m_index[*it];
+    auto end = it;
+    vertex.clear();
+    while (end != order.end() && m_index[*end] == index) {
+      vertex.insert(vertex.end(), m_vertex.begin() + 3 * (*end),
+          m_vertex.begin() + 3 * (*end) + 3);
+      ++end;
+    }
+
+    int const n = end - it;
+    color.resize(3 * n);
+    ColorGetRampedN(G, index, n, vertex.data(), color.data(), state);
+
+    for (int i = 0; i < n; ++i, ++it) {
+      copy3f(color.data() + 3 * i, m_color[*it]);
+    }
+  }
+
+  m_index.clear();
+  m_vertex.clear();
+  m_color.clear();
+}
+
 /**
  * Gets a color as 3 floats from an index and writes it into
  * the color argument.  If the index is a ramp, then it uses the vertex and state arguments to lookup the
@@ -1799,7 +1867,10 @@ const float *ColorGetSpecial(PyMOLGlobals * G, int index)
   }
 }
 
-const float *ColorGet(PyMOLGlobals * G, int index)
+/**
+ * @param rgb Buffer for 24-bit RGB colors
+ */
+static const float *ColorGetImpl(PyMOLGlobals * G, int index, float *rgb)
 {
   CColor *I = G->Color;
   const float *ptr;
@@ -1810,12 +1881,12 @@ const float *ColorGet(PyMOLGlobals * G, int index)
       ptr = I->Color[index].Color;
     return (ptr);
   } else if((index & cColor_TRGB_Mask) == cColor_TRGB_Bits) {   /* a 24-bit RGB color */
-    I->RGBColor[0] = ((index & 0x00FF0000) >> 16) / 255.0F;
-    I->RGBColor[1] = ((index & 0x0000FF00) >> 8) / 255.0F;
-    I->RGBColor[2] = ((index & 0x000000FF)) / 255.0F;
+    rgb[0] = ((index & 0x00FF0000) >> 16) / 255.0F;
+    rgb[1] = ((index & 0x0000FF00) >> 8) / 255.0F;
+    rgb[2] = ((index & 0x000000FF)) / 255.0F;
     if(I->LUTActive)
-      lookup_color(I, I->RGBColor, I->RGBColor, I->BigEndian);
-    return I->RGBColor;
+      lookup_color(I, rgb, rgb, I->BigEndian);
+    return rgb;
   } else if(index == cColorFront) {
     return I->Front;
   } else if(index == cColorBack) {
@@ -1826,6 +1897,18 @@ const float *ColorGet(PyMOLGlobals * G, int index)
   }
 }
 
+const float *ColorGet(PyMOLGlobals * G, int index)
+{
+  return ColorGetImpl(G, index, G->Color->RGBColor);
+}
+
+void ColorGetCopy(PyMOLGlobals * G, int index, float *rgb)
+{
+  const float *ptr = ColorGetImpl(G, index, rgb);
+  if(ptr != rgb)
+    copy3f(ptr, rgb);
+}
+
 const float *ColorGetRaw(PyMOLGlobals * G, int index)
 {
   CColor *I = G->Color;
@@ -19,6 +19,7 @@ Z* -------------------------------------------------------------------
 
 #include <unordered_map>
 #include <string>
+#include <vector>
 
 #include "pymol/zstring_view.h"
 
@@ -103,6 +104,7 @@ void ColorUpdateFront(PyMOLGlobals * G, const float *back);
 void ColorUpdateFrontFromSettings(PyMOLGlobals * G);
 
 const float *ColorGet(PyMOLGlobals * G, int index);   /* pointer maybe invalid after creating a new color */
+void ColorGetCopy(PyMOLGlobals * G, int index, float *rgb); /* like ColorGet, doesn't use a shared buffer (for worker threads) */
 const float *ColorGetRaw(PyMOLGlobals * G, int index);        /* pointer maybe invalid after creating a new color */
 
 const float *ColorGetSpecial(PyMOLGlobals * G, int index);
@@ -114,11 +116,31 @@ int ColorGetStatus(PyMOLGlobals * G, int index);
 void ColorReset(PyMOLGlobals * G);
 
 int ColorGetRamped(PyMOLGlobals * G, int index, const float *vertex, float *color, int state);
+int ColorGetRampedN(PyMOLGlobals * G, int index, int n, const float *vertex, float *color, int state);
 int ColorCheckRamped(PyMOLGlobals * G, int index);
 bool ColorGetCheckRamped(PyMOLGlobals * G, int index, const float *vertex, float *color, int state);
 
 struct ObjectGadgetRamp *ColorGetRamp(PyMOLGlobals * G, int index);
 
+/**
+ * Collects ramped color lookups (like ColorGetRamped) and evaluates them
+ * with one ColorGetRampedN call per ramp.
+ *
+ * Vertices are copied, the output pointers must stay valid until flush().
+ */
+class ColorRampBatch
+{
+public:
+  void add(int index, const float* vertex, float* color);
+  void flush(PyMOLGlobals* G, int state);
+  bool empty() const { return m_index.empty(); }
+
+private:
+  std::vector<int> m_index;
+  std::vector<float> m_vertex;
+  std::vector<float*> m_color;
+};
+
 void ColorRegisterExt(PyMOLGlobals* G, const char* name, ObjectGadgetRamp*);
 void ColorForgetExt(PyMOLGlobals * G, const char *name);
 
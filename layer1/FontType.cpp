@@ -15,8 +15,6 @@ I* Additional authors of this source file include:
 Z* -------------------------------------------------------------------
 */
 
-#include <algorithm>
-
 #include"os_python.h"
 
 #include "MemoryDebug.h"
@@ -27,7 +25,13 @@ Z* -------------------------------------------------------------------
 #include "Scene.h"
 #include "Character.h"
 #include "Util.h"
-#include "FontType.h"
+#include "LabelLayout.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
 
 #define max2 std::max
 
@@ -68,6 +72,62 @@ static void GenerateCharFngrprnt(PyMOLGlobals *G, CharFngrprnt *fprnt, unsigned
   fprnt->u.i.flat = flat;
 }
 
+/* pack character codes and a size (in 1/64 pixels) into a cache key,
+   false if they don't fit */
+static bool FontTypeGlyphKey(std::uint64_t * key, unsigned int last,
+    unsigned int c, float size)
+{
+  auto size64 = (std::int64_t) (size * 64);
+  if(last >= (1u << 21) || c >= (1u << 21) || size64 < 0 ||
+      size64 >= (1 << 22))
+    return false;
+  *key = (std::uint64_t(last) << 43) | (std::uint64_t(c) << 22) |
+    std::uint64_t(size64);
+  return true;
+}
+
+static float FontTypeGetKerning(CFontType * I, unsigned int last,
+    unsigned int c, float size)
+{
+  std::uint64_t key;
+  if(!FontTypeGlyphKey(&key, last, c, size))
+    return TypeFaceGetKerning(I->TypeFace, last, c, size);
+  auto it = I->Kerning.find(key);
+  if(it != I->Kerning.end())
+    return it->second;
+  return I->Kerning[key] = TypeFaceGetKerning(I->TypeFace, last, c, size);
+}
+
+/* advance (in pixels at size * sampling) of a character, without looking up
+   the colored glyph if the metrics are known. false if the font doesn't
+   have the character. */
+static bool FontTypeGetAdvance(CFontType * I, unsigned int c, float size,
+    int sampling, short no_flat, int flat, float *advance)
+{
+  PyMOLGlobals *G = I->G;
+  std::uint64_t key;
+  bool cacheable = FontTypeGlyphKey(&key, 0, c, size * sampling);
+  if(cacheable) {
+    auto it = I->Advance.find(key);
+    if(it != I->Advance.end()) {
+      *advance = it->second;
+      return true;
+    }
+  }
+  CharFngrprnt fprnt;
+  GenerateCharFngrprnt(G, &fprnt, c, I->TextID, size, sampling, no_flat, flat);
+  int id = CharacterFind(G, &fprnt);
+  if(!id) {
+    id = TypeFaceCharacterNew(I->TypeFace, &fprnt, size * sampling);
+  }
+  if(!id)
+    return false;
+  *advance = CharacterGetAdvance(G, 1, id);
+  if(cacheable)
+    I->Advance[key] = *advance;
+  return true;
+}
+
 static const char* FontTypeRenderOpenGLImpl(const RenderInfo* info, CFontType* I,
     const char* st, float size, int flat, const float* rpos, bool needSize,
     short relativeMode, bool shouldRender, CGO* shaderCGO)
@@ -129,20 +189,12 @@ static const char* FontTypeRenderOpenGLImpl(const RenderInfo* info, CFontType* I
 	    CheckUnicode(&c, &unicnt, &unicode);
 
             if(!unicnt) {
-              CharFngrprnt fprnt;
-	      GenerateCharFngrprnt(G, &fprnt, c, I->TextID, size, sampling, 0, flat);
-              {
-                int id = CharacterFind(G, &fprnt);
-                if(!id) {
-                  id = TypeFaceCharacterNew(I->TypeFace, &fprnt, size * sampling);
-                }
-                if(id) {
-                  if(kern_flag) {
-                    line_width += (TypeFaceGetKerning(I->TypeFace,
-							       last_c, c, size) / sampling);
-                  }
-                  line_width += CharacterGetAdvance(G, sampling, id);
+              float adv;
+              if(FontTypeGetAdvance(I, c, size, sampling, 0, flat, &adv)) {
+                if(kern_flag) {
+                  line_width += (FontTypeGetKerning(I, last_c, c, size) / sampling);
                 }
+                line_width += adv / sampling;
               }
               kern_flag = true;
               last_c = c;
@@ -276,8 +328,7 @@ static const char* FontTypeRenderOpenGLImpl(const RenderInfo* info, CFontType* I
             }
             if(id) {
               if(kern_flag) {
-                TextAdvance(G, TypeFaceGetKerning(I->TypeFace,
-                                                  last_c, c, size) / sampling);
+                TextAdvance(G, FontTypeGetKerning(I, last_c, c, size) / sampling);
               }
               cont &= CharacterRenderOpenGL(G, info, id, true, relativeMode, shaderCGO);       /* handles advance */
             }
@@ -314,6 +365,37 @@ const char* CFontType::RenderOpenGLFlat(const RenderInfo* info, const char* st,
       relativeMode, shouldRender, shaderCGO);
 }
 
+/* cache key for the layout of a ray traced label, from the text and all state
+   which changes the glyphs or their placement relative to each other */
+static std::string FontTypeLabelLayoutKey(PyMOLGlobals * G, CFontType * I,
+    const char *st, float size, int sampling, bool measure)
+{
+  struct {
+    int text_id;
+    float size;
+    int sampling;
+    float spacing, just;
+    unsigned char color[4], outline_color[4];
+    int measure;
+  } state;
+  UtilZeroMem(&state, sizeof(state));
+  state.text_id = I->TextID;
+  state.size = size;
+  state.sampling = sampling;
+  state.spacing = TextGetSpacing(G);
+  state.just = TextGetJustification(G);
+  TextGetColorUChar(G, state.color, state.color + 1, state.color + 2,
+      state.color + 3);
+  TextGetOutlineColor(G, state.outline_color, state.outline_color + 1,
+      state.outline_color + 2, state.outline_color + 3);
+  state.measure = measure;
+
+  std::string key(st);
+  key.push_back('\0');
+  key.append(reinterpret_cast<const char*>(&state), sizeof(state));
+  return key;
+}
+
 const char* CFontType::RenderRay(CRay* ray, const char* st, float size,
     const float* rpos, bool needSize, short relativeMode)
 {
@@ -341,6 +423,10 @@ const char* CFontType::RenderRay(CRay* ray, const char* st, float size,
     float origpos[3];
     float *line_widths = nullptr;
     float tot_height;
+    auto cache = TextGetLayoutCache(G);
+    const pymol::LabelLayout *layout = nullptr;
+    std::string layout_key;
+    bool measure = rpos && (needSize || rpos[0] < _1);
     if (nlines>1){
       line_widths = pymol::calloc<float>(nlines);
     }
@@ -350,6 +436,11 @@ const char* CFontType::RenderRay(CRay* ray, const char* st, float size,
       size = DIP2PIXEL(size);
     }
 
+    if(cache) {
+      layout_key = FontTypeLabelLayoutKey(G, I, st, size, sampling, measure);
+      layout = cache->find(layout_key);
+    }
+
     text_buffer[0] *= size;
     text_buffer[1] *= size;
 
@@ -386,57 +477,46 @@ const char* CFontType::RenderRay(CRay* ray, const char* st, float size,
     RayGetScaledAxes(ray, xn, yn);
 
     if(rpos) {
-      if(needSize || rpos[0] < _1) {        /* we need to measure the string width before starting to draw */
+      if(measure) {        /* we need to measure the string width before starting to draw */
         float factor = rpos[0] / 2.0F - 0.5F;
-        const char *sst = st;
-	float max_x_indent = 0.f;
 	// factor -1 to 0 based on justification (i.e., rpos[0])
 	factor = (factor < _m1) ? _m1 : (factor > _0) ? _0 : factor;
-        while((c = *(sst++))) {
-	  if (c == '\n'){
-	    text_width = max2(text_width, line_width);
-	    line_widths[linenum] = line_width;
-	    line_width = 0.f;
-	    kern_flag = false;
-	    linenum++;
-	    max_x_indent = max2(x_indent, max_x_indent);
-	    x_indent = 0.f;
-	    continue;
-	  }
-	  CheckUnicode(&c, &unicnt, &unicode);
-          if(!unicnt) {
-            CharFngrprnt fprnt;
-	    GenerateCharFngrprnt(G, &fprnt, c, I->TextID, size, sampling, 1, 0 /* flat is not set */);
-            {
-              int id = CharacterFind(G, &fprnt);
-              if(!id) {
-                id = TypeFaceCharacterNew(I->TypeFace, &fprnt, size * sampling);
-              }
-              if(id) {
-		float adv;
+        if(layout) {
+          text_width = layout->text_width;
+          if (line_widths)
+            std::copy(layout->line_widths.begin(), layout->line_widths.end(),
+                line_widths);
+        } else {
+          const char *sst = st;
+          while((c = *(sst++))) {
+	    if (c == '\n'){
+	      text_width = max2(text_width, line_width);
+	      line_widths[linenum] = line_width;
+	      line_width = 0.f;
+	      kern_flag = false;
+	      linenum++;
+	      continue;
+	    }
+	    CheckUnicode(&c, &unicnt, &unicode);
+            if(!unicnt) {
+              float adv;
+              if(FontTypeGetAdvance(I, c, size, sampling, 1, 0 /* flat is not set */, &adv)) {
                 if(kern_flag) {
-		  float kern = TypeFaceGetKerning(I->TypeFace,
-						  last_c,
-						  c, size * sampling) ;
-		  line_width += kern;
-                  x_indent -= factor * kern;
+                  line_width += FontTypeGetKerning(I, last_c, c, size * sampling);
                 }
-		adv = CharacterGetAdvance(G, 1, id);
-		line_width += adv;
-                x_indent -= factor * adv;
+                line_width += adv;
                 kern_flag = true;
                 last_c = c;
               }
             }
           }
+          text_width = max2(text_width, line_width);
+          if (line_widths)
+	    line_widths[linenum] = line_width;
         }
-	max_x_indent = max2(x_indent, max_x_indent);
-	x_indent = max_x_indent;
+        x_indent = -factor * text_width;
       }
-      text_width = max2(text_width, line_width);
       tot_text_width = text_width + 2.f * text_buffer[0] * sampling;
-      if (line_widths)
-	line_widths[linenum] = line_width;
       TextSetWidth(G, tot_text_width/(float)sampling);
       tot_height = size * (nlines + (nlines-1) * (text_spacing-1.f)) + 2.f * text_buffer[1];
       TextSetHeight(G, tot_height);
@@ -478,47 +558,82 @@ const char* CFontType::RenderRay(CRay* ray, const char* st, float size,
     kern_flag = false;
     copy3f(TextGetPos(I->G), origpos);
     linenum = 0;
-    while((c = *(st++))) {
-      if (c == '\n'){
-	copy3f(origpos, TextGetPos(I->G));
-	kern_flag = false;
-	linenum++;
-	scale3f(yn, pymol_roundf(text_spacing * size * linenum * sampling), y_adj); // need to round to pixel in y
-	subtract3f(TextGetPos(G), y_adj, TextGetPos(G));
-	if (line_widths){
-	  scale3f(xn, text_just * (line_widths[0] - line_widths[linenum])/2.f, x_adj);
-	  add3f(TextGetPos(G), x_adj, TextGetPos(G));
-	}
-	kern_flag = false;
-	continue;
-      }
-      CheckUnicode(&c, &unicnt, &unicode);
-      if(!unicnt) {
-        CharFngrprnt fprnt;
-	GenerateCharFngrprnt(G, &fprnt, c, I->TextID, size, sampling, 0, 0);
-        {
-          int id = CharacterFind(G, &fprnt);
-          if(!id) {
-            id = TypeFaceCharacterNew(I->TypeFace, &fprnt, size * sampling);
-          }
-          if(id) {
-            if(kern_flag) {
-              float kern = TypeFaceGetKerning(I->TypeFace,
-                                              last_c,
-                                              c,
-                                              size * sampling);
-              v = TextGetPos(I->G);
-              scale3f(xn, kern, x_adj);
-              add3f(v, x_adj, pos);
-              TextSetPos(I->G, pos);
+    if(layout) {
+      /* skip the text, it's all in the composite character */
+      st += strlen(st) + 1;
+    } else {
+      /* with a layout cache, collect the glyph run (pen positions in
+         pixels relative to origpos) instead of adding one primitive per
+         glyph */
+      std::vector<int> run_ids;
+      std::vector<float> run_pen;
+      float pen[2] = { 0.0F, 0.0F };
+      while((c = *(st++))) {
+        if (c == '\n'){
+	  copy3f(origpos, TextGetPos(I->G));
+	  kern_flag = false;
+	  linenum++;
+	  pen[1] = -pymol_roundf(text_spacing * size * linenum * sampling); // need to round to pixel in y
+	  scale3f(yn, -pen[1], y_adj);
+	  subtract3f(TextGetPos(G), y_adj, TextGetPos(G));
+	  pen[0] = 0.0F;
+	  if (line_widths){
+	    pen[0] = text_just * (line_widths[0] - line_widths[linenum])/2.f;
+	    scale3f(xn, pen[0], x_adj);
+	    add3f(TextGetPos(G), x_adj, TextGetPos(G));
+	  }
+	  continue;
+        }
+        CheckUnicode(&c, &unicnt, &unicode);
+        if(!unicnt) {
+          CharFngrprnt fprnt;
+	  GenerateCharFngrprnt(G, &fprnt, c, I->TextID, size, sampling, 0, 0);
+          {
+            int id = CharacterFind(G, &fprnt);
+            if(!id) {
+              id = TypeFaceCharacterNew(I->TypeFace, &fprnt, size * sampling);
             }
-            ray->character(id);   /* handles advance */
+            if(id) {
+              if(kern_flag) {
+                float kern = FontTypeGetKerning(I, last_c, c, size * sampling);
+                pen[0] += kern;
+                if(!cache) {
+                  v = TextGetPos(I->G);
+                  scale3f(xn, kern, x_adj);
+                  add3f(v, x_adj, pos);
+                  TextSetPos(I->G, pos);
+                }
+              }
+              if(cache) {
+                run_ids.push_back(id);
+                run_pen.push_back(pen[0]);
+                run_pen.push_back(pen[1]);
+                pen[0] += CharacterGetAdvance(G, 1, id);
+              } else {
+                ray->character(id);   /* handles advance */
+              }
 
-            kern_flag = true;
-            last_c = c;
+              kern_flag = true;
+              last_c = c;
+            }
           }
         }
       }
+      if(cache) {
+        pymol::LabelLayout entry;
+        entry.text_width = text_width;
+        if (line_widths)
+          entry.line_widths.assign(line_widths, line_widths + nlines);
+        if(!run_ids.empty()) {
+          entry.char_id = CharacterNewFromGlyphs(G, run_ids.size(),
+              run_ids.data(), run_pen.data(), &entry.fprnt);
+        }
+        layout = &cache->insert(layout_key, std::move(entry));
+      }
+    }
+    if(layout && layout->char_id) {
+      copy3f(origpos, TextGetPos(I->G));
+      ray->character(layout->char_id);
     }
     FreeP(line_widths);
   }
@@ -21,9 +21,17 @@ Z* -------------------------------------------------------------------
 #include"Font.h"
 #include"TypeFace.h"
 
+#include <cstdint>
+#include <unordered_map>
+
 struct CFontType : public CFont {
   CTypeFace* TypeFace;
 
+  /* glyph metrics, by character code and size in 1/64 pixels */
+  std::unordered_map<std::uint64_t, float> Advance;
+  /* kerning, by character pair and size */
+  std::unordered_map<std::uint64_t, float> Kerning;
+
   ~CFontType() override;
 
   CFontType(PyMOLGlobals* G, unsigned char* dat, unsigned int len);
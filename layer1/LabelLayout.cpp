@@ -0,0 +1,64 @@
+/**
+ * @file
+ * Cached layout of ray traced labels
+ */
+
+#include "LabelLayout.h"
+
+#include "PyMOLGlobals.h"
+
+namespace pymol
+{
+
+/**
+ * True if the composite character of `layout` is still in the character
+ * store (and hasn't been replaced by another character with the same id)
+ */
+static bool LabelLayoutIsValid(PyMOLGlobals* G, LabelLayout& layout)
+{
+  if (!layout.char_id) {
+    return true;
+  }
+  return CharacterFind(G, &layout.fprnt) == layout.char_id;
+}
+
+const LabelLayout* LabelLayoutCache::find(const std::string& key)
+{
+  auto it = m_layouts.find(key);
+  if (it == m_layouts.end()) {
+    return nullptr;
+  }
+  if (!LabelLayoutIsValid(m_G, it->second)) {
+    m_layouts.erase(it);
+    return nullptr;
+  }
+  return &it->second;
+}
+
+const LabelLayout& LabelLayoutCache::insert(
+    const std::string& key, LabelLayout&& layout)
+{
+  auto& entry = m_layouts[key];
+  if (entry.char_id && LabelLayoutIsValid(m_G, entry)) {
+    CharacterRelease(m_G, entry.char_id);
+  }
+  entry = std::move(layout);
+  return entry;
+}
+
+void LabelLayoutCache::clear()
+{
+  if (!m_G->Character) {
+    // character store already freed on shutdown
+    m_layouts.clear();
+    return;
+  }
+  for (auto& item : m_layouts) {
+    if (item.second.char_id && LabelLayoutIsValid(m_G, item.second)) {
+      CharacterRelease(m_G, item.second.char_id);
+    }
+  }
+  m_layouts.clear();
+}
+
+} // namespace pymol
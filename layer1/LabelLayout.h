@@ -0,0 +1,70 @@
+/**
+ * @file
+ * Cached layout of ray traced labels
+ *
+ * The glyphs of a label are combined into one character pixmap, so the ray
+ * tracer intersects one quad per label instead of one per glyph. The layout
+ * (composite character and line widths) is kept until the owning
+ * representation is rebuilt, i.e. until the label text or font settings
+ * change.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Character.h"
+
+struct PyMOLGlobals;
+
+namespace pymol
+{
+
+/**
+ * Layout of one label in (sampled) pixels
+ */
+struct LabelLayout {
+  /// Composite character with all glyphs, 0 if there is nothing to draw
+  int char_id = 0;
+  CharFngrprnt fprnt{};
+
+  float text_width = 0.f;
+  std::vector<float> line_widths;
+};
+
+/**
+ * Label layouts of one representation, keyed by text and font state
+ */
+class LabelLayoutCache
+{
+  PyMOLGlobals* m_G;
+  std::unordered_map<std::string, LabelLayout> m_layouts;
+
+public:
+  explicit LabelLayoutCache(PyMOLGlobals* G)
+      : m_G(G)
+  {
+  }
+  LabelLayoutCache(const LabelLayoutCache&) = delete;
+  LabelLayoutCache& operator=(const LabelLayoutCache&) = delete;
+  ~LabelLayoutCache() { clear(); }
+
+  /**
+   * Cached layout, or nullptr. Layouts whose composite character was purged
+   * from the character store are dropped.
+   */
+  const LabelLayout* find(const std::string& key);
+
+  /// Add a layout, the cache takes over its composite character
+  const LabelLayout& insert(const std::string& key, LabelLayout&& layout);
+
+  /// Remove all layouts and release their composite characters
+  void clear();
+
+  std::size_t size() const { return m_layouts.size(); }
+};
+
+} // namespace pymol
@@ -0,0 +1,107 @@
+/**
+ * @file
+ * Distance based level of detail for tessellated representations
+ */
+
+#include "LevelOfDetail.h"
+
+#include <algorithm>
+#include <cfloat>
+
+#include "Base.h"
+#include "Ray.h"
+#include "Scene.h"
+#include "SceneDef.h"
+#include "Setting.h"
+
+// each level starts at this fraction of the previous level's threshold
+#define LOD_LEVEL_RATIO 0.25f
+
+// a chunk stays at its level until the threshold is passed by this factor
+#define LOD_HYSTERESIS 1.25f
+
+namespace pymol
+{
+
+int LodSelectLevel(float pixels_per_angstrom, float pixels, int current)
+{
+  int level = 0;
+  for (float threshold = pixels; level < LodLevelCount - 1;
+       threshold *= LOD_LEVEL_RATIO) {
+    float t = threshold;
+    if (current >= 0) {
+      // coarser: must grow clearly past the threshold to get finer, and
+      // vice versa
+      t = (level < current) ? threshold * LOD_HYSTERESIS
+                            : threshold / LOD_HYSTERESIS;
+    }
+    if (pixels_per_angstrom >= t)
+      break;
+    ++level;
+  }
+  return level;
+}
+
+int LodQuality(int quality, int level, int min_)
+{
+  return std::min(quality, std::max(min_, quality >> level));
+}
+
+void LodChunk::include(const float* v)
+{
+  if (!has_extent) {
+    std::copy_n(v, 3, min);
+    std::copy_n(v, 3, max);
+    has_extent = true;
+    return;
+  }
+  for (int i = 0; i < 3; ++i) {
+    min[i] = std::min(min[i], v[i]);
+    max[i] = std::max(max[i], v[i]);
+  }
+}
+
+int LodChunk::select(PyMOLGlobals* G, const RenderInfo* info)
+{
+  if (info->pick) {
+    return level;
+  }
+
+  if (!has_extent || !SettingGet<bool>(G, cSetting_level_of_detail)) {
+    return (level = 0);
+  }
+
+  // the depth is linear over the box, so the nearest point is a corner
+  float scale = FLT_MAX;
+  for (int i = 0; i < 8; ++i) {
+    float v[3] = {
+        (i & 1) ? max[0] : min[0],
+        (i & 2) ? max[1] : min[1],
+        (i & 4) ? max[2] : min[2],
+    };
+    float const s = info->ray ? RayGetScreenVertexScale(info->ray, v)
+                              : SceneGetScreenVertexScale(G, v);
+    if (!(s > R_SMALL8)) {
+      // corner behind the camera
+      return (level = 0);
+    }
+    scale = std::min(scale, s);
+  }
+
+  auto const pixels = SettingGet<float>(G, cSetting_level_of_detail_pixels);
+  return (level = LodSelectLevel(1.f / scale, pixels, info->ray ? -1 : level));
+}
+
+void LodStatsAdd(
+    PyMOLGlobals* G, const RenderInfo* info, int level, std::size_t triangles)
+{
+  if (info->pick || level < 0 || level >= LodLevelCount) {
+    return;
+  }
+
+  auto& stats = G->Scene->LodStats;
+  ++stats.chunks[level];
+  stats.triangles[level] += triangles;
+}
+
+} // namespace pymol
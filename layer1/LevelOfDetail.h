@@ -0,0 +1,75 @@
+/**
+ * @file
+ * Distance based level of detail for tessellated representations
+ *
+ * Representations which tessellate their geometry (cartoon, sphere and stick
+ * triangles) can provide coarser versions of it. The level is chosen per
+ * chunk (a representation of one coordinate set) from the projected size of
+ * one Angstrom in pixels at the chunk's nearest point.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+struct PyMOLGlobals;
+struct RenderInfo;
+
+namespace pymol
+{
+
+/// Number of detail levels, 0 is the full detail
+constexpr int LodLevelCount = 3;
+
+/**
+ * Detail level from the size of one Angstrom in pixels.
+ *
+ * @param pixels_per_angstrom Projected size
+ * @param pixels Size below which the detail gets reduced (level 1). Each
+ * further level starts at a quarter of the previous threshold.
+ * @param current Level of the previous frame, or -1 for no hysteresis
+ */
+int LodSelectLevel(float pixels_per_angstrom, float pixels, int current);
+
+/**
+ * Reduce a quality (edges, sampling) setting for the given detail level.
+ * Every level halves the quality, but not below `min_`, and never above the
+ * full quality.
+ */
+int LodQuality(int quality, int level, int min_);
+
+/**
+ * Triangles which were sent to the renderer per detail level
+ */
+struct LodStats {
+  std::size_t chunks[LodLevelCount]{};
+  std::size_t triangles[LodLevelCount]{};
+};
+
+/**
+ * Detail level state of a chunk of geometry
+ */
+struct LodChunk {
+  float min[3]{};
+  float max[3]{};
+  bool has_extent = false;
+
+  /// Level which was used for the last frame
+  int level = 0;
+
+  /// Grow the extent to include `v`
+  void include(const float* v);
+
+  /**
+   * Select the level for rendering. Without `level_of_detail`, or when
+   * picking, this is the full detail or the last selected level. Ray
+   * tracing doesn't apply the hysteresis, so images are reproducible.
+   */
+  int select(PyMOLGlobals* G, const RenderInfo* info);
+};
+
+/// Add a rendered chunk to the statistics of the current frame
+void LodStatsAdd(PyMOLGlobals* G, const RenderInfo* info, int level,
+    std::size_t triangles);
+
+} // namespace pymol
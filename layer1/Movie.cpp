@@ -43,6 +43,21 @@ Z* -------------------------------------------------------------------
 #include"MovieScene.h"
 #include"Feedback.h"
 
+#include <algorithm>
+
+#if defined(__linux__) && !defined(_PYMOL_NOPY)
+#define PYMOL_MOVIE_FORK
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifdef PYMOL_OPENMP
+#include <omp.h>
+#endif
+
 #define cMovieDragModeMoveKey   1
 #define cMovieDragModeInsDel    2
 #define cMovieDragModeCopyKey   3
@@ -622,6 +637,185 @@ void MovieSetSize(PyMOLGlobals * G, unsigned int width, unsigned int height)
 }
 
 
+/*========================================================================*/
+static std::string MovieModalFileName(const CMovieModal * M, int frame)
+{
+  switch (M->format) {
+  case cMyPNG_FormatPPM:
+    return pymol::string_format("%s%04d.ppm", M->prefix.c_str(), frame + 1);
+  case cMyPNG_FormatPNG:
+  default:
+    return pymol::string_format("%s%04d.png", M->prefix.c_str(), frame + 1);
+  }
+}
+
+static bool MovieFileExists(const char * fname)
+{
+  FILE *tmp = fopen(fname, "rb");
+  if(tmp) {
+    fclose(tmp);
+    return true;
+  }
+  return false;
+}
+
+#ifdef PYMOL_MOVIE_FORK
+
+/**
+ * Sent from a worker process to the parent for every frame it rendered
+ */
+struct MovieWorkerReport {
+  int frame;
+  int ok;
+  double seconds;
+};
+
+/**
+ * Worker process main loop. All frame commands are replayed, since they may
+ * have cumulative effects, but only every n-th frame is ray traced.
+ */
+static void MovieWorkerRun(PyMOLGlobals * G, CMovie * I, CMovieModal * M,
+    int worker, int fd)
+{
+  /* the OpenGL context and the OpenMP thread pool don't survive fork() */
+  G->HaveGUI = false;
+  G->ValidContext = false;
+#ifdef PYMOL_OPENMP
+  omp_set_num_threads(1);
+#endif
+  int max_threads = SettingGetGlobal_i(G, cSetting_max_threads);
+  SettingSetGlobal_i(G, cSetting_max_threads,
+      std::max(1, max_threads / M->n_workers));
+
+  for(int frame = 0; frame < M->nFrame && !G->Interrupt; ++frame) {
+    SceneSetFrame(G, 0, frame);
+    MovieDoFrameCommand(G, frame);
+    MovieFlushCommands(G);
+
+    if((frame % M->n_workers) != worker ||
+        frame < M->start || frame > M->stop)
+      continue;
+
+    auto fname = MovieModalFileName(M, frame);
+    if(M->missing_only && MovieFileExists(fname.c_str()))
+      continue;
+
+    MovieWorkerReport report{frame, false, UtilGetSeconds(G)};
+    int image = MovieFrameToImage(G, frame);
+    VecCheck(I->Image, image);
+    SceneUpdate(G, false);
+    SceneMakeMovieImage(G, false, false, M->mode, M->width, M->height);
+    if(I->Image[image]) {
+      report.ok = MyPNGWrite(fname.c_str(), *I->Image[image],
+          SettingGetGlobal_f(G, cSetting_image_dots_per_inch), M->format,
+          true, SettingGetGlobal_f(G, cSetting_png_screen_gamma),
+          SettingGetGlobal_f(G, cSetting_png_file_gamma));
+      I->Image[image] = nullptr;
+    }
+    report.seconds = UtilGetSeconds(G) - report.seconds;
+
+    if(write(fd, &report, sizeof(report)) != sizeof(report))
+      break;
+  }
+}
+
+/**
+ * Fork M->n_workers processes which ray trace disjoint subsets of the frames
+ * and mark the frames which were written in M->done. Frames of failed
+ * workers are left to the serial render loop.
+ */
+static void MovieRenderForked(PyMOLGlobals * G, CMovie * I, CMovieModal * M)
+{
+  std::vector<pid_t> pids;
+  std::vector<pollfd> fds;
+
+  M->done.assign(M->nFrame, false);
+
+  int blocked = PAutoBlock(G);
+  for(int worker = 0; worker < M->n_workers; ++worker) {
+    int pipefd[2];
+    if(pipe(pipefd) != 0)
+      break;
+
+    PyOS_BeforeFork();
+    pid_t pid = fork();
+
+    if(pid == 0) {
+      PyOS_AfterFork_Child();
+      PAutoUnblock(G, blocked);
+      close(pipefd[0]);
+      for(auto& p : fds)
+        close(p.fd);
+      MovieWorkerRun(G, I, M, worker, pipefd[1]);
+      close(pipefd[1]);
+      _exit(0);                 /* no Python or atexit cleanup */
+    }
+
+    PyOS_AfterFork_Parent();
+    close(pipefd[1]);
+    if(pid < 0) {
+      PRINTFB(G, FB_Movie, FB_Warnings)
+        " MoviePNG-Warning: fork failed (%s)\n", strerror(errno) ENDFB(G);
+      close(pipefd[0]);
+      break;
+    }
+    pids.push_back(pid);
+    fds.push_back({pipefd[0], POLLIN, 0});
+  }
+  PAutoUnblock(G, blocked);
+
+  PRINTFB(G, FB_Movie, FB_Details)
+    " Movie: ray tracing with %d worker processes.\n", (int) pids.size()
+    ENDFB(G);
+
+  int n_done = 0;
+  for(std::size_t n_open = fds.size(); n_open;) {
+    if(poll(fds.data(), fds.size(), 250) < 0 && errno != EINTR)
+      break;
+
+    if(G->Interrupt) {
+      for(auto pid : pids)
+        kill(pid, SIGTERM);
+    }
+
+    for(auto& p : fds) {
+      if(p.fd < 0 || !p.revents)
+        continue;
+
+      MovieWorkerReport report;
+      if(read(p.fd, &report, sizeof(report)) != sizeof(report)) {
+        close(p.fd);
+        p.fd = -1;
+        --n_open;
+        continue;
+      }
+
+      if(report.ok && report.frame >= 0 && report.frame < M->nFrame) {
+        M->done[report.frame] = true;
+        M->timings.push_back(report.seconds);
+        ++n_done;
+        PRINTFB(G, FB_Movie, FB_Details)
+          " Movie: frame %4d of %4d, %4.2f sec. (%d done).\n",
+          report.frame + 1, M->nFrame, report.seconds, n_done ENDFB(G);
+        OrthoBusySlow(G, n_done, M->nFrame);
+      }
+    }
+  }
+
+  for(auto pid : pids) {
+    int status = 0;
+    while(waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      PRINTFB(G, FB_Movie, FB_Warnings)
+        " MoviePNG-Warning: worker process %d failed, remaining frames will be rendered serially.\n",
+        (int) pid ENDFB(G);
+    }
+  }
+}
+
+#endif
+
 /*========================================================================*/
 static void MovieModalPNG(PyMOLGlobals * G, CMovie * I, CMovieModal * M)
 {
@@ -656,6 +850,19 @@ static void MovieModalPNG(PyMOLGlobals * G, CMovie * I, CMovieModal * M)
       SceneSetFrame(G, 0, 0);
     MoviePlay(G, cMoviePlay);
     VecCheck(I->Image, M->nFrame);
+    M->startTiming = UtilGetSeconds(G);
+#ifdef PYMOL_MOVIE_FORK
+    /* frame-parallel ray tracing, the serial loop below then only
+       renders the frames which the workers failed on */
+    if(M->mode == cSceneImage_Ray && !M->modal && !G->Interrupt) {
+      M->n_workers = SettingGetGlobal_i(G, cSetting_movie_workers);
+      if(M->n_workers > 1) {
+        MovieRenderForked(G, I, M);
+      } else {
+        M->n_workers = 0;
+      }
+    }
+#endif
     M->frame = 0;
     M->stage = 1;
     if(G->Interrupt) {
@@ -670,24 +877,14 @@ static void MovieModalPNG(PyMOLGlobals * G, CMovie * I, CMovieModal * M)
 
       PRINTFB(G, FB_Movie, FB_Debugging)
         " MoviePNG-DEBUG: Cycle %d...\n", M->frame ENDFB(G);
-      switch (M->format) {
-      case cMyPNG_FormatPPM:
-        M->fname = pymol::string_format("%s%04d.ppm", M->prefix.c_str(), M->frame + 1);
-        break;
-      case cMyPNG_FormatPNG:
-      default:
-        M->fname = pymol::string_format("%s%04d.png", M->prefix.c_str(), M->frame + 1);
-        break;
-      }
+      M->fname = MovieModalFileName(M, M->frame);
 
       if(M->missing_only) {
-        FILE *tmp = fopen(M->fname.c_str(), "rb");
-        if(tmp) {
-          fclose(tmp);
-          M->file_missing = false;
-        } else {
-          M->file_missing = true;
-        }
+        M->file_missing = !MovieFileExists(M->fname.c_str());
+      }
+      if(M->frame < (int) M->done.size() && M->done[M->frame]) {
+        /* already written by a worker process */
+        M->file_missing = false;
       }
       SceneSetFrame(G, 0, M->frame);
       MovieDoFrameCommand(G, M->frame);
@@ -756,6 +953,9 @@ static void MovieModalPNG(PyMOLGlobals * G, CMovie * I, CMovieModal * M)
     }
     M->timing = UtilGetSeconds(G) - M->timing;
     M->accumTiming += M->timing;
+    M->timings.push_back(M->timing);
+    if(M->n_workers)
+      ++M->n_retried;
     {
       double est1 = (M->nFrame - M->frame) * M->timing;
       double est2 = ((M->nFrame - M->frame) / (float) (M->frame + 1)) * M->accumTiming;
@@ -796,6 +996,17 @@ static void MovieModalPNG(PyMOLGlobals * G, CMovie * I, CMovieModal * M)
     SceneInvalidate(G);         /* important */
     PRINTFB(G, FB_Movie, FB_Debugging)
       " MoviePNG-DEBUG: done.\n" ENDFB(G);
+    if(M->n_workers && !M->timings.empty()) {
+      auto minmax = std::minmax_element(M->timings.begin(), M->timings.end());
+      double sum = 0;
+      for(double t : M->timings)
+        sum += t;
+      PRINTFB(G, FB_Movie, FB_Details)
+        " Movie: %d frames in %4.2f sec. with %d workers (per frame: %4.2f avg, %4.2f min, %4.2f max; %d rendered serially).\n",
+        (int) M->timings.size(), UtilGetSeconds(G) - M->startTiming,
+        M->n_workers, sum / M->timings.size(), *minmax.first,
+        *minmax.second, M->n_retried ENDFB(G);
+    }
     SettingSetGlobal_b(G, cSetting_cache_frames, M->save);
     MoviePlay(G, cMovieStop);
     MovieClearImages(G);
@@ -19,6 +19,7 @@ Z* -------------------------------------------------------------------
 
 #include <memory>
 #include <string>
+#include <vector>
 #include"os_python.h"
 #include"Ortho.h"
 #include"Scene.h"
@@ -50,6 +51,13 @@ struct CMovieModal {
   int format = 0;
   int quiet = 0;
   std::string fname;
+
+  /* frame-parallel ray tracing (movie_workers) */
+  int n_workers = 0;
+  int n_retried = 0;
+  double startTiming = 0;
+  std::vector<bool> done;       /* frames written by a worker process */
+  std::vector<double> timings;  /* seconds per rendered frame */
 };
 
 struct CMovie : public Block {
@@ -27,6 +27,10 @@ Z* -------------------------------------------------------------------
 #include "os_predef.h"
 #include "os_std.h"
 
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
 #include "ButMode.h"
 #include "CGO.h"
 #include "Control.h"
@@ -108,9 +108,7 @@ int PConvPyListToStringVLA(PyObject * obj, char **vla_ptr);
 #define PConvPyListToIntVLA(obj, f)     PConvPyListToIntArrayImpl(obj, f, true)
 
 int PConvPyStrToStr(PyObject * obj, char *ptr, int l);
-#ifndef _PYMOL_NOPY
 int PConvPyStrToStrPtr(PyObject * obj, const char **ptr);
-#endif
 int PConvPyStrToLexRef(PyObject * obj, OVLexicon * lex, int *lex_ref);
 int PConvPyFloatToFloat(PyObject * obj, float *ptr);
 int PConvPyIntToChar(PyObject * obj, char *ptr);
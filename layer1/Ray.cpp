@@ -14,6 +14,10 @@ I* Additional authors of this source file include:
 -*
 Z* -------------------------------------------------------------------
 */
+#include <algorithm>
+#include <thread>
+#include <vector>
+
 #include"os_python.h"
 
 #include"os_predef.h"
@@ -40,6 +44,7 @@ Z* -------------------------------------------------------------------
 #include"MyPNG.h"
 #include"CGO.h"
 #include "Feedback.h"
+#include "Trace.h"
 
 #define SettingGetfv SettingGetGlobal_3fv
 
@@ -2874,65 +2879,47 @@ void RayProjectTriangle(CRay * I, RayInfo * r, float *light, float *v0, float *n
   }
 }
 
-#ifndef _PYMOL_NOPY
+/**
+ * Run `fn` for `n` consecutive thread infos, the first one on the calling
+ * thread and the others on worker threads. Returns when all are done.
+ */
+template <typename T>
+static void RaySpawn(T* Thread, int n, int (*fn)(T*))
+{
+  std::vector<std::thread> workers;
+  workers.reserve(n - 1);
+  for (int a = 1; a < n; ++a) {
+    workers.emplace_back(fn, Thread + a);
+  }
+  fn(Thread);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
 static void RayHashSpawn(CRayHashThreadInfo * Thread, int n_thread, int n_total)
 {
-  int blocked;
-  PyObject *info_list;
-  int a, c, n = 0;
   CRay *I = Thread->ray;
-  PyMOLGlobals *G = I->G;
-
-  blocked = PAutoBlock(G);
 
   PRINTFB(I->G, FB_Ray, FB_Blather)
     " Ray: filling voxels with %d threads...\n", n_thread ENDFB(I->G);
-  while(n < n_total) {
-    c = n;
-    info_list = PyList_New(n_thread);
-    for(a = 0; a < n_thread; a++) {
-      if((c + a) < n_total) {
-        PyList_SetItem(
-            info_list, a, PyCapsule_New(Thread + c + a, nullptr, nullptr));
-      } else {
-        PyList_SetItem(info_list, a, PConvAutoNone(nullptr));
-      }
-      n++;
-    }
-    PXDecRef(PYOBJECT_CALLMETHOD
-             (G->P_inst->cmd, "_ray_hash_spawn", "OO", info_list, G->P_inst->cmd));
-    Py_DECREF(info_list);
+  for (int n = 0; n < n_total; n += n_thread) {
+    RaySpawn(Thread + n, std::min(n_thread, n_total - n), RayHashThread);
   }
-  PAutoUnblock(G, blocked);
 }
-#endif
 
-#ifndef _PYMOL_NOPY
 static void RayAntiSpawn(CRayAntiThreadInfo * Thread, int n_thread)
 {
-  int blocked;
-  PyObject *info_list;
-  int a;
   CRay *I = Thread->ray;
-  PyMOLGlobals *G = I->G;
-
-  blocked = PAutoBlock(G);
 
   PRINTFB(I->G, FB_Ray, FB_Blather)
     " Ray: antialiasing with %d threads...\n", n_thread ENDFB(I->G);
-  info_list = PyList_New(n_thread);
-  for(a = 0; a < n_thread; a++) {
-    PyList_SetItem(info_list, a, PyCapsule_New(Thread + a, nullptr, nullptr));
-  }
-  PXDecRef(PYOBJECT_CALLMETHOD
-           (G->P_inst->cmd, "_ray_anti_spawn", "OO", info_list, G->P_inst->cmd));
-  Py_DECREF(info_list);
-  PAutoUnblock(G, blocked);
+  RaySpawn(Thread, n_thread, RayAntiThread);
 }
-#endif
 
 int RayHashThread(CRayHashThreadInfo * T)
 {
+  PYMOL_TRACE_SCOPE("RayHashThread", "ray");
   BasisMakeMap(T->basis, T->vert2prim, T->prim, T->n_prim, T->clipBox, T->phase,
                cCache_ray_map, T->perspective, T->front, T->size_hint);
 
@@ -2950,30 +2937,14 @@ int RayHashThread(CRayHashThreadInfo * T)
   return 1;
 }
 
-#ifndef _PYMOL_NOPY
 static void RayTraceSpawn(CRayThreadInfo * Thread, int n_thread)
 {
-  int blocked;
-  PyObject *info_list;
-  int a;
   CRay *I = Thread->ray;
-  PyMOLGlobals *G = I->G;
-
-  blocked = PAutoBlock(G);
 
   PRINTFB(I->G, FB_Ray, FB_Blather)
     " Ray: rendering with %d threads...\n", n_thread ENDFB(I->G);
-  info_list = PyList_New(n_thread);
-  for(a = 0; a < n_thread; a++) {
-    PyList_SetItem(info_list, a, PyCapsule_New(Thread + a, nullptr, nullptr));
-  }
-  PXDecRef(PYOBJECT_CALLMETHOD
-           (G->P_inst->cmd, "_ray_spawn", "OO", info_list, G->P_inst->cmd));
-  Py_DECREF(info_list);
-  PAutoUnblock(G, blocked);
-
+  RaySpawn(Thread, n_thread, RayTraceThread);
 }
-#endif
 
 static int find_edge(unsigned int *ptr, float *depth, unsigned int width,
                      int threshold, int back)
@@ -3165,6 +3136,7 @@ static void RayPrimGetColorRamped(PyMOLGlobals * G, float *matrix, RayInfo * r,
 
 int RayTraceThread(CRayThreadInfo * T)
 {
+  PYMOL_TRACE_SCOPE("RayTraceThread", "ray");
   CRay *I = T->ray;
   int x, y, yy;
   float excess = 0.0F;
@@ -4618,6 +4590,7 @@ int RayTraceThread(CRayThreadInfo * T)
 
 int RayAntiThread(CRayAntiThreadInfo * T)
 {
+  PYMOL_TRACE_SCOPE("RayAntiThread", "ray");
   int src_row_pixels;
 
   unsigned int *pSrc;
@@ -5519,13 +5492,11 @@ extern int n_sausages;
 extern int n_skipped;
 #endif
 
-float *rayDepthPixels = nullptr;
-int rayVolume = 0, rayWidth = 0, rayHeight = 0;
-
 /*========================================================================*/
 void RayRender(CRay * I, unsigned int *image, double timing,
                float angle, int antialias, unsigned int *return_bg)
 {
+  PYMOL_TRACE_SCOPE("RayRender", "ray");
   int a, x, y;
   unsigned int *image_copy = nullptr;
   unsigned int back_mask, fore_mask = 0, trace_word = 0;
@@ -5782,10 +5753,14 @@ void RayRender(CRay * I, unsigned int *image, double timing,
       I->PrimSize = 0.0F;
     }
     ok &= !I->G->Interrupt;
-    if (ok)
-      ok &= RayExpandPrimitives(I);
-    if (ok)
-      ok &= RayTransformFirst(I, perspective, false);
+    {
+      PYMOL_TRACE_SCOPE("RayExpandPrimitives", "ray");
+      if (ok)
+        ok &= RayExpandPrimitives(I);
+      if (ok)
+        ok &= RayTransformFirst(I, perspective, false);
+    }
+    pymol::trace::counter("ray primitives", I->NPrimitive);
 
     OrthoBusyFast(I->G, 3, 20);
 
@@ -5872,7 +5847,6 @@ void RayRender(CRay * I, unsigned int *image, double timing,
     }
 
     OrthoBusyFast(I->G, 4, 20);
-#ifndef _PYMOL_NOPY
     if(shadows && (n_thread > 1)) {     /* parallel execution */
 
       CRayHashThreadInfo *thread_info = pymol::calloc<CRayHashThreadInfo>(I->NBasis);
@@ -5932,11 +5906,8 @@ void RayRender(CRay * I, unsigned int *image, double timing,
 
       FreeP(thread_info);
     } else
-#endif
     if (ok){ 
-#ifdef _PYMOL_NOPY
-      n_thread = 1;          /* serial execution */
-#endif
+      pymol::trace::Span map_span("RayMakeMaps", "ray");
       int* vert2prim_ptr = I->Vert2Prim.empty() ? nullptr : I->Vert2Prim.data();
       ok &= BasisMakeMap(I->Basis + 1, vert2prim_ptr, I->Primitive, I->NPrimitive,
 			 I->Volume, 0, cCache_ray_map, perspective, front, I->PrimSize);
@@ -6110,11 +6081,9 @@ void RayRender(CRay * I, unsigned int *image, double timing,
         rt[a].bkrd_data = I->bkgrd_data ? I->bkgrd_data->bits() : nullptr;
       }
 
-#ifndef _PYMOL_NOPY
       if(n_thread > 1)
         RayTraceSpawn(rt, n_thread);
       else
-#endif
         RayTraceThread(rt);
 
       if(oversample_cutoff) {   /* perform edge oversampling, if requested */
@@ -6128,11 +6097,9 @@ void RayRender(CRay * I, unsigned int *image, double timing,
           rt[a].edging = edging;
         }
 
-#ifndef _PYMOL_NOPY
         if(n_thread > 1)
           RayTraceSpawn(rt, n_thread);
         else
-#endif
           RayTraceThread(rt);
 
         CacheFreeP(I->G, edging, 0, cCache_ray_edging_buffer, false);
@@ -6518,11 +6485,9 @@ void RayRender(CRay * I, unsigned int *image, double timing,
       rt[a].ray = I;
     }
 
-#ifndef _PYMOL_NOPY
     if(n_thread > 1)
       RayAntiSpawn(rt, n_thread);
     else
-#endif
       RayAntiThread(rt);
     FreeP(rt);
     CacheFreeP(I->G, image, 0, cCache_ray_antialias_buffer, false);
@@ -6552,12 +6517,12 @@ void RayRender(CRay * I, unsigned int *image, double timing,
 	  depth[x+width*y] = -dd/(back-front) + 0.1;
 	}
       }
-      if (rayDepthPixels)
-	FreeP(rayDepthPixels);
-      rayDepthPixels = depth;
-      rayWidth = width;
-      rayHeight = height;
-      rayVolume = 3;
+      CScene* scene = I->G->Scene;
+      FreeP(scene->RayDepthPixels);
+      scene->RayDepthPixels = depth;
+      scene->RayWidth = width;
+      scene->RayHeight = height;
+      scene->RayVolume = 3;
     } else 
       FreeP(depth);
   }
@@ -7844,3 +7809,98 @@ float RayGetScaledAllAxesAtPoint(CRay * I, float *pt, float *xn, float *yn, floa
 float* RayGetProMatrix(CRay * I){
   return I->ProMatrix;
 }
+
+/*========================================================================*/
+bool RayRetainState::operator==(const RayRetainState& other) const
+{
+  auto const same3f = [](const float* v1, const float* v2) {
+    return std::equal(v1, v1 + 3, v2);
+  };
+  return TTTFlag == other.TTTFlag && (!TTTFlag || TTT == other.TTT) &&
+         context == other.context && same3f(CurColor, other.CurColor) &&
+         same3f(IntColor, other.IntColor) &&
+         CheckInterior == other.CheckInterior && Trans == other.Trans &&
+         Wobble == other.Wobble && same3f(WobbleParam, other.WobbleParam);
+}
+
+RayRetainState RayGetRetainState(const CRay* I)
+{
+  RayRetainState state;
+  state.TTTFlag = I->TTTFlag;
+  state.TTT = I->TTT;
+  state.context = I->context;
+  copy3f(I->CurColor, state.CurColor);
+  copy3f(I->IntColor, state.IntColor);
+  state.CheckInterior = I->CheckInterior;
+  state.Trans = I->Trans;
+  state.Wobble = I->Wobble;
+  copy3f(I->WobbleParam, state.WobbleParam);
+  return state;
+}
+
+static void RaySetRetainState(CRay* I, const RayRetainState& state)
+{
+  I->TTTFlag = state.TTTFlag;
+  I->TTT = state.TTT;
+  I->context = state.context;
+  copy3f(state.CurColor, I->CurColor);
+  copy3f(state.IntColor, I->IntColor);
+  I->CheckInterior = state.CheckInterior;
+  I->Trans = state.Trans;
+  I->Wobble = state.Wobble;
+  copy3f(state.WobbleParam, I->WobbleParam);
+}
+
+/**
+ * Start recording the primitives which get added to the ray
+ */
+void RayRetainBegin(CRay* I, RayRetained& retained, std::size_t stamp)
+{
+  retained.prims.clear();
+  retained.stamp = stamp;
+  retained.before = RayGetRetainState(I);
+  retained.start = I->NPrimitive;
+  retained.startPrimSize = I->PrimSize;
+  retained.startPrimSizeCnt = I->PrimSizeCnt;
+}
+
+/**
+ * Keep the primitives which were added since RayRetainBegin
+ */
+void RayRetainEnd(CRay* I, RayRetained& retained, double seconds)
+{
+  retained.prims.assign(
+      I->Primitive + retained.start, I->Primitive + I->NPrimitive);
+  retained.PrimSize = I->PrimSize - retained.startPrimSize;
+  retained.PrimSizeCnt = I->PrimSizeCnt - retained.startPrimSizeCnt;
+  retained.after = RayGetRetainState(I);
+  retained.seconds = seconds;
+}
+
+/**
+ * Add retained primitives to the ray, if they were recorded with the current
+ * ray state and the scene content didn't change since.
+ * @return False if the primitives need to be generated again
+ */
+bool RayRetainReplay(CRay* I, const RayRetained& retained, std::size_t stamp)
+{
+  if (retained.stamp != stamp || !(retained.before == RayGetRetainState(I))) {
+    return false;
+  }
+
+  auto const n = retained.prims.size();
+  VLACheck(I->Primitive, CPrimitive, I->NPrimitive + n);
+  if (!I->Primitive) {
+    return false;
+  }
+
+  std::copy_n(retained.prims.data(), n, I->Primitive + I->NPrimitive);
+  I->NPrimitive += n;
+  I->PrimSize += retained.PrimSize;
+  I->PrimSizeCnt += retained.PrimSizeCnt;
+  RaySetRetainState(I, retained.after);
+
+  I->NRetained += int(n);
+  I->RetainedSeconds += retained.seconds;
+  return true;
+}
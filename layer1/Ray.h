@@ -176,6 +176,10 @@ struct _CRay {
   glm::vec3 Pos;
   std::shared_ptr<pymol::Image> bkgrd_data;
 
+  /* retained primitives which were reused for this ray */
+  int NRetained = 0;
+  double RetainedSeconds = 0;
+
 private:
   int cylinder3fv(const float *v1, const float *v2, float r, const float *c1, const float *c2,
                   const float alpha1, const float alpha2);
@@ -189,4 +193,44 @@ void RaySetPointToWorldScreenRelative(CRay * ray, float *pos, float *screenPt);
 float RayGetScaledAllAxesAtPoint(CRay * I, float *pt, float *xn, float *yn, float *zn);
 float* RayGetProMatrix(CRay * I);
 
+/**
+ * Ray state which goes into the primitives, except for the camera
+ */
+struct RayRetainState {
+  int TTTFlag;
+  glm::mat4 TTT;
+  pymol::RenderContext context;
+  float CurColor[3], IntColor[3];
+  int CheckInterior;
+  float Trans;
+  int Wobble;
+  float WobbleParam[3];
+
+  bool operator==(const RayRetainState& other) const;
+};
+
+/**
+ * Primitives which a representation added to a ray, kept for later rays
+ * which only differ in the camera.
+ */
+struct RayRetained {
+  std::size_t stamp = 0;  //!< SceneGetRetainedStamp() at recording
+  RayRetainState before;  //!< state the primitives were added with
+  RayRetainState after;   //!< state after adding them
+  std::vector<CPrimitive> prims;
+  double PrimSize = 0;
+  int PrimSizeCnt = 0;
+  double seconds = 0;     //!< time it took to add them
+
+  /* ray counters at RayRetainBegin */
+  int start = 0;
+  double startPrimSize = 0;
+  int startPrimSizeCnt = 0;
+};
+
+RayRetainState RayGetRetainState(const CRay* I);
+void RayRetainBegin(CRay* I, RayRetained& retained, std::size_t stamp);
+void RayRetainEnd(CRay* I, RayRetained& retained, double seconds);
+bool RayRetainReplay(CRay* I, const RayRetained& retained, std::size_t stamp);
+
 #endif
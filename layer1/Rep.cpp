@@ -28,6 +28,8 @@ Z* -------------------------------------------------------------------
 #include"P.h"
 #include"Util.h"
 #include"Scene.h"
+#include"Setting.h"
+#include"Ray.h"
 
 /*========================================================================*/
 /**
@@ -124,6 +126,39 @@ void Rep::invalidate(cRepInv_t level)
   SceneInvalidatePicking(I->G); // for now, if anything invalidated, then invalidate picking
   if(level > I->MaxInvalid)
     I->MaxInvalid = level;
+  m_rayRetained.reset();
+}
+
+/**
+ * Render into a ray. With `ray_retain_primitives`, camera independent reps
+ * keep their primitives and add them again to later rays, as long as
+ * neither the rep nor the scene content changed.
+ */
+void Rep::renderRay(RenderInfo* info)
+{
+  CRay* ray = info->ray;
+
+  if (!rayViewIndependent() ||
+      !SettingGet<bool>(G, cSetting_ray_retain_primitives)) {
+    m_rayRetained.reset();
+    render(info);
+    return;
+  }
+
+  auto const stamp = SceneGetRetainedStamp(G);
+
+  if (m_rayRetained && RayRetainReplay(ray, *m_rayRetained, stamp)) {
+    return;
+  }
+
+  if (!m_rayRetained) {
+    m_rayRetained = std::make_unique<RayRetained>();
+  }
+
+  double const start = UtilGetSeconds(G);
+  RayRetainBegin(ray, *m_rayRetained, stamp);
+  render(info);
+  RayRetainEnd(ray, *m_rayRetained, UtilGetSeconds(G) - start);
 }
 
 /**
@@ -199,6 +234,15 @@ Rep::~Rep()
   FreeP(P);
 }
 
+pymol::MemorySize Rep::getMemorySize() const
+{
+  pymol::MemorySize size;
+  if (m_rayRetained) {
+    size.host += pymol::memory_size(m_rayRetained->prims);
+  }
+  return size;
+}
+
 RepIterator::RepIterator(PyMOLGlobals * G, int rep_) {
   if (rep_ < 0){
     end = cRepCnt;
@@ -18,9 +18,13 @@ Z* -------------------------------------------------------------------
 #define _H_Rep
 
 #include <cassert>
+#include <memory>
 
+#include "MemoryUsage.h"
 #include "Picking.h"
 
+struct RayRetained;
+
 #define cCartoon_skip_helix -2
 #define cCartoon_skip -1
 #define cCartoon_auto 0
@@ -198,6 +202,20 @@ struct Rep {
   virtual void render(RenderInfo* info);
   virtual void invalidate(cRepInv_t level);
 
+  /**
+   * True if the ray primitives of this rep don't depend on the camera (e.g.
+   * no line widths in pixels, no billboards), so they can be retained.
+   */
+  virtual bool rayViewIndependent() const { return false; }
+
+  /**
+   * Memory held by this rep (geometry, CGOs and their GPU buffers, retained
+   * ray primitives). Subclasses add their buffers to Rep::getMemorySize().
+   */
+  virtual pymol::MemorySize getMemorySize() const;
+
+  void renderRay(RenderInfo* info);
+
   virtual ~Rep();
 
   pymol::CObject* obj = nullptr; // TODO redundant, use getObj()
@@ -227,6 +245,8 @@ private:
 
   bool m_has_transparency = false;
 
+  std::unique_ptr<RayRetained> m_rayRetained;
+
 public:
   Rep* update();
 
@@ -57,6 +57,7 @@ Z* -------------------------------------------------------------------
 #include"Text.h"
 #include"PyMOLOptions.h"
 #include"PyMOL.h"
+#include "Trace.h"
 #include"PConv.h"
 #include"ScrollBar.h"
 #include "ShaderMgr.h"
@@ -69,7 +70,9 @@ Z* -------------------------------------------------------------------
 
 //#define _OPENVR_STEREO_DEBUG_VIEWS
 
+#include <atomic>
 #include <string>
+#include <thread>
 #include <vector>
 #include <algorithm>
 #include <glm/vec3.hpp>
@@ -121,8 +124,6 @@ float anaglyphR_constants[6][9] = { { 0.000, 0.000, 0.299, 0.000, 0.000, 0.587,
 /* allow up to 10 seconds at 30 FPS */
 
 /* EXPERIMENTAL VOLUME RAYTRACING DATA */
-extern float *rayDepthPixels;
-extern int rayVolume, rayWidth, rayHeight;
 
 static void SceneRestartPerfTimer(PyMOLGlobals * G);
 #define SceneRotateWithDirty SceneRotate
@@ -817,6 +818,14 @@ void SceneGetCardInfo(PyMOLGlobals * G, char **vendor, char **renderer, char **v
   (*version) = I->version;
 }
 
+/**
+ * Triangles per detail level of the last rendered or ray traced frame
+ */
+const pymol::LodStats& SceneGetLodStats(PyMOLGlobals * G)
+{
+  return G->Scene->LodStats;
+}
+
 void SceneSuppressMovieFrame(PyMOLGlobals * G)
 {
   CScene *I = G->Scene;
@@ -2261,6 +2270,40 @@ void SceneChanged(PyMOLGlobals * G)
 {
   CScene *I = G->Scene;
   I->ChangedFlag = true;
+  SceneInvalidateRetained(G);
+  SceneInvalidateCopy(G, false);
+  SceneDirty(G);
+  SeqChanged(G);
+  PyMOL_NeedRedisplay(G->PyMOL);
+}
+
+/**
+ * Ray primitives which representations retained (see Rep::renderRay) are
+ * no longer valid, because something other than the camera changed.
+ */
+void SceneInvalidateRetained(PyMOLGlobals* G)
+{
+  if (G->Scene) {
+    ++G->Scene->RetainedStamp;
+  }
+}
+
+std::size_t SceneGetRetainedStamp(PyMOLGlobals* G)
+{
+  return G->Scene->RetainedStamp;
+}
+
+/**
+ * Like SceneChanged, but only `obj` needs to be updated. The next SceneUpdate
+ * only visits the changed objects, unless something requested a full update.
+ * Objects which are not in the scene get updated once they are added.
+ */
+void SceneObjectChanged(PyMOLGlobals* G, pymol::CObject* obj)
+{
+  CScene *I = G->Scene;
+  if (obj->Enabled && I->ChangedObjSet.insert(obj).second) {
+    I->ChangedObjs.push_back(obj);
+  }
   SceneInvalidateCopy(G, false);
   SceneDirty(G);
   SeqChanged(G);
@@ -2636,7 +2679,7 @@ int SceneObjectAdd(PyMOLGlobals * G, pymol::CObject * obj)
     I->NonGadgetObjs.push_back(obj);
   }
   SceneCountFrames(G);
-  SceneChanged(G);
+  SceneObjectChanged(G, obj);
   SceneInvalidatePicking(G); // PYMOL-2793
   return 1;
 }
@@ -2667,6 +2710,8 @@ int SceneObjectDel(PyMOLGlobals * G, pymol::CObject * obj, int allow_purge)
     I->Obj.clear();
     I->GadgetObjs.clear();
     I->NonGadgetObjs.clear();
+    I->ChangedObjs.clear();
+    I->ChangedObjSet.clear();
   } else {
     auto &obj_list = (obj->type == cObjectGadget) ? I->GadgetObjs : I->NonGadgetObjs;
     auto itg = find(obj_list.begin(), obj_list.end(), obj);
@@ -2682,6 +2727,12 @@ int SceneObjectDel(PyMOLGlobals * G, pymol::CObject * obj, int allow_purge)
       obj->Enabled = false;
       I->Obj.erase(it);
     }
+
+    // after the purge, which reports the object as changed again
+    if (I->ChangedObjSet.erase(obj)) {
+      auto itc = find(I->ChangedObjs.begin(), I->ChangedObjs.end(), obj);
+      I->ChangedObjs.erase(itc);
+    }
   }
   SceneCountFrames(G);
   SceneInvalidate(G);
@@ -4162,6 +4213,7 @@ void SceneFree(PyMOLGlobals * G)
   I->NonGadgetObjs.clear();
 
   ScenePurgeImage(G);
+  FreeP(I->RayDepthPixels);
   CGOFree(G->DebugCGO);
   delete G->Scene;
 }
@@ -4584,6 +4636,23 @@ void SceneCopy(PyMOLGlobals * G, GLFramebufferConfig config, int force, int enti
   }
 }
 
+/**
+ * Order in which changed objects get updated. Maps come first, since meshes,
+ * surfaces, volumes and slices are computed from them, and measurements come
+ * last, since they follow the coordinates of molecules.
+ */
+static int SceneObjectUpdateRank(const pymol::CObject* obj)
+{
+  switch (obj->type) {
+  case cObjectMap:
+    return 0;
+  case cObjectMeasurement:
+    return 2;
+  default:
+    return 1;
+  }
+}
+
 /*========================================================================*/
 int SceneRovingCheckDirty(PyMOLGlobals * G)
 {
@@ -4602,20 +4671,36 @@ void SceneObjectUpdateThread(CObjectUpdateThreadInfo * T)
   }
 }
 
-#ifndef _PYMOL_NOPY
 static void SceneObjectUpdateSpawn(PyMOLGlobals * G, CObjectUpdateThreadInfo * Thread,
                                    int n_thread, int n_total)
 {
   if(n_total == 1) {
     SceneObjectUpdateThread(Thread);
   } else if(n_total) {
+    PRINTFB(G, FB_Scene, FB_Blather)
+      " Scene: updating objects with %d threads...\n", n_thread ENDFB(G);
+#ifdef _PYMOL_NOPY
+    // no interpreter to re-enter, update on native threads
+    std::atomic<int> next{0};
+    auto worker = [&]() {
+      for (int a; (a = next++) < n_total;) {
+        SceneObjectUpdateThread(Thread + a);
+      }
+    };
+    std::vector<std::thread> workers;
+    for (int a = 1; a < n_thread; ++a) {
+      workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : workers) {
+      t.join();
+    }
+#else
     int blocked;
     PyObject *info_list;
     int a, n = 0;
     blocked = PAutoBlock(G);
 
-    PRINTFB(G, FB_Scene, FB_Blather)
-      " Scene: updating objects with %d threads...\n", n_thread ENDFB(G);
     info_list = PyList_New(n_total);
     for(a = 0; a < n_total; a++) {
       PyList_SetItem(info_list, a, PyCapsule_New(Thread + a, nullptr, nullptr));
@@ -4625,9 +4710,9 @@ static void SceneObjectUpdateSpawn(PyMOLGlobals * G, CObjectUpdateThreadInfo * T
              (G->P_inst->cmd, "_object_update_spawn", "Oi", info_list, n_thread));
     Py_DECREF(info_list);
     PAutoUnblock(G, blocked);
+#endif
   }
 }
-#endif
 
 static void SceneStencilCheck(PyMOLGlobals *G) 
 {
@@ -4652,6 +4737,7 @@ static void SceneStencilCheck(PyMOLGlobals *G)
 /*========================================================================*/
 void SceneUpdate(PyMOLGlobals * G, int force)
 {
+  PYMOL_TRACE_SCOPE("SceneUpdate", "scene");
   CScene *I = G->Scene;
 
   int cur_state = SettingGetGlobal_i(G, cSetting_state) - 1;
@@ -4672,8 +4758,20 @@ void SceneUpdate(PyMOLGlobals * G, int force)
     }
   }
 
-  if(force || I->ChangedFlag || ((cur_state != I->LastStateBuilt) &&
-                                 (defer_builds_mode > 0))) {
+  bool const update_all = force || I->ChangedFlag ||
+    ((cur_state != I->LastStateBuilt) && (defer_builds_mode > 0));
+
+  /* otherwise, only update the objects which changed */
+  std::list<pymol::CObject*> changed;
+  if(!update_all && !I->ChangedObjs.empty()) {
+    changed.assign(I->ChangedObjs.begin(), I->ChangedObjs.end());
+    changed.sort([](const pymol::CObject* a, const pymol::CObject* b) {
+      return SceneObjectUpdateRank(a) < SceneObjectUpdateRank(b);
+    });
+  }
+  auto const& objs = update_all ? I->Obj : changed;
+
+  if(update_all || !changed.empty()) {
 
     SceneCountFrames(G);
 
@@ -4682,19 +4780,20 @@ void SceneUpdate(PyMOLGlobals * G, int force)
       PyMOL_SetBusy(G->PyMOL, true);    /*  race condition -- may need to be fixed */
 
       /* update all gadgets first (single-threaded since they're thread-unsafe) */
-      for (auto& GadgetObj : I->GadgetObjs) {
-        GadgetObj->update();
+      for (auto& obj : update_all ? I->GadgetObjs : objs) {
+        if(obj->type == cObjectGadget) {
+          obj->update();
+        }
       }
 
       {
-#ifndef _PYMOL_NOPY
         int n_thread = SettingGetGlobal_i(G, cSetting_max_threads);
         int multithread = SettingGetGlobal_i(G, cSetting_async_builds);
         if(multithread && (n_thread > 1)) {
           int min_start = -1;
           int max_stop = -1;
           int n_obj = 0;
-          for (auto& obj : I->Obj) {
+          for (auto& obj : objs) {
             int start = 0;
             n_obj++;
             int stop = obj->getNFrame();
@@ -4730,30 +4829,33 @@ void SceneUpdate(PyMOLGlobals * G, int force)
 	   for all objects. */
         if(multithread && (n_thread > 1)) {
           /* multi-threaded geometry update */
-          int cnt = I->NonGadgetObjs.size();
+          auto const& non_gadgets = update_all ? I->NonGadgetObjs : objs;
+          int cnt = std::count_if(non_gadgets.begin(), non_gadgets.end(),
+              [](const pymol::CObject* obj) { return obj->type != cObjectGadget; });
 
           if(cnt) {
             CObjectUpdateThreadInfo *thread_info = pymol::malloc<CObjectUpdateThreadInfo>(cnt);
             if(thread_info) {
               cnt = 0;
-              for (auto& NonGadgetObj : I->NonGadgetObjs) {
-                thread_info[cnt++].obj = NonGadgetObj;
+              for (auto& obj : non_gadgets) {
+                if(obj->type != cObjectGadget) {
+                  thread_info[cnt++].obj = obj;
+                }
               }
               SceneObjectUpdateSpawn(G, thread_info, n_thread, cnt);
               FreeP(thread_info);
             }
           }
         } else
-#endif
           /* single-threaded update */
-          for (auto& obj : I->Obj) {
+          for (auto& obj : objs) {
             obj->update();
           }
       }
       PyMOL_SetBusy(G->PyMOL, false);   /*  race condition -- may need to be fixed */
     } else { /* defer builds mode == 5 -- for now, only update non-molecular objects */
       /* single-threaded update */
-      for (auto& obj : I->Obj) {
+      for (auto& obj : objs) {
         if(obj->type != cObjectMolecule) {
           obj->update();
         }
@@ -4761,6 +4863,8 @@ void SceneUpdate(PyMOLGlobals * G, int force)
     }
 
     I->ChangedFlag = false;
+    I->ChangedObjs.clear();
+    I->ChangedObjSet.clear();
 
     if((defer_builds_mode >= 2) && (force || (defer_builds_mode != 5)) &&
        (cur_state != I->LastStateBuilt)) {
@@ -76,6 +76,9 @@ int SceneGetState(PyMOLGlobals * G);
 void SceneDirty(PyMOLGlobals * G);      /* scene dirty, but leave the overlay if one exists */
 void SceneInvalidate(PyMOLGlobals * G); /* scene dirty and remove the overlay */
 void SceneChanged(PyMOLGlobals * G);    /* update 3D objects */
+void SceneObjectChanged(PyMOLGlobals * G, pymol::CObject* obj); /* update one object */
+void SceneInvalidateRetained(PyMOLGlobals * G); /* retained ray primitives */
+std::size_t SceneGetRetainedStamp(PyMOLGlobals * G);
 
 int SceneCountFrames(PyMOLGlobals * G);
 int SceneGetNFrame(PyMOLGlobals * G, int *has_movie=nullptr);
@@ -172,6 +175,7 @@ void SceneInvalidateCopy(PyMOLGlobals * G, int free_buffer);
 
 void SceneSetCardInfo(PyMOLGlobals * G, const char *vendor, const char *renderer, const char *version);
 void SceneGetCardInfo(PyMOLGlobals * G, char **vendor, char **renderer, char **version);
+const pymol::LodStats& SceneGetLodStats(PyMOLGlobals * G);
 int SceneLoadPNG(PyMOLGlobals * G, const char *fname, int movie_flag, int stereo, int quiet);
 
 void SceneSetDefaultView(PyMOLGlobals * G);
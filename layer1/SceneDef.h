@@ -30,7 +30,9 @@ Z* -------------------------------------------------------------------
 #include"Rect.h"
 #include "Camera.h"
 #include "Spatial.h"
+#include "LevelOfDetail.h"
 #include<list>
+#include<unordered_set>
 #include<vector>
 
 #include <glm/mat4x4.hpp>
@@ -100,6 +102,10 @@ class CScene : public Block {
   double SweepTime{};
   bool DirtyFlag{true};
   bool ChangedFlag{};
+  /* objects which need an update, when ChangedFlag isn't set */
+  std::vector<pymol::CObject*> ChangedObjs;
+  std::unordered_set<const pymol::CObject*> ChangedObjSet;
+  std::size_t RetainedStamp{}; //!< see SceneInvalidateRetained
   int CopyType{};
   bool CopyNextFlag{true}, CopyForced{};
   int NFrame { 0 };
@@ -173,6 +179,13 @@ class CScene : public Block {
   int vp_times{}, vp_stereo_mode{};
   float vp_width_scale{};
   PickColorManager pickmgr;
+  pymol::LodStats LodStats; //!< triangles per detail level of the last frame
+
+  /* experimental volume + ray tracing composition */
+  std::shared_ptr<pymol::Image> RayVolumeImage;
+  float* RayDepthPixels{};
+  int RayVolume{}, RayWidth{}, RayHeight{};
+  double RayAccumTiming{};
 
   CScene(PyMOLGlobals * G) : Block(G), m_ScrollBar(G, false) {}
 
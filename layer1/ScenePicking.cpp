@@ -11,12 +11,258 @@
 #include "Err.h"
 #include "Picking.h"
 #include "Feedback.h"
+#include "CoordSet.h"
+#include "Matrix.h"
+#include "ObjectMolecule.h"
+#include "PickBVH.h"
+#include "Vector.h"
 
 #define cRange 7
 
+/**
+ * True if picking should cast rays against the per-coordset BVH on the CPU
+ * (pick_method=1, or no OpenGL) instead of rendering with pick colors.
+ * Only molecular objects are pickable this way. Grid mode and side-by-side
+ * stereo always use color picking.
+ */
+static bool SceneUseCPUPicking(PyMOLGlobals* G)
+{
+  CScene *I = G->Scene;
+  if (I->grid.active || StereoIsAdjacent(G))
+    return false;
+  return SettingGet<int>(G, cSetting_pick_method) == 1 || !G->HaveGUI;
+}
+
+/**
+ * Camera setup for CPU picking. Eye space has the camera at the origin,
+ * looking down -z.
+ */
+struct ScenePickCamera {
+  double eye_from_world[16]; // row-major
+  bool ortho;
+  float half_w, half_h;      // ortho: half extent, perspective: tan(fov/2)
+  float front, back;
+  int left, bottom, width, height;
+};
+
+static ScenePickCamera ScenePickCameraGet(PyMOLGlobals* G)
+{
+  CScene *I = G->Scene;
+  ScenePickCamera cam;
+  const auto& rot = I->m_view.rotMatrix();
+  const auto& pos = I->m_view.pos();
+  const auto& ori = I->m_view.origin();
+  const auto extent = SceneGetExtent(G);
+
+  // T(pos) * R * T(-origin), see SceneComposeModelViewMatrix
+  double* m = cam.eye_from_world;
+  identity44d(m);
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      m[i * 4 + j] = rot[j][i];
+    }
+    m[i * 4 + 3] =
+        pos[i] - (m[i * 4] * ori.x + m[i * 4 + 1] * ori.y + m[i * 4 + 2] * ori.z);
+  }
+
+  cam.left = I->rect.left;
+  cam.bottom = I->rect.bottom;
+  cam.width = std::max<int>(1, extent.width);
+  cam.height = std::max<int>(1, extent.height);
+  cam.front = I->m_view.m_clipSafe().m_front;
+  cam.back = I->m_view.m_clipSafe().m_back;
+
+  // same as SceneProjectionMatrix
+  cam.ortho = SettingGet<bool>(G, cSetting_ortho);
+  if (cam.ortho) {
+    cam.half_h = std::max(R_SMALL4, -pos.z) * GetFovWidth(G) / 2.f;
+  } else {
+    cam.half_h = tanf(GetFovWidth(G) / 2.f);
+  }
+  cam.half_w = cam.half_h * cam.width / cam.height;
+
+  return cam;
+}
+
+/**
+ * Transformation from the coordinate space of an object state to eye space
+ * (including TTT and state matrix), and its inverse.
+ */
+static bool ScenePickEyeFromModel(const ScenePickCamera& cam,
+    pymol::CObject* obj, int state, double* eye_from_model,
+    double* model_from_eye)
+{
+  double world_from_model[16];
+  if (ObjectGetTotalMatrix(obj, state, false, world_from_model)) {
+    multiply44d44d44d(cam.eye_from_world, world_from_model, eye_from_model);
+  } else {
+    copy44d(cam.eye_from_world, eye_from_model);
+  }
+  return xx_matrix_invert(model_from_eye, eye_from_model, 4);
+}
+
+/**
+ * Calls `func(obj, state, cs, eye_from_model, model_from_eye)` for every
+ * displayed coordinate set
+ */
+template <typename Func>
+static void ScenePickForEachCoordSet(
+    PyMOLGlobals* G, const ScenePickCamera& cam, Func&& func)
+{
+  CScene *I = G->Scene;
+  int const scene_state = SceneGetState(G);
+
+  for (auto obj : I->Obj) {
+    if (obj->type != cObjectMolecule)
+      continue;
+
+    auto objMol = static_cast<ObjectMolecule*>(obj);
+    for (StateIterator iter(G, obj->Setting.get(), scene_state, objMol->NCSet);
+         iter.next();) {
+      CoordSet* cs = objMol->CSet[iter.state];
+      if (!cs)
+        continue;
+
+      double eye_from_model[16], model_from_eye[16];
+      if (!ScenePickEyeFromModel(
+              cam, obj, iter.state, eye_from_model, model_from_eye))
+        continue;
+
+      if (!cs->PickTree) {
+        cs->PickTree = pymol::make_cache<pymol::PickBVH>(cs);
+      }
+
+      func(obj, iter.state, cs, eye_from_model, model_from_eye);
+    }
+  }
+}
+
+/**
+ * CPU version of SceneRenderPickingSinglePick
+ */
+static void SceneCPUPick(PyMOLGlobals* G, int x, int y, Picking* pick)
+{
+  auto const cam = ScenePickCameraGet(G);
+
+  // ray through the pixel center, in eye space
+  float const sx = 2.f * (x + 0.5f - cam.left) / cam.width - 1.f;
+  float const sy = 2.f * (y + 0.5f - cam.bottom) / cam.height - 1.f;
+  float const pixel = 2.f * cam.half_h / cam.height;
+
+  pymol::PickRay eye_ray;
+  if (cam.ortho) {
+    set3f(eye_ray.origin, sx * cam.half_w, sy * cam.half_h, 0.f);
+    set3f(eye_ray.dir, 0.f, 0.f, -1.f);
+    eye_ray.pixel0 = pixel;
+    eye_ray.pixel1 = 0.f;
+  } else {
+    set3f(eye_ray.origin, 0.f, 0.f, 0.f);
+    set3f(eye_ray.dir, sx * cam.half_w, sy * cam.half_h, -1.f);
+    eye_ray.pixel0 = 0.f;
+    eye_ray.pixel1 = pixel;
+  }
+  eye_ray.tmin = cam.front;
+  eye_ray.tmax = cam.back;
+  eye_ray.tolerance = DIP2PIXEL(cRange);
+
+  pymol::PickHit hit;
+  pick->context.object = nullptr;
+
+  ScenePickForEachCoordSet(G, cam,
+      [&](pymol::CObject* obj, int state, CoordSet* cs, const double*,
+          const double* model_from_eye) {
+        auto ray = eye_ray;
+        transform44d3f(model_from_eye, eye_ray.origin, ray.origin);
+        transform44d3fas33d3f(model_from_eye, eye_ray.dir, ray.dir);
+
+        if (cs->PickTree->intersect(cs, ray, hit)) {
+          pick->src.index = hit.index;
+          pick->src.bond = hit.bond;
+          pick->context.object = obj;
+          pick->context.state = state;
+        }
+      });
+}
+
+/**
+ * CPU version of SceneRenderPickingMultiPick. Unlike color picking, this
+ * also finds atoms which are hidden behind other geometry.
+ */
+static void SceneCPUMultipick(PyMOLGlobals* G, Multipick* smp)
+{
+  auto const cam = ScenePickCameraGet(G);
+
+  auto const to_screen = [&](int v, int offset, int size, float half) {
+    return (2.f * (v - offset) / size - 1.f) * half;
+  };
+  float const a0 = to_screen(smp->x, cam.left, cam.width, cam.half_w);
+  float const a1 =
+      to_screen(smp->x + std::max(1, smp->w), cam.left, cam.width, cam.half_w);
+  float const b0 = to_screen(smp->y, cam.bottom, cam.height, cam.half_h);
+  float const b1 = to_screen(
+      smp->y + std::max(1, smp->h), cam.bottom, cam.height, cam.half_h);
+
+  // eye space planes of the selection frustum (inside is positive)
+  float const eye_planes[6][4] = {
+      {1.f, 0.f, cam.ortho ? 0.f : a0, cam.ortho ? -a0 : 0.f},
+      {-1.f, 0.f, cam.ortho ? 0.f : -a1, cam.ortho ? a1 : 0.f},
+      {0.f, 1.f, cam.ortho ? 0.f : b0, cam.ortho ? -b0 : 0.f},
+      {0.f, -1.f, cam.ortho ? 0.f : -b1, cam.ortho ? b1 : 0.f},
+      {0.f, 0.f, -1.f, -cam.front},
+      {0.f, 0.f, 1.f, cam.back},
+  };
+
+  std::vector<int> atoms;
+  std::vector<bool> seen;
+
+  ScenePickForEachCoordSet(G, cam,
+      [&](pymol::CObject* obj, int state, CoordSet* cs,
+          const double* eye_from_model, const double*) {
+        // plane in model space: transpose(eye_from_model) * plane
+        float planes[6][4];
+        for (int k = 0; k < 6; ++k) {
+          for (int j = 0; j < 4; ++j) {
+            double sum = 0.0;
+            for (int i = 0; i < 4; ++i) {
+              sum += eye_from_model[i * 4 + j] * eye_planes[k][i];
+            }
+            planes[k][j] = sum;
+          }
+          float const len = length3f(planes[k]);
+          if (len > R_SMALL8) {
+            scale3f(planes[k], 1.f / len, planes[k]);
+            planes[k][3] /= len;
+          }
+        }
+
+        atoms.clear();
+        cs->PickTree->intersect(cs, planes, 6, atoms);
+
+        seen.assign(cs->Obj->NAtom, false);
+        for (int atm : atoms) {
+          if (seen[atm])
+            continue;
+          seen[atm] = true;
+
+          Picking pik;
+          pik.src.index = atm;
+          pik.src.bond = cPickableAtom;
+          pik.context.object = obj;
+          pik.context.state = state;
+          smp->picked.push_back(pik);
+        }
+      });
+}
+
 int SceneDoXYPick(PyMOLGlobals * G, int x, int y, ClickSide click_side)
 {
   CScene *I = G->Scene;
+
+  if (SceneUseCPUPicking(G)) {
+    SceneCPUPick(G, x, y, &I->LastPicked);
+    return (I->LastPicked.context.object != nullptr);
+  }
+
   int defer_builds_mode = SettingGet<int>(G, cSetting_defer_builds_mode);
 
   if(defer_builds_mode == 5)    /* force generation of a pickable version */
@@ -332,6 +578,12 @@ void SceneRenderPicking(PyMOLGlobals* G, int stereo_mode, ClickSide click_side,
 int SceneMultipick(PyMOLGlobals * G, Multipick * smp)
 {
   CScene *I = G->Scene;
+
+  if (SceneUseCPUPicking(G)) {
+    SceneCPUMultipick(G, smp);
+    return (1);
+  }
+
   int defer_builds_mode = SettingGet<int>(G, cSetting_defer_builds_mode);
 
   if(defer_builds_mode == 5)    /* force generation of a pickable version */
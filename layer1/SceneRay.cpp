@@ -11,13 +11,6 @@
 #include"P.h"
 #include "Feedback.h"
 
-static double accumTiming = 0.0;
-
-/* EXPERIMENTAL VOLUME RAYTRACING DATA */
-static std::shared_ptr<pymol::Image> rayVolumeImage;
-extern float *rayDepthPixels;
-extern int rayVolume, rayWidth, rayHeight;
-
 
 static void SceneRaySetRayView(PyMOLGlobals * G, CScene *I, int stereo_hand,
     float *rayView, float *angle, float shift)
@@ -112,6 +105,8 @@ bool SceneRay(PyMOLGlobals * G,
   int ortho = SettingGetGlobal_i(G, cSetting_ray_orthoscopic);
   int last_grid_active = I->grid.active;
   int grid_size = 0;
+  int n_retained = 0;
+  double retained_seconds = 0;
 
   if(SettingGetGlobal_i(G, cSetting_defer_builds_mode) == 5)
     SceneUpdate(G, true);
@@ -148,6 +143,7 @@ bool SceneRay(PyMOLGlobals * G,
   fov = SettingGetGlobal_f(G, cSetting_field_of_view);
 
   timing = UtilGetSeconds(G);   /* start timing the process */
+  I->LodStats = {};
 
   SceneUpdate(G, false);
 
@@ -381,9 +377,9 @@ bool SceneRay(PyMOLGlobals * G,
           I->CopyForced = true;
 
           if (SettingGet<bool>(G, cSetting_ray_volume) && !I->Image->empty()) {
-            rayVolumeImage = I->Image;
+            I->RayVolumeImage = I->Image;
           } else {
-            rayVolumeImage = nullptr;
+            I->RayVolumeImage = nullptr;
           }
         }
         break;
@@ -489,6 +485,8 @@ bool SceneRay(PyMOLGlobals * G,
         break;
 
       }
+      n_retained += ray->NRetained;
+      retained_seconds += ray->RetainedSeconds;
       RayFree(ray);
     }
     if(I->grid.active) {
@@ -715,13 +713,18 @@ bool SceneRay(PyMOLGlobals * G,
   }
   timing = UtilGetSeconds(G) - timing;
   if(mode != 2) {               /* don't show timings for tests */
-    accumTiming += timing;
+    I->RayAccumTiming += timing;
 
     if(show_timing && !quiet) {
       if(!G->Interrupt) {
         PRINTFB(G, FB_Ray, FB_Details)
           " Ray: render time: %4.2f sec. = %3.1f frames/hour (%4.2f sec. accum.).\n",
-          timing, 3600 / timing, accumTiming ENDFB(G);
+          timing, 3600 / timing, I->RayAccumTiming ENDFB(G);
+        if(n_retained) {
+          PRINTFB(G, FB_Ray, FB_Details)
+            " Ray: reused %d retained primitives, saved %4.2f sec.\n",
+            n_retained, retained_seconds ENDFB(G);
+        }
       } else {
         PRINTFB(G, FB_Ray, FB_Details)
           " Ray: render aborted.\n" ENDFB(G);
@@ -734,7 +737,7 @@ bool SceneRay(PyMOLGlobals * G,
   }
 
   /* EXPERIMENTAL VOLUME CODE */
-  if (rayVolume) {
+  if (I->RayVolume) {
     SceneUpdate(G, true);
   }
   OrthoBusyFast(G, 20, 20);
@@ -786,10 +789,10 @@ void SceneRenderRayVolume(PyMOLGlobals * G, CScene *I){
 #endif
   glDepthMask(GL_FALSE);
 #ifndef PURE_OPENGL_ES_2
-  if (PIsGlutThread() && rayVolumeImage) {
-    if (rayWidth == I->Width && rayHeight == I->Height){
-      glDrawPixels(rayVolumeImage->getWidth(), rayVolumeImage->getHeight(),
-          GL_RGBA, GL_UNSIGNED_BYTE, rayVolumeImage->bits());
+  if (PIsGlutThread() && I->RayVolumeImage) {
+    if (I->RayWidth == I->Width && I->RayHeight == I->Height){
+      glDrawPixels(I->RayVolumeImage->getWidth(), I->RayVolumeImage->getHeight(),
+          GL_RGBA, GL_UNSIGNED_BYTE, I->RayVolumeImage->bits());
     } else {
       SceneDrawImageOverlay(G, 1, nullptr);
     }
@@ -799,8 +802,8 @@ void SceneRenderRayVolume(PyMOLGlobals * G, CScene *I){
   glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
   glDepthFunc(GL_ALWAYS);
 #ifndef PURE_OPENGL_ES_2
-  if (PIsGlutThread() && rayWidth == I->Width && rayHeight == I->Height)
-    glDrawPixels(I->Width, I->Height, GL_DEPTH_COMPONENT, GL_FLOAT, rayDepthPixels); 
+  if (PIsGlutThread() && I->RayWidth == I->Width && I->RayHeight == I->Height)
+    glDrawPixels(I->Width, I->Height, GL_DEPTH_COMPONENT, GL_FLOAT, I->RayDepthPixels); 
 #endif
   glDepthFunc(GL_LESS);
   glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
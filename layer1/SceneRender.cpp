@@ -26,10 +26,6 @@
 #include "OpenVRMode.h"
 #endif
 
-/* EXPERIMENTAL VOLUME RAYTRACING DATA */
-extern float* rayDepthPixels;
-extern int rayVolume, rayWidth, rayHeight;
-
 static void SetDrawBufferForStereo(
     PyMOLGlobals* G, CScene* I, int stereo_mode, int times, int fog_active);
 static void SceneDrawStencilInBuffer(
@@ -423,6 +419,7 @@ void SceneRender(PyMOLGlobals* G, const SceneRenderInfo& renderInfo)
       /* STANDARD RENDERING */
 
       start_time = UtilGetSeconds(G);
+      I->LodStats = {};
 
       glEnable(GL_BLEND);
       glBlendFunc_default();
@@ -472,9 +469,9 @@ void SceneRender(PyMOLGlobals* G, const SceneRenderInfo& renderInfo)
       /*** THIS IS AN UGLY EXPERIMENTAL
        *** VOLUME + RAYTRACING COMPOSITION CODE
        ***/
-      if (rayVolume && rayDepthPixels) {
+      if (I->RayVolume && I->RayDepthPixels) {
         SceneRenderRayVolume(G, I);
-        rayVolume--;
+        I->RayVolume--;
       }
       /*** END OF EXPERIMENTAL CODE ***/
 
@@ -855,7 +852,7 @@ void SceneRenderAll(PyMOLGlobals* G, SceneUnitContext* context, float* normal,
           if (obj->type == cObjectGizmo && disregard_gizmo) {
             continue;
           }
-          if (!rayVolume || obj->type == cObjectVolume) {
+          if (!I->RayVolume || obj->type == cObjectVolume) {
             SceneRenderAllObject(
                 G, I, context, &info, normal, state, obj, grid, slot_vla, fat);
           }
@@ -864,7 +861,7 @@ void SceneRenderAll(PyMOLGlobals* G, SceneUnitContext* context, float* normal,
       case SceneRenderOrder::GadgetsLast:
         for (auto obj : I->NonGadgetObjs) {
           /* EXPERIMENTAL RAY-VOLUME COMPOSITION CODE */
-          if (!rayVolume || obj->type == cObjectVolume) {
+          if (!I->RayVolume || obj->type == cObjectVolume) {
             SceneRenderAllObject(
                 G, I, context, &info, normal, state, obj, grid, slot_vla, fat);
           }
@@ -547,6 +547,51 @@ int SettingUniquePrintAll(PyMOLGlobals * G, int src_unique_id)
   return ok;
 }
 
+/**
+ * Memory of the settings of one unique id (entries of its chain)
+ */
+std::size_t SettingUniqueGetMemorySize(PyMOLGlobals * G, int unique_id)
+{
+  CSettingUnique *I = G->SettingUnique;
+  auto offsetIt = I->id2offset.find(unique_id);
+  if (offsetIt == I->id2offset.end()) {
+    return 0;
+  }
+  std::size_t size = 0;
+  for (int offset = offsetIt->second; offset; offset = I->entry[offset].next) {
+    size += sizeof(SettingUniqueEntry);
+  }
+  return size;
+}
+
+/**
+ * Memory of the unique settings store, including unused entries
+ */
+std::size_t SettingUniqueGetStoreMemorySize(PyMOLGlobals * G)
+{
+  CSettingUnique *I = G->SettingUnique;
+  // approximate size of a hash map node
+  return I->entry.capacity() * sizeof(SettingUniqueEntry) +
+         I->id2offset.size() * (sizeof(std::pair<int, int>) + 2 * sizeof(void*));
+}
+
+/**
+ * Memory of a setting record, including string values
+ */
+std::size_t SettingGetMemorySize(const CSetting * I)
+{
+  if (!I) {
+    return 0;
+  }
+  std::size_t size = sizeof(CSetting);
+  for (int index = 0; index < cSetting_INIT; ++index) {
+    if (SettingInfo[index].type == cSetting_string && I->info[index].str_) {
+      size += sizeof(std::string) + I->info[index].str_->capacity();
+    }
+  }
+  return size;
+}
+
 int SettingUniqueCopyAll(PyMOLGlobals * G, int src_unique_id, int dst_unique_id)
 {
   int ok = true;
@@ -671,6 +716,7 @@ static bool is_session_blacklisted(int index) {
   case cSetting_suspend_updates:
   case cSetting_text:
   case cSetting_trilines:
+  case cSetting_undo_max_memory:
   case cSetting_use_geometry_shaders:
   case cSetting_use_shaders:
   case cSetting_pick32bit:
@@ -1885,6 +1931,9 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
     return;
   }
 
+  // settings are read while generating ray primitives
+  SceneInvalidateRetained(G);
+
   // range check for int (global only)
   if (rec.type == cSetting_int && rec.hasMinMax() && !(sele && sele[0])) {
     int value = SettingGetGlobal_i(G, index);
@@ -1919,7 +1968,6 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
     break;
   case cSetting_pickable:
     ExecutiveInvalidateRep(G, inv_sele, cRepAll, cRepInvAll);
-    SceneChanged(G);
     break;
   case cSetting_grid_mode:
     if (!SettingGetGlobal_i(G, cSetting_grid_mode))
@@ -2164,7 +2212,6 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
   case cSetting_gradient_min_slope:
   case cSetting_gradient_symmetry:
     ExecutiveInvalidateRep(G, inv_sele, cRepMesh, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_min_mesh_spacing:
   case cSetting_mesh_grid_max:
@@ -2181,7 +2228,6 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
   case cSetting_mesh_quality:
   case cSetting_mesh_skip:
     ExecutiveInvalidateRep(G, inv_sele, cRepMesh, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_valence:
   case cSetting_valence_mode:
@@ -2193,7 +2239,6 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
   case cSetting_hide_long_bonds:
     ExecutiveInvalidateRep(G, inv_sele, cRepLine, cRepInvRep);
     ExecutiveInvalidateRep(G, inv_sele, cRepCyl, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_stick_transparency:
   case cSetting_stick_debug:
@@ -2201,18 +2246,15 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
   case cSetting_stick_as_cylinders:
   case cSetting_stick_good_geometry:
     ExecutiveInvalidateRep(G, inv_sele, cRepCyl, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_line_use_shader:
     if (SettingGetGlobal_b(G, cSetting_use_shaders)){
       ExecutiveInvalidateRep(G, inv_sele, cRepRibbon, cRepInvRep);
-      SceneChanged(G);
     }
     break;
   case cSetting_ribbon_use_shader:
     if (SettingGetGlobal_b(G, cSetting_use_shaders)){
       ExecutiveInvalidateRep(G, inv_sele, cRepRibbon, cRepInvRep);
-      SceneChanged(G);
     }
     break;
   case cSetting_dot_as_spheres:
@@ -2222,18 +2264,15 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
   case cSetting_dot_use_shader:
     if (SettingGetGlobal_b(G, cSetting_use_shaders)){
       ExecutiveInvalidateRep(G, inv_sele, cRepDot, cRepInvRep);
-      SceneChanged(G);
     }
     break;
   case cSetting_nonbonded_use_shader:
     if (SettingGetGlobal_b(G, cSetting_use_shaders)){
       ExecutiveInvalidateRep(G, inv_sele, cRepNonbonded, cRepInvRep);
-      SceneChanged(G);
     }
     break;
   case cSetting_nb_spheres_size:
     ExecutiveInvalidateRep(G, inv_sele, cRepNonbondedSphere, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_nb_spheres_use_shader:
     if (SettingGetGlobal_b(G, cSetting_use_shaders)){
@@ -2286,12 +2325,10 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
   case cSetting_slice_dynamic_grid:
   case cSetting_slice_dynamic_grid_resolution:
     ExecutiveInvalidateRep(G, inv_sele, cRepSlice, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_label_font_id:
   case cSetting_label_size:
     ExecutiveInvalidateRep(G, inv_sele, cRepLabel, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_retain_order:
   case cSetting_pdb_hetatm_sort:
@@ -2347,18 +2384,15 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
   case cSetting_stick_h_scale:
     ExecutiveInvalidateRep(G, inv_sele, cRepCyl, cRepInvRep);
     ExecutiveInvalidateRep(G, inv_sele, cRepCartoon, cRepInvRep);       /* base width */
-    SceneChanged(G);
     break;
   case cSetting_nb_spheres_quality:
     {
       ExecutiveInvalidateRep(G, inv_sele, cRepNonbondedSphere, cRepInvRep);
-      SceneChanged(G);
     }
   case cSetting_cgo_sphere_quality:
   case cSetting_cgo_debug:
     {
       ExecutiveInvalidateRep(G, inv_sele, cRepCGO, cRepInvRep);
-      SceneChanged(G);
       break;
     }
   case cSetting_stick_quality:
@@ -2372,27 +2406,22 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
   case cSetting_stick_color:
   case cSetting_stick_use_shader:
     ExecutiveInvalidateRep(G, inv_sele, cRepCyl, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_clamp_colors:
   case cSetting_ramp_blend_nearby_colors:
     ExecutiveInvalidateRep(G, inv_sele, cRepAll, cRepInvColor);
-    SceneChanged(G);
     break;
   case cSetting_label_color:
   case cSetting_label_outline_color:
   case cSetting_label_position:
     ExecutiveRebuildAllObjectDist(G);
     ExecutiveInvalidateRep(G, inv_sele, cRepLabel, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_cartoon_color:
     ExecutiveInvalidateRep(G, inv_sele, cRepCartoon, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_ribbon_color:
     ExecutiveInvalidateRep(G, inv_sele, cRepRibbon, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_cgo_line_width:
   case cSetting_line_width:    
@@ -2417,7 +2446,6 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
   case cSetting_line_radius:
     ExecutiveInvalidateRep(G, inv_sele, cRepLine, cRepInvRep);
     ExecutiveInvalidateRep(G, inv_sele, cRepNonbonded, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_scenes_changed:
     {
@@ -2439,29 +2467,24 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
     break;
   case cSetting_mesh_width:
     ExecutiveInvalidateRep(G, inv_sele, cRepMesh, cRepInvColor);
-    SceneChanged(G);
     break;
   case cSetting_ellipsoid_probability:
   case cSetting_ellipsoid_scale:
   case cSetting_ellipsoid_color:
   case cSetting_ellipsoid_transparency:
     ExecutiveInvalidateRep(G, inv_sele, cRepEllipsoid, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_ellipsoid_quality:
   case cSetting_cgo_ellipsoid_quality:
     ExecutiveInvalidateRep(G, inv_sele, cRepCGO, cRepInvRep);
     ExecutiveInvalidateRep(G, inv_sele, cRepEllipsoid, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_mesh_color:
   case cSetting_mesh_negative_color:
     ExecutiveInvalidateRep(G, inv_sele, cRepMesh, cRepInvColor);
-    SceneChanged(G);
     break;
   case cSetting_ray_color_ramps:
     ExecutiveInvalidateRep(G, inv_sele, cRepAll, cRepInvColor);
-    SceneChanged(G);
     break;
   case cSetting_sphere_mode:
 #ifndef _PYMOL_IP_EXTRAS
@@ -2491,17 +2514,14 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
     ExecutiveInvalidateRep(G, inv_sele, cRepCyl, cRepInvRep);
     ExecutiveInvalidateRep(G, inv_sele, cRepNonbondedSphere, cRepInvRep);
     ExecutiveInvalidateRep(G, inv_sele, cRepSphere, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_nonbonded_size:
   case cSetting_nonbonded_transparency:
     ExecutiveInvalidateRep(G, inv_sele, cRepNonbonded, cRepInvRep);
     ExecutiveInvalidateRep(G, inv_sele, cRepNonbondedSphere, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_mesh_radius:
     ExecutiveInvalidateRep(G, inv_sele, cRepMesh, cRepInvColor);
-    SceneChanged(G);
     break;
   case cSetting_ambient_occlusion_scale:
     SceneChanged(G);
@@ -2530,15 +2550,12 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
   case cSetting_surface_ramp_above_mode:
   case cSetting_transparency:
     ExecutiveInvalidateRep(G, inv_sele, cRepSurface, cRepInvColor);
-    SceneChanged(G);
     break;
   case cSetting_dot_color:
     ExecutiveInvalidateRep(G, inv_sele, cRepDot, cRepInvColor);
-    SceneChanged(G);
     break;
   case cSetting_sphere_color:
     ExecutiveInvalidateRep(G, inv_sele, cRepSphere, cRepInvColor);
-    SceneChanged(G);
     break;
 
   case cSetting_surface_quality:
@@ -2563,7 +2580,6 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
   case cSetting_cavity_cull:
   case cSetting_surface_smooth_edges:
     ExecutiveInvalidateRep(G, inv_sele, cRepSurface, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_surface_use_shader:
     SceneChanged(G);
@@ -2571,22 +2587,18 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
   case cSetting_isosurface_algorithm:
   case cSetting_surface_negative_visible:
     ExecutiveInvalidateRep(G, inv_sele, cRepSurface, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_mesh_negative_visible:
     ExecutiveInvalidateRep(G, inv_sele, cRepMesh, cRepInvAll);
-    SceneChanged(G);
     break;
   case cSetting_solvent_radius:
     ExecutiveInvalidateRep(G, inv_sele, cRepSurface, cRepInvRep);
     ExecutiveInvalidateRep(G, inv_sele, cRepMesh, cRepInvRep);
     ExecutiveInvalidateRep(G, inv_sele, cRepDot, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_trace_atoms_mode:
     ExecutiveInvalidateRep(G, inv_sele, cRepRibbon, cRepInvRep);
     ExecutiveInvalidateRep(G, inv_sele, cRepCartoon, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_ribbon_smooth:
   case cSetting_ribbon_power:
@@ -2598,7 +2610,6 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
   case cSetting_ribbon_trace_atoms:
   case cSetting_ribbon_transparency:
     ExecutiveInvalidateRep(G, inv_sele, cRepRibbon, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_draw_mode:
     ExecutiveInvalidateRep(G, inv_sele, cRepCyl, cRepInvRep);
@@ -2611,7 +2622,6 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
     ExecutiveInvalidateRep(G, inv_sele, cRepCyl, cRepInvRep);
     ExecutiveInvalidateRep(G, inv_sele, cRepSphere, cRepInvRep);
     ExecutiveInvalidateRep(G, inv_sele, cRepEllipsoid, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_ribbon_side_chain_helper:
   case cSetting_ribbon_nucleic_acid_mode:
@@ -2620,7 +2630,6 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
     ExecutiveInvalidateRep(G, inv_sele, cRepCyl, cRepInvRep);
     ExecutiveInvalidateRep(G, inv_sele, cRepSphere, cRepInvRep);
     ExecutiveInvalidateRep(G, inv_sele, cRepEllipsoid, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_ray_trace_mode:        /* affects loop quality */
     G->ShaderMgr->Set_Reload_Bits(RELOAD_VARIABLES);
@@ -2683,24 +2692,20 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
   case cSetting_cartoon_gap_cutoff:
   case cSetting_cartoon_all_alt:
     ExecutiveInvalidateRep(G, inv_sele, cRepCartoon, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_cartoon_use_shader:
     if (SettingGetGlobal_b(G, cSetting_use_shaders)){
       ExecutiveInvalidateRep(G, inv_sele, cRepCartoon, cRepInvRep);
-      SceneChanged(G);
     }
     break;
   case cSetting_cgo_use_shader:
     if (SettingGetGlobal_b(G, cSetting_use_shaders)){
       ExecutiveInvalidateRep(G, inv_sele, cRepCGO, cRepInvRep);
-      SceneChanged(G);
     }
     break;
   case cSetting_cgo_shader_ub_flags:
     if (SettingGetGlobal_b(G, cSetting_use_shaders) && SettingGetGlobal_b(G, cSetting_cgo_use_shader)){
       ExecutiveInvalidateRep(G, inv_sele, cRepSphere, cRepInvRep);
-      SceneChanged(G);
     }
     break;
   case cSetting_cgo_shader_ub_color:
@@ -2708,7 +2713,6 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
       ExecutiveInvalidateRep(G, inv_sele, cRepCGO, cRepInvRep);
       ExecutiveInvalidateRep(G, inv_sele, cRepCartoon, cRepInvRep);
       ExecutiveInvalidateRep(G, inv_sele, cRepSphere, cRepInvRep);
-      SceneChanged(G);
     }
     break;
   case cSetting_cgo_shader_ub_normal:
@@ -2719,7 +2723,6 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
       // this should really only invalidate spheres that use normals (sphere_mode=0, not sure about other modes)
       // but invalidating all spheres for now
       ExecutiveInvalidateRep(G, inv_sele, cRepSphere, cRepInvRep); 
-      SceneChanged(G);
     }
     break;
   case cSetting_trilines:
@@ -2729,11 +2732,9 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
      ExecutiveInvalidateRep(G, inv_sele, cRepCartoon, cRepInvRep);
      ExecutiveInvalidateRep(G, inv_sele, cRepDash, cRepInvRep);
      ExecutiveInvalidateRep(G, inv_sele, cRepNonbonded, cRepInvRep);
-     SceneChanged(G);
      break;
   case cSetting_cell_centered:
      ExecutiveInvalidateRep(G, inv_sele, cRepCell, cRepInvRep);
-     SceneChanged(G);
      break;
   case cSetting_dot_width:
   case cSetting_dot_radius:
@@ -2743,7 +2744,6 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
   case cSetting_dot_hydrogens:
   case cSetting_trim_dots:
     ExecutiveInvalidateRep(G, inv_sele, cRepDot, cRepInvRep);
-    SceneChanged(G);
     break;
   case cSetting_bg_gradient:
       ColorUpdateFrontFromSettings(G);
@@ -2917,7 +2917,6 @@ void SettingGenerateSideEffects(PyMOLGlobals * G, int index, const char *sele, i
   case cSetting_surface_color_smoothing:
   case cSetting_surface_color_smoothing_threshold:
     ExecutiveInvalidateRep(G, inv_sele, cRepSurface, cRepInvColor);    
-    SceneChanged(G);
     break;
   case cSetting_smooth_half_bonds:
     SceneChanged(G);
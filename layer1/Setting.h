@@ -157,6 +157,11 @@ int SettingUniqueFromPyList(PyMOLGlobals * G, PyObject * list, int partial_resto
 int SettingUniqueConvertOldSessionID(PyMOLGlobals * G, int old_unique_id);
 
 int SettingUniqueCopyAll(PyMOLGlobals * G, int src_unique_id, int dst_unique_id);
+
+/* memory accounting (bytes) */
+std::size_t SettingUniqueGetMemorySize(PyMOLGlobals * G, int unique_id);
+std::size_t SettingUniqueGetStoreMemorySize(PyMOLGlobals * G);
+std::size_t SettingGetMemorySize(const CSetting * I);
 void SettingInitGlobal(PyMOLGlobals * G, int alloc, int reset_gui, int use_default);
 void SettingStoreDefault(PyMOLGlobals * G);
 void SettingPurgeDefault(PyMOLGlobals * G);
@@ -905,6 +905,12 @@ enum {
   REC_f( 795, salt_bridge_distance                        , global    , 5.0f ),
   REC_b( 796, use_tessellation_shaders                , global    , true ),
   REC_c( 797, cell_color                              , ostate    , "-1" ),
+  REC_f( 798, undo_max_memory                         , global    , 64.0f ),
+  REC_i( 799, pick_method                             , global    , 0, 0, 1 ),
+  REC_b( 800, level_of_detail                         , global    , false ),
+  REC_f( 801, level_of_detail_pixels                  , global    , 4.0f ), // pixels per Angstrom below which detail is reduced
+  REC_b( 802, ray_retain_primitives                   , global    , false ), // reuse camera independent ray primitives
+  REC_i( 803, movie_workers                           , global    , 0 ), // forked processes for ray traced movie export (Linux)
 
 #ifdef SETTINGINFO_IMPLEMENTATION
 #undef SETTINGINFO_IMPLEMENTATION
@@ -65,6 +65,8 @@ struct CText {
   bool Flat = false;
   bool IsPicking = false;
 
+  pymol::LabelLayoutCache* LayoutCache = nullptr;
+
 private:
   std::vector<std::unique_ptr<CFont>> m_fonts;
 
@@ -107,6 +109,16 @@ void TextSetLabelBkgrdInfo(PyMOLGlobals * G, float label_spacing, float label_ju
   }
 }
 
+void TextSetLayoutCache(PyMOLGlobals * G, pymol::LabelLayoutCache * cache)
+{
+  G->Text->LayoutCache = cache;
+}
+
+pymol::LabelLayoutCache *TextGetLayoutCache(PyMOLGlobals * G)
+{
+  return G->Text->LayoutCache;
+}
+
 void TextSetIsPicking(PyMOLGlobals * G, bool IsPicking)
 {
   CText *I = G->Text;
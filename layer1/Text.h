@@ -20,6 +20,11 @@ Z* -------------------------------------------------------------------
 #include"PyMOLGlobals.h"
 #include"Base.h"
 
+namespace pymol
+{
+class LabelLayoutCache;
+}
+
 
 /* Here are the issues:
 
@@ -127,6 +132,10 @@ float TextGetSpacing(PyMOLGlobals * G);
 float TextGetJustification(PyMOLGlobals * G);
 float *TextGetLabelBuffer(PyMOLGlobals * G);
 
+/* label layouts of the representation which is being ray traced, or nullptr */
+void TextSetLayoutCache(PyMOLGlobals * G, pymol::LabelLayoutCache * cache);
+pymol::LabelLayoutCache *TextGetLayoutCache(PyMOLGlobals * G);
+
 void TextSetIsPicking(PyMOLGlobals * G, bool IsPicking);
 bool TextGetIsPicking(PyMOLGlobals * G);
 
@@ -39,6 +39,7 @@ Z* -------------------------------------------------------------------
 #include "pymol/zstring_view.h"
 
 #include <map>
+#include <tuple>
 #include <unordered_set>
 
 struct CAtomInfo {
@@ -2024,6 +2025,206 @@ int AtomInfoCompareIgnoreHet(PyMOLGlobals * G, const AtomInfoType * at1, const A
   return AtomInfoCompare(G, at1, at2, true, false);
 }
 
+namespace
+{
+/**
+ * Dense ranks of the distinct strings of a lexicon field, in the order of a
+ * string comparison function (strings which compare equal share a rank)
+ */
+class LexFieldRanks
+{
+  std::vector<unsigned> m_rank; // lexidx -> rank
+  unsigned m_max = 0;
+
+public:
+  template <typename Compare>
+  LexFieldRanks(const AtomInfoType* rec, int n, lexidx_t AtomInfoType::*field,
+      Compare compare)
+  {
+    lexidx_t max_id = 0;
+    for (int i = 0; i < n; ++i)
+      max_id = std::max(max_id, rec[i].*field);
+
+    std::vector<bool> used(max_id + 1);
+    for (int i = 0; i < n; ++i)
+      used[rec[i].*field] = true;
+
+    std::vector<lexidx_t> ids;
+    for (lexidx_t id = 0; id <= max_id; ++id) {
+      if (used[id])
+        ids.push_back(id);
+    }
+
+    std::sort(ids.begin(), ids.end(), [&](lexidx_t a, lexidx_t b) {
+      return compare(a, b) < 0;
+    });
+
+    m_rank.resize(max_id + 1);
+    for (size_t k = 1; k < ids.size(); ++k) {
+      if (compare(ids[k - 1], ids[k]) != 0)
+        ++m_max;
+      m_rank[ids[k]] = m_max;
+    }
+  }
+
+  unsigned operator()(lexidx_t id) const { return m_rank[id]; }
+  unsigned max() const { return m_max; }
+};
+
+/// Number of bits needed for values up to `max`
+int bits_for(std::uint64_t max)
+{
+  int n = 0;
+  for (; max; max >>= 1)
+    ++n;
+  return n;
+}
+} // namespace
+
+/**
+ * Packed integer sort keys, which order atoms like AtomInfoCompare (with
+ * rank, optionally ignoring hetatm). String fields are replaced by their
+ * rank among the distinct strings, so comparing atoms doesn't touch the
+ * lexicon.
+ *
+ * Where AtomInfoCompare isn't a consistent ordering, the keys pick one:
+ * - rank_assisted_sorts: residues with different insertion codes are
+ *   ordered by the lowest rank of their atoms
+ * - "bulk" het groups (resv 0) are ordered by rank also when compared with
+ *   non-het atoms of the same residue (only with ignore_hetatm)
+ *
+ * @param ignore_hetatm Don't sort het atoms after polymer atoms
+ * @param rank_first Order by rank first (retain_order)
+ * @param[out] nbits Number of used key bits, 0 if the fields need more than
+ * 128 bits (use AtomInfoCompare then)
+ */
+std::vector<pymol::SortKey> AtomInfoGetSortKeys(PyMOLGlobals* G,
+    const AtomInfoType* rec, int n, bool ignore_hetatm, bool rank_first,
+    int* nbits)
+{
+  std::vector<pymol::SortKey> keys;
+  *nbits = 0;
+
+  if (n < 1)
+    return keys;
+
+  LexFieldRanks const segi_rank(rec, n, &AtomInfoType::segi,
+      [G](lexidx_t a, lexidx_t b) { return WordCompare(G, a, b, false); });
+  LexFieldRanks const chain_rank(rec, n, &AtomInfoType::chain,
+      [G](lexidx_t a, lexidx_t b) { return WordCompare(G, a, b, false); });
+  LexFieldRanks const resn_rank(rec, n, &AtomInfoType::resn,
+      [G](lexidx_t a, lexidx_t b) { return WordCompare(G, a, b, true); });
+  LexFieldRanks const name_rank(rec, n, &AtomInfoType::name,
+      [G](lexidx_t a, lexidx_t b) { return AtomInfoNameCompare(G, a, b); });
+
+  int min_resv = rec[0].resv, max_resv = rec[0].resv;
+  int min_rank = rec[0].rank, max_rank = rec[0].rank;
+  int min_state = rec[0].discrete_state, max_state = rec[0].discrete_state;
+  int min_priority = rec[0].priority, max_priority = rec[0].priority;
+  int min_alt = rec[0].alt[0], max_alt = rec[0].alt[0];
+  bool any_inscode = false;
+
+  for (int i = 0; i < n; ++i) {
+    auto const& ai = rec[i];
+    min_resv = std::min(min_resv, ai.resv);
+    max_resv = std::max(max_resv, ai.resv);
+    min_rank = std::min(min_rank, ai.rank);
+    max_rank = std::max(max_rank, ai.rank);
+    min_state = std::min(min_state, ai.discrete_state);
+    max_state = std::max(max_state, ai.discrete_state);
+    min_priority = std::min(min_priority, ai.priority);
+    max_priority = std::max(max_priority, ai.priority);
+    min_alt = std::min(min_alt, int(ai.alt[0]));
+    max_alt = std::max(max_alt, int(ai.alt[0]));
+    any_inscode = any_inscode || ai.inscode;
+  }
+
+  // insertion code field
+  bool const insertions_go_first =
+      SettingGetGlobal_b(G, cSetting_pdb_insertions_go_first);
+  bool const rank_assisted =
+      any_inscode && !insertions_go_first &&
+      SettingGetGlobal_b(G, cSetting_rank_assisted_sorts);
+
+  std::vector<unsigned> inscode_key(n);
+  unsigned max_inscode_key = 0;
+
+  if (rank_assisted) {
+    // lowest rank per residue
+    std::map<std::tuple<unsigned, unsigned, bool, int, char>, int> first_rank;
+    auto residue = [&](const AtomInfoType& ai) {
+      return std::make_tuple(segi_rank(ai.segi), chain_rank(ai.chain),
+          !ignore_hetatm && ai.hetatm, ai.resv, getInscodeUpper(&ai));
+    };
+    for (int i = 0; i < n; ++i) {
+      auto it = first_rank.emplace(residue(rec[i]), rec[i].rank).first;
+      it->second = std::min(it->second, rec[i].rank);
+    }
+    for (int i = 0; i < n; ++i) {
+      inscode_key[i] = unsigned(first_rank[residue(rec[i])] - min_rank);
+    }
+    max_inscode_key = unsigned(max_rank - min_rank);
+  } else if (any_inscode) {
+    for (int i = 0; i < n; ++i) {
+      signed char const c = getInscodeUpper(rec + i);
+      inscode_key[i] = (insertions_go_first && !rec[i].inscode)
+                           ? 0x100
+                           : unsigned(int(c) + 0x80);
+    }
+    max_inscode_key = 0x100;
+  }
+
+  int const bits_rank = bits_for(unsigned(max_rank - min_rank));
+  int const bits_segi = bits_for(segi_rank.max());
+  int const bits_chain = bits_for(chain_rank.max());
+  int const bits_hetatm = ignore_hetatm ? 0 : 1;
+  int const bits_resv = bits_for(unsigned(max_resv - min_resv));
+  int const bits_inscode = bits_for(max_inscode_key);
+  int const bits_resn = bits_for(resn_rank.max());
+  int const bits_state = bits_for(unsigned(max_state - min_state));
+  int const bits_priority = bits_for(unsigned(max_priority - min_priority));
+  int const bits_name = bits_for(name_rank.max());
+  int const bits_alt = bits_for(unsigned(max_alt - min_alt));
+
+  int const total = (rank_first ? 2 : 1) * bits_rank + bits_segi +
+                    bits_chain + bits_hetatm + bits_resv + bits_inscode +
+                    bits_resn + bits_state + bits_priority + bits_name +
+                    bits_alt;
+
+  if (total > 128)
+    return keys;
+
+  keys.resize(n);
+
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for if (n > 10000)
+#endif
+  for (int i = 0; i < n; ++i) {
+    auto const& ai = rec[i];
+    auto& key = keys[i];
+
+    // "bulk" het group with no residue number: order by rank
+    bool const bulk = !ai.resv && ai.hetatm;
+
+    if (rank_first)
+      key.push(unsigned(ai.rank - min_rank), bits_rank);
+    key.push(segi_rank(ai.segi), bits_segi);
+    key.push(chain_rank(ai.chain), bits_chain);
+    key.push(ai.hetatm ? 1 : 0, bits_hetatm);
+    key.push(unsigned(ai.resv - min_resv), bits_resv);
+    key.push(inscode_key[i], bits_inscode);
+    key.push(resn_rank(ai.resn), bits_resn);
+    key.push(unsigned(ai.discrete_state - min_state), bits_state);
+    key.push(bulk ? 0 : unsigned(ai.priority - min_priority), bits_priority);
+    key.push(bulk ? 0 : name_rank(ai.name), bits_name);
+    key.push(bulk ? 0 : unsigned(ai.alt[0] - min_alt), bits_alt);
+    key.push(unsigned(ai.rank - min_rank), bits_rank);
+  }
+
+  *nbits = std::max(total, 1);
+  return keys;
+}
+
 /**
  * Function only used for matching atoms of two aligned residues.
  *
@@ -2286,15 +2487,17 @@ int AtomInfoGetExpectedValence(PyMOLGlobals * G, const AtomInfoType * I)
 static int get_protons(const char * symbol)
 {
   char titleized[4];
-  static std::map<pymol::zstring_view, int> lookup;
 
-  if (lookup.empty()) {
+  // built once, shared by all instances (thread-safe initialization)
+  static const std::map<pymol::zstring_view, int> lookup = [] {
+    std::map<pymol::zstring_view, int> lookup;
     for (int i = 0; i < ElementTableSize; i++)
       lookup[ElementTable[i].symbol] = i;
 
     lookup["Q"] = cAN_H;
     lookup["D"] = cAN_H;
-  }
+    return lookup;
+  }();
 
   // check second letter for lower case
   if (symbol[0] && isupper(symbol[1]) && strcmp(symbol, "LP") != 0) {
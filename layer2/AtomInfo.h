@@ -23,6 +23,7 @@ Z* -------------------------------------------------------------------
 #include"Setting.h"
 #include"SymOp.h"
 #include"Version.h"
+#include "RadixSort.h"
 
 #if _PyMOL_VERSION_int < 1770
 #define AtomInfoVERSION  176
@@ -416,6 +417,9 @@ int AtomInfoCompareIgnoreRank(PyMOLGlobals * G, const AtomInfoType * at1, const
 int AtomInfoCompareIgnoreHet(PyMOLGlobals * G, const AtomInfoType * at1, const AtomInfoType * at2);
 int AtomInfoCompareIgnoreRankHet(PyMOLGlobals * G, const AtomInfoType * at1,
                                  const AtomInfoType * at2);
+std::vector<pymol::SortKey> AtomInfoGetSortKeys(PyMOLGlobals* G,
+    const AtomInfoType* rec, int n, bool ignore_hetatm, bool rank_first,
+    int* nbits);
 float AtomInfoGetBondLength(PyMOLGlobals * G, const AtomInfoType * ai1, const AtomInfoType * ai2);
 int AtomInfoSameResidue(PyMOLGlobals * G, const AtomInfoType * at1, const AtomInfoType * at2);
 int AtomInfoSameResidueP(PyMOLGlobals * G, const AtomInfoType * at1, const AtomInfoType * at2);
@@ -12,6 +12,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <iostream>
 #include <numeric>
 #include <string>
@@ -23,6 +24,10 @@
 #include "MemoryDebug.h"
 #include "strcasecmp.h"
 
+#ifdef PYMOL_OPENMP
+#include <omp.h>
+#endif
+
 #if !defined(_PYMOL_NO_MSGPACKC)
 #include <msgpack.hpp>
 #endif
@@ -35,12 +40,69 @@ template <> std::string raw_to_typed(const char* s) { return s; }
 template <> char        raw_to_typed(const char* s) { return s[0]; }
 template <> int         raw_to_typed(const char* s) { return atoi(s); }
 
+/**
+ * Fast path for plain decimal numbers with at most 15 significant digits
+ * and a small exponent, which convert exactly (Clinger's fast path).
+ * @return False if `s` needs the general conversion
+ */
+static bool fast_atof(const char* s, double& out)
+{
+  static const double pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+      1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19,
+      1e20, 1e21, 1e22};
+
+  const char* p = s;
+  bool neg = false;
+  if (*p == '-' || *p == '+')
+    neg = (*p++ == '-');
+
+  std::uint64_t mantissa = 0;
+  int ndigits = 0, exp10 = 0;
+
+  for (; *p >= '0' && *p <= '9'; ++p, ++ndigits)
+    mantissa = mantissa * 10 + (*p - '0');
+
+  if (*p == '.') {
+    for (++p; *p >= '0' && *p <= '9'; ++p, ++ndigits, --exp10)
+      mantissa = mantissa * 10 + (*p - '0');
+  }
+
+  if (ndigits == 0 || ndigits > 15)
+    return false;
+
+  if (*p == 'e' || *p == 'E') {
+    ++p;
+    bool eneg = false;
+    if (*p == '-' || *p == '+')
+      eneg = (*p++ == '-');
+    int e = 0, edigits = 0;
+    for (; *p >= '0' && *p <= '9' && edigits < 4; ++p, ++edigits)
+      e = e * 10 + (*p - '0');
+    if (edigits == 0)
+      return false;
+    exp10 += eneg ? -e : e;
+  }
+
+  if (*p || exp10 < -22 || exp10 > 22)
+    return false;
+
+  double v = double(mantissa);
+  v = (exp10 < 0) ? v / pow10[-exp10] : v * pow10[exp10];
+  out = neg ? -v : v;
+  return true;
+}
+
 /**
  * Convert to floating point number, ignores uncertainty notation
  * 1.23(45)e2 -> 1.23e2
  */
 template <> double raw_to_typed(const char* s)
 {
+  double v;
+  if (fast_atof(s, v)) {
+    return v;
+  }
+
   const char *close, *open = strchr(s, '(');
   if (open && (close = strchr(open, ')'))) {
     return atof(std::string(s, open - s).append(close + 1).c_str());
@@ -55,6 +117,26 @@ template <> float raw_to_typed(const char* s)
 
 } // namespace _cif_detail
 
+template <typename T>
+std::vector<T> cif_array::to_vector_n(unsigned n, T d) const
+{
+  std::vector<T> v(n);
+  int const n_arr = std::min(n, size());
+
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for schedule(static) if (n_arr > 10000)
+#endif
+  for (int i = 0; i < n_arr; ++i)
+    v[i] = as<T>(i, d);
+
+  std::fill(v.begin() + n_arr, v.end(), d);
+  return v;
+}
+
+template std::vector<int> cif_array::to_vector_n(unsigned, int) const;
+template std::vector<float> cif_array::to_vector_n(unsigned, float) const;
+template std::vector<double> cif_array::to_vector_n(unsigned, double) const;
+
 // basic IO and string handling
 
 // Return true if "c" is whitespace or null
@@ -288,57 +370,84 @@ cif_file& cif_file::operator=(cif_file&&) = default;
 // destructor
 cif_file::~cif_file() = default;
 
-bool cif_file::parse(char*&& p) {
-  m_datablocks.clear();
-  m_tokens.clear();
-  m_contents.reset(p);
+/**
+ * Tokens of a text range. The null-terminators are written after the
+ * tokenization (see cif_token_chunk::terminate()), so that a failed attempt
+ * to tokenize a chunk leaves the buffer untouched.
+ */
+struct cif_token_chunk {
+  std::vector<char*> tokens;
+  std::vector<char*> ends; // null-terminator position or nullptr
+  std::vector<bool> keypossible;
 
-  if (!p) {
-    error("parse(nullptr)");
-    return false;
+  void push(char* token, char* end, bool key) {
+    tokens.push_back(token);
+    ends.push_back(end);
+    keypossible.push_back(key);
   }
 
-  auto& tokens = m_tokens;
-  char quote;
-  char prev = '\0';
+  void terminate() const {
+    for (char* end : ends) {
+      if (end)
+        *end = 0;
+    }
+  }
+};
 
-  std::vector<bool> keypossible;
+/**
+ * Tokenize the range [p, end). `end` must be the end of the buffer or the
+ * start of a line which is not inside a text field.
+ *
+ * @param prev Character before `p` (null at the start of the buffer)
+ * @param bounded True for a chunk of a parallel tokenization: Fail if a
+ * quoted string spans lines or if a text field doesn't end within the range
+ * @return False if `bounded` and the range can't be tokenized on its own
+ */
+static bool cif_tokenize_range(
+    char* p, const char* end, char prev, bool bounded, cif_token_chunk& out)
+{
+  char quote;
 
-  // tokenize
   while (true) {
-    while (iswhitespace(*p))
+    while (p != end && iswhitespace(*p))
       prev = *(p++);
 
-    if (!*p)
+    if (p == end || !*p)
       break;
 
     if (*p == '#') {
       while (!(islinefeed0(*++p)));
       prev = *p;
-    } else if (isquote(*p)) { // will nullptr the closing quote
+    } else if (isquote(*p)) {
       quote = *p;
-      keypossible.push_back(false);
-      tokens.push_back(p + 1);
-      while (*++p && !(*p == quote && iswhitespace0(p[1])));
+      char* token = p + 1;
+      while (*++p && !(*p == quote && iswhitespace0(p[1]))) {
+        if (bounded && islinefeed(*p))
+          return false;
+      }
+      out.push(token, *p ? p : nullptr, false);
       if (*p)
-        *(p++) = 0;
+        ++p;
       prev = *p;
     } else if (*p == ';' && islinefeed(prev)) {
       // multi-line tokens start with ";" and end with "\n;"
       // multi-line tokens cannot be keys, only values.
-      keypossible.push_back(false);
-      tokens.push_back(p + 1);
+      char* token = p + 1;
       // advance until `\n;`
       while (*++p && !(islinefeed(*p) && p[1] == ';'));
+      if (bounded && (*p ? (p + 1 >= end) : (p != end)))
+        return false;
       // step to next line and null the line feed
+      char* term = nullptr;
       if (*p) {
-        *p = 0;
+        term = p;
         // \r\n on Windows)
-        if (p - 1 > tokens.back() && *(p - 1) == '\r') {
-          *(p - 1) = 0;
+        if (p - 1 > token && *(p - 1) == '\r') {
+          term = p - 1;
         }
         p += 2;
       }
+      out.push(token, term, false);
       prev = ';';
     } else { // will null the whitespace
       char * q = p++;
@@ -346,16 +455,155 @@ bool cif_file::parse(char*&& p) {
       prev = *p;
       if (p - q == 1 && (*q == '?' || *q == '.')) {
         // store values '.' (inapplicable) and '?' (unknown) as null-pointers
-        q = nullptr;
-        keypossible.push_back(false);
+        out.push(nullptr, nullptr, false);
       } else {
+        out.push(q, *p ? p : nullptr, true);
         if (*p)
-          *(p++) = 0;
-        keypossible.push_back(true);
+          ++p;
+      }
+    }
+  }
+
+  return true;
+}
+
+#ifdef PYMOL_OPENMP
+// files smaller than this are tokenized serially
+#define CIF_PARALLEL_MIN_SIZE (4 << 20)
+
+/**
+ * Split [begin, end) into chunks at line starts which are not inside a
+ * text field (a text field is open after an odd number of lines which start
+ * with ";").
+ *
+ * @return Chunk start positions, the first one is `begin`
+ */
+static std::vector<char*> cif_chunk_starts(char* begin, char* end, int n_chunks)
+{
+  std::vector<char*> starts = {begin};
+  std::size_t const len = end - begin;
+
+  for (int k = 1; k < n_chunks; ++k) {
+    char* q = begin + len * k / n_chunks;
+    if (q <= starts.back())
+      continue;
+    q = static_cast<char*>(memchr(q - 1, '\n', end - (q - 1)));
+    if (!q || ++q >= end)
+      break;
+    if (q > starts.back())
+      starts.push_back(q);
+  }
+
+  int const n = starts.size();
+  std::vector<int> parity(n + 1, 0);
+
+  // count text field delimiters per chunk
+#pragma omp parallel for schedule(static)
+  for (int k = 0; k < n; ++k) {
+    char* q = std::max(starts[k], begin + 1);
+    const char* q_end = (k + 1 < n) ? starts[k + 1] : end;
+    int count = 0;
+    for (; q < q_end; ++q) {
+      if (*q == ';' && islinefeed(q[-1]))
+        ++count;
+    }
+    parity[k + 1] = count & 1;
+  }
+
+  std::vector<char*> result = {begin};
+  int open = 0;
+
+  for (int k = 1; k < n; ++k) {
+    open ^= parity[k];
+    char* q = starts[k];
+
+    if (open) {
+      // move past the end of the text field
+      while (q < end && !(*q == ';' && islinefeed(q[-1])))
+        ++q;
+      q = (q < end) ? static_cast<char*>(memchr(q, '\n', end - q)) : nullptr;
+      if (!q || ++q >= end)
+        break;
+    }
+
+    if (q > result.back())
+      result.push_back(q);
+  }
+
+  return result;
+}
+#endif
+
+/**
+ * Tokenize a CIF string in place (null-terminates the tokens). Large
+ * strings are split into chunks and tokenized in parallel.
+ */
+static void cif_tokenize(char* p, std::vector<char*>& tokens,
+    std::vector<bool>& keypossible)
+{
+  tokens.clear();
+  keypossible.clear();
+
+#ifdef PYMOL_OPENMP
+  std::size_t const len = strlen(p);
+  int const n_threads = omp_get_max_threads();
+
+  if (len >= CIF_PARALLEL_MIN_SIZE && n_threads > 1) {
+    auto starts = cif_chunk_starts(p, p + len, n_threads * 4);
+    int const n = starts.size();
+    std::vector<cif_token_chunk> chunks(n);
+    int ok = true;
+
+#pragma omp parallel for schedule(dynamic, 1) reduction(&&:ok)
+    for (int k = 0; k < n; ++k) {
+      char* end = (k + 1 < n) ? starts[k + 1] : p + len;
+      char prev = (starts[k] == p) ? '\0' : starts[k][-1];
+      ok = cif_tokenize_range(starts[k], end, prev, true, chunks[k]) && ok;
+    }
+
+    if (ok) {
+      std::size_t n_tokens = 0;
+      for (auto const& chunk : chunks)
+        n_tokens += chunk.tokens.size();
+      tokens.reserve(n_tokens);
+      keypossible.reserve(n_tokens);
+
+      for (auto const& chunk : chunks) {
+        chunk.terminate();
+        tokens.insert(tokens.end(), chunk.tokens.begin(), chunk.tokens.end());
+        keypossible.insert(keypossible.end(), chunk.keypossible.begin(),
+            chunk.keypossible.end());
       }
-      tokens.push_back(q);
+
+      return;
     }
+
+    // malformed (e.g. multi-line quoted strings), fall back to serial
   }
+#endif
+
+  cif_token_chunk chunk;
+  cif_tokenize_range(p, nullptr, '\0', false, chunk);
+  chunk.terminate();
+  tokens = std::move(chunk.tokens);
+  keypossible = std::move(chunk.keypossible);
+}
+
+bool cif_file::parse(char*&& p) {
+  m_datablocks.clear();
+  m_tokens.clear();
+  m_contents.reset(p);
+
+  if (!p) {
+    error("parse(nullptr)");
+    return false;
+  }
+
+  auto& tokens = m_tokens;
+  std::vector<bool> keypossible;
+
+  // tokenize
+  cif_tokenize(p, tokens, keypossible);
 
   cif_detail::cif_str_data* current_frame = nullptr;
   std::vector<cif_detail::cif_str_data*> frame_stack;
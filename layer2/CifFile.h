@@ -292,6 +292,12 @@ public:
     return d;
   }
 
+  /// True if as_s() may be called concurrently (doesn't convert through
+  /// the internal string cache)
+  bool as_s_is_thread_safe() const {
+    return std::holds_alternative<cif_detail::cif_str_array>(m_array);
+  }
+
   /// Alias for as<int>()
   int as_i(unsigned pos = 0, int d = 0) const { return as(pos, d); }
 
@@ -310,6 +316,13 @@ public:
       v.push_back(as<T>(i, d));
     return v;
   }
+
+  /**
+   * Like to_vector() but with exactly `n` elements (`d` past the end of the
+   * array). Large arrays are converted in parallel. Implemented for int,
+   * float and double.
+   */
+  template <typename T> std::vector<T> to_vector_n(unsigned n, T d = T()) const;
 };
 
 /**
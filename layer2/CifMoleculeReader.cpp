@@ -32,10 +32,15 @@
 #include "Util2.h"
 #include "Vector.h"
 #include "Lex.h"
+#include "LexConcurrent.h"
 #include "strcasecmp.h"
 #include "pymol/zstring_view.h"
 #include "Feedback.h"
 
+#ifdef PYMOL_OPENMP
+#include <omp.h>
+#endif
+
 #ifdef _PYMOL_IP_PROPERTIES
 #endif
 
@@ -1046,6 +1051,55 @@ public:
  *
  * return: models as VLA of coordinate sets
  */
+/**
+ * Intern the strings of the given columns (counted references, like
+ * LexIdx). Large text CIF columns are interned in parallel.
+ *
+ * @return One vector of ids per column
+ */
+static std::vector<std::vector<lexidx_t>> intern_columns(PyMOLGlobals* G,
+    const std::vector<const cif_array*>& columns, int nrows)
+{
+  int const ncols = columns.size();
+  std::vector<std::vector<lexidx_t>> ids(ncols, std::vector<lexidx_t>(nrows));
+
+#ifdef PYMOL_OPENMP
+  int const n_threads = omp_get_max_threads();
+  bool const parallel = nrows > 10000 && n_threads > 1 &&
+    std::all_of(columns.begin(), columns.end(),
+        [](const cif_array* arr) { return arr->as_s_is_thread_safe(); });
+
+  if (parallel) {
+    pymol::LexInterner interner(G);
+    std::vector<pymol::LexStaging> staging;
+    for (int t = 0; t < n_threads; ++t)
+      staging.emplace_back(interner);
+
+#pragma omp parallel num_threads(n_threads)
+    {
+      auto& local = staging[omp_get_thread_num()];
+#pragma omp for schedule(static)
+      for (int i = 0; i < nrows; ++i) {
+        for (int c = 0; c < ncols; ++c)
+          ids[c][i] = local.idx(columns[c]->as_s(i));
+      }
+    }
+
+    for (auto& local : staging)
+      local.merge();
+
+    return ids;
+  }
+#endif
+
+  for (int c = 0; c < ncols; ++c) {
+    for (int i = 0; i < nrows; ++i)
+      ids[c][i] = LexIdx(G, columns[c]->as_s(i));
+  }
+
+  return ids;
+}
+
 static CoordSet** read_atom_site(PyMOLGlobals* G, const cif_data* data,
     AtomInfoType** atInfoPtr, CifContentInfo& info, bool discrete, bool quiet)
 {
@@ -1129,14 +1183,24 @@ static CoordSet** read_atom_site(PyMOLGlobals* G, const cif_data* data,
   AtomInfoType *ai;
   int atomCount = 0;
   int auto_show = RepGetAutoShowMask(G);
-  int first_model_num = model_to_state(arr_mod_num->as_i(0, 1));
   CoordSet * cset;
   int mod_num, ncsets = 0;
 
+  // convert the numeric columns up front (in parallel for large files)
+  auto const col_mod_num = arr_mod_num->to_vector_n(nrows, 1);
+  auto const col_x = arr_x->to_vector_n(nrows, 0.f);
+  auto const col_y = arr_y->to_vector_n(nrows, 0.f);
+  auto const col_z = arr_z->to_vector_n(nrows, 0.f);
+  auto const col_b = (arr_u ? arr_u : arr_b)->to_vector_n(nrows, 0.);
+  auto const col_q = arr_q->to_vector_n(nrows, 1.f);
+  auto const col_id = arr_ID->to_vector_n(nrows, 0);
+
+  int first_model_num = model_to_state(nrows ? col_mod_num[0] : 1);
+
   // collect number of atoms per model and number of coord sets
   std::map<int, int> atoms_per_model;
   for (int i = 0, n = nrows; i < n; i++) {
-    mod_num = model_to_state(arr_mod_num->as_i(i, 1));
+    mod_num = model_to_state(col_mod_num[i]);
 
     if (mod_num < 1) {
       PRINTFB(G, FB_ObjectMolecule, FB_Errors)
@@ -1161,23 +1225,38 @@ static CoordSet** read_atom_site(PyMOLGlobals* G, const cif_data* data,
   // mm_atom_site_label -> atom index (1-indexed)
   std::map<std::string, int> name_dict;
 
+  // intern the string columns up front (in parallel for large files)
+  auto const col_lex = intern_columns(G,
+      {arr_segi, arr_chain, arr_name, arr_resn, arr_label}, nrows);
+  auto const& col_segi = col_lex[0];
+  auto const& col_chain = col_lex[1];
+  auto const& col_name = col_lex[2];
+  auto const& col_resn = col_lex[3];
+  auto const& col_label = col_lex[4];
+
+  // release the references of a row which doesn't become an atom
+  auto const release_row = [&](int i) {
+    for (auto const& col : col_lex)
+      LexDec(G, col[i]);
+  };
+
   for (int i = 0, n = nrows; i < n; i++) {
-    lexidx_t segi = LexIdx(G, arr_segi->as_s(i));
+    lexidx_t segi = col_segi[i];
 
     if (info.is_excluded_chain(segi)) {
-      LexDec(G, segi);
+      release_row(i);
       continue;
     }
 
-    mod_num = model_to_state(arr_mod_num->as_i(i, 1));
+    mod_num = model_to_state(col_mod_num[i]);
 
     // copy coordinates into coord set
     cset = csets[mod_num - 1];
     int idx = cset->NIndex++;
     float * coord = cset->coordPtr(idx);
-    coord[0] = arr_x->as_d(i);
-    coord[1] = arr_y->as_d(i);
-    coord[2] = arr_z->as_d(i);
+    coord[0] = col_x[i];
+    coord[1] = col_y[i];
+    coord[2] = col_z[i];
 
     if (!discrete && ncsets > 1) {
       // mm_atom_site_label aggregate
@@ -1194,6 +1273,7 @@ static CoordSet** read_atom_site(PyMOLGlobals* G, const cif_data* data,
         int atm = name_dict[key] - 1;
         if (atm >= 0) {
           cset->IdxToAtm[idx] = atm;
+          release_row(i);
           continue;
         }
       }
@@ -1209,18 +1289,19 @@ static CoordSet** read_atom_site(PyMOLGlobals* G, const cif_data* data,
     ai->rank = atomCount;
     ai->alt[0] = arr_alt->as_s(i)[0];
 
-    ai->id = arr_ID->as_i(i);
+    ai->id = col_id[i];
     ai->b = (arr_u != nullptr) ?
-             arr_u->as_d(i) * 78.95683520871486 : // B = U * 8 * pi^2
-             arr_b->as_d(i);
-    ai->q = arr_q->as_d(i, 1.0);
+             col_b[i] * 78.95683520871486 : // B = U * 8 * pi^2
+             col_b[i];
+    ai->q = col_q[i];
 
     strncpy_alpha(ai->elem, arr_symbol->as_s(i), cElemNameLen);
 
-    ai->chain = LexIdx(G, arr_chain->as_s(i));
-    ai->name = LexIdx(G, arr_name->as_s(i));
-    ai->resn = LexIdx(G, arr_resn->as_s(i));
-    ai->segi = std::move(segi); // steal reference
+    // steal references
+    ai->chain = col_chain[i];
+    ai->name = col_name[i];
+    ai->resn = col_resn[i];
+    ai->segi = segi;
 
     if ('H' == arr_group_pdb->as_s(i)[0]) {
       ai->hetatm = true;
@@ -1246,7 +1327,7 @@ static CoordSet** read_atom_site(PyMOLGlobals* G, const cif_data* data,
     ai->partialCharge = arr_partial_charge->as_d(i);
     ai->elec_radius = arr_elec_radius->as_d(i);
     ai->vdw = arr_vdw->as_d(i);
-    ai->label = LexIdx(G, arr_label->as_s(i));
+    ai->label = col_label[i];
 
     AtomInfoAssignParameters(G, ai);
 
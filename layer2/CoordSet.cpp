@@ -52,6 +52,7 @@ Z* -------------------------------------------------------------------
 #include"PyMOLObject.h"
 #include "Executive.h"
 #include "Lex.h"
+#include "Trace.h"
 
 #ifdef _PYMOL_IP_PROPERTIES
 #include "Property.h"
@@ -1216,9 +1217,19 @@ void CoordSet::invalidateRep(cRep_t type, cRepInv_t level)
     }
   }
 
+  if (PickTree) {
+    if (level == cRepInvCoord) {
+      PickTree->invalidateCoords();
+    } else if (level == cRepInvPick || level >= cRepInvVisib) {
+      // the tree skips masked and hidden atoms
+      PickTree.reset();
+    }
+  }
+
   if(level >= cRepInvCoord) {   /* if coordinates change, then this map becomes invalid */
     MapFree(Coord2Idx);
     Coord2Idx = nullptr;
+    ++CoordVersion;
     ExecutiveInvalidateSelectionIndicatorsCGO(G);
     SceneInvalidatePicking(G);
     /* invalidate distances */
@@ -1233,7 +1244,11 @@ void CoordSet::invalidateRep(cRep_t type, cRepInv_t level)
   }
 #endif
 
-  SceneChanged(G);
+  if (Obj) {
+    SceneObjectChanged(G, Obj);
+  } else {
+    SceneChanged(G);
+  }
 }
 
 
@@ -1242,6 +1257,7 @@ void CoordSet::invalidateRep(cRep_t type, cRepInv_t level)
 #define RepUpdateMacro(rep, new_fn, state)                                     \
   {                                                                            \
     if (Active[rep] && !G->Interrupt) {                                        \
+      PYMOL_TRACE_SCOPE("RepUpdate", "rep", #new_fn);                          \
       if (Rep[rep]) {                                                          \
         assert(Rep[rep]->cs == this);                                          \
         assert(Rep[rep]->getState() == state);                                 \
@@ -1333,6 +1349,41 @@ void CoordSetUpdateCoord2IdxMap(CoordSet * I, float cutoff)
   }
 }
 
+/*========================================================================*/
+// number of spatial indices kept per object, besides the one in use
+#define CS_SPATIAL_INDEX_KEEP 3
+
+const pymol::SpatialIndex& CoordSet::getSpatialIndex()
+{
+  if (Obj) {
+    SpatialIdxUsed = ++Obj->SpatialIdxClock;
+  }
+
+  if (!SpatialIdx || SpatialIdx->version() != CoordVersion ||
+      SpatialIdx->size() != NIndex) {
+    // evict the least recently used indices of other states (trajectories)
+    while (Obj) {
+      CoordSet* lru = nullptr;
+      int n_kept = 0;
+      for (int state = 0; state < Obj->NCSet; ++state) {
+        auto* cs = Obj->CSet[state];
+        if (cs && cs != this && cs->SpatialIdx) {
+          ++n_kept;
+          if (!lru || cs->SpatialIdxUsed < lru->SpatialIdxUsed)
+            lru = cs;
+        }
+      }
+      if (n_kept < CS_SPATIAL_INDEX_KEEP)
+        break;
+      lru->SpatialIdx.reset();
+    }
+
+    SpatialIdx =
+        pymol::make_cache<pymol::SpatialIndex>(Coord.data(), NIndex, CoordVersion);
+  }
+  return *SpatialIdx;
+}
+
 /*========================================================================*/
 void CoordSet::render(RenderInfo * info)
 {
@@ -1423,7 +1474,12 @@ void CoordSet::render(RenderInfo * info)
       ray->color3fv(ColorGet(G, Obj->Color));
     }
 
-    if (ray || pick) {
+    if (ray) {
+      r->renderRay(info);
+      continue;
+    }
+
+    if (pick) {
       r->render(info);
       continue;
     }
@@ -23,6 +23,8 @@ Z* -------------------------------------------------------------------
 #include"Word.h"
 #include"Setting.h"
 #include"ObjectMolecule.h"
+#include"PickBVH.h"
+#include"SpatialIndex.h"
 #include"vla.h"
 
 #include "pymol/math_defines.h"
@@ -76,6 +78,11 @@ struct CoordSet : CObjectState {
   float const* coordPtrSym(
       int idx, pymol::SymOp const& symop, float* v_out, bool inv = false) const;
 
+  /// Spatial index over the coordinates (indices are coordinate indices),
+  /// rebuilt on demand if the coordinates changed. Only the indices of the
+  /// most recently queried states of an object are kept.
+  const pymol::SpatialIndex& getSpatialIndex();
+
   AtomInfoType * getAtomInfo(int idx) {
     return Obj->AtomInfo + IdxToAtm[idx];
   }
@@ -139,6 +146,14 @@ struct CoordSet : CObjectState {
   MapType *Coord2Idx = nullptr;
   float Coord2IdxReq = 0, Coord2IdxDiv = 0;
 
+  /* for CPU picking, built on demand */
+  pymol::cache_ptr<pymol::PickBVH> PickTree;
+
+  /* for proximity selections, see getSpatialIndex() */
+  pymol::cache_ptr<pymol::SpatialIndex> SpatialIdx;
+  unsigned SpatialIdxUsed = 0; // see ObjectMolecule::SpatialIdxClock
+  unsigned CoordVersion = 0; // incremented when coordinates are invalidated
+
   /* temporary / optimization */
 
   int objMolOpInvalidated = 0;
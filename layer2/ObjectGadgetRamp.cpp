@@ -14,6 +14,8 @@ I* Additional authors of this source file include:
 -*
 Z* -------------------------------------------------------------------
 */
+#include <vector>
+
 #include"os_python.h"
 
 #include"os_predef.h"
@@ -580,6 +582,153 @@ int ObjectGadgetRampInterVertex(ObjectGadgetRamp * I, const float *pos, float *c
   return (ok);
 }
 
+/**
+ * True if the ramp has colors which are ramps themselves. Those are looked
+ * up with ColorGetRamped, which must not run concurrently.
+ */
+static bool ObjectGadgetRampHasNestedRamps(ObjectGadgetRamp * I)
+{
+  int n_color = I->Color ? VLAGetSize(I->Color) / 3 : 0;
+  for (int i = 0; i < n_color; ++i) {
+    if (GetSpecial(I->Color + i * 3) <= cColorExtCutoff)
+      return true;
+  }
+  return false;
+}
+
+/**
+ * Batch version of ObjectGadgetRampInterVertex. Map values and nearest
+ * atoms are looked up for all vertices at once, and the ramp interpolation
+ * runs in parallel.
+ *
+ * @param n Number of vertices
+ * @param pos Vertex coordinates (3 * n)
+ * @param[out] color Colors (3 * n), not written if the ramp source is
+ * missing
+ */
+int ObjectGadgetRampInterVertices(ObjectGadgetRamp * I, int n, const float *pos,
+                                  float *color, int state)
+{
+  if(n < 2 || I->RampType == cRampNone) {
+    for(int i = 0; i < n; ++i) {
+      if(!ObjectGadgetRampInterVertex(I, pos + 3 * i, color + 3 * i, state))
+        return false;
+    }
+    return true;
+  }
+
+  // lazy initialization, must not happen in the parallel loops
+  ObjectGadgetRampGetLevel(I);
+
+  bool const nested = ObjectGadgetRampHasNestedRamps(I);
+  int ok = true;
+
+  switch (I->RampType) {
+  case cRampMap:
+    if(!I->Map)
+      I->Map = ExecutiveFindObjectMapByName(I->G, I->SrcName);
+    if(!ExecutiveValidateObjectPtr(I->G, I->Map, cObjectMap))
+      ok = false;
+    else {
+      int src_state;
+      if(I->SrcState >= 0)
+        src_state = I->SrcState;
+      else
+        src_state = state;
+      if(src_state < 0)
+        src_state = SceneGetState(I->G);
+
+      std::vector<float> level(n);
+      ok = ObjectMapInterpolate(I->Map, src_state, pos, level.data(), nullptr, n);
+      if(ok) {
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for if(n > 1000)
+#endif
+        for(int i = 0; i < n; ++i) {
+          ObjectGadgetRampInterpolate(I, level[i], color + 3 * i);
+        }
+      }
+    }
+    break;
+  case cRampMol:
+    if(!I->Mol)
+      I->Mol = ExecutiveFindObjectMoleculeByName(I->G, I->SrcName);
+    if(!ExecutiveValidateObjectPtr(I->G, I->Mol, cObjectMolecule))
+      ok = false;
+    else {
+      float cutoff = 1.0F;
+      int sub_vdw = false;
+      if(state < 0)
+        state = SceneGetState(I->G);
+      if(I->Level && I->NLevel) {
+        cutoff = I->Level[I->NLevel - 1];
+        if(I->Level[0] < 0.0F) {
+          sub_vdw = true;
+          cutoff += MAX_VDW;
+        }
+      }
+      if(I->Mol->NCSet == 1) // if only one state, then set state to 0
+        state = 0;
+
+      bool const blend = SettingGet_b(I->G, I->Setting.get(), nullptr,
+          cSetting_ramp_blend_nearby_colors);
+
+      std::vector<int> atoms(n);
+      std::vector<float> dists(n);
+      std::vector<float> atomic(3 * n);
+      ObjectMoleculeGetNearestAtoms(I->Mol, n, pos, cutoff, state,
+          atoms.data(), dists.data(), blend ? atomic.data() : nullptr, sub_vdw);
+
+      // color lookups are not thread-safe (24-bit colors)
+      float object[3];
+      copy3f(ColorGetRaw(I->G, I->Mol->Color), object);
+      if(!blend) {
+        for(int i = 0; i < n; ++i) {
+          int const index = atoms[i];
+          if(index >= 0) {
+            const AtomInfoType *ai = I->Mol->AtomInfo + index;
+            copy3f(ColorGetRaw(I->G, ai->color), atomic.data() + 3 * i);
+            if(sub_vdw) {
+              dists[i] -= ai->vdw;
+              if(dists[i] < 0.0F)
+                dists[i] = 0.0F;
+            }
+          }
+        }
+      }
+
+      auto const interpolate = [&](int i) {
+        const float white[3] = { 1.0F, 1.0F, 1.0F };
+        const float *vertex = pos + 3 * i;
+        float *dst = color + 3 * i;
+        bool found = atoms[i] >= 0;
+        if(!ObjectGadgetRampInterpolateWithSpecial(I,
+              found ? dists[i] : cutoff + 1.0F, dst,
+              found ? atomic.data() + 3 * i : white,
+              found ? object : white, vertex, state, false)) {
+          copy3f(I->Color.data(), dst);
+        }
+      };
+
+      if(nested) {
+        for(int i = 0; i < n; ++i)
+          interpolate(i);
+      } else {
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for if(n > 1000)
+#endif
+        for(int i = 0; i < n; ++i)
+          interpolate(i);
+      }
+    }
+    break;
+  default:
+    ok = false;
+    break;
+  }
+  return (ok);
+}
+
 static void ObjectGadgetRampUpdateCGO(ObjectGadgetRamp * I, GadgetSet * gs)
 {
   CGO *cgo;
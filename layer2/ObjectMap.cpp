@@ -1016,165 +1016,137 @@ int ObjectMapStateInterpolate(ObjectMapState * ms, const float *array, float *re
                               int n)
 {
   int ok = true;
-  const float *inp;
-  int a, b, c;
-  float x, y, z;
-  inp = array;
+  CField *field = ms->Field->data.get();
 
   if(ObjectMapStateValidXtal(ms)) {
-    float frac[3];
+    const float *realToFrac = ms->Symmetry->Crystal.realToFrac();
 
-    while(n--) {
-      /* get the fractional coordinate */
-      transform33f3f(ms->Symmetry->Crystal.realToFrac(), inp, frac);
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for reduction(&&:ok) if(n > 1000)
+#endif
+    for(int i = 0; i < n; ++i) {
+      float frac[3];
+      bool in_bounds = true;
 
-      inp += 3;
+      /* get the fractional coordinate */
+      transform33f3f(realToFrac, array + 3 * i, frac);
 
       /* compute the effective lattice offset as a function of cell spacing */
 
-      x = (ms->Div[0] * frac[0]);
-      y = (ms->Div[1] * frac[1]);
-      z = (ms->Div[2] * frac[2]);
+      float x = (ms->Div[0] * frac[0]);
+      float y = (ms->Div[1] * frac[1]);
+      float z = (ms->Div[2] * frac[2]);
 
       /* now separate the integral and fractional parts for interpolation */
 
-      a = (int) floor(x + R_SMALL8);
-      b = (int) floor(y + R_SMALL8);
-      c = (int) floor(z + R_SMALL8);
+      int a = (int) floor(x + R_SMALL8);
+      int b = (int) floor(y + R_SMALL8);
+      int c = (int) floor(z + R_SMALL8);
       x -= a;
       y -= b;
       z -= c;
 
-      if(flag)
-        *flag = 1;
       /* wrap into the map */
 
       if(a < ms->Min[0]) {
-        if(x < 0.99F) {
-          ok = false;
-          if(flag)
-            *flag = 0;
-        }
+        if(x < 0.99F)
+          in_bounds = false;
         x = 0.0F;
         a = ms->Min[0];
       } else if(a >= ms->FDim[0] + ms->Min[0] - 1) {
-        if(x > 0.01F) {
-          ok = false;
-          if(flag)
-            *flag = 0;
-        }
+        if(x > 0.01F)
+          in_bounds = false;
         x = 0.0F;
         a = ms->FDim[0] + ms->Min[0] - 1;
       }
 
       if(b < ms->Min[1]) {
-        if(y < 0.99F) {
-          ok = false;
-          if(flag)
-            *flag = 0;
-        }
+        if(y < 0.99F)
+          in_bounds = false;
         y = 0.0F;
         b = ms->Min[1];
       } else if(b >= ms->FDim[1] + ms->Min[1] - 1) {
-        if(y > 0.01F) {
-          ok = false;
-          if(flag)
-            *flag = 0;
-        }
+        if(y > 0.01F)
+          in_bounds = false;
         y = 0.0F;
         b = ms->FDim[1] + ms->Min[1] - 1;
       }
 
       if(c < ms->Min[2]) {
-        if(z < 0.99F) {
-          ok = false;
-          if(flag)
-            *flag = 0;
-        }
+        if(z < 0.99F)
+          in_bounds = false;
         z = 0.0F;
         c = ms->Min[2];
       } else if(c >= ms->FDim[2] + ms->Min[2] - 1) {
-        if(z > 0.01) {
-          ok = false;
-          if(flag)
-            *flag = 0;
-        }
+        if(z > 0.01)
+          in_bounds = false;
         z = 0.0F;
         c = ms->FDim[2] + ms->Min[2] - 1;
       }
-      /*      printf("%d %d %d %8.3f %8.3f %8.3f\n",a,b,c,x,y,z); */
-      *(result++) = FieldInterpolatef(ms->Field->data.get(),
-                                      a - ms->Min[0],
-                                      b - ms->Min[1], c - ms->Min[2], x, y, z);
-      if(flag)
-        flag++;
 
+      result[i] = FieldInterpolatef(field,
+                                    a - ms->Min[0],
+                                    b - ms->Min[1], c - ms->Min[2], x, y, z);
+      if(flag)
+        flag[i] = in_bounds;
+      ok = ok && in_bounds;
     }
   } else {
 
-    while(n--) {
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for reduction(&&:ok) if(n > 1000)
+#endif
+    for(int i = 0; i < n; ++i) {
+      const float *inp = array + 3 * i;
+      bool in_bounds = true;
 
-      x = (inp[0] - ms->Origin[0]) / ms->Grid[0];
-      y = (inp[1] - ms->Origin[1]) / ms->Grid[1];
-      z = (inp[2] - ms->Origin[2]) / ms->Grid[2];
-      inp += 3;
+      float x = (inp[0] - ms->Origin[0]) / ms->Grid[0];
+      float y = (inp[1] - ms->Origin[1]) / ms->Grid[1];
+      float z = (inp[2] - ms->Origin[2]) / ms->Grid[2];
 
-      a = (int) floor(x + R_SMALL8);
-      b = (int) floor(y + R_SMALL8);
-      c = (int) floor(z + R_SMALL8);
+      int a = (int) floor(x + R_SMALL8);
+      int b = (int) floor(y + R_SMALL8);
+      int c = (int) floor(z + R_SMALL8);
       x -= a;
       y -= b;
       z -= c;
 
-      if(flag)
-        *flag = 1;
       if(a < ms->Min[0]) {
         x = 0.0F;
         a = ms->Min[0];
-        ok = false;
-        if(flag)
-          *flag = 0;
+        in_bounds = false;
       } else if(a >= ms->Max[0]) {
         x = 1.0F;
         a = ms->Max[0] - 1;
-        ok = false;
-        if(flag)
-          *flag = 0;
+        in_bounds = false;
       }
 
       if(b < ms->Min[1]) {
         y = 0.0F;
         b = ms->Min[1];
-        ok = false;
-        if(flag)
-          *flag = 0;
+        in_bounds = false;
       } else if(b >= ms->Max[1]) {
         y = 1.0F;
         b = ms->Max[1] - 1;
-        ok = false;
-        if(flag)
-          *flag = 0;
+        in_bounds = false;
       }
 
       if(c < ms->Min[2]) {
         z = 0.0F;
         c = ms->Min[2];
-        ok = false;
-        if(flag)
-          *flag = 0;
+        in_bounds = false;
       } else if(c >= ms->Max[2]) {
         z = 1.0F;
         c = ms->Max[2] - 1;
-        ok = false;
-        if(flag)
-          *flag = 0;
+        in_bounds = false;
       }
-      /*      printf("%d %d %d %8.3f %8.3f %8.3f\n",a,b,c,x,y,z); */
-      *(result++) = FieldInterpolatef(ms->Field->data.get(),
-                                      a - ms->Min[0],
-                                      b - ms->Min[1], c - ms->Min[2], x, y, z);
+
+      result[i] = FieldInterpolatef(field,
+                                    a - ms->Min[0],
+                                    b - ms->Min[1], c - ms->Min[2], x, y, z);
       if(flag)
-        flag++;
+        flag[i] = in_bounds;
+      ok = ok && in_bounds;
     }
   }
   return (ok);
@@ -352,10 +352,10 @@ void ObjectMesh::invalidate(cRep_t rep, cRepInv_t level, int state)
       ms->RefreshFlag = true;
       if (level >= cRepInvAll) {
         ms->ResurfaceFlag = true;
-        SceneChanged(I->G);
+        SceneObjectChanged(I->G, I);
       } else if (level >= cRepInvColor) {
         ms->RecolorFlag = true;
-        SceneChanged(I->G);
+        SceneObjectChanged(I->G, I);
       } else {
         SceneInvalidate(I->G);
       }
@@ -444,6 +444,7 @@ static void ObjectMeshStateUpdateColors(ObjectMesh* I, ObjectMeshState* ms)
     rc = ms->RC.data();
     vc = ms->VC.data();
     if (vc) {
+      ColorRampBatch ramp_batch;
       for (a = 0; a < n_vert; a++) {
         if (a == base_n_vert) {
           int new_color = SettingGet_color(
@@ -456,7 +457,7 @@ static void ObjectMeshStateUpdateColors(ObjectMesh* I, ObjectMeshState* ms)
           }
         }
         if (ColorCheckRamped(I->G, cur_color)) {
-          ColorGetRamped(I->G, cur_color, v, vc, state);
+          ramp_batch.add(cur_color, v, vc);
           *rc = cur_color;
           ramped_flag = true;
         } else {
@@ -467,6 +468,7 @@ static void ObjectMeshStateUpdateColors(ObjectMesh* I, ObjectMeshState* ms)
         vc += 3;
         v += 3;
       }
+      ramp_batch.flush(I->G, state);
     }
 
     if (one_color_flag && (!ramped_flag)) {
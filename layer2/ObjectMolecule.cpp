@@ -73,9 +73,6 @@ static
 CoordSet *ObjectMoleculeMMDStr2CoordSet(PyMOLGlobals * G, const char *buffer,
                                         AtomInfoType ** atInfoPtr, const char **restart);
 
-static
-void ObjectMoleculeTransformTTTf(ObjectMolecule * I, float *ttt, int state);
-
 static
 int ObjectMoleculeGetAtomGeometry(const ObjectMolecule * I, int state, int at);
 
@@ -4210,26 +4207,29 @@ int ObjectMoleculePreposReplAtom(ObjectMolecule * I, int index, AtomInfoType * a
 
 /*========================================================================*/
 
-#if 1
-void ObjectMoleculeSaveUndo(ObjectMolecule * I, int state, int log)
+/**
+ * Checkpoint for undo: Edits since the previous checkpoint become one undo
+ * step (see pymol::UndoJournal).
+ *
+ * @param state State which is about to be edited
+ * @param log Log a `cmd.push_undo` command
+ * @param mergeKey If non-zero and same as for the previous checkpoint,
+ * continue the current undo step
+ * @param touched Optional list of atoms which the upcoming edit will move
+ */
+void ObjectMoleculeSaveUndo(ObjectMolecule * I, int state, int log, int mergeKey,
+    const std::vector<int>* touched)
 {
-  CoordSet *cs;
   PyMOLGlobals *G = I->G;
-  FreeP(I->UndoCoord[I->UndoIter]);
-  I->UndoState[I->UndoIter] = -1;
   if(state < 0)
     state = 0;
   if(I->NCSet == 1)
     state = 0;
-  state = state % I->NCSet;
-  cs = I->CSet[state];
-  if(cs) {
-    I->UndoCoord[I->UndoIter] = pymol::malloc<float>(cs->NIndex * 3);
-    memcpy(I->UndoCoord[I->UndoIter], cs->Coord, sizeof(float) * cs->NIndex * 3);
-    I->UndoState[I->UndoIter] = state;
-    I->UndoNIndex[I->UndoIter] = cs->NIndex;
-  }
-  I->UndoIter = cUndoMask & (I->UndoIter + 1);
+  if(I->NCSet > 0)
+    state = state % I->NCSet;
+  if(!I->Undo)
+    I->Undo = pymol::make_cache<pymol::UndoJournal>();
+  I->Undo->checkpoint(I, state, mergeKey, touched);
   ExecutiveSetLastObjectEdited(G, I);
   if(log) {
     OrthoLineType line;
@@ -4238,57 +4238,20 @@ void ObjectMoleculeSaveUndo(ObjectMolecule * I, int state, int log)
       PLog(G, line, cPLog_no_flush);
     }
   }
-
 }
 
 
 /*========================================================================*/
+/**
+ * @param dir -1 for undo, 1 for redo
+ */
 void ObjectMoleculeUndo(ObjectMolecule * I, int dir)
 {
-  CoordSet *cs;
-  int state;
-
-  FreeP(I->UndoCoord[I->UndoIter]);
-  I->UndoState[I->UndoIter] = -1;
-  state = SceneGetState(I->G);
-  if(state < 0)
-    state = 0;
-  if(I->NCSet == 1)
-    state = 0;
-  state = state % I->NCSet;
-  cs = I->CSet[state];
-  if(cs) {
-    I->UndoCoord[I->UndoIter] = pymol::malloc<float>(cs->NIndex * 3);
-    memcpy(I->UndoCoord[I->UndoIter], cs->Coord, sizeof(float) * cs->NIndex * 3);
-    I->UndoState[I->UndoIter] = state;
-    I->UndoNIndex[I->UndoIter] = cs->NIndex;
-  }
-
-  I->UndoIter = cUndoMask & (I->UndoIter + dir);
-  if(!I->UndoCoord[I->UndoIter])
-    I->UndoIter = cUndoMask & (I->UndoIter - dir);
-
-  if(I->UndoState[I->UndoIter] >= 0) {
-    state = I->UndoState[I->UndoIter];
-    if(state < 0)
-      state = 0;
-
-    if(I->NCSet == 1)
-      state = 0;
-    state = state % I->NCSet;
-    cs = I->CSet[state];
-    if(cs) {
-      if(cs->NIndex == I->UndoNIndex[I->UndoIter]) {
-        memcpy(cs->Coord.data(), I->UndoCoord[I->UndoIter], sizeof(float) * cs->NIndex * 3);
-        I->UndoState[I->UndoIter] = -1;
-        FreeP(I->UndoCoord[I->UndoIter]);
-        cs->invalidateRep(cRepAll, cRepInvCoord);
-        SceneChanged(I->G);
-      }
-    }
-  }
+  if(!I->Undo)
+    return;
+  if(dir < 0 ? I->Undo->undo(I) : I->Undo->redo(I))
+    SceneChanged(I->G);
 }
-#endif
 
 int ObjectMoleculeAddBond(ObjectMolecule * I, int sele0, int sele1, int order, pymol::zstring_view symop)
 {
@@ -10331,12 +10294,12 @@ bool ObjectMoleculeSeleOp(ObjectMolecule * I, int sele, ObjectMoleculeOpRec * op
       case OMOP_AlterState:    /* overly coarse - doing all states, could do just 1 */
         if(!op->i3) {           /* not read_only? */
           I->invalidate(cRepAll, cRepInvRep, -1);
-          SceneChanged(G);
+          SceneObjectChanged(G, I);
         }
         break;
       case OMOP_CSetIdxSetFlagged:
         I->invalidate(cRepAll, cRepInvRep, -1);
-        SceneChanged(G);
+        SceneObjectChanged(G, I);
         break;
       case OMOP_SaveUndo:
         op->i2 = true;
@@ -11065,6 +11028,8 @@ void ObjectMoleculeDummyUpdate(ObjectMolecule * I, int mode)
     SceneGetCenter(I->G, I->CSet[0]->Coord.data());
     break;
   }
+  // coordinates changed without rep invalidation
+  ++I->CSet[0]->CoordVersion;
 }
 
 
@@ -11091,7 +11056,6 @@ ObjectMolecule *ObjectMoleculeDummyNew(PyMOLGlobals * G, int type)
 ObjectMolecule::ObjectMolecule(PyMOLGlobals * G, int discreteFlag) : pymol::CObject(G)
 {
   auto I = this;
-  int a;
   I->type = cObjectMolecule;
   I->CSet = pymol::vla<CoordSet*>(10); /* auto-zero */
   I->DiscreteFlag = discreteFlag;
@@ -11103,11 +11067,6 @@ ObjectMolecule::ObjectMolecule(PyMOLGlobals * G, int discreteFlag) : pymol::CObj
     I->DiscreteCSet = nullptr;
   }
   I->AtomInfo = pymol::vla<AtomInfoType>(10);
-  for(a = 0; a <= cUndoMask; a++) {
-    I->UndoCoord[a] = nullptr;
-    I->UndoState[a] = -1;
-  }
-  I->UndoIter = 0;
 }
 
 
@@ -11126,8 +11085,6 @@ void ObjectMoleculeCopyNoAlloc(const ObjectMolecule* obj, ObjectMolecule* I)
   I->ViewElem = nullptr;
   I->gridSlotSelIndicatorsCGO = nullptr;
 
-  for(a = 0; a <= cUndoMask; a++)
-    I->UndoCoord[a] = nullptr;
   I->CSet = pymol::vla<CoordSet*>(I->NCSet);   /* auto-zero */
   for(a = 0; a < I->NCSet; a++) {
     I->CSet[a] = CoordSetCopy(obj->CSet[a]);
@@ -11277,8 +11234,6 @@ ObjectMolecule::~ObjectMolecule()
     }
     VLAFreeP(I->Bond);
   }
-  for(a = 0; a <= cUndoMask; a++)
-    FreeP(I->UndoCoord[a]);
   if(I->Sculpt)
     DeleteP(I->Sculpt);
   delete I->CSTmpl;
@@ -11426,6 +11381,47 @@ ObjectMolecule *ObjectMoleculeReadPDBStr(PyMOLGlobals * G, ObjectMolecule * I,
         }
       }
     }
+
+    /* ensembles: read the following models which have the same atoms in
+       one go, without rebuilding the atom info for each of them */
+    if(ok && restart && successCnt == 1 && !I->DiscreteFlag && pdb_info &&
+       (pdb_info->variant == PDB_VARIANT_DEFAULT ||
+        pdb_info->variant == PDB_VARIANT_PDBQT) &&
+       !SettingGetGlobal_b(G, cSetting_pdb_honor_model_number)) {
+      auto csets = ObjectMoleculePDBStr2CoordSets(I, start, cset, &restart);
+      for(auto cs : csets) {
+        state = state + 1;
+        VLACheck(I->CSet, CoordSet *, state);
+        if(I->NCSet <= state)
+          I->NCSet = state + 1;
+        delete I->CSet[state];
+        I->CSet[state] = cs;
+
+        if(I->Symmetry && pdb_info->scale.flag[0] &&
+           pdb_info->scale.flag[1] && pdb_info->scale.flag[2]) {
+          CoordSetInsureOrthogonal(G, cs, pdb_info->scale.matrix,
+              &I->Symmetry->Crystal, quiet);
+        }
+
+        if(SettingGetGlobal_b(G, cSetting_pdb_hetatm_guess_valences)) {
+          ObjectMoleculeGuessValences(I, state, nullptr, nullptr, false);
+        }
+
+        successCnt++;
+        if(!quiet) {
+          if(successCnt == 2) {
+            PRINTFB(G, FB_ObjectMolecule, FB_Actions)
+              " %s: read MODEL %d\n", __func__, 1 ENDFB(G);
+          }
+          PRINTFB(G, FB_ObjectMolecule, FB_Actions)
+            " %s: read MODEL %d\n", __func__, successCnt ENDFB(G);
+        }
+      }
+      if(!csets.empty()) {
+        SceneCountFrames(G);
+        ok &= ObjectMoleculeExtendIndices(I, -1);
+      }
+    }
     if(restart) {
       repeatFlag = true;
       start = restart;
@@ -11691,12 +11687,29 @@ int *AtomInfoGetSortedIndex(PyMOLGlobals * G,
     if(obj)
       setting = obj->Setting.get();
 
-    UtilSortIndexGlobals(G, n, rec, index, (UtilOrderFnGlobals *) (
-        SettingGet_b(G, setting, nullptr, cSetting_retain_order) ?
-          AtomInfoInOrigOrder :
-        SettingGet_b(G, setting, nullptr, cSetting_pdb_hetatm_sort) ?
-          AtomInfoInOrder :
+    bool retain_order = SettingGet_b(G, setting, nullptr, cSetting_retain_order);
+    bool hetatm_sort = SettingGet_b(G, setting, nullptr, cSetting_pdb_hetatm_sort);
+
+    /* packed integer keys, no lexicon lookups while sorting */
+    int nbits = 0;
+    auto keys = AtomInfoGetSortKeys(G, rec, n, !hetatm_sort, retain_order, &nbits);
+
+    if(nbits) {
+      a = 1;
+      while(a < n && keys[a - 1] <= keys[a])
+        a++;
+      if(a >= n) {              /* already in order */
+        for(a = 0; a < n; a++)
+          index[a] = a;
+      } else {
+        pymol::RadixSortIndex(n, keys.data(), nbits, index);
+      }
+    } else {
+      UtilSortIndexGlobals(G, n, rec, index, (UtilOrderFnGlobals *) (
+          retain_order ? AtomInfoInOrigOrder :
+          hetatm_sort ? AtomInfoInOrder :
           AtomInfoInOrderIgnoreHet));
+    }
   }
 
   for(a = 0; a < n; a++)
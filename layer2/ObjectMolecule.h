@@ -32,6 +32,7 @@ Z* -------------------------------------------------------------------
 #include "AtomNeighbors.h"
 
 #include "Sculpt.h"
+#include "UndoJournal.h"
 #include <memory>
 
 #ifdef _WEBGL
@@ -43,7 +44,6 @@ Z* -------------------------------------------------------------------
 #define cKeywordCenter "center"
 #define cKeywordOrigin "origin"
 
-#define cUndoMask 0xF
 enum cLoadType_t : int;
 
 /**
@@ -76,13 +76,6 @@ struct ObjectMolecule : public pymol::CObject {
      int *UniformAtmToIdx, *UniformIdxToAtm;  */
   int SeleBase = 0;                 /* for internal usage by  selector & only valid during selection process */
   pymol::copyable_ptr<CSymmetry> Symmetry;
-#if 1
-  // legacy undo
-  float *UndoCoord[cUndoMask + 1] {};
-  int UndoState[cUndoMask + 1] {};
-  int UndoNIndex[cUndoMask + 1] {};
-  int UndoIter = 0;
-#endif
 
 private:
   pymol::cache_ptr<int[]> Neighbor;
@@ -93,8 +86,11 @@ public:
   int AtomCounter = -1;
   /* not stored */
   struct CSculpt *Sculpt =  nullptr;
+  pymol::cache_ptr<pymol::UndoJournal> Undo;
+  int AtomOrderGeneration = 0; /* bumped when atoms are permuted */
   int RepVisCacheValid = 0;
   int RepVisCache = 0;     /* for transient storage during updates */
+  unsigned SpatialIdxClock = 0; /* LRU of the states' spatial indices */
 
   // for reporting available assembly ids after mmCIF loading - SUBJECT TO CHANGE
   std::shared_ptr<pymol::cif_file> m_ciffile;
@@ -289,6 +285,9 @@ int ObjectMoleculeGetNearestAtomIndex(ObjectMolecule * I, const float *point, fl
 int ObjectMoleculeGetNearestBlendedColor(ObjectMolecule * I, const float *point, float cutoff,
                                          int state, float *dist, float *color,
                                          int sub_vdw);
+void ObjectMoleculeGetNearestAtoms(ObjectMolecule * I, int n, const float *points,
+                                   float cutoff, int state, int *atoms, float *dists,
+                                   float *blended, int sub_vdw);
 
 int *ObjectMoleculeGetPrioritizedOtherIndexList(ObjectMolecule * I, struct CoordSet *cs);
 int ObjectMoleculeGetPrioritizedOther(const int *other, int a1, int a2, int *double_sided);
@@ -386,6 +385,7 @@ int ObjectMoleculeMoveAtomLabel(ObjectMolecule * I, int state, int index, float
 int ObjectMoleculeGetAtomVertex(const ObjectMolecule *, int state, int index, float *v);
 int ObjectMoleculeGetAtomTxfVertex(const ObjectMolecule*, int state, int index, float *v);
 int ObjectMoleculeGetAtomIndex(const ObjectMolecule*, SelectorID_t sele);
+void ObjectMoleculeTransformTTTf(ObjectMolecule * I, float *ttt, int state);
 int ObjectMoleculeTransformSelection(ObjectMolecule * I, int state,
                                      int sele, const float *TTT, int log,
                                      const char *sname, int homogenous, int global);
@@ -409,7 +409,8 @@ int ObjectMoleculeRemoveBonds(ObjectMolecule * I, int sele1, int sele2);
 
 int ObjectMoleculeAutoDisableAtomNameWildcard(ObjectMolecule * I);
 
-void ObjectMoleculeSaveUndo(ObjectMolecule * I, int state, int log);
+void ObjectMoleculeSaveUndo(ObjectMolecule * I, int state, int log, int mergeKey = 0,
+    const std::vector<int>* touched = nullptr);
 void ObjectMoleculeUndo(ObjectMolecule * I, int dir);
 int ObjectMoleculePrepareAtom(ObjectMolecule * I, int index, AtomInfoType * ai, bool uniquefy=true);
 void ObjectMoleculeReplaceAtom(ObjectMolecule * I, int index, AtomInfoType&& ai);
@@ -512,6 +513,9 @@ struct CoordSet *ObjectMoleculePDBStr2CoordSet(PyMOLGlobals * G,
                                                PDBInfoRec * pdb_info,
                                                int quiet, int *model_number);
 
+std::vector<CoordSet*> ObjectMoleculePDBStr2CoordSets(ObjectMolecule* I,
+    const char* first_model, const CoordSet* tmpl, const char** restart_model);
+
 #ifndef NO_MMLIBS
 int ObjectMoleculeUpdateAtomTypeInfoForState(PyMOLGlobals * G, ObjectMolecule * obj, int state, int initialize, int format);
 #endif
@@ -660,6 +660,94 @@ int ObjectMoleculeGetNearestBlendedColor(ObjectMolecule * I, const float *point,
   return result;
 }
 
+/**
+ * Batch version of ObjectMoleculeGetNearestAtomIndex, or of
+ * ObjectMoleculeGetNearestBlendedColor if `blended` is given (`sub_vdw` only
+ * applies to the latter). Uses the spatial index of the coordinate set.
+ *
+ * @param n Number of points
+ * @param points Coordinates (3 * n)
+ * @param[out] atoms Nearest atom index per point, or -1
+ * @param[out] dists Distance to the nearest atom per point, or -1
+ * @param[out] blended Distance weighted atom colors (3 * n, optional)
+ */
+void ObjectMoleculeGetNearestAtoms(ObjectMolecule * I, int n, const float *points,
+                                   float cutoff, int state, int *atoms, float *dists,
+                                   float *blended, int sub_vdw)
+{
+  assert(state != -1 /* all states */);
+  auto* cs = I->getCoordSet(state);
+
+  std::fill_n(atoms, n, -1);
+  std::fill_n(dists, n, -1.0F);
+  if(blended)
+    std::fill_n(blended, 3 * n, 0.0F);
+
+  if(!cs || !cs->NIndex)
+    return;
+
+  auto const& index = cs->getSpatialIndex();
+
+  // ColorGet is not thread-safe (24-bit colors)
+  std::vector<float> idx_color;
+  if(blended) {
+    idx_color.resize(3 * cs->NIndex);
+    for(int j = 0; j < cs->NIndex; ++j) {
+      copy3f(ColorGet(I->G, I->AtomInfo[cs->IdxToAtm[j]].color),
+          idx_color.data() + 3 * j);
+    }
+  }
+
+  float const inner = (blended && sub_vdw) ? cutoff - MAX_VDW : cutoff;
+  float const inner2 = inner * inner;
+
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for if(n > 1000)
+#endif
+  for(int i = 0; i < n; ++i) {
+    const float *point = points + 3 * i;
+    float nearest = inner2;
+    float tot_weight = 0.0F;
+    float color[3] = {0.0F, 0.0F, 0.0F};
+    int result = -1;
+
+    index.forEachWithin(point, cutoff, [&](int j) {
+      float test = diffsq3f(cs->coordPtr(j), point);
+      if(blended) {
+        if(sub_vdw) {
+          test = sqrt1f(test);
+          test -= I->AtomInfo[cs->IdxToAtm[j]].vdw;
+          if(test < 0.0F)
+            test = 0.0F;
+          test = test * test;
+        }
+        if(test < inner2) {
+          float weight = inner - sqrt1f(test);
+          const float *at_col = idx_color.data() + 3 * j;
+          color[0] += at_col[0] * weight;
+          color[1] += at_col[1] * weight;
+          color[2] += at_col[2] * weight;
+          tot_weight += weight;
+        }
+      }
+      if(test < nearest || (test == nearest && j > result)) {
+        result = j;
+        nearest = test;
+      }
+    });
+
+    if(result >= 0) {
+      atoms[i] = cs->IdxToAtm[result];
+      dists[i] = sqrt1f(nearest);
+      if(blended) {
+        if(tot_weight > 0.0F)
+          scale3f(color, 1.0F / tot_weight, color);
+        copy3f(color, blended + 3 * i);
+      }
+    }
+  }
+}
+
 int ObjectMoleculeGetNearestAtomIndex(ObjectMolecule * I, const float *point, float cutoff,
                                       int state, float *dist)
 {
@@ -2772,6 +2860,207 @@ pqr_done:
   return (cset);
 }
 
+static bool pdb_is_atom_line(const char* p)
+{
+  return strstartswith(p, "ATOM ") || strstartswith(p, "HETATM");
+}
+
+/**
+ * Length of the line starting at `p`, without the line feed
+ */
+static int pdb_line_length(const char* p)
+{
+  return strcspn(p, "\r\n");
+}
+
+/**
+ * True if two ATOM/HETATM records (of at least 27 characters) have the same
+ * record name, atom name, alt, residue name, chain, residue number,
+ * insertion code and segi.
+ */
+static bool pdb_same_atom(const char* a, const char* b)
+{
+  if (memcmp(a, b, 6) != 0 || memcmp(a + 12, b + 12, 15) != 0)
+    return false;
+
+  int const len_a = pdb_line_length(a);
+  int const len_b = pdb_line_length(b);
+  for (int col = 72; col < 76; ++col) {
+    if ((col < len_a ? a[col] : ' ') != (col < len_b ? b[col] : ' '))
+      return false;
+  }
+
+  return true;
+}
+
+/**
+ * Parse an 8 character coordinate field, same result as sscanf("%f") on the
+ * field. Plain fixed point numbers are parsed without sscanf.
+ */
+static float pdb_parse_coord(const char* field)
+{
+  char cc[9];
+  memcpy(cc, field, 8);
+  cc[8] = 0;
+
+  const char* p = cc;
+  while (*p == ' ')
+    ++p;
+
+  bool const neg = (*p == '-');
+  if (neg || *p == '+')
+    ++p;
+
+  int mantissa = 0, scale = 1, ndigits = 0;
+  for (; isdigit(*p); ++p, ++ndigits)
+    mantissa = mantissa * 10 + (*p - '0');
+  if (*p == '.') {
+    for (++p; isdigit(*p); ++p, ++ndigits, scale *= 10)
+      mantissa = mantissa * 10 + (*p - '0');
+  }
+  while (*p == ' ')
+    ++p;
+
+  if (ndigits && !*p) {
+    // correctly rounded, double has more than 2 * 24 + 2 bits
+    float v = float(double(mantissa) / double(scale));
+    return neg ? -v : v;
+  }
+
+  float v = 0.f;
+  sscanf(cc, "%f", &v);
+  return v;
+}
+
+/**
+ * Read the coordinates of one model. Fails for records which
+ * ObjectMoleculePDBStr2CoordSet would read into anything but coordinates,
+ * and if the atoms differ from the template model.
+ *
+ * @param p Start of the model
+ * @param end End of the model (start of the next one)
+ * @param tmpl_lines ATOM/HETATM records of the first model
+ * @param[out] coord Coordinates
+ * @return False if the model needs the general reader
+ */
+static bool pdb_read_model_coords(const char* p, const char* end,
+    const std::vector<const char*>& tmpl_lines, float* coord)
+{
+  size_t a = 0;
+
+  for (; p < end; p = nextline(p)) {
+    if (pdb_is_atom_line(p)) {
+      if (a == tmpl_lines.size() || pdb_line_length(p) < 54 ||
+          !pdb_same_atom(p, tmpl_lines[a]))
+        return false;
+      for (int d = 0; d < 3; ++d) {
+        *(coord++) = pdb_parse_coord(p + 30 + 8 * d);
+      }
+      ++a;
+    } else if (!(strstartswith(p, "MODEL ") || strstartswith(p, "ENDMDL") ||
+                   strstartswith(p, "ANISOU") || strstartswith(p, "TER") ||
+                   strstartswith(p, "REMARK") || strstartswith(p, "USER") ||
+                   *p == '\r' || *p == '\n')) {
+      return false;
+    }
+  }
+
+  return a == tmpl_lines.size();
+}
+
+/**
+ * Fast path for multi-model files where all models have the same atoms in
+ * the same order (NMR ensembles, trajectories, docking poses).
+ *
+ * Finds the MODEL/ENDMDL boundaries after `*restart_model` and reads all
+ * models which are followed by another model in parallel, directly into new
+ * coordinate sets with the atom mapping of `tmpl`. The last model, and any
+ * model from the first one which doesn't match the template on, are left to
+ * ObjectMoleculePDBStr2CoordSet, which handles the end of the object.
+ *
+ * @param first_model Start of the buffer which was read into `tmpl`
+ * @param tmpl Coordinate set of the first model, after merging into `I`
+ * @param[in,out] restart_model Start of the next model. On return, start of
+ * the first model which was not read.
+ * @return New coordinate sets, one per model
+ */
+std::vector<CoordSet*> ObjectMoleculePDBStr2CoordSets(ObjectMolecule* I,
+    const char* first_model, const CoordSet* tmpl, const char** restart_model)
+{
+  std::vector<CoordSet*> csets;
+  int const nAtom = tmpl->NIndex;
+
+  // atom records of the first model, in coordinate set order
+  std::vector<const char*> tmpl_lines;
+  tmpl_lines.reserve(nAtom);
+  for (const char* p = first_model; *p && !strstartswith(p, "ENDMDL");
+       p = nextline(p)) {
+    if (pdb_is_atom_line(p))
+      tmpl_lines.push_back(p);
+  }
+
+  if (tmpl_lines.size() != size_t(nAtom) || !*restart_model)
+    return csets;
+
+  for (auto line : tmpl_lines) {
+    if (pdb_line_length(line) < 54)
+      return csets;
+  }
+
+  // PASS 1: model boundaries
+  std::vector<const char*> starts = {*restart_model};
+  for (const char* p = *restart_model; *p;) {
+    if (strstartswith(p, "ENDMDL")) {
+      p = nextline(p);
+      if (!strstartswith(p, "MODEL "))
+        break;
+      starts.push_back(p);
+    } else {
+      p = nextline(p);
+    }
+  }
+
+  int const n_models = starts.size() - 1;
+  if (n_models < 1)
+    return csets;
+
+  csets.resize(n_models);
+  for (auto& cs : csets) {
+    cs = CoordSetNew(I->G);
+    cs->NIndex = nAtom;
+    cs->Coord.resize(3 * nAtom);
+    cs->IdxToAtm = tmpl->IdxToAtm;
+    cs->Obj = I;
+  }
+
+  // PASS 2: coordinates
+  std::vector<char> valid(n_models);
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for schedule(dynamic, 4) if (n_models > 1)
+#endif
+  for (int m = 0; m < n_models; ++m) {
+    valid[m] = pdb_read_model_coords(
+        starts[m], starts[m + 1], tmpl_lines, csets[m]->Coord.data());
+    if (valid[m])
+      csets[m]->updateNonDiscreteAtmToIdx(I->NAtom);
+  }
+
+  int const n_valid =
+      std::find(valid.begin(), valid.end(), false) - valid.begin();
+  for (int m = n_valid; m < n_models; ++m) {
+    delete csets[m];
+  }
+  csets.resize(n_valid);
+
+  *restart_model = starts[n_valid];
+
+  PRINTFB(I->G, FB_ObjectMolecule, FB_Blather)
+    " %s: read %d of %d models in parallel\n", __func__, n_valid,
+    n_models ENDFB(I->G);
+
+  return csets;
+}
+
 
 /*========================================================================*/
 
@@ -3781,7 +4070,7 @@ bool ObjectMoleculeConnect(ObjectMolecule* I, int& nBond, pymol::vla<BondType>&
         MapNew(G, (max_cutoff + MAX_VDW) * (offset_begin ? -1 : 1), //
             cs->Coord, cs->NIndex));
     p_return_val_if_fail(map, false); // memory error
-    MapSetupExpress(map.get()); // Don't let MapEIter call this in omp parallel
+    MapSetupCSR(map.get()); // Don't let MapEIter call this in omp parallel
 
     /// Return false on error
     auto const find_bonds_for_atom = [&](unsigned i, float const* v1,
@@ -4090,6 +4379,7 @@ int ObjectMoleculeSort(ObjectMolecule * I)
       }
 
       I->updateAtmToIdx();
+      I->AtomOrderGeneration++;
 
       ExecutiveUniqueIDAtomDictInvalidate(I->G);
 
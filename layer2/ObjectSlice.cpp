@@ -213,7 +213,7 @@ void ObjectSlice::invalidate(cRep_t rep, cRepInv_t level, int state)
     if(!once_flag)
       state = a;
     State[state].RefreshFlag = true;
-    SceneChanged(G);
+    SceneObjectChanged(G, this);
     if(once_flag)
       break;
   }
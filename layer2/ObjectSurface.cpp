@@ -290,13 +290,13 @@ void ObjectSurface::invalidate(cRep_t rep, cRepInv_t level, int state)
 	if(I->State[state].shaderCGO){
 	  I->State[state].shaderCGO.reset();
 	}
-        SceneChanged(I->G);
+        SceneObjectChanged(I->G, I);
       } else if(level >= cRepInvColor) {
         I->State[state].RecolorFlag = true;
 	if(I->State[state].shaderCGO){
 	  I->State[state].shaderCGO.reset();
 	}
-        SceneChanged(I->G);
+        SceneObjectChanged(I->G, I);
       } else {
         SceneInvalidate(I->G);
       }
@@ -366,6 +366,7 @@ static void ObjectSurfaceStateUpdateColors(ObjectSurface * I, ObjectSurfaceState
         vc = ms->VC.empty() ? nullptr : ms->VC.data();
         v += 3;
         if(vc) {
+          ColorRampBatch ramp_batch;
           for(a = 0; a < n_vert; a++) {
             if(a == base_n_vert) {
               int new_color = SettingGet_color(I->G, I->Setting.get(),
@@ -378,7 +379,7 @@ static void ObjectSurfaceStateUpdateColors(ObjectSurface * I, ObjectSurfaceState
               }
             }
             if(ColorCheckRamped(I->G, cur_color)) {
-              ColorGetRamped(I->G, cur_color, v, vc, state);
+              ramp_batch.add(cur_color, v, vc);
               *rc = cur_color;
               ramped_flag = true;
             } else {
@@ -389,6 +390,7 @@ static void ObjectSurfaceStateUpdateColors(ObjectSurface * I, ObjectSurfaceState
             vc += 3;
             v += 6;             /* alternates with normals */
           }
+          ramp_batch.flush(I->G, state);
         }
       }
       break;
@@ -410,6 +412,7 @@ static void ObjectSurfaceStateUpdateColors(ObjectSurface * I, ObjectSurfaceState
         rc = ms->RC.data();
         vc = ms->VC.empty() ? nullptr : ms->VC.data();
         if(vc) {
+          ColorRampBatch ramp_batch;
           for(a = 0; a < n_vert; a++) {
             if(a == base_n_vert) {
               int new_color = SettingGet_color(I->G, I->Setting.get(),
@@ -422,7 +425,7 @@ static void ObjectSurfaceStateUpdateColors(ObjectSurface * I, ObjectSurfaceState
             }
 
             if(ColorCheckRamped(I->G, cur_color)) {
-              ColorGetRamped(I->G, cur_color, v, vc, state);
+              ramp_batch.add(cur_color, v, vc);
               *rc = cur_color;
               ramped_flag = true;
             } else {
@@ -433,6 +436,7 @@ static void ObjectSurfaceStateUpdateColors(ObjectSurface * I, ObjectSurfaceState
             vc += 3;
             v += 3;
           }
+          ramp_batch.flush(I->G, state);
         }
       }
       break;
@@ -356,7 +356,7 @@ void ObjectVolume::invalidate(cRep_t rep, cRepInv_t level, int state)
         I->State[state].ResurfaceFlag = true;
         I->State[state].RefreshFlag = true;
       }
-      SceneChanged(I->G);
+      SceneObjectChanged(I->G, I);
       if(once_flag)
         break;
     }
@@ -0,0 +1,538 @@
+/**
+ * @file
+ * Bounding volume hierarchy over the pickable atoms and half-bonds of a
+ * coordinate set, for CPU (ray-cast) picking
+ */
+
+#include "PickBVH.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "CoordSet.h"
+#include "ObjectMolecule.h"
+#include "Picking.h"
+#include "Setting.h"
+#include "Vector.h"
+
+#define PICK_BVH_LEAF_SIZE 4
+
+namespace pymol
+{
+
+bool PickHit::worseThan(const PickHit& other) const
+{
+  if (index < 0)
+    return true;
+  // compare in whole pixels, like the ring search of color buffer picking
+  float const ring = std::ceil(miss), other_ring = std::ceil(other.miss);
+  if (other_ring != ring)
+    return other_ring < ring;
+  return other.depth < depth;
+}
+
+/**
+ * Point on a half-bond (idx0 -> midpoint)
+ */
+static void HalfBondEnd(const float* coord, int idx0, int idx1, float* v)
+{
+  average3f(coord + idx0 * 3, coord + idx1 * 3, v);
+}
+
+/**
+ * Half-extent of the cartoon cross section at a guide atom. Resolves
+ * cCartoon_auto by secondary structure like RepCartoon does.
+ */
+class CartoonPickRadius
+{
+  float m_loop, m_rect, m_oval, m_tube, m_dumbbell, m_putty, m_helix;
+  int m_cylindrical_helices;
+  bool m_fancy_helices, m_fancy_sheets;
+
+public:
+  explicit CartoonPickRadius(const CoordSet* cs)
+  {
+    m_loop = SettingGet<float>(*cs, cSetting_cartoon_loop_radius);
+    m_rect = SettingGet<float>(*cs, cSetting_cartoon_rect_length);
+    m_oval = SettingGet<float>(*cs, cSetting_cartoon_oval_length);
+    m_tube = SettingGet<float>(*cs, cSetting_cartoon_tube_radius);
+    m_dumbbell = SettingGet<float>(*cs, cSetting_cartoon_dumbbell_length);
+    m_helix = SettingGet<float>(*cs, cSetting_cartoon_helix_radius);
+    // upper bound, the actual radius depends on the b-factor
+    m_putty = SettingGet<float>(*cs, cSetting_cartoon_putty_radius) *
+              std::max(1.f, SettingGet<float>(*cs, cSetting_cartoon_putty_scale_max));
+    m_cylindrical_helices =
+        SettingGet<int>(*cs, cSetting_cartoon_cylindrical_helices);
+    m_fancy_helices = SettingGet<bool>(*cs, cSetting_cartoon_fancy_helices);
+    m_fancy_sheets = SettingGet<bool>(*cs, cSetting_cartoon_fancy_sheets);
+  }
+
+  float operator()(const AtomInfoType* ai) const
+  {
+    int cartoon = ai->cartoon;
+
+    if (cartoon == cCartoon_auto) {
+      switch (ai->ssType[0]) {
+      case 'H':
+      case 'h':
+        if (m_cylindrical_helices) {
+          return m_helix;
+        }
+        cartoon = m_fancy_helices ? cCartoon_dumbbell : cCartoon_oval;
+        break;
+      case 'S':
+      case 's':
+        cartoon = m_fancy_sheets ? cCartoon_arrow : cCartoon_rect;
+        break;
+      default:
+        cartoon = cCartoon_loop;
+      }
+    }
+
+    switch (cartoon) {
+    case cCartoon_rect:
+    case cCartoon_arrow:
+      return m_rect;
+    case cCartoon_oval:
+      return m_oval;
+    case cCartoon_dumbbell:
+      return m_dumbbell;
+    case cCartoon_tube:
+      return m_tube;
+    case cCartoon_putty:
+      return m_putty;
+    case cCartoon_cylinder:
+    case cCartoon_skip_helix:
+      return m_helix;
+    default:
+      return m_loop;
+    }
+  }
+};
+
+PickBVH::PickBVH(const CoordSet* cs)
+{
+  const ObjectMolecule* obj = cs->Obj;
+  PyMOLGlobals* G = obj->G;
+
+  auto const sphere_scale = SettingGet<float>(*cs, cSetting_sphere_scale);
+  auto const stick_radius = SettingGet<float>(*cs, cSetting_stick_radius);
+  auto const nb_spheres_size =
+      SettingGet<float>(*cs, cSetting_nb_spheres_size);
+  CartoonPickRadius const cartoon_radius(cs);
+  auto const pickable = SettingGet<bool>(*cs, cSetting_pickable);
+
+  std::vector<char> atom_ok(cs->NIndex);
+
+  for (int idx = 0; idx < cs->NIndex; ++idx) {
+    int const atm = cs->IdxToAtm[idx];
+    const AtomInfoType* ai = obj->AtomInfo + atm;
+    int const vis = ai->visRep;
+
+    if (ai->masked || !AtomSettingGetWD(G, ai, cSetting_pickable, pickable))
+      continue;
+
+    atom_ok[idx] = true;
+
+    float radius = -1.f;
+    if (vis & (cRepSphereBit | cRepEllipsoidBit)) {
+      radius = std::max(radius,
+          ai->vdw * AtomSettingGetWD(G, ai, cSetting_sphere_scale, sphere_scale));
+    }
+    if (vis & (cRepSurfaceBit | cRepMeshBit | cRepDotBit)) {
+      radius = std::max(radius, ai->vdw);
+    }
+    if (ai->bonded) {
+      if (vis & cRepCylBit) {
+        radius = std::max(radius,
+            AtomSettingGetWD(G, ai, cSetting_stick_radius, stick_radius));
+      }
+      if (vis & cRepLineBit) {
+        radius = std::max(radius, 0.f);
+      }
+    } else {
+      if (vis & cRepNonbondedSphereBit) {
+        radius = std::max(radius, nb_spheres_size);
+      }
+      if (vis & cRepNonbondedBit) {
+        radius = std::max(radius, 0.f);
+      }
+    }
+    if ((vis & (cRepCartoonBit | cRepRibbonBit)) &&
+        (ai->flags & cAtomFlag_guide)) {
+      radius = std::max(radius, (vis & cRepCartoonBit) ? cartoon_radius(ai) : 0.f);
+    }
+
+    if (radius >= 0.f) {
+      m_prims.push_back({atm, cPickableAtom, idx, -1, radius});
+    }
+  }
+
+  for (int b = 0; b < obj->NBond; ++b) {
+    const BondType* bond = obj->Bond + b;
+    if (bond->hasSymOp())
+      continue;
+
+    int const idx[2] = {
+        cs->atmToIdx(bond->index[0]), cs->atmToIdx(bond->index[1])};
+    if (idx[0] < 0 || idx[1] < 0)
+      continue;
+
+    for (int k = 0; k < 2; ++k) {
+      if (!atom_ok[idx[k]])
+        continue;
+
+      int const atm = bond->index[k];
+      int const vis = obj->AtomInfo[atm].visRep;
+      float radius;
+      if (vis & cRepCylBit) {
+        radius = BondSettingGetWD(G, bond, cSetting_stick_radius,
+            AtomSettingGetWD(G, obj->AtomInfo + atm, cSetting_stick_radius,
+                stick_radius));
+      } else if (vis & cRepLineBit) {
+        radius = 0.f;
+      } else {
+        continue;
+      }
+
+      m_prims.push_back({atm, b, idx[k], idx[1 - k], radius});
+    }
+  }
+
+  if (!m_prims.empty()) {
+    m_nodes.reserve(2 * (m_prims.size() / PICK_BVH_LEAF_SIZE) + 1);
+    build(cs->Coord.data(), 0, m_prims.size());
+  }
+}
+
+void PickBVH::primBounds(
+    const float* coord, const Prim& prim, float* lo, float* hi) const
+{
+  const float* v0 = coord + prim.idx0 * 3;
+  if (prim.idx1 < 0) {
+    for (int d = 0; d < 3; ++d) {
+      lo[d] = v0[d] - prim.radius;
+      hi[d] = v0[d] + prim.radius;
+    }
+  } else {
+    float v1[3];
+    HalfBondEnd(coord, prim.idx0, prim.idx1, v1);
+    for (int d = 0; d < 3; ++d) {
+      lo[d] = std::min(v0[d], v1[d]) - prim.radius;
+      hi[d] = std::max(v0[d], v1[d]) + prim.radius;
+    }
+  }
+}
+
+/**
+ * Recursive top-down build with median split along the longest axis of the
+ * primitive centers.
+ *
+ * @return Node index
+ */
+int PickBVH::build(const float* coord, int first, int count)
+{
+  int const node_index = m_nodes.size();
+  m_nodes.emplace_back();
+
+  float lo[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+  float hi[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+  float clo[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+  float chi[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+  for (int i = first; i < first + count; ++i) {
+    float plo[3], phi[3];
+    primBounds(coord, m_prims[i], plo, phi);
+    for (int d = 0; d < 3; ++d) {
+      float const c = (plo[d] + phi[d]) * 0.5f;
+      lo[d] = std::min(lo[d], plo[d]);
+      hi[d] = std::max(hi[d], phi[d]);
+      clo[d] = std::min(clo[d], c);
+      chi[d] = std::max(chi[d], c);
+    }
+  }
+
+  int axis = 0;
+  for (int d = 1; d < 3; ++d) {
+    if (chi[d] - clo[d] > chi[axis] - clo[axis])
+      axis = d;
+  }
+
+  int right = -1;
+
+  if (count > PICK_BVH_LEAF_SIZE && chi[axis] > clo[axis]) {
+    auto center = [&](const Prim& prim) {
+      float plo[3], phi[3];
+      primBounds(coord, prim, plo, phi);
+      return plo[axis] + phi[axis];
+    };
+
+    int const mid = first + count / 2;
+    std::nth_element(m_prims.begin() + first, m_prims.begin() + mid,
+        m_prims.begin() + first + count,
+        [&](const Prim& a, const Prim& b) { return center(a) < center(b); });
+
+    build(coord, first, mid - first);
+    right = build(coord, mid, first + count - mid);
+    first = count = 0;
+  }
+
+  auto& node = m_nodes[node_index];
+  copy3f(lo, node.lo);
+  copy3f(hi, node.hi);
+  node.first = first;
+  node.count = count;
+  node.right = right;
+
+  return node_index;
+}
+
+/**
+ * Update the bounding boxes for new coordinates (same primitives)
+ */
+void PickBVH::refit(const CoordSet* cs)
+{
+  const float* coord = cs->Coord.data();
+
+  // children always come after their parent
+  for (int i = int(m_nodes.size()) - 1; i >= 0; --i) {
+    auto& node = m_nodes[i];
+    if (node.count) {
+      primBounds(coord, m_prims[node.first], node.lo, node.hi);
+      for (int p = node.first + 1; p < node.first + node.count; ++p) {
+        float plo[3], phi[3];
+        primBounds(coord, m_prims[p], plo, phi);
+        for (int d = 0; d < 3; ++d) {
+          node.lo[d] = std::min(node.lo[d], plo[d]);
+          node.hi[d] = std::max(node.hi[d], phi[d]);
+        }
+      }
+    } else {
+      const auto& left = m_nodes[i + 1];
+      const auto& right = m_nodes[node.right];
+      for (int d = 0; d < 3; ++d) {
+        node.lo[d] = std::min(left.lo[d], right.lo[d]);
+        node.hi[d] = std::max(left.hi[d], right.hi[d]);
+      }
+    }
+  }
+
+  m_coordsDirty = false;
+}
+
+/**
+ * Slab test of the ray against a box, expanded by `pad`
+ *
+ * @param[out] tnear Entry depth
+ */
+static bool RayBox(const PickRay& ray, const float* lo, const float* hi,
+    float pad, float& tnear)
+{
+  float t0 = ray.tmin, t1 = ray.tmax;
+  for (int d = 0; d < 3; ++d) {
+    float const blo = lo[d] - pad, bhi = hi[d] + pad;
+    if (std::fabs(ray.dir[d]) < R_SMALL8) {
+      if (ray.origin[d] < blo || ray.origin[d] > bhi)
+        return false;
+      continue;
+    }
+    float const inv = 1.f / ray.dir[d];
+    float ta = (blo - ray.origin[d]) * inv;
+    float tb = (bhi - ray.origin[d]) * inv;
+    if (ta > tb)
+      std::swap(ta, tb);
+    t0 = std::max(t0, ta);
+    t1 = std::min(t1, tb);
+    if (t0 > t1)
+      return false;
+  }
+  tnear = t0;
+  return true;
+}
+
+/**
+ * Closest approach of the ray to point `v`
+ *
+ * @param[out] t Ray parameter (depth)
+ * @return Distance
+ */
+static float RayPointDistance(const PickRay& ray, const float* v, float& t)
+{
+  float ov[3], p[3];
+  subtract3f(v, ray.origin, ov);
+  t = dot_product3f(ov, ray.dir) / lengthsq3f(ray.dir);
+  scale3f(ray.dir, t, p);
+  add3f(ray.origin, p, p);
+  return diff3f(v, p);
+}
+
+bool PickBVH::intersect(const CoordSet* cs, const PickRay& ray, PickHit& hit)
+{
+  if (m_nodes.empty())
+    return false;
+
+  if (m_coordsDirty)
+    refit(cs);
+
+  const float* coord = cs->Coord.data();
+  float const dir_len = length3f(ray.dir);
+  float const pad =
+      ray.tolerance * (ray.pixel0 + ray.pixel1 * std::max(0.f, ray.tmax));
+  bool found = false;
+
+  // median splits keep this shallow, but never drop subtrees
+  std::vector<int> stack;
+  stack.reserve(64);
+  stack.push_back(0);
+
+  while (!stack.empty()) {
+    const auto& node = m_nodes[stack.back()];
+    stack.pop_back();
+
+    float tnear;
+    if (!RayBox(ray, node.lo, node.hi, pad, tnear))
+      continue;
+
+    // can't beat a direct hit in front of this box
+    if (hit.index >= 0 && hit.miss == 0.f && tnear > hit.depth)
+      continue;
+
+    if (!node.count) {
+      stack.push_back(node.right);
+      stack.push_back(&node - m_nodes.data() + 1);
+      continue;
+    }
+
+    for (int p = node.first; p < node.first + node.count; ++p) {
+      const auto& prim = m_prims[p];
+      const float* v0 = coord + prim.idx0 * 3;
+      float closest[3];
+
+      if (prim.idx1 < 0) {
+        copy3f(v0, closest);
+      } else {
+        // closest point on the half-bond segment to the ray (line)
+        float v1[3], seg[3], w[3];
+        HalfBondEnd(coord, prim.idx0, prim.idx1, v1);
+        subtract3f(v1, v0, seg);
+        subtract3f(ray.origin, v0, w);
+        float const a = lengthsq3f(ray.dir);
+        float const b = dot_product3f(ray.dir, seg);
+        float const c = lengthsq3f(seg);
+        float const d = dot_product3f(ray.dir, w);
+        float const e = dot_product3f(seg, w);
+        float const denom = a * c - b * b;
+        float s = 0.f;
+        if (denom > R_SMALL8)
+          s = std::clamp((a * e - b * d) / denom, 0.f, 1.f);
+        else if (c > R_SMALL8)
+          s = std::clamp(e / c, 0.f, 1.f);
+        scale3f(seg, s, closest);
+        add3f(v0, closest, closest);
+      }
+
+      float t;
+      float const dist = RayPointDistance(ray, closest, t);
+      if (t < ray.tmin || t > ray.tmax)
+        continue;
+
+      PickHit candidate;
+      candidate.index = prim.atm;
+      candidate.bond = prim.bond;
+
+      if (dist <= prim.radius) {
+        candidate.depth =
+            t - std::sqrt(prim.radius * prim.radius - dist * dist) / dir_len;
+      } else {
+        float const pixel = ray.pixel0 + ray.pixel1 * t;
+        candidate.depth = t;
+        candidate.miss = (dist - prim.radius) / std::max(pixel, R_SMALL8);
+        if (candidate.miss > ray.tolerance)
+          continue;
+      }
+
+      if (hit.worseThan(candidate)) {
+        hit = candidate;
+        found = true;
+      }
+    }
+  }
+
+  return found;
+}
+
+void PickBVH::intersect(const CoordSet* cs, const float (*planes)[4],
+    int n_planes, std::vector<int>& atoms)
+{
+  if (m_nodes.empty())
+    return;
+
+  if (m_coordsDirty)
+    refit(cs);
+
+  const float* coord = cs->Coord.data();
+
+  // median splits keep this shallow, but never drop subtrees
+  std::vector<int> stack;
+  stack.reserve(64);
+  stack.push_back(0);
+
+  while (!stack.empty()) {
+    const auto& node = m_nodes[stack.back()];
+    stack.pop_back();
+
+    // box completely outside of any plane?
+    bool outside = false;
+    for (int k = 0; k < n_planes && !outside; ++k) {
+      const float* n = planes[k];
+      float const pv[3] = {
+          n[0] >= 0.f ? node.hi[0] : node.lo[0],
+          n[1] >= 0.f ? node.hi[1] : node.lo[1],
+          n[2] >= 0.f ? node.hi[2] : node.lo[2],
+      };
+      outside = dot_product3f(n, pv) + n[3] < 0.f;
+    }
+    if (outside)
+      continue;
+
+    if (!node.count) {
+      stack.push_back(node.right);
+      stack.push_back(&node - m_nodes.data() + 1);
+      continue;
+    }
+
+    for (int p = node.first; p < node.first + node.count; ++p) {
+      const auto& prim = m_prims[p];
+      const float* v0 = coord + prim.idx0 * 3;
+      float v1[3];
+      if (prim.idx1 < 0) {
+        copy3f(v0, v1);
+      } else {
+        HalfBondEnd(coord, prim.idx0, prim.idx1, v1);
+      }
+
+      // clip the segment v0 -> v1 against all planes
+      float s0 = 0.f, s1 = 1.f;
+      for (int k = 0; k < n_planes && s0 <= s1; ++k) {
+        const float* n = planes[k];
+        float const f0 = dot_product3f(n, v0) + n[3] + prim.radius;
+        float const f1 = dot_product3f(n, v1) + n[3] + prim.radius;
+        if (f0 < 0.f && f1 < 0.f) {
+          s0 = 1.f;
+          s1 = 0.f;
+        } else if (f0 < 0.f) {
+          s0 = std::max(s0, f0 / (f0 - f1));
+        } else if (f1 < 0.f) {
+          s1 = std::min(s1, f0 / (f0 - f1));
+        }
+      }
+
+      if (s0 <= s1) {
+        atoms.push_back(prim.atm);
+      }
+    }
+  }
+}
+
+} // namespace pymol
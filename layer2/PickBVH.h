@@ -0,0 +1,95 @@
+/**
+ * @file
+ * Bounding volume hierarchy over the pickable atoms and half-bonds of a
+ * coordinate set, for CPU (ray-cast) picking
+ */
+
+#pragma once
+
+#include <vector>
+
+struct CoordSet;
+
+namespace pymol
+{
+
+/**
+ * Pick ray in the coordinate space of a coordinate set. The ray parameter
+ * `t` is the camera space depth (`dir` advances by one unit of depth).
+ */
+struct PickRay {
+  float origin[3];
+  float dir[3];
+  float tmin, tmax;       ///< clipping planes
+  float pixel0, pixel1;   ///< size of a pixel at depth t: pixel0 + pixel1 * t
+  float tolerance;        ///< max distance from the ray in pixels
+};
+
+struct PickHit {
+  int index = -1;         ///< atom index
+  int bond = -1;          ///< bond index or cPickableAtom
+  float depth = 0.f;
+  float miss = 0.f;       ///< distance from the ray in pixels (0 = direct hit)
+
+  /// True if `other` is a better hit than this one
+  bool worseThan(const PickHit& other) const;
+};
+
+/**
+ * BVH over spheres (atoms) and capsules (half-bonds) with radii from the
+ * visible representations (spheres, sticks, lines, cartoon guide atoms,
+ * ...). Built lazily and owned by the coordinate set. Coordinate changes
+ * only refit the bounding boxes, visibility changes require a rebuild.
+ */
+class PickBVH
+{
+public:
+  explicit PickBVH(const CoordSet* cs);
+
+  /// Coordinates changed, refit before the next query
+  void invalidateCoords() { m_coordsDirty = true; }
+
+  /**
+   * Find the closest primitive along the ray, within the ray's tolerance.
+   * @param[in,out] hit Only updated if a better hit is found
+   * @return True if `hit` was updated
+   */
+  bool intersect(const CoordSet* cs, const PickRay& ray, PickHit& hit);
+
+  /**
+   * Collect the atoms of all primitives which are (partially) inside a
+   * convex volume.
+   *
+   * @param planes Plane equations (unit normal, offset) with the inside
+   * in positive direction
+   * @param[out] atoms Atom indices (appended, may contain duplicates)
+   */
+  void intersect(const CoordSet* cs, const float (*planes)[4], int n_planes,
+      std::vector<int>& atoms);
+
+private:
+  struct Prim {
+    int atm;
+    int bond;   // cPickableAtom for atoms
+    int idx0;   // coordinate index
+    int idx1;   // other end of a half-bond, or -1
+    float radius;
+  };
+
+  struct Node {
+    float lo[3], hi[3];
+    int first, count; // primitive range (leaf if count > 0)
+    int right;        // right child (left child is the next node)
+  };
+
+  void primBounds(const float* coord, const Prim& prim, float* lo,
+      float* hi) const;
+  int build(const float* coord, int first, int count);
+  void refit(const CoordSet* cs);
+
+  std::vector<Prim> m_prims;
+  std::vector<Node> m_nodes;
+  bool m_coordsDirty = false;
+};
+
+} // namespace pymol
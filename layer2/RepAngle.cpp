@@ -40,6 +40,7 @@ struct RepAngle : Rep {
 
   cRep_t type() const override { return cRepAngle; }
   void render(RenderInfo* info) override;
+  pymol::MemorySize getMemorySize() const override;
 
   pymol::vla<float> V;
   int N = 0;
@@ -56,6 +57,14 @@ RepAngle::~RepAngle()
   CGOFree(shaderCGO);
 }
 
+pymol::MemorySize RepAngle::getMemorySize() const
+{
+  auto size = Rep::getMemorySize();
+  size.host += pymol::memory_size(V);
+  size += CGOGetMemorySize(shaderCGO);
+  return size;
+}
+
 static int RepAngleCGOGenerate(RepAngle * I, RenderInfo * info)
 {
   PyMOLGlobals *G = I->G;
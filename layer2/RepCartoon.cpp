@@ -16,7 +16,10 @@ I* Additional authors of this source file include:
 Z* -------------------------------------------------------------------
 */
 
+#include <algorithm>
+#include <memory>
 #include <set>
+#include <vector>
 
 #include"os_predef.h"
 #include"os_std.h"
@@ -30,13 +33,19 @@ Z* -------------------------------------------------------------------
 #include"Word.h"
 #include"Feedback.h"
 #include"CGO.h"
+#include"CGOStreamBuilder.h"
 #include"Extrude.h"
+#include"LevelOfDetail.h"
 #include"ShaderMgr.h"
 #include "Lex.h"
 #include "CoordSet.h"
 
 #include "AtomIterators.h"
 
+#ifdef PYMOL_OPENMP
+#include <omp.h>
+#endif
+
 enum {
   CARTOON_CYLINDRICAL_HELICES_CURVED = 1,
   CARTOON_CYLINDRICAL_HELICES_STRAIGHT = 2
@@ -58,39 +67,19 @@ public:
   bool operator== (const CCInOut &other) const { return cc_in == other.cc_in; }
 };
 
-struct RepCartoon : Rep {
-  using Rep::Rep;
-
-  ~RepCartoon() override;
-
-  cRep_t type() const override { return cRepCartoon; }
-  void render(RenderInfo* info) override;
-  void invalidate(cRepInv_t level) override;
-  bool sameVis() const override;
-
-  CGO* ray = nullptr;
-  CGO* std = nullptr;
-  CGO* preshader = nullptr;
-
-  /**
-   * Free the preshader CGO or move to another owner.
-   * @post preshader == nullptr
-   */
-  void disposePreshaderCGO() {
-    if (!ray) {
-      std::swap(ray, preshader);
-    } else {
-      CGOFree(preshader);
-    }
-  }
-
-  char* LastVisib = nullptr;
-};
-
 #include"ObjectMolecule.h"
 
 #define ESCAPE_MAX 500
 
+void RepCartoon::disposePreshaderCGO()
+{
+  if (!ray) {
+    std::swap(ray, preshader);
+  } else {
+    CGOFree(preshader);
+  }
+}
+
 RepCartoon::~RepCartoon()
 {
   auto I = this;
@@ -101,6 +90,20 @@ RepCartoon::~RepCartoon()
   FreeP(I->LastVisib);
 }
 
+pymol::MemorySize RepCartoon::getMemorySize() const
+{
+  auto size = Rep::getMemorySize();
+  size += CGOGetMemorySize(ray);
+  size += CGOGetMemorySize(std);
+  size += CGOGetMemorySize(preshader);
+  for (auto& rep : coarse) {
+    if (rep) {
+      size += rep->getMemorySize();
+    }
+  }
+  return size;
+}
+
 /**
  * CGOAddTwoSidedBackfaceSpecialOps: this function takes in a CGO,
  * and outputs a CGO with that CGO wrapped with the two operations:
@@ -201,12 +204,28 @@ static int RepCartoonCGOGenerate(RepCartoon * I, RenderInfo * info)
         }
       }
 
-      /* For the rest of the primitives that exist, simplify them into Geometry
-       * (should probably be no more, but do this anyway) */
-      std::unique_ptr<CGO> leftOverCGOSimplified(CGOSimplify(leftOverCGOBorrowed));
-      if (leftOverCGOSimplified) {
+      /* Stream the extruded triangles straight into draw buffers. Only the
+       * rest of the primitives (should probably be no more, but do this
+       * anyway) get simplified into Geometry first */
+      pymol::CGOStreamBuilder builder(G);
+      std::unique_ptr<CGO> primitivesCGO(CGONew(G));
+      ok &= builder.append(leftOverCGOBorrowed, primitivesCGO.get());
+      CGOStop(primitivesCGO.get());
+
+      std::unique_ptr<CGO> notTrianglesCGO(CGONew(G));
+      std::unique_ptr<CGO> primitivesSimplified(CGOSimplify(primitivesCGO.get()));
+      if (ok && primitivesSimplified) {
+        ok &= builder.append(primitivesSimplified.get(), notTrianglesCGO.get());
+      }
+      CGOStop(notTrianglesCGO.get());
+
+      if (ok && !builder.empty()) {
+        convertcgo->free_append(builder.finish());
+      }
+      if (ok && CGOHasOperationsOfTypeN(notTrianglesCGO.get(),
+                    {CGO_BEGIN, CGO_DRAW_ARRAYS})) {
         std::unique_ptr<CGO> optimized(
-            CGOOptimizeToVBONotIndexed(leftOverCGOSimplified.get()));
+            CGOOptimizeToVBONotIndexed(notTrianglesCGO.get()));
         if (optimized) {
           convertcgo->move_append(std::move(*optimized));
         }
@@ -238,10 +257,26 @@ static int RepCartoonCGOGenerate(RepCartoon * I, RenderInfo * info)
   return ok;
 }
 
+static RepCartoon* RepCartoonNewLevel(CoordSet* cs, int state, int lod_level);
+
 void RepCartoon::render(RenderInfo* info)
 {
   auto I = this;
 
+  int const level = I->lod.select(G, info);
+  if (level > 0) {
+    auto& coarse = I->coarse[level - 1];
+    if (!coarse) {
+      coarse.reset(RepCartoonNewLevel(I->cs, I->getState(), level));
+    }
+    if (coarse) {
+      coarse->render(info);
+      // CoordSet::render picks the pass from this rep
+      I->setHasTransparency(coarse->hasTransparency());
+      return;
+    }
+  }
+
   if (info->ray) {
 #ifndef _PYMOL_NO_RAY
     CGO* raycgo = I->ray ? I->ray : I->preshader;
@@ -251,6 +286,8 @@ void RepCartoon::render(RenderInfo* info)
       PRINTFB(G, FB_RepCartoon, FB_Warnings)
         " %s-Warning: ray rendering failed\n", __func__ ENDFB(G);
       CGOFree(I->ray);
+    } else if (raycgo) {
+      pymol::LodStatsAdd(G, info, I->lodLevel, CGOCountTriangles(raycgo));
     }
 #endif
     return;
@@ -266,6 +303,8 @@ void RepCartoon::render(RenderInfo* info)
         I->disposePreshaderCGO();
         I->invalidate(cRepInvPurge);
         I->cs->Active[cRepCartoon] = false;
+      } else {
+        I->nTriangles = CGOCountTriangles(I->std);
       }
     }
 
@@ -277,6 +316,7 @@ void RepCartoon::render(RenderInfo* info)
                            I->cs->Setting.get(), I->obj->Setting.get());
       } else {
         CGORender(I->std, nullptr, I->cs->Setting.get(), I->obj->Setting.get(), info, I);
+        pymol::LodStatsAdd(G, info, I->lodLevel, I->nTriangles);
       }
     }
   }
@@ -2078,6 +2118,7 @@ void CartoonGenerateSample(PyMOLGlobals *G, int sampling, int *n_p, float dev, f
   float f0, f1, f2, f3, f4;
   float a0;
   const float *v0;
+  float rgb[3]; /* not ColorGet's buffer, called from worker threads */
   unsigned int *vi = *vi_p;
   float *valpha = *valpha_p;
   float *vc = *vc_p, *v = *v_p, *vn = *vn_p;
@@ -2086,11 +2127,13 @@ void CartoonGenerateSample(PyMOLGlobals *G, int sampling, int *n_p, float dev, f
       /* provide starting point on first point in segment only... */
       f0 = ((float) b) / sampling;      /* fraction of completion */
       if(f0 <= 0.5) {
-        v0 = ColorGet(G, c1);
+        ColorGetCopy(G, c1, rgb);
+        v0 = rgb;
         i0 = atom_index1;
         a0 = alpha1;
       } else {
-        v0 = ColorGet(G, c2);
+        ColorGetCopy(G, c2, rgb);
+        v0 = rgb;
         i0 = atom_index2;
         a0 = alpha2;
       }
@@ -2116,11 +2159,13 @@ void CartoonGenerateSample(PyMOLGlobals *G, int sampling, int *n_p, float dev, f
     }
     f0 = ((float) b + 1) / sampling;
     if(f0 <= 0.5) {
-      v0 = ColorGet(G, c1);
+      ColorGetCopy(G, c1, rgb);
+      v0 = rgb;
       i0 = atom_index1;
       a0 = alpha1;
     } else {
-      v0 = ColorGet(G, c2);
+      ColorGetCopy(G, c2, rgb);
+      v0 = rgb;
       i0 = atom_index2;
       a0 = alpha2;
     }
@@ -2285,7 +2330,11 @@ int CartoonExtrudeRect(PyMOLGlobals *G, CExtrude *ex, CGO *cgo, float width, flo
       if (ok)
         ExtrudeBuildNormals2f(ex);
       if (ok)
-        ok &= ExtrudeCGOSurfacePolygon(ex, cgo, cCylCap::Flat, ColorGet(G, highlight_color));
+        {
+        float rgb[3];
+        ColorGetCopy(G, highlight_color, rgb);
+        ok &= ExtrudeCGOSurfacePolygon(ex, cgo, cCylCap::Flat, rgb);
+      }
     }
   }
   return ok;
@@ -2300,8 +2349,11 @@ int CartoonExtrudeOval(PyMOLGlobals *G, CExtrude *ex, CGO *cgo, short use_cylind
   if (ok){
     if(highlight_color < 0)
       ok &= ExtrudeCGOSurfaceTube(ex, cgo, cCylCap::Flat, nullptr, use_cylinders_for_strands);
-    else
-      ok &= ExtrudeCGOSurfaceTube(ex, cgo, cCylCap::Flat, ColorGet(G, highlight_color), use_cylinders_for_strands);
+    else {
+      float rgb[3];
+      ColorGetCopy(G, highlight_color, rgb);
+      ok &= ExtrudeCGOSurfaceTube(ex, cgo, cCylCap::Flat, rgb, use_cylinders_for_strands);
+    }
   }
   return ok;
 }
@@ -2315,8 +2367,11 @@ int CartoonExtrudeArrow(PyMOLGlobals *G, CExtrude *ex, CGO *cgo, int sampling, f
   if (ok){
     if(highlight_color < 0)
       ok &= ExtrudeCGOSurfaceStrand(ex, cgo, sampling, nullptr);
-    else
-      ok &= ExtrudeCGOSurfaceStrand(ex, cgo, sampling, ColorGet(G, highlight_color));
+    else {
+      float rgb[3];
+      ColorGetCopy(G, highlight_color, rgb);
+      ok &= ExtrudeCGOSurfaceStrand(ex, cgo, sampling, rgb);
+    }
   }
   /* for PLY files      
      ExtrudeCircle(ex,loop_quality,loop_radius);
@@ -2346,9 +2401,11 @@ int CartoonExtrudeDumbbell(PyMOLGlobals *G, CExtrude *ex, CGO *cgo, int sampling
       ok &= ExtrudeDumbbell1(ex, dumbbell_width, dumbbell_length, 2);
     if (ok)
       ExtrudeBuildNormals2f(ex);
-    if (ok)
-      ok &= ExtrudeCGOSurfacePolygonTaper(ex, cgo, sampling,
-                                          ColorGet(G, highlight_color));
+    if (ok) {
+      float rgb[3];
+      ColorGetCopy(G, highlight_color, rgb);
+      ok &= ExtrudeCGOSurfacePolygonTaper(ex, cgo, sampling, rgb);
+    }
   }
   /*
     ExtrudeCGOSurfacePolygonX(ex,cgo,1); */
@@ -2407,32 +2464,61 @@ static int GetCartoonQuality(CoordSet * cs, int setting, int v1, int v2, int v3,
   return quality;
 }
 
+// paths with fewer guide atoms are extruded by a single thread
+#define CARTOON_PARALLEL_MIN 2000
+
+/**
+ * Guide atoms [a_begin, a_end) of the cartoon path, extruded independently
+ */
+struct CartoonShard {
+  int a_begin;
+  int a_end;
+  bool skip_pending;
+};
+
+/**
+ * Appends a shard which was extruded with an unknown current pick color.
+ * The shard's first pick color gets dropped if `cgo` has it already, which
+ * gives the same operations as extruding the whole path into `cgo`.
+ */
+static void CartoonAppendShard(CGO* cgo, CGO*& shard)
+{
+  for (auto it = shard->begin(); !it.is_stop(); ++it) {
+    if (it.op_code() != CGO_PICK_COLOR)
+      continue;
+
+    float* pc = shard->op + (it.data() - shard->op);
+    if (CGO_get_uint(pc) == cgo->current_pick_color_index &&
+        CGO_get_int(pc + 1) == cgo->current_pick_color_bond) {
+      std::copy(pc + CGO_PICK_COLOR_SZ, shard->op + shard->c, pc - 1);
+      shard->c -= CGO_PICK_COLOR_SZ + 1;
+      shard->op[shard->c] = 0; // CGO_STOP
+    }
+    break;
+  }
+
+  if (shard->current_pick_color_index != (unsigned int) -1 ||
+      shard->current_pick_color_bond != cPickableAtom) {
+    cgo->current_pick_color_index = shard->current_pick_color_index;
+    cgo->current_pick_color_bond = shard->current_pick_color_bond;
+  }
+
+  cgo->free_append(shard);
+}
+
 static
 CGO *GenerateRepCartoonCGO(CoordSet *cs, ObjectMolecule *obj, nuc_acid_data *ndata, short use_cylinders_for_strands,
                            float *pv, int nAt, float *tv, float *pvo,
                            float *dl,
                            const CCInOut *car,
                            int *seg, int *at, int *nuc_flag,
-                           float *putty_vals, float alpha){
+                           float *putty_vals, float alpha, int lod_level){
   PyMOLGlobals *G = cs->G;
   int ok = true;
   CGO *cgo;
-  int contigFlag, contFlag, extrudeFlag, n_p;
   CExtrude *ex = nullptr;
-  float dev;
-  unsigned int *vi;
-  int atom_index1, atom_index2;
-  float *v, *v1, *v2, *vo;
-  float *d, *vc = nullptr, *vn;
-  float *valpha = nullptr;
-  int *atp;
-  int c1, c2;
-  int a;
   int sampling;
   float *sampling_tmp;
-  int *segptr;
-  const CCInOut *cc;
-  int cur_car;
   float loop_radius;
   int nucleic_color = 0;
   float throw_;
@@ -2448,16 +2534,6 @@ CGO *GenerateRepCartoonCGO(CoordSet *cs, ObjectMolecule *obj, nuc_acid_data *nda
   float dumbbell_radius, dumbbell_width, dumbbell_length;
   float ring_width;
 
-  auto EXTRUDE_TRUNCATE = [&ex, &n_p, &v, &vc, &valpha, &vn, &vi]() {
-    ExtrudeTruncate(ex, 0);
-    n_p = 0;
-    v = ex->p;
-    vc = ex->c;
-    valpha = ex->alpha;
-    vn = ex->n;
-    vi = ex->i;
-  };
-
   cartoon_color =
     SettingGet_color(G, cs->Setting.get(), obj->Setting.get(), cSetting_cartoon_color);
   ring_width =
@@ -2499,6 +2575,14 @@ CGO *GenerateRepCartoonCGO(CoordSet *cs, ObjectMolecule *obj, nuc_acid_data *nda
   loop_quality  = GetCartoonQuality(cs, cSetting_cartoon_loop_quality,   6, 6, 5, 4);
   sampling      = GetCartoonQuality(cs, cSetting_cartoon_sampling,       7, 5, 3, 2, 1);
 
+  if (lod_level > 0) {
+    tube_quality  = pymol::LodQuality(tube_quality,  lod_level, 3);
+    oval_quality  = pymol::LodQuality(oval_quality,  lod_level, 3);
+    putty_quality = pymol::LodQuality(putty_quality, lod_level, 3);
+    loop_quality  = pymol::LodQuality(loop_quality,  lod_level, 3);
+    sampling      = pymol::LodQuality(sampling,      lod_level, 2);
+  }
+
   PRINTFB(G, FB_RepCartoon, FB_Blather)
     " RepCartoon: Use settings tube_quality=%d oval_quality=%d putty_quality=%d loop_quality=%d sampling=%d\n",
     tube_quality, oval_quality, putty_quality, loop_quality, sampling
@@ -2554,34 +2638,57 @@ CGO *GenerateRepCartoonCGO(CoordSet *cs, ObjectMolecule *obj, nuc_acid_data *nda
     ok = GenerateRepCartoonProcessCylindricalHelices(G, obj, cs, cgo, ex, nAt, seg, pv, tv,
                                                      pvo, car, at, dl, cartoon_color, discrete_colors, loop_radius, alpha);
   }
-  if(ok && nAt > 1) {
+  const auto helix_radius = SettingGet<float>(
+      G, cs->Setting.get(), obj->Setting.get(), cSetting_cartoon_helix_radius);
+
+  /* Extrudes the guide atoms [a_begin, a_end), which must start and end at
+   * segment boundaries, into `cgo`. With `skip_pending`, the walk starts in
+   * the state which the whole path walk has when points of skipped cartoon
+   * from previous segments are still pending. */
+  auto extrude_range = [&](CExtrude* ex, CGO* cgo, int a_begin, int a_end,
+                           bool skip_pending, float* sampling_tmp) {
+    int ok = true;
+    int n_p = 0;
+    float *v, *vc, *valpha, *vn;
+    unsigned int* vi;
+    int c1, c2;
+
+    auto EXTRUDE_TRUNCATE = [&ex, &n_p, &v, &vc, &valpha, &vn, &vi]() {
+      ExtrudeTruncate(ex, 0);
+      n_p = 0;
+      v = ex->p;
+      vc = ex->c;
+      valpha = ex->alpha;
+      vn = ex->n;
+      vi = ex->i;
+    };
+
     EXTRUDE_TRUNCATE();
-    v1 = pv;                    /* points */
-    v2 = tv;                    /* tangents */
-    vo = pvo;
-    d = dl;
-    segptr = seg;
-    cc = car;
-    atp = at;                   /* cs index pointer */
-    a = 0;
-    contFlag = true;
-    cur_car = cCartoon_skip;
-    extrudeFlag = false;
-    contigFlag = false;
-
-    const auto helix_radius = SettingGet<float>(
-        G, cs->Setting.get(), obj->Setting.get(), cSetting_cartoon_helix_radius);
+    float* v1 = pv + 3 * a_begin; /* points */
+    float* v2 = tv + 3 * a_begin; /* tangents */
+    float* vo = pvo + 3 * a_begin;
+    float* d = dl + a_begin;
+    int* segptr = seg + a_begin;
+    const CCInOut* cc = car + a_begin;
+    int* atp = at + a_begin; /* cs index pointer */
+    int a = a_begin;
+    int contFlag = true;
+    int cur_car = cCartoon_skip;
+    int extrudeFlag = false;
+    /* pending points only get truncated by extruding, which leaves the
+     * path contiguous */
+    int contigFlag = skip_pending;
 
     while(contFlag) {
-      if (CheckExtrudeContigFlags(nAt, n_p, a, &cur_car, cc, segptr, &contigFlag, &extrudeFlag)){
+      if (CheckExtrudeContigFlags(a_end, n_p, a, &cur_car, cc, segptr, &contigFlag, &extrudeFlag)){
         EXTRUDE_TRUNCATE();
       }
 
       if(ok && !extrudeFlag) {
-        if((a < (nAt - 1)) && (*segptr == *(segptr + 1))) {       /* working in the same segment... */
+        if((a < (a_end - 1)) && (*segptr == *(segptr + 1))) {       /* working in the same segment... */
           AtomInfoType *ai1, *ai2;
-          atom_index1 = cs->IdxToAtm[*atp];
-          atom_index2 = cs->IdxToAtm[*(atp + 1)];
+          int atom_index1 = cs->IdxToAtm[*atp];
+          int atom_index2 = cs->IdxToAtm[*(atp + 1)];
           ai1 = obj->AtomInfo + atom_index1;
           ai2 = obj->AtomInfo + atom_index2;
 
@@ -2589,7 +2696,7 @@ CGO *GenerateRepCartoonCGO(CoordSet *cs, ObjectMolecule *obj, nuc_acid_data *nda
           float alpha2 = alpha;
 
           ComputeCartoonAtomColors(G, obj, cs, nuc_flag, atom_index1, atom_index2, &c1, &c2, atp, cc, cur_car, cartoon_color, alpha1, alpha2, nucleic_color, discrete_colors, n_p, contigFlag);
-          dev = throw_ * (*d);
+          float dev = throw_ * (*d);
 
           auto const cur_sampling = (cur_car == cCartoon_cylinder)
                                         ? sampling_cylindrical_helices
@@ -2614,14 +2721,14 @@ CGO *GenerateRepCartoonCGO(CoordSet *cs, ObjectMolecule *obj, nuc_acid_data *nda
       }
 
       a++;
-      if(a == nAt) {  // if at end, don't continue and extrude if needed
+      if(a == a_end) {  // if at end, don't continue and extrude if needed
         contFlag = false;
         if(n_p)
           extrudeFlag = true;
       }
       if(ok && extrudeFlag) {
         contigFlag = true;
-        if((a < nAt) && extrudeFlag) {
+        if((a < a_end) && extrudeFlag) {
           if(*(segptr - 1) != *(segptr))
             contigFlag = false;
         }
@@ -2678,14 +2785,85 @@ CGO *GenerateRepCartoonCGO(CoordSet *cs, ObjectMolecule *obj, nuc_acid_data *nda
         if (ok){
           EXTRUDE_TRUNCATE();  // doesn't include vi = ex->i, not used?
         }
-        /*
-          ExtrudeTruncate(ex, 0);
-        n_p = 0;
-        v = ex->p;
-        vc = ex->c;
-        vn = ex->n;*/
       }
     }
+    return ok;
+  };
+
+  if(ok && nAt > 1) {
+    /* split the path into shards of whole segments */
+    std::vector<CartoonShard> shards;
+    int n_shards_max = 1;
+#ifdef PYMOL_OPENMP
+    if (nAt >= CARTOON_PARALLEL_MIN)
+      n_shards_max = omp_get_max_threads() * 4;
+#endif
+    int const shard_size = (nAt + n_shards_max - 1) / n_shards_max;
+    bool skip_pending = false;
+    int seg_begin = 0;
+    shards.push_back({0, 0, false});
+    for (int a = 0; a < nAt; ++a) {
+      if (a < nAt - 1 && seg[a] == seg[a + 1])
+        continue;
+
+      /* skipped points of the last pair stay pending (see
+       * CheckExtrudeContigFlags), other cartoon gets extruded */
+      if (a > seg_begin) {
+        skip_pending =
+            prioritize(car[a - 1].getCCOut(), car[a].getCCIn()) == cCartoon_skip;
+      }
+      seg_begin = a + 1;
+
+      auto& shard = shards.back();
+      shard.a_end = a + 1;
+      if (shard.a_end - shard.a_begin >= shard_size && a < nAt - 1) {
+        shards.push_back({a + 1, a + 1, skip_pending});
+      }
+    }
+
+    int const n_shards = shards.size();
+    std::vector<CGO*> shard_cgos(n_shards, nullptr);
+    std::vector<int> shard_ok(n_shards, true);
+
+    /* the first shard goes straight into `cgo`, the others are concatenated
+     * in order afterwards */
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for schedule(dynamic, 1) if (n_shards > 1)
+#endif
+    for (int i = 0; i < n_shards; ++i) {
+      auto const& shard = shards[i];
+      if (i == 0) {
+        shard_ok[i] = extrude_range(ex, cgo, shard.a_begin, shard.a_end,
+            shard.skip_pending, sampling_tmp);
+        continue;
+      }
+
+      CGO* shard_cgo = CGONew(G);
+      CExtrude* shard_ex = ExtrudeNew(G);
+      std::vector<float> shard_sampling_tmp(sampling * 3);
+      int shard_is_ok = shard_cgo && shard_ex &&
+          ExtrudeAllocPointsNormalsColors(shard_ex,
+              (shard.a_end - shard.a_begin + 1) * (3 * sampling + 3));
+      if (shard_is_ok) {
+        // unknown pick color state, see CartoonAppendShard
+        shard_cgo->current_pick_color_index = (unsigned int) -1;
+        shard_cgo->current_pick_color_bond = cPickableAtom;
+        shard_is_ok = extrude_range(shard_ex, shard_cgo, shard.a_begin,
+            shard.a_end, shard.skip_pending, shard_sampling_tmp.data());
+      }
+      if (shard_ex)
+        ExtrudeFree(shard_ex);
+      shard_ok[i] = shard_is_ok;
+      shard_cgos[i] = shard_cgo;
+    }
+
+    for (int i = 0; i < n_shards; ++i) {
+      ok = ok && shard_ok[i];
+      if (ok && shard_cgos[i]) {
+        CartoonAppendShard(cgo, shard_cgos[i]);
+      }
+      CGOFree(shard_cgos[i]);
+    }
   }
 
   if(ok && nAt > 1) {
@@ -2726,6 +2904,16 @@ bool RepCartoon::sameVis() const
   return true;
 }
 
+/**
+ * The detail level and the cartoon_debug lines depend on the camera
+ */
+bool RepCartoon::rayViewIndependent() const
+{
+  return !SettingGet<bool>(G, cSetting_level_of_detail) &&
+         !SettingGet<int>(G, cs->Setting.get(), obj->Setting.get(),
+             cSetting_cartoon_debug);
+}
+
 void RepCartoon::invalidate(cRepInv_t level)
 {
   if (level >= cRepInvColor){
@@ -3667,6 +3855,24 @@ void RepCartoonSmoothLoops(PyMOLGlobals* G, ObjectMolecule* obj,
 }
 
 Rep *RepCartoonNew(CoordSet * cs, int state)
+{
+  auto I = RepCartoonNewLevel(cs, state, 0);
+
+  if (I) {
+    for (int idx = 0; idx < cs->NIndex; ++idx) {
+      if (cs->getAtomInfo(idx)->visRep & cRepCartoonBit) {
+        I->lod.include(cs->coordPtr(idx));
+      }
+    }
+  }
+
+  return I;
+}
+
+/**
+ * @param lod_level Detail level, 0 for the full detail
+ */
+static RepCartoon* RepCartoonNewLevel(CoordSet* cs, int state, int lod_level)
 {
   PyMOLGlobals *G = cs->G;
   ObjectMolecule *obj;
@@ -3703,6 +3909,7 @@ Rep *RepCartoonNew(CoordSet * cs, int state)
    * DEVELOP ON IT ONLY AT EXTREME RISK TO YOUR MENTAL HEALTH */
 
   auto I = new RepCartoon(cs, state);
+  I->lodLevel = lod_level;
 
   PRINTFD(G, FB_RepCartoon)
     " RepCartoonNew-Debug: entered.\n" ENDFD;
@@ -3832,7 +4039,7 @@ Rep *RepCartoonNew(CoordSet * cs, int state)
 
     CGO* preshadercgo =
         GenerateRepCartoonCGO(cs, obj, &ndata, na_strands_as_cylinders, pv, nAt,
-            tv, pvo, dl, car, seg, at, nuc_flag, putty_vals, alpha);
+            tv, pvo, dl, car, seg, at, nuc_flag, putty_vals, alpha, lod_level);
 
     if (preshadercgo && preshadercgo->has_begin_end) {
       CGOCombineBeginEnd(&preshadercgo);
@@ -3868,5 +4075,5 @@ Rep *RepCartoonNew(CoordSet * cs, int state)
   FreeP(flag_tmp);
   FreeP(nuc_flag);
   VLAFreeP(ndata.ring_anchor);
-  return (Rep *) I;
+  return I;
 }
@@ -17,8 +17,50 @@ Z* -------------------------------------------------------------------
 #ifndef _H_RepCartoon
 #define _H_RepCartoon
 
-struct Rep;
+#include <cstddef>
+#include <memory>
+
+#include"Rep.h"
+#include"LevelOfDetail.h"
+
 struct CoordSet;
+struct RenderInfo;
+class CGO;
+
+struct RepCartoon : Rep {
+  using Rep::Rep;
+
+  ~RepCartoon() override;
+
+  cRep_t type() const override { return cRepCartoon; }
+  bool rayViewIndependent() const override;
+  void render(RenderInfo* info) override;
+  pymol::MemorySize getMemorySize() const override;
+  void invalidate(cRepInv_t level) override;
+  bool sameVis() const override;
+
+  CGO* ray = nullptr;
+  CGO* std = nullptr;
+  CGO* preshader = nullptr;
+
+  /**
+   * Free the preshader CGO or move to another owner.
+   * @post preshader == nullptr
+   */
+  void disposePreshaderCGO();
+
+  char* LastVisib = nullptr;
+
+  //! Detail level of this rep, and the level selection of the full detail rep
+  int lodLevel = 0;
+  pymol::LodChunk lod;
+
+  //! Coarser versions of this rep, generated on demand
+  std::unique_ptr<RepCartoon> coarse[pymol::LodLevelCount - 1];
+
+  //! Triangles of the `std` CGO
+  std::size_t nTriangles = 0;
+};
 
 Rep *RepCartoonNew(CoordSet * cset, int state);
 
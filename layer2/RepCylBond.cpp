@@ -32,6 +32,7 @@
 #include"ShaderMgr.h"
 #include"Scene.h"
 #include"CGO.h"
+#include"LevelOfDetail.h"
 #include "Lex.h"
 
 #include <iostream>
@@ -42,10 +43,21 @@ struct RepCylBond : Rep {
   ~RepCylBond() override;
 
   cRep_t type() const override { return cRepCyl; }
+  bool rayViewIndependent() const override { return true; }
   void render(RenderInfo* info) override;
+  pymol::MemorySize getMemorySize() const override;
 
   CGO* primitiveCGO = nullptr;
   CGO* renderCGO = nullptr;
+
+  //! Tessellated (not cylinder shader) renderCGO and its coarser levels
+  bool renderTessellated = false;
+  CGO* coarseCGO[pymol::LodLevelCount - 1] = {};
+  std::size_t nTriangles[pymol::LodLevelCount] = {};
+  pymol::LodChunk lod;
+
+  void freeRenderCGOs();
+  CGO* getRenderCGO(RenderInfo* info);
 };
 
 /* RepCylinder -- This function is a helper function that generates a cylinder for RepCylBond.
@@ -110,10 +122,36 @@ RepCylBond::~RepCylBond()
 {
   auto I = this;
   CGOFree(I->primitiveCGO);
-  CGOFree(I->renderCGO);
+  freeRenderCGOs();
+}
+
+pymol::MemorySize RepCylBond::getMemorySize() const
+{
+  auto size = Rep::getMemorySize();
+  size += CGOGetMemorySize(primitiveCGO);
+  if (renderCGO != primitiveCGO) {
+    size += CGOGetMemorySize(renderCGO);
+  }
+  for (auto cgo : coarseCGO) {
+    size += CGOGetMemorySize(cgo);
+  }
+  return size;
 }
 
-static int RepCylBondCGOGenerate(RepCylBond * I, RenderInfo * info)
+void RepCylBond::freeRenderCGOs()
+{
+  CGOFree(renderCGO);
+  for (auto& cgo : coarseCGO) {
+    CGOFree(cgo);
+  }
+}
+
+/**
+ * @param lod_level Detail level of the tessellated geometry, 0 for the full
+ * detail. Only used without the cylinder shader.
+ */
+static CGO* RepCylBondCGOGenerate(
+    RepCylBond* I, RenderInfo* info, int lod_level = 0)
 {
   PyMOLGlobals *G = I->G;
 
@@ -145,10 +183,17 @@ static int RepCylBondCGOGenerate(RepCylBond * I, RenderInfo * info)
       convertcgo->move_append(std::move(*spherescgo));
     }
   } else {
+    int sphere_quality = SettingGet<int>(G, cSetting_cgo_sphere_quality);
+    int stick_quality = -1;
+    if (lod_level > 0) {
+      sphere_quality = pymol::LodQuality(sphere_quality, lod_level, 0);
+      stick_quality = pymol::LodQuality(
+          SettingGet<int>(G, cSetting_stick_quality), lod_level, 3);
+    }
     std::unique_ptr<CGO> simplified(CGOSimplify(input, 0, //
-        SettingGet<int>(G, cSetting_cgo_sphere_quality),
-        SettingGet<int>(G, cSetting_stick_round_nub)));
-    p_return_val_if_fail(simplified, false);
+        sphere_quality, SettingGet<int>(G, cSetting_stick_round_nub),
+        stick_quality));
+    p_return_val_if_fail(simplified, nullptr);
     if (use_shader) {
       convertcgo.reset(CGOOptimizeToVBONotIndexed(simplified.get()));
     } else {
@@ -156,13 +201,44 @@ static int RepCylBondCGOGenerate(RepCylBond * I, RenderInfo * info)
     }
   }
 
-  p_return_val_if_fail(convertcgo, false);
+  p_return_val_if_fail(convertcgo, nullptr);
 
-  assert(!I->renderCGO);
-  I->renderCGO = convertcgo.release();
-  CGOSetUseShader(I->renderCGO, use_shader);
+  I->renderTessellated = !as_cylinders;
+  I->nTriangles[lod_level] = CGOCountTriangles(convertcgo.get());
+  CGOSetUseShader(convertcgo.get(), use_shader);
 
-  return true;
+  return convertcgo.release();
+}
+
+/**
+ * Get the CGO for the selected detail level, generate it if needed
+ */
+CGO* RepCylBond::getRenderCGO(RenderInfo* info)
+{
+  if (!renderCGO) {
+    renderCGO = RepCylBondCGOGenerate(this, info);
+    if (!renderCGO) {
+      return nullptr;
+    }
+  }
+
+  // cylinder shader (impostors) has no tessellation to reduce
+  int const level = renderTessellated ? lod.select(G, info) : 0;
+  if (level > 0) {
+    auto& coarse = coarseCGO[level - 1];
+    if (!coarse && !info->pick) {
+      coarse = RepCylBondCGOGenerate(this, info, level);
+    }
+    if (coarse) {
+      pymol::LodStatsAdd(G, info, level, nTriangles[level]);
+      return coarse;
+    }
+  }
+
+  if (renderTessellated) {
+    pymol::LodStatsAdd(G, info, 0, nTriangles[0]);
+  }
+  return renderCGO;
 }
 
 void RepCylBond::render(RenderInfo * info)
@@ -183,8 +259,7 @@ void RepCylBond::render(RenderInfo * info)
       && SettingGetGlobal_b(G, cSetting_use_shaders);
 
     if (I->renderCGO && (CGOCheckWhetherToFree(G, I->renderCGO) || ((bool)I->renderCGO->use_shader) != use_shader)){
-      CGOFree(I->renderCGO);
-      I->renderCGO = 0;
+      I->freeRenderCGOs();
     }
 
     if(pick) {
@@ -192,16 +267,15 @@ void RepCylBond::render(RenderInfo * info)
         " RepCylBondRender: rendering pickable...\n" ENDFD;
 
       if (I->renderCGO){
-        CGORenderPicking(I->renderCGO, info, &I->context, I->cs->Setting.get(), I->obj->Setting.get());
+        CGORenderPicking(I->getRenderCGO(info), info, &I->context, I->cs->Setting.get(), I->obj->Setting.get());
       }
     } else { /* else not pick, i.e., when rendering */
-      if (!I->renderCGO){
-        ok &= RepCylBondCGOGenerate(I, info);
-        assert(I->renderCGO);
-      }
+      auto renderCGO = I->getRenderCGO(info);
+      ok &= renderCGO != nullptr;
+      assert(renderCGO);
       const float *color = ColorGet(G, I->obj->Color);
-      I->renderCGO->debug = SettingGetGlobal_i(G, cSetting_stick_debug);
-      CGORender(I->renderCGO, color, nullptr, nullptr, info, I);
+      renderCGO->debug = SettingGetGlobal_i(G, cSetting_stick_debug);
+      CGORender(renderCGO, color, nullptr, nullptr, info, I);
     }
   }
 }
@@ -904,6 +978,12 @@ Rep *RepCylBondNew(CoordSet * cs, int state)
   if (!ok){
     delete I;
     I = nullptr;
+  } else {
+    for (int idx = 0; idx < cs->NIndex; ++idx) {
+      if (cs->getAtomInfo(idx)->visRep & cRepCylBit) {
+        I->lod.include(cs->coordPtr(idx));
+      }
+    }
   }
 
   return (Rep *) I;
@@ -39,6 +39,7 @@ struct RepDihedral : Rep {
 
   cRep_t type() const override { return cRepDihedral; }
   void render(RenderInfo* info) override;
+  pymol::MemorySize getMemorySize() const override;
 
   float* V = nullptr;
   int N = 0;
@@ -59,6 +60,14 @@ RepDihedral::~RepDihedral()
   VLAFreeP(I->V);
 }
 
+pymol::MemorySize RepDihedral::getMemorySize() const
+{
+  auto size = Rep::getMemorySize();
+  size.host += pymol::memory_size(V);
+  size += CGOGetMemorySize(shaderCGO);
+  return size;
+}
+
 static int RepDihedralCGOGenerate(RepDihedral * I, RenderInfo * info)
 {
   PyMOLGlobals *G = I->G;
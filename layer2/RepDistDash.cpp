@@ -44,6 +44,7 @@ struct RepDistDash : Rep {
 
   cRep_t type() const override { return cRepDash; }
   void render(RenderInfo* info) override;
+  pymol::MemorySize getMemorySize() const override;
 
   float* V = nullptr;
   int N = 0;
@@ -62,6 +63,14 @@ RepDistDash::~RepDistDash()
   VLAFreeP(V);
 }
 
+pymol::MemorySize RepDistDash::getMemorySize() const
+{
+  auto size = Rep::getMemorySize();
+  size.host += pymol::memory_size(V);
+  size += CGOGetMemorySize(shaderCGO);
+  return size;
+}
+
 /* Has no prototype */
 static void RepDistDashCGOGenerate(RepDistDash* I, std::optional<float> dash_transparency)
 {
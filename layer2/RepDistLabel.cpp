@@ -45,6 +45,7 @@ struct RepDistLabel : Rep {
 
   cRep_t type() const override { return cRepLabel; }
   void render(RenderInfo* info) override;
+  pymol::MemorySize getMemorySize() const override;
 
   float* V = nullptr;
   int N = 0;
@@ -69,6 +70,14 @@ RepDistLabel::~RepDistLabel()
   VLAFreeP(I->L);
 }
 
+pymol::MemorySize RepDistLabel::getMemorySize() const
+{
+  auto size = Rep::getMemorySize();
+  size.host += pymol::memory_size(V) + pymol::memory_size(L);
+  size += CGOGetMemorySize(shaderCGO);
+  return size;
+}
+
 void RepDistLabel::render(RenderInfo* info)
 {
   auto I = this;
@@ -51,6 +51,18 @@ RepDot::~RepDot()
   FreeP(I->Atom);
 }
 
+pymol::MemorySize RepDot::getMemorySize() const
+{
+  auto size = Rep::getMemorySize();
+  // V also holds color records, count the dot coordinates only
+  size.host += N * 3 * sizeof(float);
+  if (A) {
+    size.host += N * (sizeof(float) * 4 + sizeof(int) * 3); // A, VN, T, F, Atom
+  }
+  size += CGOGetMemorySize(shaderCGO);
+  return size;
+}
+
 static int RepDotCGOGenerate(RepDot * I)
 {
   PyMOLGlobals *G = I->G;
@@ -302,6 +314,7 @@ Rep *RepDotDoNew(CoordSet * cs, cRepDot_t mode, int state)
 
   int lastColor = cColorDefault;
   int colorCnt = 0;
+  ColorRampBatch ramp_batch;
 
   auto I = new RepDot(cs, state);
 
@@ -410,7 +423,7 @@ Rep *RepDotDoNew(CoordSet * cs, cRepDot_t mode, int state)
           lastColor = c1;
           // save new color
           if (ColorCheckRamped(G, c1)) {
-            ColorGetRamped(G, c1, v1, v, state);
+            ramp_batch.add(c1, v1, v);
           } else {
             copy3(ColorGet(G, c1), v);
           }
@@ -446,6 +459,8 @@ Rep *RepDotDoNew(CoordSet * cs, cRepDot_t mode, int state)
     ok_assert(1, !G->Interrupt);
   }
 
+  ramp_batch.flush(G, state);
+
   // save count
   if (countPtr)
     *countPtr = (float) colorCnt;
@@ -32,6 +32,7 @@ struct RepDot : Rep {
 
   cRep_t type() const override { return cRepDot; }
   void render(RenderInfo* info) override;
+  pymol::MemorySize getMemorySize() const override;
 
   float dotSize;
   float *V = nullptr;
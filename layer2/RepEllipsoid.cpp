@@ -37,6 +37,7 @@ struct RepEllipsoid : Rep {
 
   cRep_t type() const override { return cRepEllipsoid; }
   void render(RenderInfo* info) override;
+  pymol::MemorySize getMemorySize() const override;
 
   CGO* ray = nullptr;
   CGO* std = nullptr;
@@ -53,6 +54,15 @@ RepEllipsoid::~RepEllipsoid()
   CGOFree(I->shaderCGO);
 }
 
+pymol::MemorySize RepEllipsoid::getMemorySize() const
+{
+  auto size = Rep::getMemorySize();
+  size += CGOGetMemorySize(ray);
+  size += CGOGetMemorySize(std);
+  size += CGOGetMemorySize(shaderCGO);
+  return size;
+}
+
 void RepEllipsoid::render(RenderInfo* info)
 {
   auto I = this;
@@ -25,6 +25,7 @@ Z* -------------------------------------------------------------------
 #include "Color.h"
 #include "CoordSet.h"
 #include "Err.h"
+#include "LabelLayout.h"
 #include "Map.h"
 #include "Matrix.h"
 #include "RepLabel.h"
@@ -78,6 +79,7 @@ struct RepLabel : Rep {
 
   cRep_t type() const override { return cRepLabel; }
   void render(RenderInfo* info) override;
+  pymol::MemorySize getMemorySize() const override;
 
   // VItemType *V;
   float* V = nullptr;
@@ -86,6 +88,9 @@ struct RepLabel : Rep {
   int OutlineColor;
   CGO* shaderCGO = nullptr;
   int texture_font_size = 0;
+
+  // composite label characters for ray tracing
+  pymol::LabelLayoutCache layoutCache{G};
 };
 
 #define SHADERCGO I->shaderCGO
@@ -100,6 +105,14 @@ RepLabel::~RepLabel()
   CGOFree(I->shaderCGO);
 }
 
+pymol::MemorySize RepLabel::getMemorySize() const
+{
+  auto size = Rep::getMemorySize();
+  size.host += N * (sizeof(float) * 28 + sizeof(lexidx_t));
+  size += CGOGetMemorySize(shaderCGO);
+  return size;
+}
+
 #define MAX_LABEL_TEXTURE_SIZE 256
 #define MAX_LABEL_FOR_ALWAYS_REFRESH 32
 #define PERCENTAGE_CHANGE_FOR_REFRESH .2f
@@ -1229,6 +1242,14 @@ static void RepLabelRenderRay(RepLabel* I, RenderInfo* info)
   if (c) {
     const char* st;
     TextSetOutlineColor(G, I->OutlineColor);
+
+    // size in pixels of labels with world units changes with the view,
+    // don't let the layouts for old views pile up
+    if (I->layoutCache.size() > 2 * (std::size_t) I->N + 16) {
+      I->layoutCache.clear();
+    }
+    TextSetLayoutCache(G, &I->layoutCache);
+
     while (c--) {
       if (*l) {
         float xn[3], yn[3], tCenter[3], offpt[3];
@@ -1275,6 +1296,8 @@ static void RepLabelRenderRay(RepLabel* I, RenderInfo* info)
       v += 28;
       l++;
     }
+
+    TextSetLayoutCache(G, nullptr);
   }
 #endif
 }
@@ -43,6 +43,7 @@ struct RepMesh : Rep {
 
   cRep_t type() const override { return cRepMesh; }
   void render(RenderInfo* info) override;
+  pymol::MemorySize getMemorySize() const override;
   Rep* recolor() override;
   bool sameVis() const override;
 
@@ -73,6 +74,20 @@ RepMesh::~RepMesh()
   FreeP(I->LastVisib);
 }
 
+pymol::MemorySize RepMesh::getMemorySize() const
+{
+  auto size = Rep::getMemorySize();
+  size.host += pymol::memory_size(N) + pymol::memory_size(V);
+  if (VC) {
+    size.host += NTot * 3 * sizeof(float);
+  }
+  if (Dot) {
+    size.host += NDot * 3 * sizeof(float);
+  }
+  size += CGOGetMemorySize(shaderCGO);
+  return size;
+}
+
 static
 int RepMeshGetSolventDots(RepMesh * I, CoordSet * cs, float *min, float *max,
                           float probe_radius);
@@ -630,6 +645,7 @@ Rep* RepMesh::recolor()
     /* now, assign colors to each point */
     map = MapNew(G, I->max_vdw + probe_radius, cs->Coord, cs->NIndex, nullptr);
     if(map) {
+      ColorRampBatch ramp_batch;
       MapSetupExpress(map);
       for(a = 0; a < I->NTot; a++) {
         AtomInfoType *ai0 = nullptr;
@@ -681,7 +697,7 @@ Rep* RepMesh::recolor()
 
         if(ColorCheckRamped(G, c1)) {
           I->oneColorFlag = false;
-          ColorGetRamped(G, c1, v0, vc, state);
+          ramp_batch.add(c1, v0, vc);
           vc += 3;
         } else {
           c0 = ColorGet(G, c1);
@@ -690,6 +706,7 @@ Rep* RepMesh::recolor()
           *(vc++) = *(c0++);
         }
       }
+      ramp_batch.flush(G, state);
       MapFree(map);
     }
     if(I->oneColorFlag) {
@@ -37,6 +37,7 @@ struct RepNonbonded : Rep {
 
   cRep_t type() const override { return cRepNonbonded; }
   void render(RenderInfo* info) override;
+  pymol::MemorySize getMemorySize() const override;
 
   CGO *primitiveCGO;
   CGO *shaderCGO;
@@ -51,6 +52,14 @@ RepNonbonded::~RepNonbonded()
   CGOFree(shaderCGO);
 }
 
+pymol::MemorySize RepNonbonded::getMemorySize() const
+{
+  auto size = Rep::getMemorySize();
+  size += CGOGetMemorySize(primitiveCGO);
+  size += CGOGetMemorySize(shaderCGO);
+  return size;
+}
+
 void RepNonbondedRenderImmediate(CoordSet * cs, RenderInfo * info)
 {
 #ifndef PURE_OPENGL_ES_2
@@ -39,6 +39,7 @@ struct RepNonbondedSphere : Rep {
 
   cRep_t type() const override { return cRepNonbondedSphere; }
   void render(RenderInfo* info) override;
+  pymol::MemorySize getMemorySize() const override;
 
   CGO *shaderCGO, *primitiveCGO;
 };
@@ -51,6 +52,14 @@ RepNonbondedSphere::~RepNonbondedSphere()
   CGOFree(primitiveCGO);
 }
 
+pymol::MemorySize RepNonbondedSphere::getMemorySize() const
+{
+  auto size = Rep::getMemorySize();
+  size += CGOGetMemorySize(primitiveCGO);
+  size += CGOGetMemorySize(shaderCGO);
+  return size;
+}
+
 void RepNonbondedSphere::render(RenderInfo* info)
 {
   auto I = this;
@@ -41,6 +41,7 @@ struct RepRibbon : Rep {
 
   cRep_t type() const override { return cRepRibbon; }
   void render(RenderInfo* info) override;
+  pymol::MemorySize getMemorySize() const override;
 
   float ribbon_width;
   float radius;
@@ -57,6 +58,14 @@ RepRibbon::~RepRibbon()
   CGOFree(shaderCGO);
 }
 
+pymol::MemorySize RepRibbon::getMemorySize() const
+{
+  auto size = Rep::getMemorySize();
+  size += CGOGetMemorySize(primitiveCGO);
+  size += CGOGetMemorySize(shaderCGO);
+  return size;
+}
+
 static void RepRibbonRenderRay(RepRibbon* I, RenderInfo* info) {
   auto ray = info->ray;
   CGORenderRay(I->primitiveCGO, ray, info, nullptr, nullptr, I->cs->Setting.get(), I->obj->Setting.get());
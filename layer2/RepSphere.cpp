@@ -38,6 +38,8 @@
 #include "Lex.h"
 #include "CoordSet.h"
 
+#include <algorithm>
+
 #define SPHERE_NORMAL_RANGE 6.f
 #define SPHERE_NORMAL_RANGE2 (SPHERE_NORMAL_RANGE*SPHERE_NORMAL_RANGE)
 
@@ -71,10 +73,27 @@ RepSphere::~RepSphere()
   CGOFree(I->primitiveCGO);
   CGOFree(I->renderCGO);
   CGOFree(I->spheroidCGO);
+  for (auto& cgo : I->coarseCGO) {
+    CGOFree(cgo);
+  }
   FreeP(I->LastColor);
   FreeP(I->LastVisib);
 }
 
+pymol::MemorySize RepSphere::getMemorySize() const
+{
+  auto size = Rep::getMemorySize();
+  size += CGOGetMemorySize(primitiveCGO);
+  if (renderCGO != primitiveCGO) {
+    size += CGOGetMemorySize(renderCGO);
+  }
+  size += CGOGetMemorySize(spheroidCGO);
+  for (auto cgo : coarseCGO) {
+    size += CGOGetMemorySize(cgo);
+  }
+  return size;
+}
+
 void RenderSphereComputeFog(PyMOLGlobals *G, RenderInfo *info, float *fog_info)
 {
   /* compute -Ze = (Wc) of fog start */
@@ -113,10 +132,58 @@ static int RepSphereRenderRay(PyMOLGlobals *G, RepSphere * I, RenderInfo * info)
 }
 #endif
 
+/**
+ * Render (or pick) the tessellated spheres at the selected detail level
+ */
+static void RepSphereRenderTriangles(RepSphere * I, RenderInfo * info)
+{
+  PyMOLGlobals *G = I->G;
+  CGO *cgo = I->renderCGO;
+  int level = I->lod.select(G, info);
+
+  if (level > 0 && cgo->use_shader) {
+    auto& coarse = I->coarseCGO[level - 1];
+    if (!coarse && !info->pick)
+      coarse = RepSphere_Generate_Triangles_LOD(G, I, level);
+    if (coarse)
+      cgo = coarse;
+    else
+      level = 0;
+  }
+
+  // without shaders, spheres are tessellated while rendering
+  short const sphere_quality = cgo->sphere_quality;
+  if (!cgo->use_shader)
+    cgo->sphere_quality = pymol::LodQuality(sphere_quality, level, 0);
+
+  if (info->pick) {
+    CGORenderPicking(cgo, info, &I->context, I->cs->Setting.get(), I->obj->Setting.get());
+  } else {
+    CGORender(cgo, nullptr, nullptr, nullptr, info, I);
+
+    std::size_t ntri;
+    if (cgo->use_shader) {
+      ntri = CGOCountTriangles(cgo);
+    } else {
+      auto sp = G->Sphere->Sphere[std::clamp<int>(
+          cgo->sphere_quality, 0, NUMBER_OF_SPHERE_LEVELS - 1)];
+      ntri = std::size_t(I->nSpheres) * (sp->NVertTot - 2 * sp->NStrip);
+    }
+    pymol::LodStatsAdd(G, info, level, ntri);
+  }
+
+  cgo->sphere_quality = sphere_quality;
+}
+
 static void RepSphereRenderPick(RepSphere * I, RenderInfo * info, int sphere_mode)
 {
   assert(I->renderCGO);
 
+  if (I->renderTessellated) {
+    RepSphereRenderTriangles(I, info);
+    return;
+  }
+
   CGORenderPicking(I->renderCGO, info, &I->context, I->cs->Setting.get(), I->obj->Setting.get());
 }
 
@@ -175,6 +242,13 @@ void RepSphere::render(RenderInfo* info)
         if (I->renderCGO->use_shader != use_shader){
           CGOFree(I->renderCGO);
           I->renderCGO = 0;
+          I->renderTessellated = false;
+          for (auto& cgo : I->coarseCGO) {
+            CGOFree(cgo);
+          }
+        } else if (I->renderTessellated) {
+          RepSphereRenderTriangles(I, info);
+          return;
         } else {
           CGORender(I->renderCGO, nullptr, nullptr, nullptr, info, I);
           return;
@@ -203,8 +277,12 @@ void RepSphere::render(RenderInfo* info)
         I->cs->Active[cRepSphere] = false;
       }
 
-      if (I->renderCGO)
-        CGORender(I->renderCGO, nullptr, nullptr, nullptr, info, I);
+      if (I->renderCGO) {
+        if (I->renderTessellated)
+          RepSphereRenderTriangles(I, info);
+        else
+          CGORender(I->renderCGO, nullptr, nullptr, nullptr, info, I);
+      }
     }
   }
 }
@@ -536,6 +614,7 @@ Rep *RepSphereNew(CoordSet * cs, int state)
     if(marked[a1]) {
         int cnc = nspheres * 3;
         nspheres++;
+        I->lod.include(cs->coordPtr(a));
         VLACheck(v_tmp, float, cnc + 3);
         copy3f(cs->coordPtr(a), &v_tmp[cnc]);
     }
@@ -572,6 +651,7 @@ Rep *RepSphereNew(CoordSet * cs, int state)
                                          cartoon_side_chain_helper, ribbon_side_chain_helper);
       if(marked[a1]) {
         nspheres++;
+        I->lod.include(cs->coordPtr(a));
         RepSphereAddAtomVisInfoToStoredVC(I, obj, cs, state, a1, ati1, a,
             sphere_scale, sphere_color, transp, &variable_alpha, sphere_add,
             sphere_mode);
@@ -609,6 +689,7 @@ Rep *RepSphereNew(CoordSet * cs, int state)
   }
 
   FreeP(marked);
+  I->nSpheres = nspheres;
   if(nspheres == 0 || !ok) {
     delete I;
     I = nullptr;
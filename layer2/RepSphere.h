@@ -18,6 +18,7 @@ Z* -------------------------------------------------------------------
 #define _H_RepSphere
 
 #include"Rep.h"
+#include"LevelOfDetail.h"
 
 struct PyMOLGlobals;
 struct CoordSet;
@@ -30,7 +31,9 @@ struct RepSphere : Rep {
   ~RepSphere() override;
 
   cRep_t type() const override { return cRepSphere; }
+  bool rayViewIndependent() const override { return true; }
   void render(RenderInfo* info) override;
+  pymol::MemorySize getMemorySize() const override;
   bool sameVis() const override;
 
   bool* LastVisib = nullptr;
@@ -38,6 +41,14 @@ struct RepSphere : Rep {
   CGO* renderCGO = nullptr;
   CGO* primitiveCGO = nullptr;
   CGO* spheroidCGO = nullptr;
+
+  //! Number of spheres in primitiveCGO
+  int nSpheres = 0;
+
+  //! Tessellated renderCGO (sphere_mode 0) and its coarser levels
+  bool renderTessellated = false;
+  CGO* coarseCGO[pymol::LodLevelCount - 1] = {};
+  pymol::LodChunk lod;
 };
 
 Rep *RepSphereNew(CoordSet * cset, int state);
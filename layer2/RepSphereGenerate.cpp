@@ -20,6 +20,9 @@ Z* -------------------------------------------------------------------
 #include "ShaderMgr.h"
 #include "Err.h"
 #include "CoordSet.h"
+#include "LevelOfDetail.h"
+
+#include <memory>
 
 void RepSphere_Generate_Triangles(PyMOLGlobals *G, RepSphere *I,
                                   RenderInfo *info) {
@@ -51,9 +54,29 @@ void RepSphere_Generate_Triangles(PyMOLGlobals *G, RepSphere *I,
     I->cs->Active[cRepSphere] = false;
   } else {
     I->renderCGO->sphere_quality = sphere_quality;
+    I->renderTessellated = true;
   }
 }
 
+/* reduced sphere_quality for detail levels > 0, shader (VBO) path only,
+ * without shaders the quality is picked when rendering the spheres */
+CGO *RepSphere_Generate_Triangles_LOD(PyMOLGlobals *G, RepSphere *I,
+                                      int lod_level) {
+  int sphere_quality = pymol::LodQuality(
+      SettingGet_i(G, I->cs->Setting.get(), I->obj->Setting.get(),
+                   cSetting_sphere_quality),
+      lod_level, 0);
+
+  std::unique_ptr<CGO> convertcgo(CGOSimplify(I->primitiveCGO, 0, sphere_quality));
+  if (!convertcgo)
+    return nullptr;
+
+  CGO *cgo = CGOOptimizeToVBONotIndexed(convertcgo.get(), 0);
+  if (cgo)
+    cgo->sphere_quality = sphere_quality;
+  return cgo;
+}
+
 void RepSphere_Generate_Impostor_Spheres(PyMOLGlobals *G, RepSphere *I,
                                          RenderInfo *info) {
   if (!I->renderCGO) {
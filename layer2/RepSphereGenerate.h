@@ -19,9 +19,12 @@ Z* -------------------------------------------------------------------
 struct PyMOLGlobals;
 struct RepSphere;
 struct RenderInfo;
+class CGO;
 
 void RepSphere_Generate_Triangles(PyMOLGlobals *G, RepSphere *I,
                                   RenderInfo *info);
+CGO *RepSphere_Generate_Triangles_LOD(PyMOLGlobals *G, RepSphere *I,
+                                      int lod_level);
 void RepSphere_Generate_Impostor_Spheres(PyMOLGlobals *G, RepSphere *I,
                                          RenderInfo *info);
 void RepSphere_Generate_Point_Sprites(PyMOLGlobals *G, RepSphere *I,
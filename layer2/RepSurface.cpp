@@ -21,6 +21,7 @@ Z* -------------------------------------------------------------------
 
 #include "Base.h"
 #include "CGO.h"
+#include "CGOStreamBuilder.h"
 #include "Color.h"
 #include "CoordSet.h"
 #include "Err.h"
@@ -37,6 +38,7 @@ Z* -------------------------------------------------------------------
 #include "Setting.h"
 #include "ShaderMgr.h"
 #include "Sphere.h"
+#include "Trace.h"
 #include "Triangle.h"
 #include "Util.h"
 #include "Vector.h"
@@ -52,7 +54,10 @@ struct RepSurface : Rep {
   ~RepSurface() override;
 
   cRep_t type() const override { return cRepSurface; }
+  // dot and mesh widths are in pixels
+  bool rayViewIndependent() const override { return Type == 0; }
   void render(RenderInfo* info) override;
+  pymol::MemorySize getMemorySize() const override;
   void invalidate(cRepInv_t level) override;
   Rep* recolor() override;
   bool sameVis() const override;
@@ -130,6 +135,28 @@ RepSurface::~RepSurface()
   VLAFreeP(I->AT);
 }
 
+pymol::MemorySize RepSurface::getMemorySize() const
+{
+  auto size = Rep::getMemorySize();
+  size.host += pymol::memory_size(V) + pymol::memory_size(VN) +
+               pymol::memory_size(VAO) + pymol::memory_size(T) +
+               pymol::memory_size(S) + pymol::memory_size(AT);
+  // per vertex colors, alpha and visibility
+  if (VC)
+    size.host += N * 3 * sizeof(float);
+  if (VA)
+    size.host += N * sizeof(float);
+  if (RC)
+    size.host += N * sizeof(int);
+  if (Vis)
+    size.host += N * sizeof(int);
+  size += CGOGetMemorySize(shaderCGO);
+  // picking may reuse the shader CGO
+  if (pickingCGO != shaderCGO)
+    size += CGOGetMemorySize(pickingCGO);
+  return size;
+}
+
 struct SolventDot {
   int nDot{};
   float* dot{};
@@ -266,6 +293,93 @@ static int AtomInfoIsMasked(ObjectMolecule* obj, int atm)
   return (ait->masked ? cPickableNoPick : cPickableAtom);
 }
 
+/**
+ * Opaque solid surface: stream the triangles straight into draw buffers,
+ * instead of emitting them to I->shaderCGO and optimizing that.
+ *
+ * @return shader CGO, or nullptr on failure
+ */
+static CGO* RepSurfaceStreamOpaqueTriangles(
+    RepSurface* I, float alpha, bool pick_surface)
+{
+  PyMOLGlobals* G = I->G;
+  auto* const obj = I->cs->Obj;
+  const float* v = I->V;
+  const float* vn = I->VN;
+  const float* vc = I->VC;
+  const int* vi = I->Vis;
+
+  pymol::CGOStreamBuilder builder(G);
+
+  auto add_vertex = [&](int idx) {
+    if (!I->oneColorFlag) {
+      builder.alpha(alpha);
+      builder.color(vc + idx * 3);
+    }
+    builder.normal(vn + idx * 3);
+    if (I->VAO) {
+      builder.accessibility(I->VAO[idx]);
+    }
+    if (pick_surface) {
+      builder.pickColor(I->AT[idx], AtomInfoIsMasked(obj, I->AT[idx]));
+    }
+    builder.vertex(v + idx * 3);
+  };
+
+  if (I->oneColorFlag) {
+    float col[3];
+    ColorGetEncoded(G, I->oneColor, col);
+    builder.alpha(alpha);
+    builder.color(col);
+  }
+
+  if (I->allVisibleFlag) {
+    const int* s = I->S;
+    builder.reserve(I->NT * 3);
+    for (int c = *(s++); c; c = *(s++)) {
+      builder.begin(GL_TRIANGLE_STRIP);
+      add_vertex(*(s++));
+      add_vertex(*(s++));
+      while (c--) {
+        add_vertex(*(s++));
+      }
+      builder.end();
+    }
+  } else {
+    const int* t = I->T;
+    builder.begin(GL_TRIANGLES);
+    for (int c = I->NT; c--; t += 3) {
+      if (visibility_test(I->proximity, vi, t)) {
+        add_vertex(t[0]);
+        add_vertex(t[1]);
+        add_vertex(t[2]);
+      }
+    }
+    builder.end();
+  }
+
+  if (G->Interrupt) {
+    return nullptr;
+  }
+
+  CGO* convertcgo = builder.finish(false);
+  if (!convertcgo) {
+    // nothing visible
+    convertcgo = CGONew(G);
+    CGOStop(convertcgo);
+  }
+
+  CGO* cgo = CGONew(G);
+  CGOEnable(cgo, GL_SURFACE_SHADER);
+  CGOSpecial(cgo, SET_SURFACE_UNIFORMS);
+  CGOAppendNoStop(cgo, convertcgo);
+  CGODisable(cgo, GL_SURFACE_SHADER);
+  CGOStop(cgo);
+  CGOFreeWithoutVBOs(convertcgo);
+  cgo->use_shader = true;
+  return cgo;
+}
+
 static int RepSurfaceCGOGenerate(RepSurface* I, RenderInfo* info)
 {
   PyMOLGlobals* G = I->G;
@@ -309,6 +423,16 @@ static int RepSurfaceCGOGenerate(RepSurface* I, RenderInfo* info)
     I->setHasTransparency();
   }
 
+  if (I->Type != 1 && I->Type != 2 && alpha == 1.0F && !va &&
+      !SettingGetGlobal_i(G, cSetting_surface_debug)) {
+    setShaderCGO(I, RepSurfaceStreamOpaqueTriangles(I, alpha, pick_surface));
+    if (!I->shaderCGO)
+      return false;
+    I->shaderCGO->no_pick = !pick_surface;
+    setPickingCGO(I, I->shaderCGO);
+    return ok;
+  }
+
   if (I->Type == 1) {
     /* no triangle information, so we're rendering dots only */
     int normals = SettingGet<int>(
@@ -2852,6 +2976,7 @@ Rep* RepSurface::recolor()
       ok &= !G->Interrupt;
       if (ok && !I->AT)
         I->AT = VLACalloc(int, I->N);
+      ColorRampBatch ramp_batch;
       for (a = 0; ok && a < I->N; a++) {
         float at_transp = transp;
 
@@ -3010,7 +3135,7 @@ Rep* RepSurface::recolor()
             ramped_flag = true;
             break;
           }
-          ColorGetRamped(G, c1, v_pos, vc, state);
+          ramp_batch.add(c1, v_pos, vc);
           vc += 3;
           rc++;
         } else {
@@ -3049,6 +3174,7 @@ Rep* RepSurface::recolor()
         if (!*vi)
           I->allVisibleFlag = false;
       }
+      ramp_batch.flush(G, state);
       MapFree(map);
     }
     if (variable_alpha)
@@ -4361,6 +4487,7 @@ static int RepSurfaceRemoveAtomsNotWithinCutoff(PyMOLGlobals* G,
 
 Rep* RepSurfaceNew(CoordSet* cs, int state)
 {
+  PYMOL_TRACE_SCOPE("RepSurfaceNew", "rep", cs->Obj->Name);
   int ok = true;
   PyMOLGlobals* G = cs->G;
   ObjectMolecule* obj = cs->Obj;
@@ -38,6 +38,7 @@ struct RepWireBond : Rep {
 
   cRep_t type() const override { return cRepLine; }
   void render(RenderInfo* info) override;
+  pymol::MemorySize getMemorySize() const override;
 
   CGO *shaderCGO = nullptr;
   CGO *primitiveCGO = nullptr;
@@ -259,6 +260,14 @@ RepWireBond::~RepWireBond()
   CGOFree(primitiveCGO);
 }
 
+pymol::MemorySize RepWireBond::getMemorySize() const
+{
+  auto size = Rep::getMemorySize();
+  size += CGOGetMemorySize(primitiveCGO);
+  size += CGOGetMemorySize(shaderCGO);
+  return size;
+}
+
 
 /* lower memory use and higher performance for
    display of large trajectories, etc. */
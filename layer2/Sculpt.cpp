@@ -32,33 +32,22 @@ Z* -------------------------------------------------------------------
 #include "CoordSet.h"
 
 #include"CGO.h"
+#include"Map.h"
+
+#include <algorithm>
+
+#ifdef PYMOL_OPENMP
+#include <omp.h>
+#endif
 
 #ifndef R_SMALL8
 #define R_SMALL8 0.00000001
 #endif
 
-#define NB_HASH_SIZE 262144
 #define EX_HASH_SIZE 65536
 
-#define nb_hash(v) \
-(((((int)*(v  ))>> 2)&0x0003F)|\
- ((((int)*(v+1))<< 4)&0x00FC0)|\
- ((((int)*(v+2))<<10)&0x3F000))
-
-#define nb_hash_off_i0(v0i,d) \
-  ((((d)+v0i)>> 2)&0x0003F)
-
-#define nb_hash_off_i1(v1i,e) \
- ((((e)+v1i)<< 4)&0x00FC0)
-
-#define nb_hash_off_i2(v2i,f) \
- ((((f)+v2i)<<10)&0x3F000)
-
-#define nb_hash_off(v,d,e,f) \
-(((((d)+(int)*(v  ))>> 2)&0x0003F)|\
- ((((e)+(int)*(v+1))<< 4)&0x00FC0)|\
- ((((f)+(int)*(v+2))<<10)&0x3F000))
-
+#define NB_SKIN 1.0F /* Verlet list skin (Angstrom) */
+#define SCULPT_MIN_ATOMS_PER_THREAD 500
 
 /* below are empirically optimized */
 
@@ -236,8 +225,6 @@ CSculpt::CSculpt (PyMOLGlobals * G)
 {
   this->G = G;
   this->Shaker = std::make_unique<CShaker>(G);
-  this->NBList = pymol::vla<int>(150000);
-  this->NBHash = std::vector<int>(NB_HASH_SIZE);
   this->EXList = pymol::vla<int>(100000);
   this->EXHash = std::vector<int>(EX_HASH_SIZE);
   this->Don = pymol::vla<int>(1000);
@@ -406,8 +393,8 @@ void SculptMeasureObject(CSculpt * I, ObjectMolecule * obj, int state, int match
 
   ShakerReset(I->Shaker.get());
 
-  UtilZeroMem(I->NBHash.data(), NB_HASH_SIZE * sizeof(int));
   UtilZeroMem(I->EXHash.data(), EX_HASH_SIZE * sizeof(int));
+  I->NBValid = false;
 
   if((state >= 0) && (state < obj->NCSet) && (obj->CSet[state])) {
     obj_atomInfo = obj->AtomInfo.data();
@@ -1605,61 +1592,409 @@ static int SculptDoAvoid(float avoid, float range, float actual, float *d,
   return 0;
 }
 
+/**
+ * Exclusion class of an atom pair (b0 < b1), from the exclusion hash.
+ * 10 = no exclusion, 4 = 1-4 interaction, ...
+ */
+static int SculptGetExclusion(const CSculpt * I, int b0, int b1)
+{
+  int ex = 10;
+  const int *I_EXList = I->EXList.data();
+  int xoffset = I->EXHash[ex_hash(b0, b1)];
+  while(xoffset) {
+    const int *j = I_EXList + xoffset;
+    xoffset = *j;
+    if((*(j + 1) == b0) && (*(j + 2) == b1) && (*(j + 3) < ex)) {
+      ex = *(j + 3);
+    }
+  }
+  return ex;
+}
+
+/**
+ * Sum of VDW radii of a standard (non-excluded) pair, reduced for H-bonds
+ */
+static float SculptGetVDWCutoff(const CSculpt * I, const AtomInfoType * ai0,
+                                const AtomInfoType * ai1, int b0, int b1,
+                                float hb_overlap, float hb_overlap_base)
+{
+  float cutoff = ai0->vdw + ai1->vdw;
+  if(I->Don[b0] && I->Acc[b1]) {        /* h-bond */
+    if(ai0->protons == cAN_H) {
+      cutoff -= hb_overlap;
+    } else {
+      cutoff -= hb_overlap_base;
+    }
+  } else if(I->Acc[b0] && I->Don[b1]) { /* h-bond */
+    if(ai1->protons == cAN_H) {
+      cutoff -= hb_overlap;
+    } else {
+      cutoff -= hb_overlap_base;
+    }
+  }
+  return cutoff;
+}
+
+/**
+ * Settings and per-call state which all force terms of one iteration share
+ */
+struct SculptParams {
+  const CSculpt *I;
+  const AtomInfoType *atomInfo;
+  float *coord;
+  const int *atm2idx;
+  const int *exclude;
+  int mask;
+  float bond_wt, angl_wt, tri_wt, tri_sc, min_wt, min_sc, max_wt, max_sc;
+  float line_wt, pyra_wt, pyra_inv_wt, plan_wt, tors_wt, tors_tole;
+  float vdw, vdw14, vdw_wt, vdw_wt14, hb_overlap, hb_overlap_base;
+  float avd_wt, avd_gp, avd_rg, avd_range;
+  int avd_ex;
+};
+
+/**
+ * Displacement, constraint count and strain accumulator. There is one per
+ * thread, so force terms can be evaluated concurrently.
+ */
+struct SculptAccum {
+  float *disp;
+  int *cnt;
+  float strain;
+  int count;
+};
+
+static void SculptDoDistCon(const SculptParams & P, const ShakerDistCon * sdc,
+                            SculptAccum & acc)
+{
+  int eval_flag;
+  float wt, strain;
+  int b1 = sdc->at0;
+  int b2 = sdc->at1;
+
+  switch (sdc->type) {
+  case cShakerDistBond:
+    eval_flag = cSculptBond & P.mask;
+    wt = P.bond_wt;
+    break;
+  case cShakerDistAngle:
+    eval_flag = cSculptAngl & P.mask;
+    wt = P.angl_wt;
+    break;
+  case cShakerDistLimit:
+    eval_flag = cSculptTri & P.mask;
+    wt = P.tri_wt;
+    break;
+  case cShakerDistMinim:
+    eval_flag = cSculptMin & P.mask;
+    wt = P.min_wt * sdc->weight;
+    break;
+  case cShakerDistMaxim:
+    eval_flag = cSculptMax & P.mask;
+    wt = P.max_wt * sdc->weight;
+    break;
+  default:
+    return;
+  }
+
+  if(!eval_flag || P.exclude[b1] || P.exclude[b2])
+    return;
+
+  int a1 = P.atm2idx[b1];       /* coordinate set indices */
+  int a2 = P.atm2idx[b2];
+  if((a1 < 0) || (a2 < 0))
+    return;
+
+  float *v1 = P.coord + 3 * a1;
+  float *v2 = P.coord + 3 * a2;
+  float *d1 = acc.disp + b1 * 3;
+  float *d2 = acc.disp + b2 * 3;
+
+  switch (sdc->type) {
+  case cShakerDistLimit:
+    strain = ShakerDoDistLimit(sdc->targ * P.tri_sc, v1, v2, d1, d2, wt);
+    break;
+  case cShakerDistMaxim:
+    strain = ShakerDoDistLimit(sdc->targ * P.max_sc, v1, v2, d1, d2, wt);
+    break;
+  case cShakerDistMinim:
+    strain = ShakerDoDistMinim(sdc->targ * P.min_sc, v1, v2, d1, d2, wt);
+    break;
+  default:
+    acc.strain += ShakerDoDist(sdc->targ, v1, v2, d1, d2, wt);
+    acc.cnt[b1]++;
+    acc.cnt[b2]++;
+    acc.count++;
+    return;
+  }
+
+  if(strain > 0.0F) {
+    acc.cnt[b1]++;
+    acc.cnt[b2]++;
+    acc.strain += strain;
+    acc.count++;
+  }
+}
+
+/**
+ * Coordinate set indices of four constraint atoms, false if any of them is
+ * missing or excluded.
+ */
+static bool SculptGetIdx4(const SculptParams & P, int b0, int b1, int b2, int b3,
+                          int *a)
+{
+  a[0] = P.atm2idx[b0];
+  a[1] = P.atm2idx[b1];
+  a[2] = P.atm2idx[b2];
+  a[3] = P.atm2idx[b3];
+  return (a[0] >= 0) && (a[1] >= 0) && (a[2] >= 0) && (a[3] >= 0)
+    && !(P.exclude[b0] || P.exclude[b1] || P.exclude[b2] || P.exclude[b3]);
+}
+
+static void SculptCount4(SculptAccum & acc, int b0, int b1, int b2, int b3)
+{
+  acc.count++;
+  acc.cnt[b0]++;
+  acc.cnt[b1]++;
+  acc.cnt[b2]++;
+  acc.cnt[b3]++;
+}
+
+static void SculptDoLineCon(const SculptParams & P, const ShakerLineCon * slc,
+                            SculptAccum & acc)
+{
+  int b0 = slc->at0;
+  int b1 = slc->at1;
+  int b2 = slc->at2;
+  int a0 = P.atm2idx[b0];       /* coordinate set indices */
+  int a1 = P.atm2idx[b1];
+  int a2 = P.atm2idx[b2];
+
+  if((a0 >= 0) && (a1 >= 0) && (a2 >= 0)
+     && !(P.exclude[b0] || P.exclude[b1] || P.exclude[b2])) {
+    acc.cnt[b0]++;
+    acc.cnt[b1]++;
+    acc.cnt[b2]++;
+    acc.strain +=
+      ShakerDoLine(P.coord + 3 * a0, P.coord + 3 * a1, P.coord + 3 * a2,
+                   acc.disp + b0 * 3, acc.disp + b1 * 3, acc.disp + b2 * 3,
+                   P.line_wt);
+    acc.count++;
+  }
+}
+
+static void SculptDoPyraCon(const SculptParams & P, const ShakerPyraCon * spc,
+                            SculptAccum & acc)
+{
+  int a[4];
+  if(SculptGetIdx4(P, spc->at0, spc->at1, spc->at2, spc->at3, a)) {
+    acc.strain += ShakerDoPyra(spc->targ1, spc->targ2,
+                               P.coord + 3 * a[0], P.coord + 3 * a[1],
+                               P.coord + 3 * a[2], P.coord + 3 * a[3],
+                               acc.disp + spc->at0 * 3,
+                               acc.disp + spc->at1 * 3,
+                               acc.disp + spc->at2 * 3,
+                               acc.disp + spc->at3 * 3, P.pyra_wt, P.pyra_inv_wt);
+    SculptCount4(acc, spc->at0, spc->at1, spc->at2, spc->at3);
+  }
+}
+
+static void SculptDoPlanCon(const SculptParams & P, const ShakerPlanCon * snc,
+                            SculptAccum & acc)
+{
+  int a[4];
+  if(SculptGetIdx4(P, snc->at0, snc->at1, snc->at2, snc->at3, a)) {
+    acc.strain += ShakerDoPlan(P.coord + 3 * a[0], P.coord + 3 * a[1],
+                               P.coord + 3 * a[2], P.coord + 3 * a[3],
+                               acc.disp + snc->at0 * 3,
+                               acc.disp + snc->at1 * 3,
+                               acc.disp + snc->at2 * 3,
+                               acc.disp + snc->at3 * 3,
+                               snc->target, snc->fixed, P.plan_wt);
+    SculptCount4(acc, snc->at0, snc->at1, snc->at2, snc->at3);
+  }
+}
+
+static void SculptDoTorsCon(const SculptParams & P, const ShakerTorsCon * stc,
+                            SculptAccum & acc)
+{
+  int a[4];
+  if(SculptGetIdx4(P, stc->at0, stc->at1, stc->at2, stc->at3, a)) {
+    acc.strain += ShakerDoTors(stc->type,
+                               P.coord + 3 * a[0], P.coord + 3 * a[1],
+                               P.coord + 3 * a[2], P.coord + 3 * a[3],
+                               acc.disp + stc->at0 * 3,
+                               acc.disp + stc->at1 * 3,
+                               acc.disp + stc->at2 * 3,
+                               acc.disp + stc->at3 * 3, P.tors_tole, P.tors_wt);
+    SculptCount4(acc, stc->at0, stc->at1, stc->at2, stc->at3);
+  }
+}
+
+/**
+ * VDW, 1-4 VDW and surface avoidance terms of one nonbonded pair
+ */
+static void SculptDoPair(const SculptParams & P, const SculptPair & pair,
+                         float vdw_magnified, SculptAccum & acc)
+{
+  int b0 = pair.b0;
+  int b1 = pair.b1;
+  int ex = pair.ex;
+  const AtomInfoType *ai0 = P.atomInfo + b0;
+  const AtomInfoType *ai1 = P.atomInfo + b1;
+  float *v0 = P.coord + 3 * P.atm2idx[b0];
+  float *v1 = P.coord + 3 * P.atm2idx[b1];
+  float diff[3], len;
+
+  if(((cSculptVDW | cSculptVDW14) & P.mask) && (ex > 3)) {
+    if(ex == 10) {              /* standard interaction -- no exclusion */
+      if(cSculptVDW & P.mask) {
+        float vdw_cutoff = P.vdw * SculptGetVDWCutoff(P.I, ai0, ai1, b0, b1,
+                                                      P.hb_overlap,
+                                                      P.hb_overlap_base);
+        if(SculptCheckBump(v0, v1, diff, &len, vdw_cutoff) &&
+           SculptDoBump(vdw_cutoff, len, diff, acc.disp + b0 * 3, acc.disp + b1 * 3,
+                        P.vdw_wt * vdw_magnified, &acc.strain)) {
+          acc.cnt[b0]++;
+          acc.cnt[b1]++;
+          acc.count++;
+        }
+      }
+    } else if(ex == 4) {        /* 1-4 interation */
+      if(cSculptVDW14 & P.mask) {
+        float cutoff = (ai0->vdw + ai1->vdw) * P.vdw14;
+        if(SculptCheckBump(v0, v1, diff, &len, cutoff) &&
+           SculptDoBump(cutoff, len, diff, acc.disp + b0 * 3, acc.disp + b1 * 3,
+                        P.vdw_wt14 * vdw_magnified, &acc.strain)) {
+          acc.cnt[b0]++;
+          acc.cnt[b1]++;
+          acc.count++;
+        }
+      }
+    }
+  }
+
+  /* tweak nb distances to avoid sitting in the surface rendition danger
+     zone for too long (vdw1+vdw2+0.75*solvent) */
+  if((cSculptAvoid & P.mask) && (ex > P.avd_ex)) {
+    /* either non-covalent or extended chain */
+    float target = ai0->vdw + ai1->vdw + P.avd_gp;
+    if(SculptCheckAvoid(v0, v1, diff, &len, target, P.avd_rg) &&
+       SculptDoAvoid(target, P.avd_range, len, diff, acc.disp + b0 * 3,
+                     acc.disp + b1 * 3, P.avd_wt, &acc.strain)) {
+      acc.cnt[b0]++;
+      acc.cnt[b1]++;
+      acc.count++;
+    }
+  }
+}
+
+/**
+ * Updates the Verlet neighbor list. It's only rebuilt if any active atom
+ * moved by more than half the skin since the last build, or if the active
+ * atoms, the coordinate set or the required cutoff changed.
+ *
+ * @param cutoff Largest interaction distance of any pair
+ * @param min_ex Only store pairs with a larger exclusion class
+ */
+static void SculptUpdatePairList(CSculpt * I, const CoordSet * cs,
+                                 const int *atm2idx, const std::vector<int> & active,
+                                 float cutoff, int min_ex)
+{
+  PyMOLGlobals *G = I->G;
+  const float *cs_coord = cs->Coord.data();
+  int n_active = active.size();
+  auto & ref = I->NBRefCoord;
+
+  bool rebuild = !I->NBValid || (I->NBCoordSet != cs) || (I->NBCutoff < cutoff)
+    || (I->NBMinEx != min_ex) || (I->NBActive != active);
+
+  if(!rebuild) {
+    const float max_move_sq = (NB_SKIN * 0.5F) * (NB_SKIN * 0.5F);
+    for(int aa = 0; aa < n_active; aa++) {
+      if(diffsq3f(cs_coord + 3 * atm2idx[active[aa]], ref.data() + 3 * aa) > max_move_sq) {
+        rebuild = true;
+        break;
+      }
+    }
+  }
+
+  if(!rebuild)
+    return;
+
+  float range = cutoff + NB_SKIN;
+  float range_sq = range * range;
+
+  ref.resize(3 * n_active);
+  for(int aa = 0; aa < n_active; aa++) {
+    copy3f(cs_coord + 3 * atm2idx[active[aa]], ref.data() + 3 * aa);
+  }
+
+  I->NBPairs.clear();
+  I->NBValid = false;
+
+  std::unique_ptr<MapType> map(MapNew(G, -range, ref.data(), n_active, nullptr));
+  if(!map)
+    return;
+
+  for(int aa = 0; aa < n_active; aa++) {
+    const float *v0 = ref.data() + 3 * aa;
+    int b0 = active[aa];
+    for(const auto j : MapEIter(*map, v0)) {
+      /* active is sorted, so this is b1 > b0 */
+      if(j <= aa || diffsq3f(v0, ref.data() + 3 * j) > range_sq)
+        continue;
+      int b1 = active[j];
+      int ex = SculptGetExclusion(I, b0, b1);
+      if(ex > min_ex) {
+        I->NBPairs.push_back({b0, b1, ex});
+      }
+    }
+  }
+
+  I->NBActive = active;
+  I->NBCoordSet = cs;
+  I->NBCutoff = cutoff;
+  I->NBMinEx = min_ex;
+  I->NBValid = true;
+
+  PRINTFD(G, FB_Sculpt)
+    " SculptUpdatePairList-Debug: %d pairs within %.2f\n",
+    (int) I->NBPairs.size(), range ENDFD;
+}
+
+/**
+ * Number of threads for force evaluation, small systems aren't worth the
+ * fork/join and buffer reduction overhead.
+ */
+static int SculptGetNumThreads(int n_active)
+{
+#ifdef PYMOL_OPENMP
+  int n_thread = n_active / SCULPT_MIN_ATOMS_PER_THREAD;
+  return std::max(1, std::min(n_thread, omp_get_max_threads()));
+#else
+  return 1;
+#endif
+}
+
 float SculptIterateObject(CSculpt * I, ObjectMolecule * obj,
                           int state, int const n_cycle_arg, float *center)
 {
   PyMOLGlobals *G = I->G;
   CShaker *shk;
-  int a0, a1, a2, a3, b0, b3;
   int aa;
-  float *disp = nullptr;
-  float *v, *v0, *v1, *v2, *v3;
-  float diff[3], len;
-  int *atm2idx = nullptr;
-  int *cnt = nullptr;
-  int *i;
-  int hash;
-  int nb_next;
-  int h, k, l;
-  int offset;
-  float cutoff, vdw_cutoff;
-  int ex;
-  int eval_flag;
-  int mask;
-  float wt;
-  float vdw;
-  float vdw14;
-  float vdw_wt;
-  float vdw_wt14;
-  float bond_wt;
-  float angl_wt;
-  float pyra_wt, pyra_inv_wt;
-  float plan_wt;
-  float line_wt;
-  float tors_wt;
-  float tors_tole;
-  int active_flag = false;
-  float hb_overlap, hb_overlap_base;
-  int *active, n_active;
-  int *exclude;
-  const AtomInfoType *ai0, *ai1;
+  float *v1, *v2;
+  int nb_skip, nb_skip_count;
   double task_time;
   float vdw_magnify, vdw_magnified = 1.0F;
-  int nb_skip, nb_skip_count;
-  float total_strain = 0.0F, strain;
+  float total_strain = 0.0F;
   int total_count = 1;
   CGO *cgo = nullptr;
   float good_color[3] = { 0.2, 1.0, 0.2 };
   float bad_color[3] = { 1.0, 0.2, 0.2 };
   int vdw_vis_mode;
   float vdw_vis_min = 0.0F, vdw_vis_mid = 0.0F, vdw_vis_max = 0.0F;
-  float tri_sc, tri_wt;
-  float min_sc, min_wt;
-  float max_sc = 1.025F, max_wt = 0.75F;
-  float *cs_coord;
   float solvent_radius;
-  float avd_wt, avd_gp, avd_rg;
-  int avd_ex;
+  SculptParams P;
 
   PRINTFD(G, FB_Sculpt)
     " SculptIterateObject-Debug: entered state=%d n_cycle=%d\n", state, n_cycle_arg ENDFD;
@@ -1671,59 +2006,74 @@ float SculptIterateObject(CSculpt * I, ObjectMolecule * obj,
 
     int n_cycle = n_cycle_arg ? n_cycle_arg : -1;
 
-    disp = pymol::malloc<float>(3 * obj->NAtom);
-    atm2idx = pymol::malloc<int>(obj->NAtom);
-    cnt = pymol::malloc<int>(obj->NAtom);
-    active = pymol::malloc<int>(obj->NAtom);
-    exclude = pymol::calloc<int>(obj->NAtom);
+    /* persistent buffers, only grow */
+    I->Disp.resize(3 * obj->NAtom);
+    I->Cnt.resize(obj->NAtom);
+    I->Atm2Idx.resize(obj->NAtom);
+    I->Exclude.assign(obj->NAtom, false);
+    I->Active.clear();
+
+    float *disp = I->Disp.data();
+    int *cnt = I->Cnt.data();
+    int *atm2idx = I->Atm2Idx.data();
+    auto & active = I->Active;
     shk = I->Shaker.get();
 
     PRINTFD(G, FB_Sculpt)
       " SIO-Debug: NDistCon %d\n", shk->NDistCon ENDFD;
 
-    cs_coord = cs->Coord.data();
+    float *cs_coord = cs->Coord.data();
 
-    vdw = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_vdw_scale);
-    vdw14 = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_vdw_scale14);
-    vdw_wt = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_vdw_weight);
-    vdw_wt14 =
+    P.I = I;
+    P.atomInfo = obj->AtomInfo.data();
+    P.coord = cs_coord;
+    P.atm2idx = atm2idx;
+    P.exclude = I->Exclude.data();
+
+    P.vdw = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_vdw_scale);
+    P.vdw14 = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_vdw_scale14);
+    P.vdw_wt = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_vdw_weight);
+    P.vdw_wt14 =
       SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_vdw_weight14);
-    bond_wt = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_bond_weight);
-    angl_wt = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_angl_weight);
-    pyra_wt = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_pyra_weight);
-    pyra_inv_wt =
+    P.bond_wt = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_bond_weight);
+    P.angl_wt = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_angl_weight);
+    P.pyra_wt = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_pyra_weight);
+    P.pyra_inv_wt =
       SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_pyra_inv_weight);
-    plan_wt = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_plan_weight);
-    line_wt = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_line_weight);
-    tri_wt = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_tri_weight);
-    tri_sc = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_tri_scale);
-
-    min_wt = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_min_weight);
-    min_sc = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_min_scale);
-    max_wt = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_max_weight);
-    max_sc = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_max_scale);
-
-    mask = SettingGet_i(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_field_mask);
-    hb_overlap =
+    P.plan_wt = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_plan_weight);
+    P.line_wt = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_line_weight);
+    P.tri_wt = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_tri_weight);
+    P.tri_sc = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_tri_scale);
+
+    P.min_wt = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_min_weight);
+    P.min_sc = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_min_scale);
+    P.max_wt = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_max_weight);
+    P.max_sc = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_max_scale);
+
+    P.mask = SettingGet_i(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_field_mask);
+    P.hb_overlap =
       SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_hb_overlap);
-    hb_overlap_base =
+    P.hb_overlap_base =
       SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_hb_overlap_base);
-    tors_tole =
+    P.tors_tole =
       SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_tors_tolerance);
-    tors_wt = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_tors_weight);
+    P.tors_wt = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_tors_weight);
     vdw_vis_mode =
       SettingGet_i(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_vdw_vis_mode);
     solvent_radius =
       SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_solvent_radius);
 
-    avd_wt = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_avd_weight);
-    avd_gp = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_avd_gap);
-    avd_rg = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_avd_range);
-    avd_ex = SettingGet_i(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_avd_excl);
-    if(avd_gp < 0.0F)
-      avd_gp = 1.5F * solvent_radius;
-    if(avd_rg < 0.0F)
-      avd_rg = solvent_radius;
+    P.avd_wt = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_avd_weight);
+    P.avd_gp = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_avd_gap);
+    P.avd_rg = SettingGet_f(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_avd_range);
+    P.avd_ex = SettingGet_i(G, cs->Setting.get(), obj->Setting.get(), cSetting_sculpt_avd_excl);
+    if(P.avd_gp < 0.0F)
+      P.avd_gp = 1.5F * solvent_radius;
+    if(P.avd_rg < 0.0F)
+      P.avd_rg = solvent_radius;
+    P.avd_range = solvent_radius * 0.75;
+
+    int const mask = P.mask;
 
     if(vdw_vis_mode) {
       vdw_vis_min =
@@ -1748,41 +2098,63 @@ float SculptIterateObject(CSculpt * I, ObjectMolecule * obj,
     if(nb_skip < 0)
       nb_skip = 0;
 
-    n_active = 0;
-    ai0 = obj->AtomInfo;
+    float max_vdw = 0.0F;
     {
-      int a;
+      const AtomInfoType *ai0 = obj->AtomInfo;
+      int a, a1;
       for(a = 0; a < obj->NAtom; a++) {
         if(ai0->flags & cAtomFlag_exclude) {
-          exclude[a] = true;
+          I->Exclude[a] = true;
           a1 = -1;
         } else {
           a1 = cs->atmToIdx(a);
         }
         if(a1 >= 0) {
-          active_flag = true;
-          active[n_active] = a;
-          n_active++;
+          active.push_back(a);
+          if(ai0->vdw > max_vdw)
+            max_vdw = ai0->vdw;
         }
         atm2idx[a] = a1;
         ai0++;
       }
     }
 
-    if(active_flag) {
+    int n_active = active.size();
+
+    /* nonbonded pair list parameters */
+    int nb_min_ex = 10;
+    float nb_cutoff = 0.0F;
+    if((cSculptVDW | cSculptVDW14) & mask) {
+      nb_min_ex = 3;
+      nb_cutoff = 2.0F * max_vdw * std::max(1.0F, std::max(P.vdw, P.vdw14));
+      if(vdw_vis_mode)
+        nb_cutoff = std::max(nb_cutoff, 2.0F * max_vdw - vdw_vis_min);
+    }
+    if(cSculptAvoid & mask) {
+      nb_min_ex = std::min(nb_min_ex, P.avd_ex);
+      nb_cutoff = std::max(nb_cutoff, 2.0F * max_vdw + P.avd_gp + P.avd_rg);
+    }
+
+    /* per-thread displacement buffers (thread 0 uses disp/cnt) */
+    int const n_thread = SculptGetNumThreads(n_active);
+    if(I->ThreadDisp.size() < (size_t) n_thread) {
+      I->ThreadDisp.resize(n_thread);
+      I->ThreadCnt.resize(n_thread);
+    }
+    for(int t = 1; t < n_thread; t++) {
+      I->ThreadDisp[t].resize(3 * obj->NAtom);
+      I->ThreadCnt[t].resize(obj->NAtom);
+    }
 
-      /* first, create coordinate -> vertex mapping */
-      /* and count number of constraints */
+    if(n_active) {
 
       task_time = UtilGetSeconds(G);
       vdw_magnify = 1.0F;
       nb_skip_count = 0;
 
       if(center) {
-        int *a_ptr = active;
-        int a;
         for(aa = 0; aa < n_active; aa++) {
-          a = *(a_ptr++);
+          int a = active[aa];
           {
             AtomInfoType *ai = obj->AtomInfo + a;
             if((ai->protekted != cAtomProtected_explicit) && !(ai->flags & cAtomFlag_fix)) {
@@ -1797,506 +2169,156 @@ float SculptIterateObject(CSculpt * I, ObjectMolecule * obj,
       }
 
       while(n_cycle--) {
+        bool do_nonbonded = false;
 
         total_strain = 0.0F;
         total_count = 0;
-        /* initialize displacements to zero */
 
-        v = disp;
-        i = cnt;
-        for(aa = 0; aa < n_active; aa++) {
-          int a = active[aa];
-          v = disp + a * 3;
-          cnt[a] = 0;
-          *(v) = 0.0F;
-          *(v + 1) = 0.0F;
-          *(v + 2) = 0.0F;
-        }
-
-        /* apply distance constraints */
+        /* nonbonded interactions */
 
-        {
-          const ShakerDistCon *sdc = shk->DistCon.data();
-          int a,ndc = shk->NDistCon;
-          for(a = 0; a < ndc; a++) {
-            int sdc_type = sdc->type;
-            int b1 = sdc->at0;
-            int b2 = sdc->at1;
-
-            switch (sdc_type) {
-            case cShakerDistBond:
-              eval_flag = cSculptBond & mask;
-              wt = bond_wt;
-              break;
-            case cShakerDistAngle:
-              eval_flag = cSculptAngl & mask;
-              wt = angl_wt;
-              break;
-            case cShakerDistLimit:
-              eval_flag = cSculptTri & mask;
-              wt = tri_wt;
-              break;
-            case cShakerDistMinim:
-              eval_flag = cSculptMin & mask;
-              wt = min_wt * sdc->weight;
-              break;
-            case cShakerDistMaxim:
-              eval_flag = cSculptMax & mask;
-              wt = max_wt * sdc->weight;
-              break;
-            default:
-              eval_flag = false;
-              wt = 0.0F;
-              break;
-            }
+        if((n_cycle > 0) && (nb_skip_count > 0)) {
+          /*skip and then weight extra */
+          nb_skip_count--;
+          vdw_magnify += 1.0F;
+        } else {
+          vdw_magnified = vdw_magnify;
+          vdw_magnify = 1.0F;
 
-            if(eval_flag && !(exclude[b1] || exclude[b2])) {
-              a1 = atm2idx[b1]; /* coordinate set indices */
-              a2 = atm2idx[b2];
-              if((a1 >= 0) && (a2 >= 0)) {
-                v1 = cs_coord + 3 * a1;
-                v2 = cs_coord + 3 * a2;
-                switch (sdc_type) {
-                case cShakerDistLimit:
-                  strain =
-                    ShakerDoDistLimit(sdc->targ * tri_sc, v1, v2, disp + b1 * 3,
-                                      disp + b2 * 3, wt);
-                  if(strain > 0.0F) {
-                    cnt[b1]++;
-                    cnt[b2]++;
-                    total_strain += strain;
-                    total_count++;
-                  }
-                  break;
-                case cShakerDistMaxim:
-                  strain =
-                    ShakerDoDistLimit(sdc->targ * max_sc, v1, v2, disp + b1 * 3,
-                                      disp + b2 * 3, wt);
-                  if(strain > 0.0F) {
-                    cnt[b1]++;
-                    cnt[b2]++;
-                    total_strain += strain;
-                    total_count++;
-                  }
-                  break;
-                case cShakerDistMinim:
-                  strain =
-                    ShakerDoDistMinim(sdc->targ * min_sc, v1, v2, disp + b1 * 3,
-                                      disp + b2 * 3, wt);
-                  if(strain > 0.0F) {
-                    cnt[b1]++;
-                    cnt[b2]++;
-                    total_strain += strain;
-                    total_count++;
-                  }
-                  break;
-                default:
-                  total_strain +=
-                    ShakerDoDist(sdc->targ, v1, v2, disp + b1 * 3, disp + b2 * 3, wt);
-                  cnt[b1]++;
-                  cnt[b2]++;
-                  total_count++;
+          nb_skip_count = nb_skip;
+          if((cSculptVDW | cSculptVDW14 | cSculptAvoid) & mask) {
+            SculptUpdatePairList(I, cs, atm2idx, active, nb_cutoff, nb_min_ex);
+            do_nonbonded = true;
+
+            if(vdw_vis_mode && cgo && (n_cycle < 1) && (cSculptVDW & mask)) {
+              for(const auto & pair : I->NBPairs) {
+                if(pair.ex != 10)
+                  continue;
+                const AtomInfoType *ai0 = obj->AtomInfo + pair.b0;
+                const AtomInfoType *ai1 = obj->AtomInfo + pair.b1;
+                if((!((ai0->protekted != cAtomProtected_off &&
+                       ai1->protekted != cAtomProtected_off)
+                      || (ai0->flags & ai1->flags & cAtomFlag_fix))
+                    ) || (ai0->flags & cAtomFlag_study)
+                   || (ai1->flags & cAtomFlag_study)) {
+                  float cutoff = SculptGetVDWCutoff(I, ai0, ai1, pair.b0, pair.b1,
+                                                    P.hb_overlap, P.hb_overlap_base);
+                  SculptCGOBump(cs_coord + 3 * atm2idx[pair.b0],
+                                cs_coord + 3 * atm2idx[pair.b1],
+                                ai0->vdw, ai1->vdw, cutoff,
+                                vdw_vis_min, vdw_vis_mid, vdw_vis_max,
+                                good_color, bad_color, vdw_vis_mode, cgo);
                 }
               }
             }
-            sdc++;
-          }
-        }
-        /* apply line constraints */
-
-        if(cSculptLine & mask) {
-          const ShakerLineCon *slc = shk->LineCon.data();
-          int nlc = shk->NLineCon;
-          int a,b1,b2;
-          for(a = 0; a < nlc; a++) {
-            b0 = slc->at0;
-            b1 = slc->at1;
-            b2 = slc->at2;
-            a0 = atm2idx[b0];   /* coordinate set indices */
-            a1 = atm2idx[b1];
-            a2 = atm2idx[b2];
-
-            if((a0 >= 0) && (a1 >= 0) && (a2 >= 0)
-               && !(exclude[b0] || exclude[b1] || exclude[b2])) {
-              cnt[b0]++;
-              cnt[b1]++;
-              cnt[b2]++;
-              v0 = cs_coord + 3 * a0;
-              v1 = cs_coord + 3 * a1;
-              v2 = cs_coord + 3 * a2;
-              total_strain +=
-                ShakerDoLine(v0, v1, v2, disp + b0 * 3, disp + b1 * 3, disp + b2 * 3,
-                             line_wt);
-              total_count++;
-            }
-            slc++;
-          }
-        }
-
-        /* apply pyramid constraints */
-
-        if(cSculptPyra & mask) {
-          const ShakerPyraCon *spc = shk->PyraCon.data();
-          int npc = shk->NPyraCon;
-          int a,b1,b2;
-          for(a = 0; a < npc; a++) {
-
-            b0 = spc->at0;
-            b1 = spc->at1;
-            b2 = spc->at2;
-            b3 = spc->at3;
-            a0 = atm2idx[b0];
-            a1 = atm2idx[b1];
-            a2 = atm2idx[b2];
-            a3 = atm2idx[b3];
-
-            if((a0 >= 0) && (a1 >= 0) && (a2 >= 0) && (a3 >= 0)
-               && !(exclude[b0] || exclude[b1] || exclude[b2] || exclude[b3])) {
-              v0 = cs_coord + 3 * a0;
-              v1 = cs_coord + 3 * a1;
-              v2 = cs_coord + 3 * a2;
-              v3 = cs_coord + 3 * a3;
-              total_strain += ShakerDoPyra(spc->targ1,
-                                           spc->targ2,
-                                           v0, v1, v2, v3,
-                                           disp + b0 * 3,
-                                           disp + b1 * 3,
-                                           disp + b2 * 3,
-                                           disp + b3 * 3, pyra_wt, pyra_inv_wt);
-              total_count++;
-
-              cnt[b0]++;
-              cnt[b1]++;
-              cnt[b2]++;
-              cnt[b3]++;
-            }
-            spc++;
           }
         }
 
-        if(cSculptPlan & mask) {
-          const ShakerPlanCon *snc = shk->PlanCon.data();
-          int npc = shk->NPlanCon;
-          int a,b1,b2;
-          /* apply planarity constraints */
+        /* evaluate all terms, each thread into its own buffers */
 
-          for(a = 0; a < npc; a++) {
-
-            b0 = snc->at0;
-            b1 = snc->at1;
-            b2 = snc->at2;
-            b3 = snc->at3;
-            a0 = atm2idx[b0];
-            a1 = atm2idx[b1];
-            a2 = atm2idx[b2];
-            a3 = atm2idx[b3];
-
-            if((a0 >= 0) && (a1 >= 0) && (a2 >= 0) && (a3 >= 0)
-               && !(exclude[b0] || exclude[b1] || exclude[b2] || exclude[b3])) {
-              v0 = cs_coord + 3 * a0;
-              v1 = cs_coord + 3 * a1;
-              v2 = cs_coord + 3 * a2;
-              v3 = cs_coord + 3 * a3;
-              total_strain += ShakerDoPlan(v0, v1, v2, v3,
-                                           disp + b0 * 3,
-                                           disp + b1 * 3,
-                                           disp + b2 * 3,
-                                           disp + b3 * 3,
-                                           snc->target, snc->fixed, plan_wt);
-              total_count++;
-              cnt[b0]++;
-              cnt[b1]++;
-              cnt[b2]++;
-              cnt[b3]++;
-            }
+        const SculptPair *nb_pairs = I->NBPairs.data();
+        int n_pair = do_nonbonded ? I->NBPairs.size() : 0;
 
-            snc++;
+#ifdef PYMOL_OPENMP
+#pragma omp parallel num_threads(n_thread) reduction(+ : total_strain, total_count)
+#endif
+        {
+#ifdef PYMOL_OPENMP
+          int const t = omp_get_thread_num();
+          int const n_team = omp_get_num_threads();
+#else
+          int const t = 0;
+          int const n_team = 1;
+#endif
+          SculptAccum acc = {
+            t ? I->ThreadDisp[t].data() : disp,
+            t ? I->ThreadCnt[t].data() : cnt,
+            0.0F, 0 };
+
+          /* initialize displacements to zero */
+          for(int i = 0; i < n_active; i++) {
+            int a = active[i];
+            zero3f(acc.disp + a * 3);
+            acc.cnt[a] = 0;
           }
-        }
 
-        /* apply torsion constraints */
-
-        if(cSculptTors & mask) {
-          const ShakerTorsCon *stc = shk->TorsCon.data();
-          int ntc = shk->NTorsCon;
-          int a,b1,b2;
-          /* apply planarity constraints */
+          /* apply distance constraints */
+#ifdef PYMOL_OPENMP
+#pragma omp for schedule(static) nowait
+#endif
+          for(int a = 0; a < shk->NDistCon; a++)
+            SculptDoDistCon(P, shk->DistCon + a, acc);
 
-          for(a = 0; a < ntc; a++) {
-
-            b0 = stc->at0;
-            b1 = stc->at1;
-            b2 = stc->at2;
-            b3 = stc->at3;
-            a0 = atm2idx[b0];
-            a1 = atm2idx[b1];
-            a2 = atm2idx[b2];
-            a3 = atm2idx[b3];
-
-            if((a0 >= 0) && (a1 >= 0) && (a2 >= 0) && (a3 >= 0)
-               && !(exclude[b0] || exclude[b1] || exclude[b2] || exclude[b3])) {
-              v0 = cs_coord + 3 * a0;
-              v1 = cs_coord + 3 * a1;
-              v2 = cs_coord + 3 * a2;
-              v3 = cs_coord + 3 * a3;
-              total_strain += ShakerDoTors(stc->type,
-                                           v0, v1, v2, v3,
-                                           disp + b0 * 3,
-                                           disp + b1 * 3,
-                                           disp + b2 * 3,
-                                           disp + b3 * 3, tors_tole, tors_wt);
-              total_count++;
-              cnt[b0]++;
-              cnt[b1]++;
-              cnt[b2]++;
-              cnt[b3]++;
-            }
-            stc++;
+          /* apply line constraints */
+          if(cSculptLine & mask) {
+#ifdef PYMOL_OPENMP
+#pragma omp for schedule(static) nowait
+#endif
+            for(int a = 0; a < shk->NLineCon; a++)
+              SculptDoLineCon(P, shk->LineCon + a, acc);
           }
-        }
-        /* apply nonbonded interactions */
 
-        if((n_cycle > 0) && (nb_skip_count > 0)) {
-          /*skip and then weight extra */
-          nb_skip_count--;
-          vdw_magnify += 1.0F;
-        } else {
-          int nb_off0, nb_off1;
-          int v0i, v1i, v2i;
-          int x0i;
-          int don_b0;
-          int acc_b0;
-          int b1;
-          vdw_magnified = vdw_magnify;
-          vdw_magnify = 1.0F;
+          /* apply pyramid constraints */
+          if(cSculptPyra & mask) {
+#ifdef PYMOL_OPENMP
+#pragma omp for schedule(static) nowait
+#endif
+            for(int a = 0; a < shk->NPyraCon; a++)
+              SculptDoPyraCon(P, shk->PyraCon + a, acc);
+          }
 
-          nb_skip_count = nb_skip;
-          if((cSculptVDW | cSculptVDW14 | cSculptAvoid) & mask) {
-            /* compute non-bonded interations */
+          /* apply planarity constraints */
+          if(cSculptPlan & mask) {
+#ifdef PYMOL_OPENMP
+#pragma omp for schedule(static) nowait
+#endif
+            for(int a = 0; a < shk->NPlanCon; a++)
+              SculptDoPlanCon(P, shk->PlanCon + a, acc);
+          }
 
-            /* construct nonbonded hash */
+          /* apply torsion constraints */
+          if(cSculptTors & mask) {
+#ifdef PYMOL_OPENMP
+#pragma omp for schedule(static) nowait
+#endif
+            for(int a = 0; a < shk->NTorsCon; a++)
+              SculptDoTorsCon(P, shk->TorsCon + a, acc);
+          }
 
-            nb_next = 1;
-            for(aa = 0; aa < n_active; aa++) {
-              b0 = active[aa];
-              a0 = atm2idx[b0];
-              VLACheck(I->NBList, int, nb_next + 2);
-              v0 = cs_coord + 3 * a0;
-              hash = nb_hash(v0);
-              i = I->NBList + nb_next;
-              *(i++) = I->NBHash[hash];
-              *(i++) = hash;
-              *(i++) = b0;
-              I->NBHash[hash] = nb_next;
-              nb_next += 3;
-            }
+          /* apply nonbonded interactions */
+#ifdef PYMOL_OPENMP
+#pragma omp for schedule(static) nowait
+#endif
+          for(int a = 0; a < n_pair; a++)
+            SculptDoPair(P, nb_pairs[a], vdw_magnified, acc);
 
-            /* find neighbors for each atom */
-            if((cSculptVDW | cSculptVDW14) & mask) {
-              for(aa = 0; aa < n_active; aa++) {
-                b0 = active[aa];
-                a0 = atm2idx[b0];
-                ai0 = obj->AtomInfo + b0;
-                v0 = cs_coord + 3 * a0;
-                don_b0 = I->Don[b0];
-                acc_b0 = I->Acc[b0];
-                v0i = (int) (*v0);
-                v1i = (int) (*(v0 + 1));
-                v2i = (int) (*(v0 + 2));
-                x0i = ex_hash_i0(b0);
-                for(h = -4; h < 5; h += 4) {
-                  nb_off0 = nb_hash_off_i0(v0i, h);
-                  for(k = -4; k < 5; k += 4) {
-                    nb_off1 = nb_off0 | nb_hash_off_i1(v1i, k);
-                    for(l = -4; l < 5; l += 4) {
-                      /*  offset = *(I->NBHash+nb_hash_off(v0,h,k,l)); */
-                      offset = I->NBHash[nb_off1 | nb_hash_off_i2(v2i, l)];
-                      while(offset) {
-                        i = I->NBList + offset;
-                        b1 = *(i + 2);
-                        if(b1 > b0) {
-                          /* determine exclusion (if any) */
-                          {
-                            int xoffset;
-                            const int *I_EXList = I->EXList.data();
-                            int ex1;
-                            const int *j;
-                            xoffset = I->EXHash[x0i | ex_hash_i1(b1)];
-                            ex = 10;
-                            while(xoffset) {
-                              xoffset = (*(j = I_EXList + xoffset));
-                              if((*(j + 1) == b0) && (*(j + 2) == b1)) {
-                                ex1 = *(j + 3);
-                                if(ex1 < ex) {
-                                  ex = ex1;
-                                }
-                              }
-                            }
-                          }
-                          if(ex > 3) {
-                            ai1 = obj->AtomInfo + b1;
-                            cutoff = ai0->vdw + ai1->vdw;
-
-                            if(ex == 10) {      /* standard interaction -- no exclusion */
-                              if(don_b0 && I->Acc[b1]) {        /* h-bond */
-                                if(ai0->protons == cAN_H) {
-                                  cutoff -= hb_overlap;
-                                } else {
-                                  cutoff -= hb_overlap_base;
-                                }
-                              } else if(acc_b0 && I->Don[b1]) { /* h-bond */
-                                if(ai1->protons == cAN_H) {
-                                  cutoff -= hb_overlap;
-                                } else {
-                                  cutoff -= hb_overlap_base;
-                                }
-                              }
-                              if(cSculptVDW & mask) {
-                                vdw_cutoff = cutoff * vdw;
-                                wt = vdw_wt * vdw_magnified;
-                                a1 = atm2idx[b1];
-                                v1 = cs_coord + 3 * a1;
-                                if(vdw_vis_mode && cgo && (n_cycle < 1)
-                                   && ((!((ai0->protekted != cAtomProtected_off &&
-                                           ai1->protekted != cAtomProtected_off)
-                                          || (ai0->flags & ai1->flags & cAtomFlag_fix))
-                                       ) || (ai0->flags & cAtomFlag_study)
-                                       || (ai1->flags & cAtomFlag_study))) {
-                                  SculptCGOBump(v0, v1, ai0->vdw, ai1->vdw, cutoff,
-                                                vdw_vis_min, vdw_vis_mid, vdw_vis_max,
-                                                good_color, bad_color, vdw_vis_mode, cgo);
-                                }
-                                if(SculptCheckBump(v0, v1, diff, &len, vdw_cutoff))
-                                  if(SculptDoBump(vdw_cutoff, len, diff,
-                                                  disp + b0 * 3, disp + b1 * 3, wt,
-                                                  &total_strain)) {
-                                    cnt[b0]++;
-                                    cnt[b1]++;
-                                    total_count++;
-                                  }
-                              }
-                            } else if(ex == 4) {        /* 1-4 interation */
-                              cutoff *= vdw14;
-                              wt = vdw_wt14 * vdw_magnified;
-
-                              if(cSculptVDW14 & mask) {
-                                a1 = atm2idx[b1];
-                                v1 = cs_coord + 3 * a1;
-                                if(SculptCheckBump(v0, v1, diff, &len, cutoff)) {
-                                  if(SculptDoBump(cutoff, len, diff,
-                                                  disp + b0 * 3, disp + b1 * 3, wt,
-                                                  &total_strain)) {
-                                    cnt[b0]++;
-                                    cnt[b1]++;
-                                    total_count++;
-                                  }
-                                }
-                              }
-                            } else if(ex == 5) {
-                              /* do nothing */
-                            }
-                          }
-                        }
-                        offset = (*i);
-                      }
-                    }
-                  }
-                }
-              }
-            }
+          total_strain += acc.strain;
+          total_count += acc.count;
 
-            if(cSculptAvoid & mask) {
-              float target;
-              float range = solvent_radius * 0.75;
-              /* tweak nb distances to avoid
-                 sitting in the surface
-                 rendition danger zone for too
-                 long (vdw1+vdw2+0.75*solvent) */
-              for(aa = 0; aa < n_active; aa++) {
-                b0 = active[aa];
-                a0 = atm2idx[b0];
-                ai0 = obj->AtomInfo + b0;
-                v0 = cs_coord + 3 * a0;
-                don_b0 = I->Don[b0];
-                acc_b0 = I->Acc[b0];
-                v0i = (int) (*v0);
-                v1i = (int) (*(v0 + 1));
-                v2i = (int) (*(v0 + 2));
-                x0i = ex_hash_i0(b0);
-                for(h = -8; h < 9; h += 4) {
-                  nb_off0 = nb_hash_off_i0(v0i, h);
-                  for(k = -8; k < 9; k += 4) {
-                    nb_off1 = nb_off0 | nb_hash_off_i1(v1i, k);
-                    for(l = -8; l < 9; l += 4) {
-                      /*  offset = *(I->NBHash+nb_hash_off(v0,h,k,l)); */
-                      offset = I->NBHash[nb_off1 | nb_hash_off_i2(v2i, l)];
-                      while(offset) {
-                        i = I->NBList + offset;
-                        b1 = *(i + 2);
-                        if(b1 > b0) {
-                          /* determine exclusion (if any) */
-                          {
-                            int xoffset;
-                            const int *I_EXList = I->EXList.data();
-                            int ex1;
-                            const int *j;
-                            xoffset = I->EXHash[x0i | ex_hash_i1(b1)];
-                            ex = 10;
-                            while(xoffset) {
-                              xoffset = (*(j = I_EXList + xoffset));
-                              if((*(j + 1) == b0) && (*(j + 2) == b1)) {
-                                ex1 = *(j + 3);
-                                if(ex1 < ex) {
-                                  ex = ex1;
-                                }
-                              }
-                            }
-                          }
-                          if(ex > avd_ex) {     /* either non-covalent or extended chain */
-                            ai1 = obj->AtomInfo + b1;
-                            target = ai0->vdw + ai1->vdw + avd_gp;
-                            a1 = atm2idx[b1];
-                            v1 = cs_coord + 3 * a1;
-
-                            if(SculptCheckAvoid(v0, v1, diff, &len, target, avd_rg)) {
-                              if(SculptDoAvoid(target, range, len, diff,
-                                               disp + b0 * 3, disp + b1 * 3, avd_wt,
-                                               &total_strain)) {
-                                cnt[b0]++;
-                                cnt[b1]++;
-                                total_count++;
-                              }
-                            }
-                          }
-                        }
-                        offset = (*i);
-                      }
-                    }
-                  }
-                }
+          /* sum up the per-thread buffers */
+          if(n_team > 1) {
+#ifdef PYMOL_OPENMP
+#pragma omp barrier
+#pragma omp for schedule(static)
+#endif
+            for(int i = 0; i < n_active; i++) {
+              int a = active[i];
+              for(int t2 = 1; t2 < n_team; t2++) {
+                add3f(I->ThreadDisp[t2].data() + a * 3, disp + a * 3, disp + a * 3);
+                cnt[a] += I->ThreadCnt[t2][a];
               }
             }
-
-            /* clean up nonbonded hash */
-
-            i = I->NBList + 2;
-            while(nb_next > 1) {
-              I->NBHash[*i] = 0;
-              i += 3;
-              nb_next -= 3;
-            }
           }
         }
+
         /* average the displacements */
 
         if(n_cycle >= 0) {
           int cnt_a,a;
           float _1 = 1.0F;
           float inv_cnt;
-          int *a_ptr = active;
-          float *lookup_inverse = I->inverse;
+          const float *lookup_inverse = I->inverse;
           for(aa = 0; aa < n_active; aa++) {
-            if((cnt_a = cnt[(a = *(a_ptr++))])) {
+            if((cnt_a = cnt[(a = active[aa])])) {
               AtomInfoType *ai = obj->AtomInfo + a;
               const RefPosType *cs_refpos = cs->RefPos.data();
               int flags;
@@ -2331,10 +2353,9 @@ float SculptIterateObject(CSculpt * I, ObjectMolecule * obj,
           SceneDirty(G);
         }
         if(n_cycle <= 0) {
-          int *a_ptr = active;
           if(center)
             for(aa = 0; aa < n_active; aa++) {
-              int a = *(a_ptr++);
+              int a = active[aa];
               {
                 AtomInfoType *ai = obj->AtomInfo + a;
                 if((ai->protekted != cAtomProtected_explicit) && !(ai->flags & cAtomFlag_fix)) {
@@ -2358,11 +2379,6 @@ float SculptIterateObject(CSculpt * I, ObjectMolecule * obj,
       if(total_count)
         total_strain = (1000 * total_strain) / total_count;
     }
-    FreeP(exclude);
-    FreeP(active);
-    FreeP(cnt);
-    FreeP(disp);
-    FreeP(atm2idx);
     if(cgo) {
       CGOStop(cgo);
       {
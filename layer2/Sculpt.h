@@ -21,6 +21,7 @@ Z* -------------------------------------------------------------------
 #include"vla.h"
 
 #include <memory>
+#include <vector>
 
 #define cSculptBond  0x001
 #define cSculptAngl  0x002
@@ -35,12 +36,37 @@ Z* -------------------------------------------------------------------
 #define cSculptMax   0x400
 #define cSculptAvoid 0x800
 
+struct CoordSet;
+
+/* nonbonded atom pair (b0 < b1) with its exclusion class */
+struct SculptPair {
+  int b0, b1;
+  int ex;
+};
+
 struct CSculpt {
   PyMOLGlobals *G;
   std::unique_ptr<CShaker> Shaker;
   ObjectMolecule *Obj;
-  std::vector<int> NBHash;
-  pymol::vla<int> NBList;
+
+  /* Verlet neighbor list, see SculptUpdatePairList */
+  std::vector<SculptPair> NBPairs;
+  std::vector<float> NBRefCoord;
+  std::vector<int> NBActive;
+  const CoordSet *NBCoordSet = nullptr;
+  float NBCutoff = 0.0F;
+  int NBMinEx = 0;
+  bool NBValid = false;
+
+  /* per-iteration buffers, indexed by atom, kept between calls */
+  std::vector<float> Disp;
+  std::vector<int> Cnt;
+  std::vector<int> Atm2Idx;
+  std::vector<int> Active;
+  std::vector<int> Exclude;
+  std::vector<std::vector<float>> ThreadDisp;
+  std::vector<std::vector<int>> ThreadCnt;
+
   std::vector<int> EXHash;
   pymol::vla<int> EXList;
   pymol::vla<int> Don;
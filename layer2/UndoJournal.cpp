@@ -0,0 +1,516 @@
+/**
+ * @file
+ * Delta-compressed undo history for ObjectMolecule edits
+ */
+
+#include "UndoJournal.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+
+#include "CoordSet.h"
+#include "ObjectMolecule.h"
+#include "Setting.h"
+
+namespace pymol
+{
+
+static_assert(offsetof(UndoJournal::AtomProps, pad_) +
+                      sizeof(UndoJournal::AtomProps::pad_) ==
+                  sizeof(UndoJournal::AtomProps),
+    "AtomProps must not have implicit padding");
+
+static UndoJournal::AtomProps AtomPropsGet(const AtomInfoType& ai)
+{
+  UndoJournal::AtomProps p;
+  memset(&p, 0, sizeof(p));
+  p.b = ai.b;
+  p.q = ai.q;
+  p.vdw = ai.vdw;
+  p.partialCharge = ai.partialCharge;
+  p.elec_radius = ai.elec_radius;
+  p.color = ai.color;
+  p.visRep = ai.visRep;
+  p.resv = ai.resv;
+  p.flags = ai.flags;
+  p.formalCharge = ai.formalCharge;
+  p.cartoon = ai.cartoon;
+  memcpy(p.ssType, ai.ssType, sizeof(p.ssType));
+  p.hetatm = ai.hetatm;
+  p.protekted = ai.protekted;
+  return p;
+}
+
+static void AtomPropsSet(AtomInfoType& ai, const UndoJournal::AtomProps& p)
+{
+  ai.b = p.b;
+  ai.q = p.q;
+  ai.vdw = p.vdw;
+  ai.partialCharge = p.partialCharge;
+  ai.elec_radius = p.elec_radius;
+  ai.color = p.color;
+  ai.visRep = p.visRep;
+  ai.resv = p.resv;
+  ai.flags = p.flags;
+  ai.formalCharge = p.formalCharge;
+  ai.cartoon = p.cartoon;
+  memcpy(ai.ssType, p.ssType, sizeof(p.ssType));
+  ai.hetatm = p.hetatm;
+  ai.protekted = p.protekted;
+}
+
+/**
+ * XOR the bit patterns of `x` into `dst` (word-wise)
+ */
+template <typename T> static void XorInto(T& dst, const T& x)
+{
+  constexpr std::size_t N = sizeof(T) / sizeof(std::uint32_t);
+  std::uint32_t a[N], b[N];
+  memcpy(a, &dst, sizeof(T));
+  memcpy(b, &x, sizeof(T));
+  for (std::size_t i = 0; i < N; ++i) {
+    a[i] ^= b[i];
+  }
+  memcpy(&dst, a, sizeof(T));
+}
+
+static bool BondMatches(const BondType& bond, const UndoJournal::BondRec& rec)
+{
+  return bond.index[0] == rec.index[0] && bond.index[1] == rec.index[1] &&
+         bond.order == rec.order;
+}
+
+static void BondsGet(
+    const ObjectMolecule* obj, std::vector<UndoJournal::BondRec>& recs)
+{
+  recs.resize(obj->NBond);
+  for (int b = 0; b < obj->NBond; ++b) {
+    const auto& bond = obj->Bond[b];
+    recs[b] = {{bond.index[0], bond.index[1]}, bond.order};
+  }
+}
+
+/**
+ * Replace the object's bonds. Bonds which exist before and after keep their
+ * unique_id (and bond-level settings).
+ */
+static void BondsSet(
+    ObjectMolecule* obj, const std::vector<UndoJournal::BondRec>& recs)
+{
+  PyMOLGlobals* G = obj->G;
+  int const nBond = recs.size();
+
+  if (nBond == obj->NBond) {
+    int b = 0;
+    for (; b < nBond; ++b) {
+      const auto& bond = obj->Bond[b];
+      if (bond.index[0] != recs[b].index[0] ||
+          bond.index[1] != recs[b].index[1])
+        break;
+    }
+    if (b == nBond) {
+      for (b = 0; b < nBond; ++b) {
+        obj->Bond[b].order = recs[b].order;
+      }
+      obj->invalidate(cRepAll, cRepInvBonds, -1);
+      return;
+    }
+  }
+
+  std::map<std::pair<int, int>, int> old_bonds;
+  for (int b = 0; b < obj->NBond; ++b) {
+    const auto& bond = obj->Bond[b];
+    old_bonds[{bond.index[0], bond.index[1]}] = b;
+  }
+
+  pymol::vla<BondType> bonds(nBond);
+  for (int b = 0; b < nBond; ++b) {
+    const auto& rec = recs[b];
+    auto it = old_bonds.find({rec.index[0], rec.index[1]});
+    if (it != old_bonds.end() && it->second >= 0) {
+      bonds[b] = obj->Bond[it->second];
+      bonds[b].order = rec.order;
+      it->second = -1;
+    } else {
+      BondTypeInit2(&bonds[b], rec.index[0], rec.index[1], rec.order);
+    }
+  }
+
+  for (const auto& item : old_bonds) {
+    if (item.second >= 0) {
+      AtomInfoPurgeBond(G, &obj->Bond[item.second]);
+    }
+  }
+
+  obj->Bond = std::move(bonds);
+  obj->NBond = nBond;
+
+  for (const auto& rec : recs) {
+    obj->AtomInfo[rec.index[0]].chemFlag = false;
+    obj->AtomInfo[rec.index[1]].chemFlag = false;
+  }
+
+  ObjectMoleculeUpdateNonbonded(obj);
+  obj->invalidate(cRepAll, cRepInvBonds, -1);
+}
+
+std::size_t UndoJournal::Step::memoryUsage() const
+{
+  std::size_t bytes = sizeof(Step);
+  for (const auto& delta : coords) {
+    bytes += sizeof(CoordDelta) + delta.idx.capacity() * sizeof(int) +
+             delta.bits.capacity() * sizeof(std::uint32_t);
+  }
+  bytes += atomIdx.capacity() * sizeof(int) +
+           atomBits.capacity() * sizeof(AtomProps);
+  bytes += (bondsBefore.capacity() + bondsAfter.capacity()) * sizeof(BondRec);
+  return bytes;
+}
+
+std::size_t UndoJournal::shadowMemoryUsage() const
+{
+  std::size_t bytes = m_atoms.capacity() * sizeof(AtomProps) +
+                      m_bonds.capacity() * sizeof(BondRec);
+  for (const auto& item : m_coords) {
+    bytes += item.second.capacity() * sizeof(float);
+  }
+  return bytes;
+}
+
+void UndoJournal::clear()
+{
+  m_undo.clear();
+  m_redo.clear();
+  m_stepBytes = 0;
+  m_valid = false;
+  m_nAtom = 0;
+  m_coords.clear();
+  m_atoms.clear();
+  m_bonds.clear();
+  m_mergeKey = 0;
+  m_touchedAll = true;
+  m_touched.clear();
+}
+
+/**
+ * True if the shadow copy is compatible with the object (same atoms in the
+ * same order, same number of coordinates). Otherwise the recorded indices
+ * are meaningless.
+ */
+bool UndoJournal::snapshotMatches(const ObjectMolecule* obj) const
+{
+  if (!m_valid || obj->NAtom != m_nAtom ||
+      obj->AtomOrderGeneration != m_atomOrderGeneration)
+    return false;
+
+  for (const auto& item : m_coords) {
+    if (item.first >= obj->NCSet)
+      return false;
+    const CoordSet* cs = obj->CSet[item.first];
+    if (!cs || item.second.size() != std::size_t(cs->NIndex) * 3)
+      return false;
+  }
+
+  return true;
+}
+
+/**
+ * Initialize the shadow copy, and add the coordinates of `state` to it if
+ * it's not there yet.
+ */
+void UndoJournal::snapshot(const ObjectMolecule* obj, int state)
+{
+  if (!m_valid) {
+    m_nAtom = obj->NAtom;
+    m_atomOrderGeneration = obj->AtomOrderGeneration;
+    m_atoms.resize(obj->NAtom);
+    for (int a = 0; a < obj->NAtom; ++a) {
+      m_atoms[a] = AtomPropsGet(obj->AtomInfo[a]);
+    }
+    BondsGet(obj, m_bonds);
+    m_valid = true;
+  }
+
+  if (state < 0 || state >= obj->NCSet || m_coords.count(state))
+    return;
+
+  const CoordSet* cs = obj->CSet[state];
+  if (cs) {
+    const float* coord = cs->Coord.data();
+    m_coords[state].assign(coord, coord + cs->NIndex * 3);
+  }
+}
+
+/**
+ * XOR delta of one coordinate, advances the shadow coordinate
+ */
+static void CoordDiff(const float* v, float* s, int idx, std::vector<int>& idxs,
+    std::vector<std::uint32_t>& bits)
+{
+  if (!memcmp(v, s, 3 * sizeof(float)))
+    return;
+
+  std::uint32_t a[3], b[3];
+  memcpy(a, v, sizeof(a));
+  memcpy(b, s, sizeof(b));
+  idxs.push_back(idx);
+  bits.insert(bits.end(), {a[0] ^ b[0], a[1] ^ b[1], a[2] ^ b[2]});
+  memcpy(s, v, sizeof(a));
+}
+
+/**
+ * Collect the edits since the last checkpoint and advance the shadow copy.
+ *
+ * @param touched If not NULL, only compare the coordinates of these atoms
+ * (atom properties and bonds are not compared)
+ *
+ * @pre snapshotMatches(obj)
+ */
+UndoJournal::Step UndoJournal::diff(
+    const ObjectMolecule* obj, const std::vector<int>* touched)
+{
+  Step step;
+
+  if (touched) {
+    for (auto& item : m_coords) {
+      const CoordSet* cs = obj->CSet[item.first];
+      CoordDelta delta;
+      delta.state = item.first;
+
+      for (int atm : *touched) {
+        int const idx = cs->atmToIdx(atm);
+        if (idx < 0)
+          continue;
+        CoordDiff(cs->coordPtr(idx), item.second.data() + idx * 3, idx,
+            delta.idx, delta.bits);
+      }
+
+      if (!delta.idx.empty()) {
+        step.coords.push_back(std::move(delta));
+      }
+    }
+
+    return step;
+  }
+
+  for (auto& item : m_coords) {
+    const CoordSet* cs = obj->CSet[item.first];
+    const float* coord = cs->Coord.data();
+    float* shadow = item.second.data();
+    CoordDelta delta;
+    delta.state = item.first;
+
+    for (int idx = 0; idx < cs->NIndex; ++idx) {
+      CoordDiff(coord + idx * 3, shadow + idx * 3, idx, delta.idx, delta.bits);
+    }
+
+    if (!delta.idx.empty()) {
+      delta.idx.shrink_to_fit();
+      delta.bits.shrink_to_fit();
+      step.coords.push_back(std::move(delta));
+    }
+  }
+
+  for (int a = 0; a < obj->NAtom; ++a) {
+    auto props = AtomPropsGet(obj->AtomInfo[a]);
+    if (!memcmp(&props, &m_atoms[a], sizeof(AtomProps)))
+      continue;
+
+    auto bits = props;
+    XorInto(bits, m_atoms[a]);
+    step.atomIdx.push_back(a);
+    step.atomBits.push_back(bits);
+    m_atoms[a] = props;
+  }
+
+  step.atomIdx.shrink_to_fit();
+  step.atomBits.shrink_to_fit();
+
+  bool bonds_changed = obj->NBond != int(m_bonds.size());
+  for (int b = 0; !bonds_changed && b < obj->NBond; ++b) {
+    bonds_changed = !BondMatches(obj->Bond[b], m_bonds[b]);
+  }
+
+  if (bonds_changed) {
+    step.hasBonds = true;
+    step.bondsBefore = std::move(m_bonds);
+    BondsGet(obj, m_bonds);
+    step.bondsAfter = m_bonds;
+  }
+
+  return step;
+}
+
+/**
+ * Apply a step to the object and to the shadow copy. Coordinate and atom
+ * property deltas are their own inverse, `forward` only selects the bonds.
+ *
+ * @pre No pending edits (object matches the shadow copy)
+ */
+void UndoJournal::apply(ObjectMolecule* obj, const Step& step, bool forward)
+{
+  for (const auto& delta : step.coords) {
+    CoordSet* cs = obj->CSet[delta.state];
+    float* coord = cs->Coord.data();
+    float* shadow = m_coords[delta.state].data();
+
+    for (std::size_t i = 0; i < delta.idx.size(); ++i) {
+      float* v = coord + delta.idx[i] * 3;
+      std::uint32_t a[3];
+      memcpy(a, v, sizeof(a));
+      for (int k = 0; k < 3; ++k) {
+        a[k] ^= delta.bits[i * 3 + k];
+      }
+      memcpy(v, a, sizeof(a));
+      memcpy(shadow + delta.idx[i] * 3, a, sizeof(a));
+    }
+
+    cs->invalidateRep(cRepAll, cRepInvCoord);
+  }
+
+  for (std::size_t i = 0; i < step.atomIdx.size(); ++i) {
+    auto& ai = obj->AtomInfo[step.atomIdx[i]];
+    auto props = AtomPropsGet(ai);
+    XorInto(props, step.atomBits[i]);
+    AtomPropsSet(ai, props);
+    m_atoms[step.atomIdx[i]] = props;
+  }
+
+  if (!step.atomIdx.empty()) {
+    obj->invalidate(cRepAll, cRepInvAll, -1);
+  }
+
+  if (step.hasBonds) {
+    m_bonds = forward ? step.bondsAfter : step.bondsBefore;
+    BondsSet(obj, m_bonds);
+  }
+}
+
+void UndoJournal::push(Step&& step)
+{
+  for (const auto& s : m_redo) {
+    m_stepBytes -= s.memoryUsage();
+  }
+  m_redo.clear();
+
+  m_stepBytes += step.memoryUsage();
+  m_undo.push_back(std::move(step));
+}
+
+/**
+ * Drop the oldest steps until the memory budget (undo_max_memory, in MB) is
+ * met. The shadow copy counts against the budget but can't be dropped. The
+ * most recent step is always kept.
+ */
+void UndoJournal::enforceBudget(const ObjectMolecule* obj)
+{
+  float const budget_mb =
+      SettingGet<float>(obj->G, cSetting_undo_max_memory);
+  if (budget_mb < 0.f)
+    return;
+
+  auto const budget = std::size_t(budget_mb * 1024.f * 1024.f);
+  auto const shadowBytes = shadowMemoryUsage();
+
+  while (m_stepBytes + shadowBytes > budget && m_undo.size() + m_redo.size() > 1) {
+    if (!m_undo.empty()) {
+      m_stepBytes -= m_undo.front().memoryUsage();
+      m_undo.pop_front();
+    } else {
+      m_stepBytes -= m_redo.front().memoryUsage();
+      m_redo.erase(m_redo.begin());
+    }
+  }
+}
+
+void UndoJournal::checkpoint(ObjectMolecule* obj, int state, int mergeKey,
+    const std::vector<int>* touched)
+{
+  if (!snapshotMatches(obj)) {
+    clear();
+  } else if (mergeKey && mergeKey == m_mergeKey) {
+    // continue the current step
+    if (!touched) {
+      m_touchedAll = true;
+    } else if (!m_touchedAll) {
+      m_touched.insert(m_touched.end(), touched->begin(), touched->end());
+      std::sort(m_touched.begin(), m_touched.end());
+      m_touched.erase(
+          std::unique(m_touched.begin(), m_touched.end()), m_touched.end());
+    }
+    snapshot(obj, state);
+    return;
+  } else {
+    auto step = diff(obj, m_touchedAll ? nullptr : &m_touched);
+    if (!step.empty()) {
+      push(std::move(step));
+      enforceBudget(obj);
+    }
+  }
+
+  snapshot(obj, state);
+  m_mergeKey = mergeKey;
+  m_touchedAll = !touched;
+  m_touched.clear();
+  if (touched) {
+    m_touched = *touched;
+  }
+}
+
+bool UndoJournal::undo(ObjectMolecule* obj)
+{
+  if (!snapshotMatches(obj)) {
+    clear();
+    return false;
+  }
+
+  m_mergeKey = 0;
+  m_touchedAll = true;
+
+  auto pending = diff(obj, nullptr);
+  if (!pending.empty()) {
+    push(std::move(pending));
+  }
+
+  if (m_undo.empty())
+    return false;
+
+  auto step = std::move(m_undo.back());
+  m_undo.pop_back();
+  apply(obj, step, false);
+  m_redo.push_back(std::move(step));
+  enforceBudget(obj);
+  return true;
+}
+
+bool UndoJournal::redo(ObjectMolecule* obj)
+{
+  if (!snapshotMatches(obj)) {
+    clear();
+    return false;
+  }
+
+  m_mergeKey = 0;
+  m_touchedAll = true;
+
+  auto pending = diff(obj, nullptr);
+  if (!pending.empty()) {
+    // new edits invalidate the redo history
+    push(std::move(pending));
+    enforceBudget(obj);
+    return false;
+  }
+
+  if (m_redo.empty())
+    return false;
+
+  auto step = std::move(m_redo.back());
+  m_redo.pop_back();
+  apply(obj, step, true);
+  m_undo.push_back(std::move(step));
+  return true;
+}
+
+} // namespace pymol
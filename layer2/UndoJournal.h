@@ -0,0 +1,140 @@
+/**
+ * @file
+ * Delta-compressed undo history for ObjectMolecule edits
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <vector>
+
+struct ObjectMolecule;
+
+namespace pymol
+{
+
+/**
+ * Undo/redo journal of one molecular object.
+ *
+ * Instead of copying all coordinates for every undo step, the journal keeps
+ * a single shadow copy of the data as of the last checkpoint and records
+ * only the atoms which differ from it. Deltas are stored as the XOR of the
+ * old and new bit patterns, which makes applying a step exact and its own
+ * inverse (undo and redo are the same operation).
+ *
+ * Covered: coordinates of checkpointed states, a subset of the atom
+ * properties (b, q, vdw, partial_charge, elec_radius, color, reps, flags,
+ * resv, formal_charge, cartoon, ss, hetatm, protect) and bonds. Edits which
+ * change the number of atoms or coordinates, or reorder the atoms
+ * (ObjectMolecule::AtomOrderGeneration), reset the journal.
+ */
+class UndoJournal
+{
+public:
+  /**
+   * Records all edits since the previous checkpoint as one undo step.
+   *
+   * @param state Object state which is about to be edited
+   * @param mergeKey If non-zero and equal to the key of the previous
+   * checkpoint, don't start a new step but continue the current one (e.g.
+   * consecutive mouse drags of the same atoms)
+   * @param touched If not NULL, the atoms which the upcoming edit will move.
+   * The next checkpoint then only compares their coordinates instead of the
+   * entire object. Other edits are not lost but recorded with the next
+   * complete comparison (checkpoint without hint, undo or redo).
+   */
+  void checkpoint(ObjectMolecule* obj, int state, int mergeKey = 0,
+      const std::vector<int>* touched = nullptr);
+
+  /**
+   * Reverts the most recent step (including pending edits which were not
+   * checkpointed yet).
+   *
+   * @return False if there was nothing to undo
+   */
+  bool undo(ObjectMolecule* obj);
+
+  /**
+   * Re-applies the most recently undone step.
+   *
+   * @return False if there was nothing to redo
+   */
+  bool redo(ObjectMolecule* obj);
+
+  void clear();
+
+  /// Number of undo steps
+  std::size_t size() const { return m_undo.size(); }
+
+  /// Memory used by undo and redo steps (without the shadow copy)
+  std::size_t memoryUsage() const { return m_stepBytes; }
+
+  /// Memory used by the shadow copy of the last checkpoint
+  std::size_t shadowMemoryUsage() const;
+
+  struct AtomProps {
+    float b, q, vdw, partialCharge, elec_radius;
+    int color, visRep, resv;
+    unsigned int flags;
+    signed char formalCharge, cartoon;
+    char ssType[2];
+    unsigned char hetatm, protekted;
+    unsigned char pad_[2]; // no implicit padding, compared with memcmp
+  };
+
+  struct BondRec {
+    int index[2];
+    int order;
+  };
+
+private:
+  struct CoordDelta {
+    int state;
+    std::vector<int> idx;
+    std::vector<std::uint32_t> bits; // 3 per index
+  };
+
+  struct Step {
+    std::vector<CoordDelta> coords;
+    std::vector<int> atomIdx;
+    std::vector<AtomProps> atomBits;
+    bool hasBonds = false;
+    std::vector<BondRec> bondsBefore, bondsAfter;
+
+    bool empty() const
+    {
+      return coords.empty() && atomIdx.empty() && !hasBonds;
+    }
+    std::size_t memoryUsage() const;
+  };
+
+  bool snapshotMatches(const ObjectMolecule* obj) const;
+  void snapshot(const ObjectMolecule* obj, int state);
+  Step diff(const ObjectMolecule* obj, const std::vector<int>* touched);
+  void apply(ObjectMolecule* obj, const Step& step, bool forward);
+  void push(Step&& step);
+  void enforceBudget(const ObjectMolecule* obj);
+
+  std::deque<Step> m_undo;
+  std::vector<Step> m_redo;
+  std::size_t m_stepBytes = 0;
+
+  // shadow copy as of the last checkpoint
+  bool m_valid = false;
+  int m_nAtom = 0;
+  int m_atomOrderGeneration = 0;
+  std::map<int, std::vector<float>> m_coords;
+  std::vector<AtomProps> m_atoms;
+  std::vector<BondRec> m_bonds;
+
+  int m_mergeKey = 0;
+
+  // atoms edited since the last checkpoint, if known
+  bool m_touchedAll = true;
+  std::vector<int> m_touched;
+};
+
+} // namespace pymol
@@ -62,6 +62,11 @@ struct _CEditor {
   int FavorOrigin;
   float FavoredOrigin[3];
   CGO *shaderCGO;
+  /* consecutive drags of the same target share one undo step */
+  int UndoDragKey;
+  int UndoDragIndex, UndoDragMode;
+  pymol::CObject *UndoDragObject;
+  WordType UndoDragSeleName;
 };
 
 int EditorGetScheme(PyMOLGlobals * G)
@@ -2109,7 +2114,28 @@ void EditorPrepareDrag(PyMOLGlobals * G, pymol::CObject * obj,
   if(I->DragObject) {
     I->ShowFrags = false;
     if(objMol) {
-      ObjectMoleculeSaveUndo(objMol, state, log_trans);
+      if(I->DragObject != I->UndoDragObject || I->DragIndex != I->UndoDragIndex ||
+         mode != I->UndoDragMode || strcmp(I->DragSeleName, I->UndoDragSeleName)) {
+        I->UndoDragKey++;
+        I->UndoDragObject = I->DragObject;
+        I->UndoDragIndex = I->DragIndex;
+        I->UndoDragMode = mode;
+        strcpy(I->UndoDragSeleName, I->DragSeleName);
+      }
+      /* dragging a selection only moves its atoms, unless sculpting
+         relaxes the surroundings */
+      std::vector<int> touched;
+      bool const hint = I->DragSelection >= 0 &&
+        !SettingGetGlobal_b(G, cSetting_sculpting) &&
+        !SettingGetGlobal_b(G, cSetting_auto_sculpt);
+      if(hint) {
+        for(int a = 0; a < objMol->NAtom; ++a) {
+          if(SelectorIsMember(G, objMol->AtomInfo[a].selEntry, I->DragSelection))
+            touched.push_back(a);
+        }
+      }
+      ObjectMoleculeSaveUndo(objMol, state, log_trans, I->UndoDragKey,
+          hint ? &touched : nullptr);
       if(SettingGetGlobal_b(G, cSetting_auto_sculpt)) {
         SettingSetGlobal_b(G, cSetting_sculpting, 1);
         if(!objMol->Sculpt)
@@ -2426,6 +2452,9 @@ int EditorInit(PyMOLGlobals * G)
     I->MouseInvalid = false;
     I->FavorOrigin = false;
     I->shaderCGO = nullptr;
+    I->UndoDragKey = 0;
+    I->UndoDragObject = nullptr;
+    I->UndoDragIndex = -1;
     return 1;
   } else
     return 0;
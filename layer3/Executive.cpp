@@ -93,6 +93,7 @@
 #include "ButMode.h"
 #include "Feedback.h"
 #include "TTT.h"
+#include "Trace.h"
 
 #include"OVContext.h"
 #include"OVLexicon.h"
@@ -112,6 +113,7 @@
 #ifndef _PYMOL_NOPY
 #include "ce_types.h"
 #endif
+#include "Superposition.h"
 
 #include <glm/vec3.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -1725,13 +1727,39 @@ static int ExecutiveAddKey(CExecutive * I, SpecRec * rec)
     I->Key[result.word] = rec->cand_id;
     ok = true;
   }
+  if(rec->type == cExecObject && rec->obj)
+    I->ObjSpec[rec->obj] = rec;
   return ok;
 }
 
+/**
+ * Exact (case sensitive) name lookup, constant time
+ */
+static SpecRec* ExecutiveFindSpecByKey(CExecutive* I, const char* name)
+{
+  SpecRec* rec = nullptr;
+  OVreturn_word result;
+  if(OVreturn_IS_OK((result = OVLexicon_BorrowFromCString(I->Lex, name)))) {
+    auto keyRes = I->Key.find(result.word);
+    if (keyRes != I->Key.end()) {
+      if (!TrackerGetCandRef(
+              I->Tracker, keyRes->second, (TrackerRef**) (void*) &rec)) {
+        rec = nullptr;
+      }
+    }
+  }
+  return rec;
+}
+
 static int ExecutiveDelKey(CExecutive * I, SpecRec * rec)
 {
   int ok = false;
   OVreturn_word result;
+  if(rec->type == cExecObject) {
+    auto it = I->ObjSpec.find(rec->obj);
+    if(it != I->ObjSpec.end() && it->second == rec)
+      I->ObjSpec.erase(it);
+  }
   if(OVreturn_IS_OK((result = OVLexicon_BorrowFromCString(I->Lex, rec->name)))) {
     if(OVreturn_IS_OK(OVLexicon_DecRef(I->Lex, result.word))) {
       auto res = I->Key.find(result.word);
@@ -2901,8 +2929,6 @@ pymol::Result<> ExecutiveResetMatrix(
   return {};
 }
 
-static double ret_mat[16];      /* UGH ..not thread-safe */
-
 static int ExecutiveGetObjectMatrix2(PyMOLGlobals * G, pymol::CObject * obj, int state,
                                      double **matrix, int incl_ttt)
 {
@@ -2922,6 +2948,7 @@ static int ExecutiveGetObjectMatrix2(PyMOLGlobals * G, pymol::CObject * obj, int
       const float *ttt;
       double tttd[16];
       if(ObjectGetTTT(obj, &ttt, -1)) {
+        double* ret_mat = G->Executive->ObjectMatrixTTT;
         convertTTTfR44d(ttt, tttd);
         if(*matrix) {
           copy44d(*matrix, ret_mat);
@@ -3825,6 +3852,7 @@ ExecutiveLoadPrepareArgs(PyMOLGlobals * G,
 
 pymol::Result<> ExecutiveLoad(PyMOLGlobals* G, ExecutiveLoadArgs const& args)
 {
+  PYMOL_TRACE_SCOPE("ExecutiveLoad", "load", args.fname.c_str());
   pymol::CObject* origObj = nullptr;
   const char* fname = args.fname.c_str();
   const char* content = args.content.data();
@@ -4883,25 +4911,17 @@ pymol::Result<std::vector<const char*>> ExecutiveGetChains(
   }
 }
 
+/**
+ * True if `ptr` is a managed object (of type `object_type`, if non-zero).
+ * Constant time, uses the object to record hash.
+ */
 int ExecutiveValidateObjectPtr(PyMOLGlobals * G, pymol::CObject * ptr, int object_type)
 {
-  /* this routine needs to be sped up significantly... */
-
   CExecutive *I = G->Executive;
-  int ok = false;
-  SpecRec *rec = nullptr;
-
-  while(ListIterate(I->Spec, rec, next)) {
-    if(rec->obj == ptr) {
-      if(rec->type == cExecObject) {
-        if((!object_type) || (rec->obj->type == object_type)) {
-          ok = true;
-          break;
-        }
-      }
-    }
-  }
-  return (ok);
+  auto it = I->ObjSpec.find(ptr);
+  if(it == I->ObjSpec.end())
+    return false;
+  return (!object_type) || (it->second->obj->type == object_type);
 }
 
 pymol::Result<> ExecutiveRampNew(PyMOLGlobals* G, const char* name,
@@ -5278,9 +5298,11 @@ static PyObject *ExecutiveGetExecObjectAsPyList(PyMOLGlobals * G, SpecRec * rec)
   case cObjectVolume:
     PyList_SetItem(result, 5, ObjectVolumeAsPyList((ObjectVolume *) rec->obj));
     break;
+#ifndef _PYMOL_NOPY
   case cObjectCallback:
     PyList_SetItem(result, 5, ObjectCallbackAsPyList((ObjectCallback *) rec->obj));
     break;
+#endif
   case cObjectCurve:
     PyList_SetItem(result, 5, static_cast<ObjectCurve*>(rec->obj)->asPyList());
     break;
@@ -5384,6 +5406,7 @@ static PyObject *ExecutiveGetNamedEntries(PyMOLGlobals * G, int list_id, int par
 int ExecutiveGetSession(PyMOLGlobals * G, PyObject * dict, const char *names, int partial,
                         int quiet)
 {
+  PYMOL_TRACE_SCOPE("ExecutiveGetSession", "session");
   assert(PyGILState_Check());
 
   int list_id = 0;
@@ -5549,6 +5572,7 @@ int ExecutiveSetSessionNoMLock(PyMOLGlobals* G, PyObject* session)
 int ExecutiveSetSession(PyMOLGlobals * G, PyObject * session,
                         int partial_restore, int quiet)
 {
+  PYMOL_TRACE_SCOPE("ExecutiveSetSession", "session");
   assert(PyGILState_Check());
 
   int ok = true;
@@ -6897,6 +6921,11 @@ ExecutiveMapNew(PyMOLGlobals * G, const char *name, int type, float grid_spacing
           case 5:          /* gaussian_max */
             SelectorMapGaussian(G, sele0, ms, 0.0F, state, normalize, true, quiet, resolution);
             break;
+          case 6:          /* coulomb_mesh */
+            SelectorMapCoulomb(G, sele0, ms,
+                               SettingGetGlobal_f(G, cSetting_coulomb_cutoff), state,
+                               false, false, 1.0F, true);
+            break;
           }
           if(!ms->Active)
             ObjectMapStatePurge(G, ms);
@@ -11029,6 +11058,106 @@ int ExecutiveIndex(PyMOLGlobals * G, const char *s1, int mode, int **indexVLA,
 }
 
 
+/*========================================================================*/
+/**
+ * Gathers the coordinates of the selected atoms of one object into a
+ * contiguous frames x atoms x 3 buffer.
+ *
+ * @param[in,out] states 0-based state indices. If empty, it will be filled
+ * with all states which have coordinates.
+ * @return Error if any requested state lacks some of the selected atoms
+ */
+static pymol::Result<pymol::CoordFrames> ExecutiveGatherStateFrames(
+    PyMOLGlobals* G, const ObjectMolecule* obj, int sele,
+    std::vector<int>& states)
+{
+  std::vector<int> atoms;
+  for (int a = 0; a < obj->NAtom; ++a) {
+    if (SelectorIsMember(G, obj->AtomInfo[a].selEntry, sele)) {
+      atoms.push_back(a);
+    }
+  }
+
+  if (atoms.empty()) {
+    return pymol::make_error("No atoms selected.");
+  }
+
+  if (states.empty()) {
+    for (int b = 0; b < obj->NCSet; ++b) {
+      if (obj->CSet[b]) {
+        states.push_back(b);
+      }
+    }
+  }
+
+  pymol::CoordFrames frames(states.size(), atoms.size());
+
+  for (size_t f = 0; f < states.size(); ++f) {
+    int const state = states[f];
+    const CoordSet* cs =
+        (state >= 0 && state < obj->NCSet) ? obj->CSet[state] : nullptr;
+    if (!cs) {
+      return pymol::make_error("Invalid state ", state + 1, ".");
+    }
+
+    float* dst = frames.frame(f);
+    for (int a : atoms) {
+      int const idx = cs->atmToIdx(a);
+      if (idx < 0) {
+        return pymol::make_error("Missing atoms in state ", state + 1, ".");
+      }
+      copy3f(cs->coordPtr(idx), dst);
+      dst += 3;
+    }
+  }
+
+  return frames;
+}
+
+/*========================================================================*/
+/**
+ * intra_fit and intra_rms for the common case where every state has all
+ * selected atoms: Gathers the coordinates once and superposes all states
+ * in one batch.
+ *
+ * @return False if the states are incomplete (nothing was done)
+ */
+static bool ExecutiveRMSStatesBatch(PyMOLGlobals* G, ObjectMolecule* obj,
+    int sele, int target, int mode, pymol::vla<float>& result)
+{
+  if (target >= obj->NCSet || !obj->CSet[target]) {
+    return false;
+  }
+
+  std::vector<int> states;
+  auto frames = ExecutiveGatherStateFrames(G, obj, sele, states);
+  if (!frames) {
+    return false;
+  }
+
+  auto const ref =
+      std::find(states.begin(), states.end(), target) - states.begin();
+
+  std::vector<float> ttts;
+  auto const rms = pymol::SuperposeFrames(
+      *frames, ref, mode != 0, mode == 2 ? &ttts : nullptr);
+
+  result = pymol::vla<float>(obj->NCSet);
+  std::fill_n(result.data(), obj->NCSet, -1.f);
+
+  for (size_t f = 0; f < states.size(); ++f) {
+    if (states[f] == target) {
+      continue;
+    }
+    result[states[f]] = rms[f];
+    if (mode == 2) {
+      ObjectMoleculeTransformTTTf(obj, ttts.data() + 16 * f, states[f]);
+    }
+  }
+
+  return true;
+}
+
 /*========================================================================*/
 /**
  * Fit states or calculate ensemble RMSD
@@ -11079,6 +11208,26 @@ pymol::Result<pymol::vla<float>> ExecutiveRMSStates(
     pbc = false;
   }
 
+  // pbc=1 is the intra_fit default, but unwrapping is a no-op without a
+  // usable unit cell (see ObjectMoleculePBCUnwrap)
+  if (pbc && obj) {
+    pbc = std::any_of(obj->CSet.begin(), obj->CSet.end(),
+        [](const CoordSet* cs) {
+          auto const* sym = cs ? cs->getSymmetry() : nullptr;
+          return sym && !sym->Crystal.isSuspicious();
+        });
+  }
+
+  if (obj && sele1 >= 0 && !mix && !pbc) {
+    pymol::vla<float> batch;
+    if (ExecutiveRMSStatesBatch(G, obj, sele1, target, mode, batch)) {
+      if (mode == 2) {
+        ExecutiveUpdateCoordDepends(G, obj);
+      }
+      return batch;
+    }
+  }
+
   if(ok && sele1 >= 0) {
     op1.code = OMOP_SVRT;
     op1.nvv1 = 0;
@@ -11123,6 +11272,57 @@ pymol::Result<pymol::vla<float>> ExecutiveRMSStates(
 }
 
 
+/*========================================================================*/
+/**
+ * All-vs-all RMSD matrix of object states
+ *
+ * @param s1 atom selection expression (must be within one object)
+ * @param[in,out] states 0-based state indices, all states if empty
+ * @param fit RMSD after superposition if true, in place otherwise
+ * @return states.size() x states.size() matrix (row-major)
+ */
+pymol::Result<std::vector<float>> ExecutiveRMSMatrix(PyMOLGlobals* G,
+    const char* s1, std::vector<int>& states, bool fit)
+{
+  SETUP_SELE(s1, tmpsele1, sele1);
+
+  auto obj = SelectorGetSingleObjectMolecule(G, sele1);
+  if (!obj) {
+    return pymol::make_error("Selection must be within a single object.");
+  }
+
+  auto frames = ExecutiveGatherStateFrames(G, obj, sele1, states);
+  p_return_if_error(frames);
+
+  return pymol::RMSMatrix(*frames, fit);
+}
+
+/*========================================================================*/
+/**
+ * Clusters object states by RMSD (see pymol::ClusterRMSMatrix)
+ *
+ * @return Clusters of 0-based state indices, largest first, with the
+ * cluster center as the first member
+ */
+pymol::Result<std::vector<std::vector<int>>> ExecutiveRMSCluster(
+    PyMOLGlobals* G, const char* s1, std::vector<int>& states, bool fit,
+    float cutoff)
+{
+  auto matrix = ExecutiveRMSMatrix(G, s1, states, fit);
+  p_return_if_error(matrix);
+
+  auto clusters = pymol::ClusterRMSMatrix(*matrix, states.size(), cutoff);
+
+  for (auto& cluster : clusters) {
+    for (auto& member : cluster) {
+      member = states[member];
+    }
+  }
+
+  return clusters;
+}
+
+
 /*========================================================================*/
 float ExecutiveRMSPairs(PyMOLGlobals* G, const std::vector<SelectorTmp>& sele,
     int mode, bool quiet)
@@ -12679,16 +12879,7 @@ SpecRec* ExecutiveFindSpec(PyMOLGlobals* G, pymol::zstring_view name_view)
   if(name[0] && name[0] == '%')
     name++;
   {                             /* first, try for perfect, case-specific match */
-    OVreturn_word result;
-    if(OVreturn_IS_OK((result = OVLexicon_BorrowFromCString(I->Lex, name)))) {
-      auto keyRes = I->Key.find(result.word);
-      if (keyRes != I->Key.end()) {
-        if (!TrackerGetCandRef(
-                I->Tracker, keyRes->second, (TrackerRef**) (void*) &rec)) {
-          rec = nullptr;
-        }
-      }
-    }
+    rec = ExecutiveFindSpecByKey(I, name);
     if(!rec) {                  /* otherwise try partial/case-nonspecific match */
       rec = ExecutiveAnyCaseNameMatch(G, name);
     }
@@ -13838,6 +14029,7 @@ pymol::Result<> ExecutiveInvalidateRep(
               ExecutiveObjMolSeleOp(G, sele, &op);
             } else {
               rec->obj->invalidate(rep, level, -1);
+              SceneObjectChanged(G, rec->obj);
             }
           }
           break;
@@ -13846,6 +14038,7 @@ pymol::Result<> ExecutiveInvalidateRep(
           while(ListIterate(I->Spec, rec, next)) {
             if(rec->type == cExecObject) {
               rec->obj->invalidate(rep, level, -1);
+              SceneObjectChanged(G, rec->obj);
             }
           }
           SceneInvalidate(G);
@@ -14129,6 +14322,8 @@ void ExecutiveSymExp(PyMOLGlobals * G, const char *name,
     return;
   }
 
+  MapSetupCSR(map.get(), vv1.data());
+
   std::vector<glm::vec3> cs_centers(obj->NCSet);
   for (int b = 0; b < obj->NCSet; ++b) {
     if (auto const* cs = obj->CSet[b]) {
@@ -14585,11 +14780,7 @@ void ExecutiveManageObject(PyMOLGlobals * G, pymol::CObject * obj, int zoom, int
 
   if(SettingGetGlobal_b(G, cSetting_auto_hide_selections))
     ExecutiveHideSelections(G);
-  while(ListIterate(I->Spec, rec, next)) {
-    if(rec->obj == obj) {
-      exists = true;
-    }
-  }
+  exists = I->ObjSpec.count(obj) != 0;
   if(!exists) {
     if (WordMatchExact(G, cKeywordAll, obj->Name, true)) {
       PRINTFB(G, FB_Executive, FB_Warnings)
@@ -14602,17 +14793,15 @@ void ExecutiveManageObject(PyMOLGlobals * G, pymol::CObject * obj, int zoom, int
         obj->Name ENDFB(G);
     }
 
-    while(ListIterate(I->Spec, rec, next)) {
-      if(rec->type == cExecObject) {
-        if(strcmp(rec->obj->Name, obj->Name) == 0)
-          break;
-      }
-    }
+    rec = ExecutiveFindSpecByKey(I, obj->Name);
+    if(rec && rec->type != cExecObject)
+      rec = nullptr;
     if(rec) {                   /* another object of this type already exists */
       /* purge it */
       SceneObjectDel(G, rec->obj, false);
       ExecutiveInvalidateSceneMembers(G);
       previousObjType = rec->obj->type;
+      I->ObjSpec.erase(rec->obj);
       DeleteP(rec->obj);
     } else {
       if(!quiet)
@@ -14627,6 +14816,8 @@ void ExecutiveManageObject(PyMOLGlobals * G, pymol::CObject * obj, int zoom, int
     strcpy(rec->name, obj->Name);
     rec->type = cExecObject;
     rec->obj = obj;
+    if(rec->cand_id)
+      I->ObjSpec[obj] = rec;
     previousVisible = rec->visible;
     if (previousObjType == rec->obj->type) {
       // skip
@@ -16437,6 +16628,7 @@ void ExecutiveFree(PyMOLGlobals * G)
       DeleteP(rec->obj);
   }
   ListFree(I->Spec, next, SpecRec);
+  I->ObjSpec.clear();
   if(I->Tracker)
     TrackerFree(I->Tracker);
   OVLexicon_DEL_AUTO_NULL(I->Lex);
@@ -16530,58 +16722,53 @@ PyObject * ExecutiveCEAlign(PyMOLGlobals * G, PyObject * listA, PyObject * listB
 #ifdef _PYMOL_NOPY
   return nullptr;
 #else
-  int i=0;
-  int smaller;
-  double **dmA ,**dmB, **S;
-  int bufferSize;
-  pcePoint coordsA, coordsB;
-  pathCache paths = nullptr;
-  PyObject * result;
-
-  smaller = lenA < lenB ? lenA : lenB;
-	
   /* get the coodinates from the Python objects */
-  coordsA = (pcePoint) getCoords(listA, lenA);
-  coordsB = (pcePoint) getCoords(listB, lenB);
-	
-  /* calculate the distance matrix for each protein */
-  dmA = (double**) calcDM(coordsA, lenA);
-  dmB = (double**) calcDM(coordsB, lenB);
-	
-  /* calculate the CE Similarity matrix */
-  S = (double**) calcS(dmA, dmB, lenA, lenB, windowSize);
-	
-  /* find the best path through the CE Sim. matrix */
-  bufferSize = 0;
-
-  /* the following line HANGS PyMOL */
-  paths = (pathCache) findPath(S, dmA, dmB, lenA, lenB, d0, d1, windowSize, gapMax, &bufferSize);
-	
-  /* Get the optimal superposition here... */
-  result = (PyObject*) findBest(coordsA, coordsB, paths, bufferSize, smaller, windowSize);
-	
-  /* release memory */
-  free(coordsA);
-  free(coordsB);
-  for ( i = 0; i < bufferSize; ++i )
-    free(paths[i]);
-  free(paths);
-	
-  /* distance matrices	 */
-  for ( i = 0; i < lenA; i++ )
-    free( dmA[i] );
-  free(dmA);
-	
-  for  ( i = 0; i < lenB; i++ )
-    free( dmB[i] );
-  free(dmB);
-	
-  /* similarity matrix */
-  for ( i = 0; i < lenA; i++ )
-    free( S[i] );
-  free(S);
-	
-  return (PyObject*) result;
+  auto coordsA = getCoords(listA, lenA);
+  auto coordsB = getCoords(listB, lenB);
+
+  /* distance matrices, similarity matrix, path search and superposition */
+  auto result = ceAlign(coordsA.data(), lenA, coordsB.data(), lenB, d0, d1,
+      windowSize, gapMax);
+
+  if (!result.ok) {
+    return nullptr;
+  }
+
+  return ceResultAsPyList(result);
+#endif
+}
+
+/**
+ * Aligns every mobile in `listsB` onto the target `listA`, in parallel.
+ * @param listA target coordinates [[x, y, z], ...]
+ * @param listsB list of mobile coordinate lists
+ * @return list with [alignLen, RMSD, TTT, pathA, pathB] or None per mobile
+ */
+PyObject * ExecutiveCEAlignBatch(PyMOLGlobals * G, PyObject * listA, PyObject * listsB,
+    float d0, float d1, int windowSize, int gapMax) {
+#ifdef _PYMOL_NOPY
+  return nullptr;
+#else
+  auto coordsA = getCoords(listA, PyList_Size(listA));
+
+  std::vector<std::vector<cePoint>> mobiles(PyList_Size(listsB));
+  for (size_t i = 0; i < mobiles.size(); ++i) {
+    PyObject* listB = PyList_GetItem(listsB, i);
+    mobiles[i] = getCoords(listB, PyList_Size(listB));
+  }
+
+  std::vector<ceResult> results;
+
+  PUnblock(G);
+  results = ceAlignBatch(coordsA, mobiles, d0, d1, windowSize, gapMax);
+  PBlock(G);
+
+  PyObject* pyResults = PyList_New(results.size());
+  for (size_t i = 0; i < results.size(); ++i) {
+    PyList_SET_ITEM(pyResults, i,
+        results[i].ok ? ceResultAsPyList(results[i]) : PConvAutoNone(nullptr));
+  }
+  return pyResults;
 #endif
 }
 
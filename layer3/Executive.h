@@ -413,6 +413,11 @@ pymol::Result<> ExecutiveUpdateCmd(PyMOLGlobals* G, const char* sele1,
 float ExecutiveRMSPairs(PyMOLGlobals* G, const std::vector<SelectorTmp>& sele, int mode, bool quiet);
 pymol::Result<pymol::vla<float>> ExecutiveRMSStates(PyMOLGlobals* G,
     const char* s1, int target, int mode, int quiet, int mix, bool pbc = true);
+pymol::Result<std::vector<float>> ExecutiveRMSMatrix(PyMOLGlobals* G,
+    const char* s1, std::vector<int>& states, bool fit = true);
+pymol::Result<std::vector<std::vector<int>>> ExecutiveRMSCluster(
+    PyMOLGlobals* G, const char* s1, std::vector<int>& states, bool fit,
+    float cutoff);
 int ExecutiveIndex(PyMOLGlobals * G, const char *s1, int mode, int **indexVLA,
                    ObjectMolecule *** objVLA);
 pymol::Result<> ExecutiveReset(PyMOLGlobals*, pymol::zstring_view);
@@ -791,6 +796,8 @@ int ExecutiveAssignAtomTypes(PyMOLGlobals * G, const char *s1, int format, int s
 
 PyObject * ExecutiveCEAlign(PyMOLGlobals * G, PyObject * listA, PyObject * listB, int lenA, int lenB,
 			    float d0, float d1, int windowSize, int gapMax);
+PyObject * ExecutiveCEAlignBatch(PyMOLGlobals * G, PyObject * listA, PyObject * listsB,
+    float d0, float d1, int windowSize, int gapMax);
 
 pymol::Result<> ExecutiveSetFeedbackMask(
     PyMOLGlobals* G, int action, unsigned int sysmod, unsigned char mask);
@@ -69,6 +69,7 @@ struct CExecutive : public Block {
   int all_names_list_id {}, all_obj_list_id {}, all_sel_list_id {};
   OVLexicon *Lex {};
   std::unordered_map<ov_word, int> Key;
+  std::unordered_map<const pymol::CObject*, SpecRec*> ObjSpec; // object -> record
   bool ValidGroups { false };
   bool ValidSceneMembers { false };
   int ValidGridSlots {};
@@ -88,6 +89,8 @@ struct CExecutive : public Block {
   std::unordered_map<ov_word, std::size_t> m_id2eoo {}; // unique_id -> m_eoo-index
   std::unordered_map<const pymol::CObject*, std::unordered_set<const pymol::CObject*>> m_objDeps;
 
+  double ObjectMatrixTTT[16] {}; // returned by ExecutiveGetObjectMatrix
+
   CExecutive(PyMOLGlobals * G) : Block(G), m_ScrollBar(G, false) {};
 
   int release(int button, int x, int y, int mod) override;
@@ -0,0 +1,570 @@
+/**
+ * @file
+ * Memory accounting by object, state and category
+ */
+
+#include "MemoryAccounting.h"
+
+#include "CGO.h"
+#include "CoordSet.h"
+#include "DistSet.h"
+#include "Executive.h"
+#include "GadgetSet.h"
+#include "ObjectAlignment.h"
+#include "ObjectCGO.h"
+#include "ObjectDist.h"
+#include "ObjectGadgetRamp.h"
+#include "ObjectMap.h"
+#include "ObjectMesh.h"
+#include "ObjectMolecule.h"
+#include "ObjectSlice.h"
+#include "ObjectSurface.h"
+#include "ObjectVolume.h"
+#include "Rep.h"
+#include "SelectorDef.h"
+#include "Setting.h"
+#include "SpecRec.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <tuple>
+#include <unordered_set>
+
+namespace pymol
+{
+
+// representation names as in the `show` command
+static const char* const RepNames[cRepCnt] = {
+    "sticks", "spheres", "surface", "labels", "nb_spheres", "cartoon",
+    "ribbon", "lines", "mesh", "dots", "dashes", "nonbonded", "cell", "cgo",
+    "callback", "extent", "slice", "angles", "dihedrals", "ellipsoids",
+    "volume"};
+
+static std::string RepCategory(int rep)
+{
+  return std::string("rep:") + RepNames[rep];
+}
+
+namespace
+{
+/**
+ * Sums up sizes by (object, state, category)
+ */
+class MemoryCollector
+{
+  std::map<std::tuple<std::string, int, std::string>, MemorySize> m_sizes;
+
+public:
+  PyMOLGlobals* G;
+
+  //! Selection members and unique settings attributed to objects
+  std::size_t members = 0;
+  std::size_t uniqueSettings = 0;
+
+  explicit MemoryCollector(PyMOLGlobals* G)
+      : G(G)
+  {
+  }
+
+  void add(const std::string& object, int state, const std::string& category,
+      const MemorySize& size)
+  {
+    if (size.total()) {
+      m_sizes[std::make_tuple(object, state, category)] += size;
+    }
+  }
+
+  void add(const std::string& object, int state, const std::string& category,
+      std::size_t host)
+  {
+    MemorySize size;
+    size.host = host;
+    add(object, state, category, size);
+  }
+
+  std::vector<MemoryRecord> records() const
+  {
+    std::vector<MemoryRecord> records;
+    records.reserve(m_sizes.size());
+    for (auto const& item : m_sizes) {
+      records.push_back({std::get<0>(item.first), std::get<1>(item.first),
+          std::get<2>(item.first), item.second});
+    }
+    return records;
+  }
+};
+} // namespace
+
+static std::size_t FieldMemorySize(const CField* field)
+{
+  if (!field) {
+    return 0;
+  }
+  return sizeof(CField) + memory_size(field->data) + memory_size(field->dim) +
+         memory_size(field->stride);
+}
+
+static std::size_t IsofieldMemorySize(const Isofield* field)
+{
+  if (!field) {
+    return 0;
+  }
+  return sizeof(Isofield) + FieldMemorySize(field->points.get()) +
+         FieldMemorySize(field->data.get()) +
+         FieldMemorySize(field->gradients.get());
+}
+
+/**
+ * Selection members of an atom (linked list in CSelectorManager::Member)
+ */
+static std::size_t SelectionMemorySize(
+    const CSelectorManager* mgr, SelectorMemberOffset_t offset)
+{
+  std::size_t size = 0;
+  while (offset > 0 && std::size_t(offset) < mgr->Member.size()) {
+    size += sizeof(MemberType);
+    offset = mgr->Member[offset].next;
+  }
+  return size;
+}
+
+static void CollectSettings(MemoryCollector& collector, pymol::CObject* obj)
+{
+  collector.add(
+      obj->Name, -1, "settings", SettingGetMemorySize(obj->Setting.get()));
+  for (int state = 0; state < obj->getNFrame(); ++state) {
+    auto handle = obj->getSettingHandle(state);
+    if (handle && handle != &obj->Setting) {
+      collector.add(
+          obj->Name, state, "settings", SettingGetMemorySize(handle->get()));
+    }
+  }
+}
+
+static void CollectCoordSet(MemoryCollector& collector,
+    const ObjectMolecule* obj, const CoordSet* cs, int state)
+{
+  auto G = collector.G;
+
+  std::size_t coords = sizeof(CoordSet) + memory_size(cs->Coord) +
+                       memory_size(cs->IdxToAtm) + memory_size(cs->AtmToIdx) +
+                       memory_size(cs->TmpBond) + memory_size(cs->TmpLinkBond) +
+                       memory_size(cs->Spheroid) +
+                       memory_size(cs->SpheroidNormal) +
+                       memory_size(cs->RefPos) +
+                       memory_size(cs->atom_state_setting_id);
+  collector.add(obj->Name, state, "coords", coords);
+
+  // atom-state level settings
+  if (cs->atom_state_setting_id) {
+    std::size_t settings = 0;
+    for (int idx = 0; idx < cs->NIndex; ++idx) {
+      if (auto unique_id = cs->atom_state_setting_id[idx]) {
+        settings += SettingUniqueGetMemorySize(G, unique_id);
+      }
+    }
+    collector.uniqueSettings += settings;
+    collector.add(obj->Name, state, "settings", settings);
+  }
+
+  for (int rep = 0; rep < cRepCnt; ++rep) {
+    if (cs->Rep[rep]) {
+      collector.add(
+          obj->Name, state, RepCategory(rep), cs->Rep[rep]->getMemorySize());
+    }
+  }
+
+  auto cell = CGOGetMemorySize(cs->UnitCellCGO.get());
+  cell += CGOGetMemorySize(cs->UnitCellShaderCGO.get());
+  collector.add(obj->Name, state, RepCategory(cRepCell), cell);
+
+  auto sculpt = CGOGetMemorySize(cs->SculptCGO);
+  if (cs->SculptShaderCGO != cs->SculptCGO) {
+    sculpt += CGOGetMemorySize(cs->SculptShaderCGO);
+  }
+  collector.add(obj->Name, state, "other", sculpt);
+}
+
+static void CollectMolecule(MemoryCollector& collector, ObjectMolecule* obj)
+{
+  auto G = collector.G;
+  auto mgr = G->SelectorMgr;
+
+  std::size_t atoms = memory_size(obj->AtomInfo);
+  std::size_t bonds = memory_size(obj->Bond);
+  std::size_t settings = 0;
+  std::size_t selections = 0;
+
+  for (int atm = 0; atm < obj->NAtom; ++atm) {
+    auto const& ai = obj->AtomInfo[atm];
+    if (ai.get_anisou()) {
+      atoms += 6 * sizeof(float);
+    }
+    if (ai.has_setting && ai.unique_id) {
+      settings += SettingUniqueGetMemorySize(G, ai.unique_id);
+    }
+    selections += SelectionMemorySize(mgr, ai.selEntry);
+  }
+
+  for (int b = 0; b < obj->NBond; ++b) {
+    auto const& bond = obj->Bond[b];
+    if (bond.has_setting && bond.unique_id) {
+      settings += SettingUniqueGetMemorySize(G, bond.unique_id);
+    }
+  }
+
+  collector.uniqueSettings += settings;
+  collector.members += selections;
+
+  collector.add(obj->Name, -1, "atoms", atoms);
+  collector.add(obj->Name, -1, "bonds", bonds);
+  collector.add(obj->Name, -1, "settings", settings);
+  collector.add(obj->Name, -1, "selections", selections);
+
+  std::size_t other = memory_size(obj->DiscreteAtmToIdx) +
+                      memory_size(obj->DiscreteCSet) + memory_size(obj->CSet);
+  collector.add(obj->Name, -1, "other", other);
+
+  if (obj->Undo) {
+    collector.add(obj->Name, -1, "undo",
+        obj->Undo->memoryUsage() + obj->Undo->shadowMemoryUsage());
+  }
+
+  if (obj->CSTmpl) {
+    CollectCoordSet(collector, obj, obj->CSTmpl, -1);
+  }
+
+  for (int state = 0; state < obj->NCSet; ++state) {
+    if (auto cs = obj->CSet[state]) {
+      CollectCoordSet(collector, obj, cs, state);
+    }
+  }
+}
+
+static void CollectMap(MemoryCollector& collector, ObjectMap* obj)
+{
+  for (int state = 0, n_state = obj->State.size(); state < n_state; ++state) {
+    auto const& ms = obj->State[state];
+    if (!ms.Active) {
+      continue;
+    }
+    collector.add(obj->Name, state, "map",
+        IsofieldMemorySize(ms.Field.get()) + memory_size(ms.Dim) +
+            memory_size(ms.Origin) + memory_size(ms.Range) +
+            memory_size(ms.Grid));
+    collector.add(obj->Name, state, RepCategory(cRepExtent),
+        CGOGetMemorySize(ms.shaderCGO.get()));
+  }
+}
+
+template <typename StateT>
+static void CollectIsoSurface(MemoryCollector& collector,
+    pymol::CObject* obj, const std::vector<StateT>& states, int rep)
+{
+  auto category = RepCategory(rep);
+  for (int state = 0, n_state = states.size(); state < n_state; ++state) {
+    auto const& ms = states[state];
+    MemorySize size;
+    size.host = memory_size(ms.N) + memory_size(ms.V) + memory_size(ms.VC) +
+                memory_size(ms.RC) + memory_size(ms.AtomVertex);
+    size += CGOGetMemorySize(ms.shaderCGO.get());
+    collector.add(obj->Name, state, category, size);
+
+    auto cell = CGOGetMemorySize(ms.UnitCellCGO.get());
+    collector.add(obj->Name, state, RepCategory(cRepCell), cell);
+  }
+}
+
+static void CollectCGO(MemoryCollector& collector, ObjectCGO* obj)
+{
+  for (int state = 0, n_state = obj->State.size(); state < n_state; ++state) {
+    auto const& cs = obj->State[state];
+    auto size = CGOGetMemorySize(cs.origCGO.get());
+    if (cs.renderCGO.get() != cs.origCGO.get()) {
+      size += CGOGetMemorySize(cs.renderCGO.get());
+    }
+    collector.add(obj->Name, state, RepCategory(cRepCGO), size);
+  }
+}
+
+static void CollectVolume(MemoryCollector& collector, ObjectVolume* obj)
+{
+  for (int state = 0, n_state = obj->State.size(); state < n_state; ++state) {
+    auto const& vs = obj->State[state];
+    collector.add(obj->Name, state, "map",
+        IsofieldMemorySize(vs.Field.get()) +
+            FieldMemorySize(vs.carvemask.get()));
+    collector.add(obj->Name, state, RepCategory(cRepVolume),
+        memory_size(vs.AtomVertex) + memory_size(vs.Ramp));
+  }
+}
+
+static void CollectDist(MemoryCollector& collector, ObjectDist* obj)
+{
+  for (int state = 0, n_state = obj->DSet.size(); state < n_state; ++state) {
+    auto ds = obj->DSet[state].get();
+    if (!ds) {
+      continue;
+    }
+    collector.add(obj->Name, state, "coords",
+        sizeof(DistSet) + memory_size(ds->Coord) + memory_size(ds->AngleCoord) +
+            memory_size(ds->DihedralCoord) + memory_size(ds->LabCoord) +
+            memory_size(ds->LabPos));
+    for (int rep = 0; rep < cRepCnt; ++rep) {
+      if (ds->Rep[rep]) {
+        collector.add(
+            obj->Name, state, RepCategory(rep), ds->Rep[rep]->getMemorySize());
+      }
+    }
+  }
+}
+
+static void CollectSlice(MemoryCollector& collector, ObjectSlice* obj)
+{
+  for (int state = 0, n_state = obj->State.size(); state < n_state; ++state) {
+    auto const& ss = obj->State[state];
+    MemorySize size;
+    size.host = memory_size(ss.values) + memory_size(ss.points) +
+                memory_size(ss.flags) + memory_size(ss.colors) +
+                memory_size(ss.normals) + memory_size(ss.strips);
+    size += CGOGetMemorySize(ss.shaderCGO.get());
+    collector.add(obj->Name, state, RepCategory(cRepSlice), size);
+  }
+}
+
+static void CollectAlignment(MemoryCollector& collector, ObjectAlignment* obj)
+{
+  for (int state = 0, n_state = obj->State.size(); state < n_state; ++state) {
+    auto const& as = obj->State[state];
+    collector.add(obj->Name, state, "other",
+        memory_size(as.alignVLA) + memory_size(as.id2tag));
+    auto size = CGOGetMemorySize(as.primitiveCGO.get());
+    if (as.renderCGO.get() != as.primitiveCGO.get()) {
+      size += CGOGetMemorySize(as.renderCGO.get());
+    }
+    collector.add(obj->Name, state, RepCategory(cRepCGO), size);
+  }
+}
+
+static void CollectGadget(MemoryCollector& collector, ObjectGadget* obj)
+{
+  if (obj->GadgetType == cGadgetRamp) {
+    auto ramp = static_cast<ObjectGadgetRamp*>(obj);
+    collector.add(obj->Name, -1, "other",
+        memory_size(ramp->Level) + memory_size(ramp->LevelTmp) +
+            memory_size(ramp->Color));
+  }
+
+  for (int state = 0; state < obj->NGSet; ++state) {
+    auto gs = obj->GSet[state];
+    if (!gs) {
+      continue;
+    }
+    collector.add(obj->Name, state, "coords",
+        sizeof(GadgetSet) + memory_size(gs->Coord) + memory_size(gs->Normal) +
+            memory_size(gs->Color));
+    auto size = CGOGetMemorySize(gs->ShapeCGO);
+    size += CGOGetMemorySize(gs->PickShapeCGO);
+    size += CGOGetMemorySize(gs->StdCGO);
+    size += CGOGetMemorySize(gs->PickCGO);
+    collector.add(obj->Name, state, RepCategory(cRepCGO), size);
+  }
+}
+
+static void CollectObject(MemoryCollector& collector, pymol::CObject* obj)
+{
+  switch (obj->type) {
+  case cObjectMolecule:
+    CollectMolecule(collector, static_cast<ObjectMolecule*>(obj));
+    break;
+  case cObjectMap:
+    CollectMap(collector, static_cast<ObjectMap*>(obj));
+    break;
+  case cObjectMesh:
+    CollectIsoSurface(
+        collector, obj, static_cast<ObjectMesh*>(obj)->State, cRepMesh);
+    break;
+  case cObjectSurface:
+    CollectIsoSurface(
+        collector, obj, static_cast<ObjectSurface*>(obj)->State, cRepSurface);
+    break;
+  case cObjectCGO:
+    CollectCGO(collector, static_cast<ObjectCGO*>(obj));
+    break;
+  case cObjectVolume:
+    CollectVolume(collector, static_cast<ObjectVolume*>(obj));
+    break;
+  case cObjectMeasurement:
+    CollectDist(collector, static_cast<ObjectDist*>(obj));
+    break;
+  case cObjectSlice:
+    CollectSlice(collector, static_cast<ObjectSlice*>(obj));
+    break;
+  case cObjectAlignment:
+    CollectAlignment(collector, static_cast<ObjectAlignment*>(obj));
+    break;
+  case cObjectGadget:
+    CollectGadget(collector, static_cast<ObjectGadget*>(obj));
+    break;
+  default:
+    // callbacks, groups, curves, ... hold no significant data
+    break;
+  }
+
+  CollectSettings(collector, obj);
+}
+
+/**
+ * Selection and setting stores, without the parts attributed to objects
+ */
+static void CollectGlobal(MemoryCollector& collector)
+{
+  auto G = collector.G;
+  auto mgr = G->SelectorMgr;
+
+  std::size_t selections = memory_size(mgr->Member) + memory_size(mgr->Info) +
+                           memory_size(G->Selector->Table) +
+                           memory_size(G->Selector->Obj);
+  for (auto const& info : mgr->Info) {
+    selections += info.name.capacity();
+  }
+  collector.add({}, -1, "selections",
+      selections - std::min(selections, collector.members));
+
+  std::size_t settings = SettingGetMemorySize(G->Setting) +
+                         SettingUniqueGetStoreMemorySize(G);
+  collector.add({}, -1, "settings",
+      settings - std::min(settings, collector.uniqueSettings));
+}
+
+std::vector<MemoryRecord> MemoryAccountingCollect(
+    PyMOLGlobals* G, const char* names)
+{
+  MemoryCollector collector(G);
+  std::unordered_set<pymol::CObject*> done;
+  bool all = false;
+
+  auto collect = [&](pymol::CObject* obj) {
+    if (obj && done.insert(obj).second) {
+      CollectObject(collector, obj);
+    }
+  };
+
+  for (auto& rec : ExecutiveGetSpecRecsFromPattern(G, names)) {
+    switch (rec.type) {
+    case cExecObject:
+      collect(rec.obj);
+      break;
+    case cExecAll:
+      all = true;
+      for (ObjectIterator iter(G); iter.next();) {
+        collect(iter.getObject());
+      }
+      break;
+    }
+  }
+
+  if (all) {
+    CollectGlobal(collector);
+  }
+
+  return collector.records();
+}
+
+/**
+ * Human readable byte count, e.g. "12.3 MB"
+ */
+static std::string FormatBytes(std::size_t bytes)
+{
+  static const char* const units[] = {"B", "KB", "MB", "GB", "TB"};
+  double value = bytes;
+  int unit = 0;
+  while (value >= 1024. && unit < 4) {
+    value /= 1024.;
+    ++unit;
+  }
+  char buf[32];
+  snprintf(buf, sizeof(buf), unit ? "%.1f %s" : "%.0f %s", value, units[unit]);
+  return buf;
+}
+
+static void ReportTotals(std::string& out, const char* title,
+    const std::map<std::string, MemorySize>& totals)
+{
+  std::vector<std::pair<std::string, MemorySize>> ranked(
+      totals.begin(), totals.end());
+  std::stable_sort(ranked.begin(), ranked.end(),
+      [](auto const& a, auto const& b) {
+        return a.second.total() > b.second.total();
+      });
+
+  char buf[256];
+  snprintf(buf, sizeof(buf), " %s:\n", title);
+  out += buf;
+  for (auto const& item : ranked) {
+    snprintf(buf, sizeof(buf), "  %12s %12s  %s\n",
+        FormatBytes(item.second.host).c_str(),
+        FormatBytes(item.second.gpu).c_str(), item.first.c_str());
+    out += buf;
+  }
+}
+
+std::string MemoryAccountingReport(
+    const std::vector<MemoryRecord>& records, int limit)
+{
+  std::map<std::string, MemorySize> byCategory, byObject;
+  MemorySize total;
+
+  for (auto const& rec : records) {
+    auto const& object = rec.object.empty() ? "(global)" : rec.object;
+    byCategory[rec.category] += rec.size;
+    byObject[object] += rec.size;
+    total += rec.size;
+  }
+
+  std::string out;
+  char buf[256];
+  snprintf(buf, sizeof(buf), " Memory: %s host, %s GPU\n",
+      FormatBytes(total.host).c_str(), FormatBytes(total.gpu).c_str());
+  out += buf;
+  snprintf(buf, sizeof(buf), "  %12s %12s\n", "host", "GPU");
+  out += buf;
+
+  ReportTotals(out, "by category", byCategory);
+  ReportTotals(out, "by object", byObject);
+
+  std::vector<const MemoryRecord*> ranked;
+  ranked.reserve(records.size());
+  for (auto const& rec : records) {
+    ranked.push_back(&rec);
+  }
+  std::stable_sort(ranked.begin(), ranked.end(), [](auto a, auto b) {
+    return a->size.total() > b->size.total();
+  });
+  if (limit >= 0 && ranked.size() > std::size_t(limit)) {
+    ranked.resize(limit);
+  }
+
+  snprintf(buf, sizeof(buf), " largest:\n");
+  out += buf;
+  for (auto rec : ranked) {
+    auto const& object = rec->object.empty() ? "(global)" : rec->object;
+    if (rec->state < 0) {
+      snprintf(buf, sizeof(buf), "  %12s %12s  %s %s\n",
+          FormatBytes(rec->size.host).c_str(),
+          FormatBytes(rec->size.gpu).c_str(), object.c_str(),
+          rec->category.c_str());
+    } else {
+      snprintf(buf, sizeof(buf), "  %12s %12s  %s state %d %s\n",
+          FormatBytes(rec->size.host).c_str(),
+          FormatBytes(rec->size.gpu).c_str(), object.c_str(), rec->state + 1,
+          rec->category.c_str());
+    }
+    out += buf;
+  }
+
+  return out;
+}
+
+} // namespace pymol
@@ -0,0 +1,50 @@
+/**
+ * @file
+ * Memory accounting by object, state and category
+ *
+ * Walks the data structures of objects (atoms, bonds, coordinate sets,
+ * representations and their CGOs and GPU buffers, map fields, settings,
+ * undo journals) and of the selection and settings stores, and reports the
+ * bytes they hold. Sizes are computed from the allocated capacities, small
+ * bookkeeping structures are not counted, so the totals are a lower bound
+ * of the process memory usage (see memory_usage()).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "MemoryUsage.h"
+
+struct PyMOLGlobals;
+
+namespace pymol
+{
+
+/**
+ * Memory of one category of data of one object state
+ */
+struct MemoryRecord {
+  std::string object;   //!< object name, empty for global data
+  int state;            //!< 0-based state, -1 for data not owned by a state
+  std::string category; //!< e.g. "atoms", "coords", "rep:cartoon"
+  MemorySize size;
+};
+
+/**
+ * Memory used by the objects which match `names`. Global data (selection
+ * and setting stores) is included if `names` matches "all".
+ */
+std::vector<MemoryRecord> MemoryAccountingCollect(
+    PyMOLGlobals* G, const char* names);
+
+/**
+ * Text report of `records`: totals by category and by object, followed by
+ * the `limit` largest records.
+ */
+std::string MemoryAccountingReport(
+    const std::vector<MemoryRecord>& records, int limit = 20);
+
+} // namespace pymol
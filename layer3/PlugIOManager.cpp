@@ -36,6 +36,7 @@ Z* -------------------------------------------------------------------
 #include "PyMOLGlobals.h"
 #include "ObjectMolecule.h"
 #include "ObjectMap.h"
+#include "Trace.h"
 
 #ifndef _PYMOL_VMD_PLUGINS
 int PlugIOManagerInit(PyMOLGlobals * G)
@@ -156,6 +157,7 @@ int PlugIOManagerLoadTraj(PyMOLGlobals * G, ObjectMolecule * obj,
                           int stop, int max, const char *sele, int image,
                           const float *shift, int quiet, const char *plugin_type)
 {
+  PYMOL_TRACE_SCOPE("PlugIOManagerLoadTraj", "load", fname);
   CPlugIOManager *I = G->PlugIOManager;
   molfile_plugin_t *plugin = nullptr;
 
@@ -342,6 +344,7 @@ ObjectMap *PlugIOManagerLoadVol(PyMOLGlobals * G, ObjectMap * obj,
                                 const char *fname, int state, int quiet,
                                 const char *plugin_type)
 {
+  PYMOL_TRACE_SCOPE("PlugIOManagerLoadVol", "load", fname);
   CPlugIOManager *I = G->PlugIOManager;
   molfile_plugin_t *plugin = nullptr;
   molfile_volumetric_t *metadata;
@@ -575,6 +578,7 @@ ok_except1:
 ObjectMolecule *PlugIOManagerLoadMol(PyMOLGlobals * G, ObjectMolecule *origObj,
     const char *fname, int state, int quiet, const char *plugin_type)
 {
+  PYMOL_TRACE_SCOPE("PlugIOManagerLoadMol", "load", fname);
   CPlugIOManager *manager = G->PlugIOManager;
   int natoms, nbonds = 0, *from, *to;
   int optflags = 0;
@@ -759,6 +763,7 @@ static
 ObjectCGO *PlugIOManagerLoadGraphics(PyMOLGlobals * G, ObjectCGO *origObj,
     const char *fname, int state, int quiet, const char *plugin_type)
 {
+  PYMOL_TRACE_SCOPE("PlugIOManagerLoadGraphics", "load", fname);
   CPlugIOManager *manager = G->PlugIOManager;
   void *file_handle = nullptr;
   molfile_plugin_t * plugin = nullptr;
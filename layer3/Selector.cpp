@@ -62,6 +62,7 @@ Z* -------------------------------------------------------------------
 #include "pymol/zstring_view.h"
 
 #include "SelectorDef.h"
+#include "Trace.h"
 
 using SelectorInfoIter_t = decltype(CSelectorManager::Info)::iterator;
 
@@ -307,6 +308,47 @@ static int SelectorGetObjAtmOffset(
   return -1;
 }
 
+namespace
+{
+/**
+ * Maps (model, atom) to the selector table index, for atoms found through a
+ * coordinate set's spatial index. Uses the object's base offset if valid,
+ * otherwise a lookup table built from the selector table.
+ */
+class SelectorTableLookup
+{
+  CSelector* m_sel;
+  std::vector<std::vector<int>> m_table; // per model: atom -> table index
+
+public:
+  explicit SelectorTableLookup(CSelector* I)
+      : m_sel(I)
+  {
+    if (I->SeleBaseOffsetsValid)
+      return;
+
+    m_table.resize(I->Obj.size());
+    for (ov_size a = 0; a < I->Table.size(); ++a) {
+      auto const& rec = I->Table[a];
+      auto& lookup = m_table[rec.model];
+      if (lookup.empty()) {
+        lookup.assign(I->Obj[rec.model]->NAtom, -1);
+      }
+      lookup[rec.atom] = a;
+    }
+  }
+
+  /// @return Table index or -1 if the atom is not in the table
+  int operator()(int model, int atm) const
+  {
+    if (m_table.empty())
+      return m_sel->Obj[model]->SeleBase + atm;
+    auto const& lookup = m_table[model];
+    return lookup.empty() ? -1 : lookup[atm];
+  }
+};
+} // namespace
+
 #define STYP_VALU 0
 #define STYP_OPR1 1
 #define STYP_OPR2 2
@@ -4675,46 +4717,52 @@ float SelectorSumVDWOverlap(PyMOLGlobals * G, int sele1, int state1, int sele2,
 std::vector<int> SelectorGetInterstateVector(
     PyMOLGlobals* G, int sele1, int state1, int sele2, int state2, float cutoff)
 {                               /* Assumes valid tables */
-  const size_t table_size = G->Selector->Table.size();
-  auto coords_flat = std::vector<float>(3 * table_size);
-  auto* coords = pymol::reshape<3>(coords_flat.data());
+  CSelector* I = G->Selector;
+  const size_t table_size = I->Table.size();
+  const SelectorTableLookup table_index(I);
 
-  // number of atoms in `sele1`
-  int n1 = 0;
+  // selected atoms in `sele1`: state + 1 of the coordinates to consider
+  auto flags = std::vector<int>(table_size);
 
-  // mask on selected atoms in `sele1`
-  auto flags = std::vector<MapFlag_t>(table_size);
+  // (model, state) pairs with atoms in `sele1`
+  std::vector<std::pair<int, int>> csets;
 
-  // copy coordinates of selection 1
   for (SeleCoordIterator iter(G, sele1, state1, false); iter.next();) {
-    copy3(iter.getCoord(), coords[iter.a]);
-    flags[iter.a] = true;
-    n1++;
+    flags[iter.a] = iter.state + 1;
+    std::pair<int, int> const key(I->Table[iter.a].model, iter.state);
+    if (csets.empty() || csets.back() != key) {
+      csets.push_back(key);
+    }
   }
 
-  if (n1 == 0) {
+  if (csets.empty()) {
     // no atoms in `sele1`
     return {};
   }
 
-  std::unique_ptr<MapType> map(MapNewFlagged(
-      G, -cutoff, pymol::flatten(coords), table_size, nullptr, flags.data()));
-
-  if (!map) {
-    PRINTFB(G, FB_Selector, FB_Errors)
-    " Selector-Error: unexpected map allocation failure\n" ENDFB(G);
-    return {};
-  }
+  std::sort(csets.begin(), csets.end());
+  csets.erase(std::unique(csets.begin(), csets.end()), csets.end());
 
-  std::vector<int> out;
+  std::vector<int> out, hits;
 
   for (SeleCoordIterator iter(G, sele2, state2, false); iter.next();) {
     const float* v2 = iter.getCoord();
-    for (const auto a1 : MapEIter(*map, v2)) {
-      if (within3f(coords[a1], v2, cutoff)) {
-        out.push_back(a1);
-        out.push_back(iter.a);
-      }
+
+    hits.clear();
+    for (auto const& key : csets) {
+      CoordSet* cs = I->Obj[key.first]->CSet[key.second];
+      cs->getSpatialIndex().forEachWithin(v2, cutoff, [&](int idx) {
+        int const a1 = table_index(key.first, cs->IdxToAtm[idx]);
+        if (a1 >= 0 && flags[a1] == key.second + 1) {
+          hits.push_back(a1);
+        }
+      });
+    }
+
+    std::sort(hits.begin(), hits.end());
+    for (const auto a1 : hits) {
+      out.push_back(a1);
+      out.push_back(iter.a);
     }
   }
 
@@ -4838,7 +4886,6 @@ int SelectorMapGaussian(PyMOLGlobals * G, int sele1, ObjectMapState * oMap,
                         float resolution)
 {
   CSelector *I = G->Selector;
-  float *v2;
   int n1, n2;
   int a, b, c;
   int at;
@@ -4853,10 +4900,9 @@ int SelectorMapGaussian(PyMOLGlobals * G, int sele1, ObjectMapState * oMap,
   float *occup = nullptr, *oc;
   int prot;
   int once_flag;
-  float d, e_val;
   double sum, sumsq;
   float mean, stdev;
-  double sf[256][11], *sfp;
+  double sf[256][11];
   AtomSF *atom_sf = nullptr;
   double b_adjust = (double) SettingGetGlobal_f(G, cSetting_gaussian_b_adjust);
   double elim = 7.0;
@@ -5227,57 +5273,77 @@ int SelectorMapGaussian(PyMOLGlobals * G, int sele1, ObjectMapState * oMap,
     if(map) {
       sum = 0.0;
       sumsq = 0.0;
+
+      // must be set up before the (read-only) parallel lookups
+      MapSetupCSR(map.get(), point);
+
+      /* one x-plane at a time, rows in parallel */
       for(a = oMap->Min[0]; a <= oMap->Max[0]; a++) {
         OrthoBusyFast(G, a - oMap->Min[0], oMap->Max[0] - oMap->Min[0] + 1);
-        for(b = oMap->Min[1]; b <= oMap->Max[1]; b++) {
-          for(c = oMap->Min[2]; c <= oMap->Max[2]; c++) {
-            e_val = 0.0;
-            v2 = F4Ptr(oMap->Field->points, a, b, c, 0);
-                if(use_max) {
-                  float e_partial;
-                  for (const auto j : MapEIter(*map, v2)) {
-                    d = (float) diff3f(point + 3 * j, v2) * blur_factor;        
-                    /* scale up width */
-                    sfp = atom_sf[j];
-                    if(d < sfp[10]) {
-                      d = d * d;
-                      if(d < R_SMALL8)
-                        d = R_SMALL8;
-                      e_partial = (float) ((sfp[0] * exp(-sfp[1] * d))
-                                           + (sfp[2] * exp(-sfp[3] * d))
-                                           + (sfp[4] * exp(-sfp[5] * d))
-                                           + (sfp[6] * exp(-sfp[7] * d))
-                                           + (sfp[8] * exp(-sfp[9] * d))) * blur_factor;       
-                      /* scale down intensity */
-                      if(e_partial > e_val)
-                        e_val = e_partial;
-                    }
-                  }
-                } else {
-                  for (const auto j : MapEIter(*map, v2)) {
-                    d = (float) diff3f(point + 3 * j, v2) * blur_factor;       
-                    /* scale up width */
-                    sfp = atom_sf[j];
-                    if(d < sfp[10]) {
-                      d = d * d;
-                      if(d < R_SMALL8)
-                        d = R_SMALL8;
-                      e_val += (float) ((sfp[0] * exp(-sfp[1] * d))
-                                        + (sfp[2] * exp(-sfp[3] * d))
-                                        + (sfp[4] * exp(-sfp[5] * d))
-                                        + (sfp[6] * exp(-sfp[7] * d))
-                                        + (sfp[8] * exp(-sfp[9] * d))) * blur_factor;  
-                      /* scale down intensity */
-                    }
-                  }
-                }
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for schedule(dynamic, 1) reduction(+:sum,sumsq)
+#endif
+        for(int b = oMap->Min[1]; b <= oMap->Max[1]; b++) {
+          /* atoms in range of the current voxel: gathered first, so that the
+           * exp() evaluation is a dense loop */
+          std::vector<int> near_j;
+          std::vector<float> near_d2, near_e;
+          for(int c = oMap->Min[2]; c <= oMap->Max[2]; c++) {
+            float e_val = 0.0F;
+            const float *v2 = F4Ptr(oMap->Field->points, a, b, c, 0);
+            near_j.clear();
+            near_d2.clear();
+            for (const auto j : MapEIter(*map, v2)) {
+              float d = (float) diff3f(point + 3 * j, v2) * blur_factor;
+              /* scale up width */
+              if(d < atom_sf[j][10]) {
+                d = d * d;
+                if(d < R_SMALL8)
+                  d = R_SMALL8;
+                near_j.push_back(j);
+                near_d2.push_back(d);
+              }
+            }
+
+            int const n_near = near_j.size();
+            near_e.resize(n_near);
+            const int *jp = near_j.data();
+            const float *dp = near_d2.data();
+            float *ep = near_e.data();
+
+            /* vectorizes where a vector exp() is available (e.g. glibc
+             * libmvec with -ffast-math), scalar otherwise */
+#ifdef PYMOL_OPENMP
+#pragma omp simd
+#endif
+            for(int k = 0; k < n_near; k++) {
+              const double *sfp = atom_sf[jp[k]];
+              float const d = dp[k];
+              ep[k] = (float) ((sfp[0] * exp(-sfp[1] * d))
+                               + (sfp[2] * exp(-sfp[3] * d))
+                               + (sfp[4] * exp(-sfp[5] * d))
+                               + (sfp[6] * exp(-sfp[7] * d))
+                               + (sfp[8] * exp(-sfp[9] * d))) * blur_factor;
+              /* scale down intensity */
+            }
+
+            /* accumulate in neighbor order, same result as a single loop */
+            for(int k = 0; k < n_near; k++) {
+              if(!use_max) {
+                e_val += ep[k];
+              } else if(ep[k] > e_val) {
+                e_val = ep[k];
+              }
+            }
             F3(oMap->Field->data, a, b, c) = e_val;
             sum += e_val;
             sumsq += (e_val * e_val);
-            n2++;
           }
         }
       }
+      n2 = (oMap->Max[0] - oMap->Min[0] + 1) *
+           (oMap->Max[1] - oMap->Min[1] + 1) *
+           (oMap->Max[2] - oMap->Min[2] + 1);
       mean = (float) (sum / n2);
       stdev = (float) sqrt1d((sumsq - (sum * sum / n2)) / (n2 - 1));
       if(normalize) {
@@ -5319,13 +5385,194 @@ int SelectorMapGaussian(PyMOLGlobals * G, int sele1, ObjectMapState * oMap,
 }
 
 
+/*========================================================================*/
+/**
+ * Smooth part of the 1/r kernel for the multilevel summation method: 1/r
+ * beyond `a`, an even polynomial inside (C2 continuous at `a`). The
+ * remainder 1/r - CoulombSmooth(r) vanishes beyond `a`.
+ */
+static float CoulombSmooth(float r2, float a)
+{
+  if(r2 >= a * a)
+    return 1.0F / std::sqrt(r2);
+  float s = r2 / (a * a);
+  return (1.875F - 1.25F * s + 0.375F * s * s) / a;
+}
+
+/**
+ * C1 cubic interpolation basis of the multilevel summation method
+ * (support [-2, 2])
+ */
+static float CoulombMeshBasis(float t)
+{
+  t = std::fabs(t);
+  if(t <= 1.0F)
+    return (1.0F - t) * (1.0F + t - 1.5F * t * t);
+  if(t < 2.0F)
+    return -0.5F * (t - 1.0F) * (2.0F - t) * (2.0F - t);
+  return 0.0F;
+}
+
+/**
+ * Coulomb potential without cutoff, split into a short-range part which is
+ * summed exactly within `cutoff` and a smooth long-range part which is
+ * evaluated on a coarse grid (spacing cutoff / 3) and interpolated (two
+ * level multilevel summation). Approximate, the RMS error is well below 1%
+ * of the exact sum, at a fraction of its cost for large maps.
+ *
+ * @param charge Charges, premultiplied by the units factor
+ */
+static void SelectorMapCoulombMesh(PyMOLGlobals * G, ObjectMapState * oMap,
+    const float *point, const float *charge, int n_point, float cutoff)
+{
+  const int *min = oMap->Min;
+  const int *max = oMap->Max;
+  CField *data = oMap->Field->data.get();
+  CField *points = oMap->Field->points.get();
+  assert(cutoff > 0.0F);
+  float const h = cutoff / 3.0F;
+
+  /* coarse grid over the atoms and the map, plus the support of the basis */
+  float lo[3], hi[3];
+  copy3f(point, lo);
+  copy3f(point, hi);
+  for(int j = 1; j < n_point; j++) {
+    for(int d = 0; d < 3; d++) {
+      lo[d] = std::min(lo[d], point[3 * j + d]);
+      hi[d] = std::max(hi[d], point[3 * j + d]);
+    }
+  }
+  for(int a = min[0]; a <= max[0]; a++) {
+    for(int b = min[1]; b <= max[1]; b++) {
+      for(int c = min[2]; c <= max[2]; c++) {
+        const float *v2 = F4Ptr(points, a, b, c, 0);
+        for(int d = 0; d < 3; d++) {
+          lo[d] = std::min(lo[d], v2[d]);
+          hi[d] = std::max(hi[d], v2[d]);
+        }
+      }
+    }
+  }
+
+  int dim[3];
+  for(int d = 0; d < 3; d++) {
+    lo[d] -= h;
+    dim[d] = int((hi[d] - lo[d]) / h) + 4;
+  }
+
+  auto const node = [&dim](int i, int j, int k) {
+    return (size_t(i) * dim[1] + j) * dim[2] + k;
+  };
+
+  /* first node and 4x4x4 interpolation weights around `v` */
+  auto const stencil = [&](const float *v, int *first, float (*w)[4]) {
+    for(int d = 0; d < 3; d++) {
+      float t = (v[d] - lo[d]) / h;
+      first[d] = int(t) - 1;
+      for(int m = 0; m < 4; m++)
+        w[d][m] = CoulombMeshBasis(t - float(first[d] + m));
+    }
+  };
+
+  /* charges to grid */
+  std::vector<double> grid_q(node(dim[0], 0, 0));
+  for(int j = 0; j < n_point; j++) {
+    int first[3];
+    float w[3][4];
+    stencil(point + 3 * j, first, w);
+    for(int i = 0; i < 4; i++)
+      for(int k = 0; k < 4; k++)
+        for(int l = 0; l < 4; l++)
+          grid_q[node(first[0] + i, first[1] + k, first[2] + l)] +=
+            charge[j] * w[0][i] * w[1][k] * w[2][l];
+  }
+
+  std::vector<float> qx, qy, qz, qq;
+  for(int i = 0; i < dim[0]; i++) {
+    for(int k = 0; k < dim[1]; k++) {
+      for(int l = 0; l < dim[2]; l++) {
+        double q = grid_q[node(i, k, l)];
+        if(q != 0.0) {
+          qx.push_back(lo[0] + i * h);
+          qy.push_back(lo[1] + k * h);
+          qz.push_back(lo[2] + l * h);
+          qq.push_back(float(q));
+        }
+      }
+    }
+  }
+
+  /* long-range potential on the coarse grid */
+  std::vector<float> grid_phi(grid_q.size());
+  int const n_q = qq.size();
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+  for(int i = 0; i < dim[0]; i++) {
+    for(int k = 0; k < dim[1]; k++) {
+      for(int l = 0; l < dim[2]; l++) {
+        float const x = lo[0] + i * h, y = lo[1] + k * h, z = lo[2] + l * h;
+        float sum = 0.0F;
+        for(int m = 0; m < n_q; m++) {
+          float dx = qx[m] - x, dy = qy[m] - y, dz = qz[m] - z;
+          sum += qq[m] * CoulombSmooth(dx * dx + dy * dy + dz * dz, cutoff);
+        }
+        grid_phi[node(i, k, l)] = sum;
+      }
+    }
+  }
+
+  /* exact short-range part plus interpolated long-range part */
+  std::unique_ptr<MapType> map(MapNew(G, -cutoff, point, n_point, nullptr));
+  if(!map)
+    return;
+
+  float const cut2 = cutoff * cutoff;
+
+  // must be set up before the (read-only) parallel lookups
+  MapSetupCSR(map.get(), point);
+
+  for(int a = min[0]; a <= max[0]; a++) {
+    OrthoBusyFast(G, a - min[0], max[0] - min[0] + 1);
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for(int b = min[1]; b <= max[1]; b++) {
+      for(int c = min[2]; c <= max[2]; c++) {
+        const float *v2 = F4Ptr(points, a, b, c, 0);
+        float sum = 0.0F;
+        for (const auto j : MapEIter(*map, v2)) {
+          float dist2 = diffsq3f(point + 3 * j, v2);
+          if(dist2 >= cut2)
+            continue;
+          float dist = (float) sqrt1f(dist2);
+          if(dist > R_SMALL4)
+            sum += charge[j] * (1.0F / dist - CoulombSmooth(dist2, cutoff));
+        }
+
+        int first[3];
+        float w[3][4];
+        stencil(v2, first, w);
+        for(int i = 0; i < 4; i++)
+          for(int k = 0; k < 4; k++)
+            for(int l = 0; l < 4; l++)
+              sum += w[0][i] * w[1][k] * w[2][l] *
+                grid_phi[node(first[0] + i, first[1] + k, first[2] + l)];
+
+        F3(data, a, b, c) = sum;
+      }
+    }
+  }
+}
+
+
 /*========================================================================*/
 int SelectorMapCoulomb(PyMOLGlobals * G, int sele1, ObjectMapState * oMap,
-                       float cutoff, int state, int neutral, int shift, float shift_power)
+                       float cutoff, int state, int neutral, int shift, float shift_power,
+                       int mesh)
 {
   CSelector *I = G->Selector;
-  float *v2;
-  int a, b, c, j;
+  int a, j;
   int at;
   int s, idx;
   AtomInfoType *ai;
@@ -5350,7 +5597,6 @@ int SelectorMapCoulomb(PyMOLGlobals * G, int sele1, ObjectMapState * oMap,
   c_factor = SettingGetGlobal_f(G, cSetting_coulomb_units_factor) /
              SettingGetGlobal_f(G, cSetting_coulomb_dielectric);
 
-  c = 0;
   SelectorUpdateTable(G, state, -1);
 
   point = VLAlloc(float, I->Table.size() * 3);
@@ -5445,16 +5691,27 @@ int SelectorMapCoulomb(PyMOLGlobals * G, int sele1, ObjectMapState * oMap,
     charge[a] *= c_factor;
   }
 
+  /* the mesh split distance is the cutoff (coarse grid spacing cutoff / 3) */
+  if(mesh && cutoff <= 0.0F) {
+    PRINTFB(G, FB_Selector, FB_Warnings)
+      " %s-Warning: coulomb_mesh needs coulomb_cutoff > 0, using the exact sum.\n",
+      __func__ ENDFB(G);
+    mesh = false;
+  }
+
   /* now create and apply voxel map */
-  c = 0;
   if(n_point) {
     int *min = oMap->Min;
     int *max = oMap->Max;
     CField *data = oMap->Field->data.get();
     CField *points = oMap->Field->points.get();
-    float dist;
 
-    if(cutoff > 0.0F) {         /* we are using a cutoff */
+    if(mesh) {
+      PRINTFB(G, FB_Selector, FB_Details)
+        " %s: Evaluating Coulomb potential for grid (mesh, split=%0.2f)...\n",
+        __func__, cutoff ENDFB(G);
+      SelectorMapCoulombMesh(G, oMap, point, charge, n_point, cutoff);
+    } else if(cutoff > 0.0F) {         /* we are using a cutoff */
       if(shift) {
         PRINTFB(G, FB_Selector, FB_Details)
           " %s: Evaluating local Coulomb potential for grid (shift=%0.2f)...\n", __func__,
@@ -5468,85 +5725,81 @@ int SelectorMapCoulomb(PyMOLGlobals * G, int sele1, ObjectMapState * oMap,
       std::unique_ptr<MapType> map(
           MapNew(G, -(cutoff), point, n_point, nullptr));
       if(map) {
-        float dx, dy, dz;
-        float cut = cutoff;
         float cut2 = cutoff * cutoff;
 
+        // must be set up before the (read-only) parallel lookups
+        MapSetupCSR(map.get(), point);
+
+        /* one x-plane at a time, rows in parallel */
         for(a = min[0]; a <= max[0]; a++) {
           OrthoBusyFast(G, a - min[0], max[0] - min[0] + 1);
-          for(b = min[1]; b <= max[1]; b++) {
-            for(c = min[2]; c <= max[2]; c++) {
-              F3(data, a, b, c) = 0.0F;
-              v2 = F4Ptr(points, a, b, c, 0);
-              {
-                {
-                  for (const auto j : MapEIter(*map, v2)) {
-                    v1 = point + 3 * j;
-                    while(1) {
-
-                      dx = v1[0] - v2[0];
-                      dy = v1[1] - v2[1];
-                      dx = (float) fabs(dx);
-                      dy = (float) fabs(dy);
-                      if(dx > cut)
-                        break;
-                      dz = v1[2] - v2[2];
-                      dx = dx * dx;
-                      if(dy > cut)
-                        break;
-                      dz = (float) fabs(dz);
-                      dy = dy * dy;
-                      if(dz > cut)
-                        break;
-                      dx = dx + dy;
-                      dz = dz * dz;
-                      if(dx > cut2)
-                        break;
-                      dy = dx + dz;
-                      if(dy > cut2)
-                        break;
-                      dist = (float) sqrt1f(dy);
-
-                      if(dist > R_SMALL4) {
-                        if(shift) {
-                          if(dist < cutoff) {
-                            F3(data, a, b, c) += (charge[j] / dist) *
-                              (_1 - (float) pow(dist, shift_power) / cutoff_to_power);
-                          }
-                        } else {
-                          F3(data, a, b, c) += charge[j] / dist;
-                        }
-                      }
-
-                      break;
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+          for(int b = min[1]; b <= max[1]; b++) {
+            for(int c = min[2]; c <= max[2]; c++) {
+              const float *v2 = F4Ptr(points, a, b, c, 0);
+              float sum = 0.0F;
+              for (const auto j : MapEIter(*map, v2)) {
+                float dist2 = diffsq3f(point + 3 * j, v2);
+                if(dist2 > cut2)
+                  continue;
+                float dist = (float) sqrt1f(dist2);
+                if(dist > R_SMALL4) {
+                  if(shift) {
+                    if(dist < cutoff) {
+                      sum += (charge[j] / dist) *
+                        (_1 - (float) pow(dist, shift_power) / cutoff_to_power);
                     }
+                  } else {
+                    sum += charge[j] / dist;
                   }
                 }
               }
+              F3(data, a, b, c) = sum;
             }
           }
         }
       }
     } else {
-      float *v1;
       PRINTFB(G, FB_Selector, FB_Details)
         " %s: Evaluating Coulomb potential for grid (no cutoff)...\n", __func__
         ENDFB(G);
 
+      /* structure of arrays, so that the inner loop vectorizes */
+      std::vector<float> px(n_point), py(n_point), pz(n_point);
+      for(j = 0; j < n_point; j++) {
+        px[j] = point[3 * j];
+        py[j] = point[3 * j + 1];
+        pz[j] = point[3 * j + 2];
+      }
+
+      const float *x = px.data(), *y = py.data(), *z = pz.data();
+      const float small2 = R_SMALL4 * R_SMALL4;
+
       for(a = min[0]; a <= max[0]; a++) {
         OrthoBusyFast(G, a - min[0], max[0] - min[0] + 1);
-        for(b = min[1]; b <= max[1]; b++) {
-          for(c = min[2]; c <= max[2]; c++) {
-            F3(data, a, b, c) = 0.0F;
-            v1 = point;
-            v2 = F4Ptr(points, a, b, c, 0);
-            for(j = 0; j < n_point; j++) {
-              dist = (float) diff3f(v1, v2);
-              v1 += 3;
-              if(dist > R_SMALL4) {
-                F3(data, a, b, c) += charge[j] / dist;
-              }
+#ifdef PYMOL_OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+        for(int b = min[1]; b <= max[1]; b++) {
+          for(int c = min[2]; c <= max[2]; c++) {
+            const float *v2 = F4Ptr(points, a, b, c, 0);
+            float const v2x = v2[0], v2y = v2[1], v2z = v2[2];
+            float sum = 0.0F;
+#ifdef PYMOL_OPENMP
+#pragma omp simd reduction(+:sum)
+#endif
+            for(int k = 0; k < n_point; k++) {
+              float dx = x[k] - v2x;
+              float dy = y[k] - v2y;
+              float dz = z[k] - v2z;
+              float dist2 = dx * dx + dy * dy + dz * dz;
+              // branch-free form of: if (dist > R_SMALL4) sum += q / dist
+              float q = dist2 > small2 ? charge[k] : 0.0F;
+              sum += q / std::sqrt(dist2 > small2 ? dist2 : 1.0F);
             }
+            F3(data, a, b, c) = sum;
           }
         }
       }
@@ -7224,6 +7477,7 @@ int SelectorUpdateTableImpl(PyMOLGlobals * G, CSelector *I, int req_state, Selec
 static pymol::Result<sele_array_t> SelectorSelect(
     PyMOLGlobals* G, const char* sele, int state, SelectorID_t domain, int quiet)
 {
+  PYMOL_TRACE_SCOPE("SelectorSelect", "selector", sele);
   SelectorUpdateTable(G, state, domain);
   auto parsed = SelectorParse(G, sele);
   if (!parsed.empty()) {
@@ -9359,7 +9613,8 @@ static int SelectorLogic2(PyMOLGlobals * G, EvalElem * base)
 int SelectorOperator22(PyMOLGlobals * G, EvalElem * base, int state)
 {
   int c = 0;
-  int a, d, e;
+  ov_size a;
+  int d, e;
   CSelector *I = G->Selector;
   ObjectMolecule *obj;
 
@@ -9367,7 +9622,7 @@ int SelectorOperator22(PyMOLGlobals * G, EvalElem * base, int state)
   CoordSet *cs;
   int ok = true;
   int nCSet;
-  int n1, at, idx;
+  int at, idx;
   int code = base[1].code;
 
   if(state < 0) {
@@ -9390,59 +9645,66 @@ int SelectorOperator22(PyMOLGlobals * G, EvalElem * base, int state)
         dist = 0.0;
 
       const size_t table_size = I->Table.size();
-      auto coords_flat = std::vector<float>(table_size * 3);
-      auto* coords = pymol::reshape<3>(coords_flat.data());
+      const SelectorTableLookup table_index(I);
 
       /* copy starting mask */
       const auto Flag2 = std::move(base[0].sele);
       base[0].sele_calloc(table_size);
 
+      /* models with candidate atoms, the others can't contribute */
+      std::vector<bool> model_has_flag2(I->Obj.size());
+      for(a = 0; a < table_size; a++) {
+        if(Flag2[a])
+          model_has_flag2[I->Table[a].model] = true;
+      }
+
+      nCSet = SelectorGetArrayNCSet(G, base[4].sele, false);
+
+      /* the coordinate sets' spatial indices are reused across queries as
+       * long as the coordinates don't change */
+      struct Target {
+        int model;
+        const CoordSet* cs;
+        const pymol::SpatialIndex* index;
+      };
+      std::vector<Target> targets;
+
       for(d = 0; d < I->NCSet; d++) {
         if((state < 0) || (d == state)) {
-          n1 = 0;
-          auto Flag1 = std::vector<MapFlag_t>(table_size);
-          for(a = 0; a < table_size; a++) {
-            at = I->Table[a].atom;
-            obj = I->Obj[I->Table[a].model];
-            if(d < obj->NCSet)
-              cs = obj->CSet[d];
-            else
-              cs = nullptr;
-            if(cs) {
-              if(CoordSetGetAtomVertex(cs, at, coords[a])) {
-                Flag1[a] = true;
-                n1++;
-              }
+          targets.clear();
+          for(int model = 0, n_model = I->Obj.size(); model < n_model; model++) {
+            ObjectMolecule* obj1 = I->Obj[model];
+            if(model_has_flag2[model] && obj1 && d < obj1->NCSet && obj1->CSet[d]) {
+              CoordSet* cs1 = obj1->CSet[d];
+              targets.push_back({model, cs1, &cs1->getSpatialIndex()});
             }
           }
-          if(n1) {
-            std::unique_ptr<MapType> map(MapNewFlagged(G, -dist,
-                pymol::flatten(coords), table_size, nullptr, Flag1.data()));
-	    CHECKOK(ok, map);
-            if(ok) {
-              nCSet = SelectorGetArrayNCSet(G, base[4].sele, false);
-              for(e = 0; ok && e < nCSet; e++) {
-                if((state < 0) || (e == state)) {
-                  for(a = 0; a < I->Table.size(); a++) {
-                    if(base[4].sele[a]) {
-                      at = I->Table[a].atom;
-                      obj = I->Obj[I->Table[a].model];
-                      if(e < obj->NCSet)
-                        cs = obj->CSet[e];
-                      else
-                        cs = nullptr;
-                      if(cs) {
-                        idx = cs->atmToIdx(at);
-                        if(idx >= 0) {
-                          const float* v2 = cs->coordPtr(idx);
-                          for (const auto j : MapEIter(*map, v2, false)) {
-                            if (!base[0].sele[j] && Flag2[j] &&
-                                within3f(coords[j], v2, dist) &&
-                                (code != SELE_NTO_ || !base[4].sele[j])) {
-                              base[0].sele[j] = true;
-                            }
+          if(targets.empty())
+            continue;
+
+          for(e = 0; ok && e < nCSet; e++) {
+            if((state < 0) || (e == state)) {
+              for(a = 0; a < table_size; a++) {
+                if(base[4].sele[a]) {
+                  at = I->Table[a].atom;
+                  obj = I->Obj[I->Table[a].model];
+                  if(e < obj->NCSet)
+                    cs = obj->CSet[e];
+                  else
+                    cs = nullptr;
+                  if(cs) {
+                    idx = cs->atmToIdx(at);
+                    if(idx >= 0) {
+                      const float* v2 = cs->coordPtr(idx);
+                      for(const auto& target : targets) {
+                        target.index->forEachWithin(v2, dist, [&](int idx1) {
+                          const int j = table_index(
+                              target.model, target.cs->IdxToAtm[idx1]);
+                          if (j >= 0 && !base[0].sele[j] && Flag2[j] &&
+                              (code != SELE_NTO_ || !base[4].sele[j])) {
+                            base[0].sele[j] = true;
                           }
-                        }
+                        });
                       }
                     }
                   }
@@ -140,7 +140,8 @@ int SelectorMapMaskVDW(PyMOLGlobals * G, int sele1, ObjectMapState * oMap, float
                        int state);
 
 int SelectorMapCoulomb(PyMOLGlobals * G, int sele1, ObjectMapState * oMap, float cutoff,
-                       int state, int neutral, int shift, float shift_power);
+                       int state, int neutral, int shift, float shift_power,
+                       int mesh = false);
 
 int SelectorMapGaussian(PyMOLGlobals * G, int sele1, ObjectMapState * oMap,
                         float buffer, int state, int normalize, int use_max, int quiet,
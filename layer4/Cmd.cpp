@@ -47,6 +47,7 @@ Z* -------------------------------------------------------------------
 #include"PyMOLGlobals.h"
 #include"PyMOLOptions.h"
 #include"MemoryUsage.h"
+#include"MemoryAccounting.h"
 #include"Err.h"
 #include"Cmd.h"
 #include"ButMode.h"
@@ -74,11 +75,13 @@ Z* -------------------------------------------------------------------
 #include"PlugIOManager.h"
 #include"ObjectAlignment.h"
 #include"Feedback.h"
+#include"os_numpy.h"
 
 #include "MovieScene.h"
 #include "CifFile.h"
 
 #include "MoleculeExporter.h"
+#include "Trace.h"
 
 #define tmpSele "_tmp"
 #define tmpSele1 "_tmp1"
@@ -445,57 +448,6 @@ static PyObject *CmdFixChemistry(PyObject * self, PyObject * args)
   return APIResult(G, result);
 }
 
-static PyObject *CmdRayAntiThread(PyObject * self, PyObject * args)
-{
-  PyMOLGlobals *G = nullptr;
-  PyObject *py_thread_info;
-  API_SETUP_ARGS(G, self, args, "OO", &self, &py_thread_info);
-
-  auto thread_info = reinterpret_cast<CRayAntiThreadInfo*>(
-      PyCapsule_GetPointer(py_thread_info, nullptr));
-  API_ASSERT(thread_info);
-
-  PUnblock(G);
-  RayAntiThread(thread_info);
-  PBlock(G);
-
-  return APISuccess();
-}
-
-static PyObject *CmdRayHashThread(PyObject * self, PyObject * args)
-{
-  PyMOLGlobals *G = nullptr;
-  PyObject *py_thread_info;
-  API_SETUP_ARGS(G, self, args, "OO", &self, &py_thread_info);
-
-  auto thread_info = reinterpret_cast<CRayHashThreadInfo*>(
-      PyCapsule_GetPointer(py_thread_info, nullptr));
-  API_ASSERT(thread_info);
-
-  PUnblock(G);
-  RayHashThread(thread_info);
-  PBlock(G);
-
-  return APISuccess();
-}
-
-static PyObject *CmdRayTraceThread(PyObject * self, PyObject * args)
-{
-  PyMOLGlobals *G = nullptr;
-  PyObject *py_thread_info;
-  API_SETUP_ARGS(G, self, args, "OO", &self, &py_thread_info);
-
-  auto thread_info = reinterpret_cast<CRayThreadInfo*>(
-      PyCapsule_GetPointer(py_thread_info, nullptr));
-  API_ASSERT(thread_info);
-
-  PUnblock(G);
-  RayTraceThread(thread_info);
-  PBlock(G);
-
-  return APISuccess();
-}
-
 static PyObject *CmdCoordSetUpdateThread(PyObject * self, PyObject * args)
 {
   PyMOLGlobals *G = nullptr;
@@ -1636,6 +1588,23 @@ static PyObject *CmdGetRenderer(PyObject * self, PyObject * args)
   return Py_BuildValue("(sss)", vendor, renderer, version);
 }
 
+static PyObject *CmdGetLodStats(PyObject * self, PyObject * args)
+{
+  PyMOLGlobals *G = nullptr;
+  API_SETUP_ARGS(G, self, args, "O", &self);
+  APIEnter(G);
+  auto const stats = SceneGetLodStats(G);
+  APIExit(G);
+
+  PyObject *result = PyList_New(pymol::LodLevelCount);
+  for (int level = 0; level < pymol::LodLevelCount; ++level) {
+    PyList_SET_ITEM(result, level,
+        Py_BuildValue("(nn)", Py_ssize_t(stats.chunks[level]),
+                              Py_ssize_t(stats.triangles[level])));
+  }
+  return result;
+}
+
 #include <PyMOLBuildInfo.h>
 
 static PyObject *CmdGetVersion(PyObject * self, PyObject * args)
@@ -1664,6 +1633,39 @@ static PyObject* CmdMemoryAvailable(PyObject* self, PyObject* args)
   return PConvToPyObject(pymol::memory_available());
 }
 
+static PyObject* CmdGetMemoryAccounting(PyObject* self, PyObject* args)
+{
+  PyMOLGlobals* G = nullptr;
+  const char* names;
+  API_SETUP_ARGS(G, self, args, "Os", &self, &names);
+  APIEnter(G);
+  auto const records = pymol::MemoryAccountingCollect(G, names);
+  APIExit(G);
+
+  PyObject* result = PyList_New(records.size());
+  for (size_t i = 0; i < records.size(); ++i) {
+    auto const& rec = records[i];
+    PyList_SET_ITEM(result, i,
+        Py_BuildValue("(sisnn)", rec.object.c_str(), rec.state,
+            rec.category.c_str(), Py_ssize_t(rec.size.host),
+            Py_ssize_t(rec.size.gpu)));
+  }
+  return result;
+}
+
+static PyObject* CmdMemoryReport(PyObject* self, PyObject* args)
+{
+  PyMOLGlobals* G = nullptr;
+  const char* names;
+  int limit;
+  API_SETUP_ARGS(G, self, args, "Osi", &self, &names, &limit);
+  APIEnter(G);
+  auto const report = pymol::MemoryAccountingReport(
+      pymol::MemoryAccountingCollect(G, names), limit);
+  APIExit(G);
+  return PConvToPyObject(report);
+}
+
 static PyObject* CmdGetCapabilities(PyObject*, PyObject*)
 {
   static PyObject* caps = nullptr;
@@ -4004,6 +4006,68 @@ static PyObject *CmdIntraFit(PyObject * self, PyObject * args)
   return APIAutoNone(result);
 }
 
+/**
+ * n x n float32 array if numpy is available, nested list otherwise
+ */
+static PyObject* RMSMatrixAsPyObject(const std::vector<float>& matrix, int n)
+{
+#ifdef _PYMOL_NUMPY
+  import_array1(nullptr);
+  npy_intp dims[2] = {n, n};
+  PyObject* result = PyArray_SimpleNew(2, dims, NPY_FLOAT32);
+  if (result) {
+    std::copy(matrix.begin(), matrix.end(),
+        (float*) PyArray_DATA((PyArrayObject*) result));
+  }
+  return result;
+#else
+  PyObject* result = PyList_New(n);
+  for (int i = 0; i < n; ++i) {
+    PyList_SET_ITEM(result, i,
+        PConvFloatArrayToPyList(matrix.data() + size_t(i) * n, n));
+  }
+  return result;
+#endif
+}
+
+static PyObject *CmdRMSMatrix(PyObject * self, PyObject * args)
+{
+  PyMOLGlobals *G = nullptr;
+  char *str1;
+  PyObject *py_states;
+  int fit;
+  API_SETUP_ARGS(G, self, args, "OsOi", &self, &str1, &py_states, &fit);
+  std::vector<int> states;
+  API_ASSERT(PConvFromPyObject(G, py_states, states));
+  API_ASSERT(APIEnterNotModal(G));
+  auto matrix = ExecutiveRMSMatrix(G, str1, states, fit);
+  APIExit(G);
+  if (!matrix) {
+    return APIResult(G, matrix);
+  }
+  PyObject* py_matrix = RMSMatrixAsPyObject(*matrix, states.size());
+  if (!py_matrix) {
+    return APIFailure(G);
+  }
+  return Py_BuildValue("NN", PConvToPyObject(states), py_matrix);
+}
+
+static PyObject *CmdRMSCluster(PyObject * self, PyObject * args)
+{
+  PyMOLGlobals *G = nullptr;
+  char *str1;
+  PyObject *py_states;
+  int fit;
+  float cutoff;
+  API_SETUP_ARGS(G, self, args, "OsOif", &self, &str1, &py_states, &fit, &cutoff);
+  std::vector<int> states;
+  API_ASSERT(PConvFromPyObject(G, py_states, states));
+  API_ASSERT(APIEnterNotModal(G));
+  auto result = ExecutiveRMSCluster(G, str1, states, fit, cutoff);
+  APIExit(G);
+  return APIResult(G, result);
+}
+
 static PyObject *CmdGetAtomCoords(PyObject * self, PyObject * args)
 {
   PyMOLGlobals *G = nullptr;
@@ -5617,6 +5681,31 @@ static PyObject *CmdTest(PyObject * self, PyObject * args)
   return APIResultOk(ok);
 }
 
+static PyObject *CmdTrace(PyObject * self, PyObject * args)
+{
+  PyMOLGlobals *G = nullptr;
+  int action; // 0 = status, 1 = start, 2 = stop
+  const char* filename;
+  API_SETUP_ARGS(G, self, args, "Ois", &self, &action, &filename);
+
+  switch (action) {
+  case 1:
+    pymol::trace::start();
+    break;
+  case 2:
+    pymol::trace::stop();
+    break;
+  }
+
+  if (filename[0] && !pymol::trace::write(filename)) {
+    return APIFailure(
+        G, pymol::make_error("can't write trace file '", filename, "'"));
+  }
+
+  return Py_BuildValue("(in)", int(pymol::trace::enabled()),
+      Py_ssize_t(pymol::trace::size()));
+}
+
 static PyObject *CmdCenter(PyObject * self, PyObject * args)
 {
   PyMOLGlobals *G = nullptr;
@@ -6063,6 +6152,20 @@ static PyObject *CmdCEAlign(PyObject *self, PyObject *args)
   return result;
 }
 
+static PyObject *CmdCEAlignBatch(PyObject *self, PyObject *args)
+{
+  PyMOLGlobals * G = nullptr;
+  int windowSize = 8, gap_max = 30;
+  float d0 = 3.0, d1 = 4.0;
+  PyObject *listA, *listsB;
+  API_SETUP_ARGS(G, self, args, "OO!O!|ffii", &self, &PyList_Type, &listA,
+      &PyList_Type, &listsB, &d0, &d1, &windowSize, &gap_max);
+  APIEnterBlocked(G);
+  auto result = ExecutiveCEAlignBatch(G, listA, listsB, d0, d1, windowSize, gap_max);
+  APIExitBlocked(G);
+  return result;
+}
+
 static PyObject *CmdVolume(PyObject *self, PyObject *args)
 { 
   PyMOLGlobals *G = nullptr;
@@ -6274,6 +6377,7 @@ static PyMethodDef Cmd_methods[] = {
   /*  {"cache",                 CmdCache,                METH_VARARGS }, */
   {"cartoon", CmdCartoon, METH_VARARGS},
   {"cealign", CmdCEAlign, METH_VARARGS},
+  {"cealign_batch", CmdCEAlignBatch, METH_VARARGS},
   {"center", CmdCenter, METH_VARARGS},
   {"cif_get_array", CmdCifGetArray, METH_VARARGS},
   {"clip", CmdClip, METH_VARARGS},
@@ -6340,8 +6444,10 @@ static PyMethodDef Cmd_methods[] = {
   {"get_feedback", CmdGetFeedback, METH_VARARGS},
   {"get_idtf", CmdGetIdtf, METH_VARARGS},
   {"get_legal_name", CmdGetLegalName, METH_VARARGS},
+  {"get_lod_stats", CmdGetLodStats, METH_VARARGS},
   {"get_m2io_first_block_properties", CmdM2ioFirstBlockProperties, METH_VARARGS},
 //  {"get_matrix", CmdGetMatrix, METH_VARARGS},
+  {"get_memory_accounting", CmdGetMemoryAccounting, METH_VARARGS},
   {"get_min_max", CmdGetMinMax, METH_VARARGS},
   {"get_mtl_obj", CmdGetMtlObj, METH_VARARGS},
   {"get_model", CmdGetModel, METH_VARARGS},
@@ -6427,6 +6533,7 @@ static PyMethodDef Cmd_methods[] = {
   {"mdump", CmdMDump, METH_VARARGS},
   {"mem", CmdMem, METH_VARARGS},
   {"memory_available", CmdMemoryAvailable, METH_VARARGS},
+  {"memory_report", CmdMemoryReport, METH_VARARGS},
   {"memory_usage", CmdMemoryUsage, METH_VARARGS},
   {"mmodify", CmdMModify, METH_VARARGS},
   {"move", CmdMove, METH_VARARGS},
@@ -6455,9 +6562,6 @@ static PyMethodDef Cmd_methods[] = {
   {"pbc_unwrap", CmdPBCUnwrap, METH_VARARGS},
   {"pbc_wrap", CmdPBCWrap, METH_VARARGS},
   {"quit", CmdQuit, METH_VARARGS},
-  {"ray_trace_thread", CmdRayTraceThread, METH_VARARGS},
-  {"ray_hash_thread", CmdRayHashThread, METH_VARARGS},
-  {"ray_anti_thread", CmdRayAntiThread, METH_VARARGS},
   {"ramp_new", CmdRampNew, METH_VARARGS},
   {"ready", CmdReady, METH_VARARGS},
   {"rebuild", CmdRebuild, METH_VARARGS},
@@ -6478,6 +6582,8 @@ static PyMethodDef Cmd_methods[] = {
   {"reset_matrix", CmdResetMatrix, METH_VARARGS},
   {"revalence", CmdRevalence, METH_VARARGS},
   {"rock", CmdRock, METH_VARARGS},
+  {"rms_cluster", CmdRMSCluster, METH_VARARGS},
+  {"rms_matrix", CmdRMSMatrix, METH_VARARGS},
   {"runpymol", CmdRunPyMOL, METH_VARARGS},
   {"select", CmdSelect, METH_VARARGS},
   {"select_list", CmdSelectList, METH_VARARGS},
@@ -6528,6 +6634,7 @@ static PyMethodDef Cmd_methods[] = {
   {"test", CmdTest, METH_VARARGS},
   {"test2", CmdTest2, METH_VARARGS},
   {"toggle", CmdToggle, METH_VARARGS},
+  {"trace", CmdTrace, METH_VARARGS},
   {"matrix_copy", CmdMatrixCopy, METH_VARARGS},
   {"transform_object", CmdTransformObject, METH_VARARGS},
   {"transform_selection", CmdTransformSelection, METH_VARARGS},
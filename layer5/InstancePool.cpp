@@ -0,0 +1,174 @@
+/**
+ * @file
+ * Pool of started PyMOL instances for embedding applications
+ */
+
+#include "InstancePool.h"
+
+#include "P.h"
+#include "PyMOL.h"
+
+namespace pymol
+{
+
+InstancePool::Lease& InstancePool::Lease::operator=(Lease&& other) noexcept
+{
+  if (this != &other) {
+    release();
+    m_pool = other.m_pool;
+    m_instance = other.m_instance;
+    other.m_pool = nullptr;
+    other.m_instance = nullptr;
+  }
+  return *this;
+}
+
+void InstancePool::Lease::release()
+{
+  if (m_instance) {
+    m_pool->giveBack(m_instance);
+    m_pool = nullptr;
+    m_instance = nullptr;
+  }
+}
+
+InstancePool::InstancePool(std::size_t capacity, const CPyMOLOptions* options)
+    : m_options(PyMOLOptions_New())
+    , m_capacity(capacity ? capacity : 1)
+{
+  if (options) {
+    *m_options = *options;
+  }
+
+  // headless, like "pymol -c"
+  m_options->pmgui = false;
+  m_options->internal_gui = false;
+  m_options->show_splash = false;
+}
+
+InstancePool::~InstancePool()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  // wait for outstanding leases and instances being started
+  m_cond.wait(lock, [this] { return m_idle.size() == m_started; });
+
+  for (auto instance : m_all) {
+    PyMOL_Stop(instance);
+    PFree(PyMOL_GetGlobals(instance));
+    PyMOL_Free(instance);
+  }
+
+  PyMOLOptions_Free(m_options);
+}
+
+CPyMOL* InstancePool::start()
+{
+  auto instance = PyMOL_NewWithOptions(m_options);
+  if (!instance) {
+    return nullptr;
+  }
+
+  // no-op without Python (see P.h)
+  PInit(PyMOL_GetGlobals(instance), true);
+  PyMOL_Start(instance);
+  return instance;
+}
+
+CPyMOL* InstancePool::takeIdle(std::unique_lock<std::mutex>& lock, bool wait)
+{
+  for (;;) {
+    if (!m_idle.empty()) {
+      auto instance = m_idle.back();
+      m_idle.pop_back();
+      return instance;
+    }
+
+    if (m_started < m_capacity) {
+      ++m_started;
+
+      // starting takes a while, don't block other threads
+      lock.unlock();
+      CPyMOL* instance = nullptr;
+      try {
+        instance = start();
+      } catch (...) {
+        lock.lock();
+        abandonStart();
+        throw;
+      }
+      lock.lock();
+
+      if (!instance) {
+        abandonStart();
+        return nullptr;
+      }
+
+      m_all.push_back(instance);
+      return instance;
+    }
+
+    if (!wait) {
+      return nullptr;
+    }
+
+    m_cond.wait(lock);
+  }
+}
+
+void InstancePool::abandonStart()
+{
+  --m_started;
+
+  // waiting threads may start an instance in the freed slot, the destructor
+  // may be waiting for m_started
+  m_cond.notify_all();
+}
+
+void InstancePool::giveBack(CPyMOL* instance)
+{
+  PyMOL_CmdReinitialize(instance, "everything", "");
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_idle.push_back(instance);
+  }
+
+  // notify all, the destructor may be waiting besides acquire()
+  m_cond.notify_all();
+}
+
+InstancePool::Lease InstancePool::acquire()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  auto instance = takeIdle(lock, true);
+  return instance ? Lease(this, instance) : Lease();
+}
+
+InstancePool::Lease InstancePool::tryAcquire()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  auto instance = takeIdle(lock, false);
+  return instance ? Lease(this, instance) : Lease();
+}
+
+void InstancePool::prestart(std::size_t count)
+{
+  std::vector<Lease> leases;
+
+  for (std::size_t i = 0; i < count; ++i) {
+    auto lease = tryAcquire();
+    if (!lease) {
+      break;
+    }
+    leases.push_back(std::move(lease));
+  }
+}
+
+std::size_t InstancePool::size() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_all.size();
+}
+
+} // namespace pymol
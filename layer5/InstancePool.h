@@ -0,0 +1,125 @@
+/**
+ * @file
+ * Pool of started PyMOL instances for embedding applications
+ *
+ * Starting an instance (settings, lexicons, fonts, colors, ...) costs far more
+ * than loading and rendering a typical structure. A rendering service keeps
+ * a pool of started instances and leases one per request. Returning a lease
+ * reinitializes the instance ("everything"), so every request starts from a
+ * fresh session.
+ *
+ * A lease gives one thread exclusive use of an instance. Using separate
+ * instances concurrently requires that the core keeps no mutable state
+ * outside of PyMOLGlobals. Scene, ray tracing and executive state is per
+ * instance, but the core has not been audited for all remaining static
+ * state, so serialize the calls into the core if in doubt.
+ *
+ * In builds with Python, instances are initialized with PInit and the GIL
+ * must be held while instances are started, returned and freed.
+ *
+ * @verbatim
+   pymol::InstancePool pool(std::thread::hardware_concurrency());
+   // in each worker thread
+   auto lease = pool.acquire();
+   PyMOL_CmdLoad(lease.get(), "1abc.pdb", "filename", "", "", 1, 0, 1, 1, 0, 1);
+   @endverbatim
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "PyMOLOptions.h"
+
+#ifndef CPyMOL_DEFINED
+struct CPyMOL;
+#define CPyMOL_DEFINED
+#endif
+
+namespace pymol
+{
+
+class InstancePool
+{
+public:
+  /**
+   * Exclusive use of one instance, returned to the pool on destruction
+   */
+  class Lease
+  {
+    InstancePool* m_pool = nullptr;
+    CPyMOL* m_instance = nullptr;
+
+    friend class InstancePool;
+    Lease(InstancePool* pool, CPyMOL* instance)
+        : m_pool(pool)
+        , m_instance(instance)
+    {
+    }
+
+  public:
+    Lease() = default;
+    Lease(Lease&& other) noexcept { *this = std::move(other); }
+    Lease& operator=(Lease&& other) noexcept;
+    ~Lease() { release(); }
+
+    CPyMOL* get() const { return m_instance; }
+    explicit operator bool() const { return m_instance; }
+
+    /// Return the instance to the pool early
+    void release();
+  };
+
+  /**
+   * @param capacity Maximum number of instances (at least one)
+   * @param options Options for new instances, defaults if NULL. Splash and
+   * internal GUI are always disabled.
+   */
+  explicit InstancePool(
+      std::size_t capacity, const CPyMOLOptions* options = nullptr);
+  ~InstancePool();
+
+  InstancePool(const InstancePool&) = delete;
+  InstancePool& operator=(const InstancePool&) = delete;
+
+  /**
+   * Lease an idle instance. Starts a new instance if none is idle and the
+   * capacity is not reached, otherwise blocks until one is returned.
+   * Returns an empty lease if starting a new instance failed.
+   */
+  Lease acquire();
+
+  /**
+   * Like acquire() but doesn't block. Returns an empty lease if all
+   * instances are in use or starting a new instance failed.
+   */
+  Lease tryAcquire();
+
+  /// Start instances ahead of the first requests
+  void prestart(std::size_t count);
+
+  std::size_t capacity() const { return m_capacity; }
+
+  /// Number of started instances
+  std::size_t size() const;
+
+private:
+  CPyMOL* start();
+  CPyMOL* takeIdle(std::unique_lock<std::mutex>& lock, bool wait);
+  void abandonStart();
+  void giveBack(CPyMOL* instance);
+
+  CPyMOLOptions* m_options;
+  std::size_t m_capacity;
+  std::size_t m_started = 0; // includes instances being started
+  std::vector<CPyMOL*> m_idle;
+  std::vector<CPyMOL*> m_all;
+  mutable std::mutex m_mutex;
+  std::condition_variable m_cond;
+};
+
+} // namespace pymol
@@ -18,7 +18,9 @@
 #include "os_std.h"
 #include "os_gl.h"
 
+#include <algorithm>
 #include <clocale>
+#include <string>
 
 #include "MemoryDebug.h"
 
@@ -61,6 +63,7 @@
 #include "TypeFace.h"
 #include "PlugIOManager.h"
 #include "MovieScene.h"
+#include "MyPNG.h"
 #include "Lex.h"
 #include "SelectorDef.h"
 #include "ButMode.h"
@@ -787,6 +790,16 @@ PyMOLreturn_status PyMOL_CmdRay(CPyMOL * I, int width, int height, int antialias
   PYMOL_API_UNLOCK return result;
 }
 
+PyMOLreturn_status PyMOL_CmdPNG(CPyMOL * I, const char *filename, float dpi,
+                                int quiet)
+{
+  PyMOLreturn_status result = { PyMOLstatus_FAILURE };
+  PYMOL_API_LOCK
+    result.status = get_status_ok(
+        ScenePNG(I->G, filename, dpi, quiet, true, cMyPNG_FormatPNG));
+  PYMOL_API_UNLOCK return result;
+}
+
 PyMOLreturn_status PyMOL_CmdSetView(CPyMOL * I, float *view, int view_len,
                                     float animate, int quiet)
 {
@@ -1509,6 +1522,7 @@ struct {
   {"vdb",           cLoadTypeVDBStr,    cLoadTypeUnknown},
   {"cif",           cLoadTypeCIFStr,    cLoadTypeCIF},
   {"mmtf",          cLoadTypeMMTFStr,   cLoadTypeMMTF},
+  {"bcif",          cLoadTypeBCIFStr,   cLoadTypeBCIF},
   {"mae",           cLoadTypeMAEStr,    cLoadTypeMAE},
   {"sdf",           cLoadTypeSDF2Str,   cLoadTypeSDF2},
   {"mol",           cLoadTypeMOLStr,    cLoadTypeMOL},
@@ -1528,6 +1542,81 @@ struct {
   {NULL,            cLoadTypeUnknown,   cLoadTypeUnknown}
 };
 
+/**
+ * File name extensions which differ from the ContentTypeTable name
+ * (same aliases as importing.filename_to_format)
+ */
+struct {
+  const char * ext;
+  const char * name;
+} const ContentExtensionTable[] = {
+  {"ent",           "pdb"},
+  {"p5m",           "pdb"},
+  {"mmcif",         "cif"},
+  {"sd",            "sdf"},
+  {"mmd",           "macromodel"},
+  {"out",           "macromodel"},
+  {"dat",           "macromodel"},
+  {"dxbin",         "dx"},
+  {NULL,            NULL}
+};
+
+// C++ API, this file is otherwise extern "C"
+extern "C++" {
+namespace pymol
+{
+std::string ContentFormatFromFilename(const char * filename)
+{
+  const char * ext = strrchr(filename, '.');
+  if (!ext || strpbrk(ext, "/\\:"))
+    return "";
+
+  std::string format(ext + 1);
+  for (auto& c : format)
+    c = tolower(c);
+
+  for (auto it = ContentExtensionTable; it->ext; ++it) {
+    if (format == it->ext)
+      return it->name;
+  }
+
+  auto is_numbered = [&format](const char * prefix) {
+    auto n = strlen(prefix);
+    return format.size() > n && format.compare(0, n, prefix) == 0 &&
+           std::all_of(format.begin() + n, format.end(), isdigit);
+  };
+
+  if (is_numbered("pdb"))
+    return "pdb";
+  if (is_numbered("xyz_"))
+    return "xyz";
+
+  return format;
+}
+
+cLoadType_t ContentLoadType(PyMOLGlobals * G, const char * content_format,
+                            bool content_is_filename, const char ** plugin)
+{
+  *plugin = nullptr;
+
+  for (auto it = ContentTypeTable; it->name; ++it) {
+    if (strcmp(it->name, content_format) == 0) {
+      return content_is_filename ? it->code_filename : it->code_buffer;
+    }
+  }
+
+  // formats without a native reader, e.g. "gro" or "dcd"
+  if (content_is_filename && content_format[0]) {
+    *plugin = PlugIOManagerFindPluginByExt(G, content_format);
+    if (*plugin)
+      return cLoadTypePlugin;
+  }
+
+  return cLoadTypeUnknown;
+}
+} // namespace pymol
+}
+
 /**
  * Proxy for "ExecutiveLoad" with string "content_format" (and "content_type")
  * argument.
@@ -1537,6 +1626,8 @@ struct {
  * content_length:      Length of "content", if it's not a file name or a
  *                      null-terminated string (pass -1).
  * content_format:      The file format, e.g. "pdb", "sdf", "mol2", ...
+ *                      Empty or "auto" to derive it from the file name
+ *                      extension (only if "content_type" is "filename").
  * object_name:         New object name. Can be empty if "content_type" is
  *                      "filename".
  */
@@ -1598,16 +1689,18 @@ static PyMOLreturn_status Loader(CPyMOL * I, const char *content, const char *co
       }
     }
     {
-      cLoadType_t pymol_content_type = cLoadTypeUnknown;
+      const char * plugin = nullptr;
+      std::string format_from_ext;
 
-      for (auto it = ContentTypeTable; it->name; ++it) {
-        if (strcmp(it->name, content_format) == 0) {
-          pymol_content_type = content_is_filename ?
-            it->code_filename : it->code_buffer;
-          break;
-        }
+      if (content_is_filename &&
+          (!content_format[0] || strcmp(content_format, "auto") == 0)) {
+        format_from_ext = pymol::ContentFormatFromFilename(content);
+        content_format = format_from_ext.c_str();
       }
 
+      auto pymol_content_type = pymol::ContentLoadType(
+          G, content_format, content_is_filename, &plugin);
+
       if (pymol_content_type == cLoadTypeUnknown) {
         PRINTFB(G, FB_Executive, FB_Errors)
           " Error: Unknown content format '%s' with type '%s'\n",
@@ -1622,7 +1715,7 @@ static PyMOLreturn_status Loader(CPyMOL * I, const char *content, const char *co
                            content_length,
                            pymol_content_type,
                            object_name,
-                           state - 1, zoom, discrete, finish, multiplex, quiet, nullptr, 0, nullptr);
+                           state - 1, zoom, discrete, finish, multiplex, quiet, plugin, 0, nullptr);
         ok = static_cast<bool>(result);
       }
     }
@@ -47,6 +47,7 @@ Z* -------------------------------------------------------------------
  * You have been warned!
  */
 
+#include "ov_types.h"
 #include "OVreturns.h"
 
 #ifdef __cplusplus
@@ -515,6 +516,11 @@ PyMOLreturn_status PyMOL_CmdRay(CPyMOL * I, int width, int height, int antialias
                                 float angle, float shift, int renderer, int defer,
                                 int quiet);
 
+/* save the last rendered image (e.g. from PyMOL_CmdRay) to a PNG file,
+   dpi < 0 uses the "image_dots_per_inch" setting */
+PyMOLreturn_status PyMOL_CmdPNG(CPyMOL * I, const char *filename, float dpi,
+                                int quiet);
+
 PyMOLreturn_status PyMOL_CmdIsodot(CPyMOL * I, const char *name, const char *map_name, float level,
                                    const char *selection, float buffer, int state, float carve,
                                    int source_state, int quiet);
@@ -593,5 +599,30 @@ AtomPropertyInfo *PyMOL_GetAtomPropertyInfo(CPyMOL * I, const char *atompropname
 
 #ifdef __cplusplus
 }
+
+#include <string>
+
+enum cLoadType_t : int;
+
+namespace pymol
+{
+/**
+ * Content format for a file name: the lower case extension, mapped through
+ * ContentExtensionTable. Numbered PDB (.pdb1) and XYZ (.xyz_1) extensions
+ * are recognized. Extensions which are not in ContentTypeTable are returned
+ * as-is and may still match a molfile plugin.
+ */
+std::string ContentFormatFromFilename(const char* filename);
+
+/**
+ * Load type for a content format (ContentTypeTable). File formats without a
+ * native reader fall back to a molfile plugin.
+ *
+ * @param[out] plugin Plugin name for cLoadTypePlugin, otherwise NULL
+ * @return cLoadTypeUnknown if the format is not supported
+ */
+cLoadType_t ContentLoadType(struct PyMOLGlobals* G, const char* content_format,
+    bool content_is_filename, const char** plugin);
+} // namespace pymol
 #endif
 #endif
@@ -0,0 +1,464 @@
+/**
+ * @file
+ * Benchmark runner for core kernels, writes machine readable JSON
+ *
+ * Usage: pymol_bench [--list] [--filter <substring>] [--json <file>]
+ *                    [--min-time <seconds>] [--bcif <file>]
+ */
+
+#include "Bench.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <thread>
+
+#include "Executive.h"
+#include "ObjectMolecule.h"
+#include "PyMOL.h"
+#include "PyMOLGlobals.h"
+#include "PyMOLOptions.h"
+#include "Version.h"
+
+namespace pymol
+{
+namespace bench
+{
+
+namespace
+{
+struct Case {
+  std::string name;
+  std::string group;
+  BenchFn fn;
+  long arg;
+};
+
+std::vector<Case>& registry()
+{
+  static std::vector<Case> cases;
+  return cases;
+}
+
+const char* s_bcif_filename = nullptr;
+
+void write_json_string(FILE* f, const char* s)
+{
+  fputc('"', f);
+  for (; *s; ++s) {
+    auto c = static_cast<unsigned char>(*s);
+    if (c == '"' || c == '\\') {
+      fputc('\\', f);
+      fputc(c, f);
+    } else if (c < 0x20) {
+      fprintf(f, "\\u%04x", c);
+    } else {
+      fputc(c, f);
+    }
+  }
+  fputc('"', f);
+}
+
+struct SynthAtom {
+  const char* name;
+  const char* elem;
+  const char* resn;
+  char chain;
+  int resv;
+  float xyz[3];
+};
+
+/**
+ * Residues of 5 atoms on a cubic lattice with 3.8 Angstrom spacing, so the
+ * density is roughly that of a folded protein.
+ */
+std::vector<SynthAtom> MakeAtoms(int n_atoms)
+{
+  static const char* resns[] = {
+      "ALA", "GLY", "SER", "LEU", "LYS", "GLU", "ASP", "VAL"};
+  static const struct {
+    const char* name;
+    const char* elem;
+    float offset[3];
+  } templ[] = {
+      {"N", "N", {-1.2f, 0.3f, 0.f}},
+      {"CA", "C", {0.f, 0.f, 0.f}},
+      {"C", "C", {1.2f, 0.3f, 0.f}},
+      {"O", "O", {1.6f, 1.4f, 0.f}},
+      {"CB", "C", {0.f, -0.9f, 1.2f}},
+  };
+
+  int const n_res = (n_atoms + 4) / 5;
+  int const side = std::max(1, int(std::ceil(std::cbrt(double(n_res)))));
+
+  std::vector<SynthAtom> atoms;
+  atoms.reserve(n_atoms);
+
+  for (int r = 0; int(atoms.size()) < n_atoms; ++r) {
+    int x = r % side;
+    int y = (r / side) % side;
+    int z = r / (side * side);
+    // snake through the lattice to keep consecutive residues adjacent
+    if (y % 2)
+      x = side - 1 - x;
+    if (z % 2)
+      y = side - 1 - y;
+
+    for (auto const& t : templ) {
+      if (int(atoms.size()) == n_atoms)
+        break;
+      SynthAtom atom;
+      atom.name = t.name;
+      atom.elem = t.elem;
+      atom.resn = resns[r % 8];
+      atom.chain = char('A' + (r / 1000) % 26);
+      atom.resv = r % 1000 + 1;
+      atom.xyz[0] = x * 3.8f + t.offset[0];
+      atom.xyz[1] = y * 3.8f + t.offset[1];
+      atom.xyz[2] = z * 3.8f + t.offset[2];
+      atoms.push_back(atom);
+    }
+  }
+
+  return atoms;
+}
+} // namespace
+
+struct Runner {
+  static void run(Case const& c, State& state)
+  {
+    c.fn(state);
+    if (state.m_skipped.empty() && state.m_samples.empty()) {
+      state.skip("no timed iterations");
+    }
+  }
+
+  static bool finished(State const& state)
+  {
+    return state.m_samples.size() >= state.m_max_iterations ||
+           (state.m_samples.size() >= state.m_min_iterations &&
+               std::chrono::duration<double>(State::clock::now() -
+                                             state.m_begin)
+                       .count() >= state.m_min_time);
+  }
+
+  static void write(FILE* f, Case const& c, State const& state, bool last)
+  {
+    fputs("    {\"name\": ", f);
+    write_json_string(f, c.name.c_str());
+    fputs(", \"group\": ", f);
+    write_json_string(f, c.group.c_str());
+    fprintf(f, ", \"arg\": %ld", c.arg);
+
+    if (!state.m_skipped.empty()) {
+      fputs(", \"skipped\": ", f);
+      write_json_string(f, state.m_skipped.c_str());
+      fputs(last ? "}\n" : "},\n", f);
+      return;
+    }
+
+    auto samples = state.m_samples;
+    std::sort(samples.begin(), samples.end());
+    auto const n = samples.size();
+    double mean = 0;
+    for (auto s : samples)
+      mean += s;
+    mean /= n;
+    double var = 0;
+    for (auto s : samples)
+      var += (s - mean) * (s - mean);
+    double const stddev = n > 1 ? std::sqrt(var / (n - 1)) : 0.0;
+    double const median =
+        n % 2 ? samples[n / 2] : 0.5 * (samples[n / 2 - 1] + samples[n / 2]);
+
+    fprintf(f,
+        ", \"iterations\": %zu, \"min_ns\": %.1f, \"median_ns\": %.1f"
+        ", \"mean_ns\": %.1f, \"stddev_ns\": %.1f",
+        n, samples.front(), median, mean, stddev);
+
+    if (state.m_items > 0) {
+      fprintf(f, ", \"items_per_second\": %.6g", state.m_items * 1e9 / median);
+    }
+
+    if (!state.m_counters.empty()) {
+      fputs(", \"counters\": {", f);
+      for (std::size_t i = 0; i < state.m_counters.size(); ++i) {
+        if (i)
+          fputs(", ", f);
+        write_json_string(f, state.m_counters[i].first.c_str());
+        fprintf(f, ": %.17g", state.m_counters[i].second);
+      }
+      fputc('}', f);
+    }
+
+    fputs(last ? "}\n" : "},\n", f);
+  }
+
+  static void print(Case const& c, State const& state)
+  {
+    if (!state.m_skipped.empty()) {
+      printf("%-40s skipped: %s\n", c.name.c_str(), state.m_skipped.c_str());
+      return;
+    }
+    auto samples = state.m_samples;
+    std::sort(samples.begin(), samples.end());
+    printf("%-40s %12.3f ms (min %.3f ms, %zu iterations)\n", c.name.c_str(),
+        samples[samples.size() / 2] * 1e-6, samples.front() * 1e-6,
+        samples.size());
+  }
+};
+
+bool State::keepRunning()
+{
+  auto const now = clock::now();
+
+  if (!m_skipped.empty()) {
+    return false;
+  }
+
+  if (!m_started) {
+    m_started = true;
+  } else if (m_warmup) {
+    m_warmup = false;
+    m_begin = now;
+  } else {
+    m_samples.push_back(
+        std::chrono::duration<double, std::nano>(now - m_start - m_paused)
+            .count());
+    if (Runner::finished(*this)) {
+      return false;
+    }
+  }
+
+  m_paused = {};
+  m_start = clock::now();
+  return true;
+}
+
+Registration::Registration(const char* name, const char* group, BenchFn fn,
+    std::initializer_list<long> args)
+{
+  if (args.size() == 0) {
+    registry().push_back({name, group, fn, 0});
+    return;
+  }
+  for (auto arg : args) {
+    registry().push_back(
+        {std::string(name) + "/" + std::to_string(arg), group, fn, arg});
+  }
+}
+
+const char* BcifFilename()
+{
+  return s_bcif_filename;
+}
+
+std::vector<float> MakePoints(int n, float box)
+{
+  std::vector<float> vert(3 * n);
+  unsigned seed = 12345;
+  for (auto& v : vert) {
+    seed = seed * 1103515245u + 12345u;
+    v = ((seed >> 8) % 100000) * 1e-5f * box;
+  }
+  return vert;
+}
+
+std::string MakePDBString(int n_atoms)
+{
+  std::string pdb;
+  char line[96];
+  int serial = 0;
+  for (auto const& atom : MakeAtoms(n_atoms)) {
+    snprintf(line, sizeof(line),
+        "ATOM  %5d  %-3s %3s %c%4d    %8.3f%8.3f%8.3f  1.00  0.00          "
+        "%2s\n",
+        ++serial % 100000, atom.name, atom.resn, atom.chain, atom.resv,
+        atom.xyz[0], atom.xyz[1], atom.xyz[2], atom.elem);
+    pdb += line;
+  }
+  pdb += "END\n";
+  return pdb;
+}
+
+std::string MakeCIFString(int n_atoms)
+{
+  std::string cif = "data_bench\n"
+                    "loop_\n"
+                    "_atom_site.group_PDB\n"
+                    "_atom_site.id\n"
+                    "_atom_site.type_symbol\n"
+                    "_atom_site.label_atom_id\n"
+                    "_atom_site.label_comp_id\n"
+                    "_atom_site.label_asym_id\n"
+                    "_atom_site.label_seq_id\n"
+                    "_atom_site.Cartn_x\n"
+                    "_atom_site.Cartn_y\n"
+                    "_atom_site.Cartn_z\n"
+                    "_atom_site.occupancy\n"
+                    "_atom_site.B_iso_or_equiv\n";
+  char line[128];
+  int serial = 0;
+  for (auto const& atom : MakeAtoms(n_atoms)) {
+    snprintf(line, sizeof(line), "ATOM %d %s %s %s %c %d %.3f %.3f %.3f 1.00 0.00\n",
+        ++serial, atom.elem, atom.name, atom.resn, atom.chain, atom.resv,
+        atom.xyz[0], atom.xyz[1], atom.xyz[2]);
+    cif += line;
+  }
+  return cif;
+}
+
+ObjectMolecule* LoadSynthetic(PyMOLGlobals* G, const char* name, int n_atoms)
+{
+  auto const pdb = MakePDBString(n_atoms);
+  auto result = ExecutiveLoad(G, nullptr, pdb.c_str(), pdb.size(),
+      cLoadTypePDBStr, name, -1, 0, 0, 1, 0, 1, nullptr);
+  if (!result) {
+    return nullptr;
+  }
+  return ExecutiveFindObject<ObjectMolecule>(G, name);
+}
+
+} // namespace bench
+} // namespace pymol
+
+using namespace pymol::bench;
+
+static void Usage()
+{
+  fputs("usage: pymol_bench [--list] [--filter <substring>] [--json <file>]\n"
+        "                   [--min-time <seconds>] [--bcif <file>]\n",
+      stderr);
+}
+
+static void WriteContext(FILE* f)
+{
+  char date[64] = "";
+  std::time_t now = std::time(nullptr);
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+
+  fputs("  \"context\": {\"date\": ", f);
+  write_json_string(f, date);
+  fputs(", \"pymol_version\": ", f);
+  write_json_string(f, _PyMOL_VERSION);
+#if defined(__VERSION__)
+  fputs(", \"compiler\": ", f);
+  write_json_string(f, __VERSION__);
+#elif defined(_MSC_VER)
+  fprintf(f, ", \"compiler\": \"MSVC %d\"", _MSC_VER);
+#endif
+#ifdef NDEBUG
+  fputs(", \"build_type\": \"release\"", f);
+#else
+  fputs(", \"build_type\": \"debug\"", f);
+#endif
+#ifdef PYMOL_OPENMP
+  fputs(", \"openmp\": true", f);
+#else
+  fputs(", \"openmp\": false", f);
+#endif
+  fprintf(f, ", \"hardware_threads\": %u},\n",
+      std::thread::hardware_concurrency());
+}
+
+/**
+ * Headless instance of the Python-free core (_PYMOL_NOPY), no interpreter
+ * is involved in the timings
+ */
+static CPyMOL* StartPyMOL()
+{
+  auto options = PyMOLOptions_New();
+  options->pmgui = false;
+  options->internal_gui = false;
+  options->show_splash = false;
+  options->quiet = true;
+  auto inst = PyMOL_NewWithOptions(options);
+  PyMOLOptions_Free(options);
+
+  PyMOL_Start(inst);
+  return inst;
+}
+
+static void StopPyMOL(CPyMOL* inst)
+{
+  PyMOL_Stop(inst);
+  PyMOL_Free(inst);
+}
+
+int main(int argc, char* argv[])
+{
+  const char* filter = nullptr;
+  const char* json_filename = nullptr;
+  double min_time = 0.5;
+  bool list = false;
+
+  for (int i = 1; i < argc; ++i) {
+    bool const has_value = i + 1 < argc;
+    if (!strcmp(argv[i], "--list")) {
+      list = true;
+    } else if (!strcmp(argv[i], "--filter") && has_value) {
+      filter = argv[++i];
+    } else if (!strcmp(argv[i], "--json") && has_value) {
+      json_filename = argv[++i];
+    } else if (!strcmp(argv[i], "--min-time") && has_value) {
+      min_time = atof(argv[++i]);
+    } else if (!strcmp(argv[i], "--bcif") && has_value) {
+      s_bcif_filename = argv[++i];
+    } else {
+      Usage();
+      return 2;
+    }
+  }
+
+  std::vector<Case const*> selected;
+  for (auto const& c : registry()) {
+    if (!filter || c.name.find(filter) != std::string::npos) {
+      selected.push_back(&c);
+    }
+  }
+
+  if (list) {
+    for (auto c : selected) {
+      printf("%s\n", c->name.c_str());
+    }
+    return 0;
+  }
+
+  FILE* json = nullptr;
+  if (json_filename) {
+    json = fopen(json_filename, "wb");
+    if (!json) {
+      fprintf(stderr, "pymol_bench: can't write %s\n", json_filename);
+      return 1;
+    }
+    fputs("{\n", json);
+    WriteContext(json);
+    fputs("  \"benchmarks\": [\n", json);
+  }
+
+  auto inst = StartPyMOL();
+  auto G = PyMOL_GetGlobals(inst);
+
+  for (std::size_t i = 0; i < selected.size(); ++i) {
+    auto const& c = *selected[i];
+    State state(G, c.arg, min_time, 5, 1000000);
+    Runner::run(c, state);
+    Runner::print(c, state);
+    if (json) {
+      Runner::write(json, c, state, i + 1 == selected.size());
+      fflush(json);
+    }
+  }
+
+  StopPyMOL(inst);
+
+  if (json) {
+    fputs("  ]\n}\n", json);
+    fclose(json);
+  }
+
+  return 0;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file
+ * Minimal benchmark harness for core kernels (see Bench.cpp for the runner)
+ *
+ * A benchmark is registered with BENCHMARK_CASE and times the body of its
+ * `while (state.keepRunning())` loop. Everything before the loop is setup
+ * and is not timed.
+ *
+ * @verbatim
+   BENCHMARK_CASE("MapNew", "Map", 1000, 100000)
+   {
+     auto vert = pymol::bench::MakePoints(state.arg());
+     while (state.keepRunning()) {
+       ...
+     }
+   }
+   @endverbatim
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct PyMOLGlobals;
+class ObjectMolecule;
+
+namespace pymol
+{
+namespace bench
+{
+
+class State
+{
+  using clock = std::chrono::steady_clock;
+
+  PyMOLGlobals* m_G;
+  long m_arg;
+  double m_min_time;
+  std::size_t m_min_iterations;
+  std::size_t m_max_iterations;
+
+  bool m_started = false;
+  bool m_warmup = true;
+  clock::time_point m_begin;
+  clock::time_point m_start;
+  clock::duration m_paused{};
+  clock::time_point m_pause_start;
+
+  std::vector<double> m_samples; // ns per iteration
+  double m_items = 0;
+  std::string m_skipped;
+  std::vector<std::pair<std::string, double>> m_counters;
+
+  friend struct Runner;
+
+public:
+  State(PyMOLGlobals* G, long arg, double min_time, std::size_t min_iterations,
+      std::size_t max_iterations)
+      : m_G(G)
+      , m_arg(arg)
+      , m_min_time(min_time)
+      , m_min_iterations(min_iterations)
+      , m_max_iterations(max_iterations)
+  {
+  }
+
+  PyMOLGlobals* G() const { return m_G; }
+
+  /// Size parameter of this instance (0 if the case has no sizes)
+  long arg() const { return m_arg; }
+
+  /**
+   * Loop condition of the timed section. The first iteration is a warm-up
+   * and is not recorded.
+   */
+  bool keepRunning();
+
+  /// Exclude the following code from the current iteration (e.g. cleanup)
+  void pause() { m_pause_start = clock::now(); }
+  void resume() { m_paused += clock::now() - m_pause_start; }
+
+  /// Number of items (atoms, points, ...) processed by one iteration
+  void setItemsPerIteration(double items) { m_items = items; }
+
+  /// Additional value to report, e.g. the size of the output
+  void counter(const char* name, double value)
+  {
+    m_counters.emplace_back(name, value);
+  }
+
+  /// Don't run this benchmark, e.g. if the build lacks a feature
+  void skip(std::string reason) { m_skipped = std::move(reason); }
+};
+
+/// Keep the compiler from optimizing away a computed value
+template <typename T> inline void doNotOptimize(T const& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile char sink;
+  sink = *reinterpret_cast<const volatile char*>(&value);
+#endif
+}
+
+using BenchFn = void (*)(State&);
+
+struct Registration {
+  Registration(const char* name, const char* group, BenchFn fn,
+      std::initializer_list<long> args = {});
+};
+
+/// Optional file given with --bcif
+const char* BcifFilename();
+
+/// Deterministic scatter of `n` points in a cubic box
+std::vector<float> MakePoints(int n, float box = 50.f);
+
+/// Synthetic protein-like PDB of `n_atoms` atoms (5 atoms per residue)
+std::string MakePDBString(int n_atoms);
+
+/// Same atoms as MakePDBString() as mmCIF `atom_site` table
+std::string MakeCIFString(int n_atoms);
+
+/// Load MakePDBString(n_atoms) as object `name`
+ObjectMolecule* LoadSynthetic(PyMOLGlobals* G, const char* name, int n_atoms);
+
+} // namespace bench
+} // namespace pymol
+
+#define PYMOL_BENCH_CAT2(a, b) a##b
+#define PYMOL_BENCH_CAT(a, b) PYMOL_BENCH_CAT2(a, b)
+
+#define PYMOL_BENCH_CASE_IMPL(fn, name, group, ...)                            \
+  static void fn(pymol::bench::State&);                                        \
+  static pymol::bench::Registration PYMOL_BENCH_CAT(fn, _reg)(                 \
+      name, group, fn, {__VA_ARGS__});                                         \
+  static void fn(pymol::bench::State& state)
+
+/**
+ * Register a benchmark, optionally once for each of the given sizes
+ * (available as state.arg())
+ */
+#define BENCHMARK_CASE(name, group, ...)                                       \
+  PYMOL_BENCH_CASE_IMPL(PYMOL_BENCH_CAT(_pymol_bench_, __LINE__), name,        \
+      group, __VA_ARGS__)
@@ -0,0 +1,92 @@
+#include "Bench.h"
+
+#include "CGO.h"
+#include "PyMOLGlobals.h"
+#include "ShaderMgr.h"
+
+using namespace pymol::bench;
+
+/// Triangles of random points wrapped in begin/end blocks of 99 vertices
+static CGO* MakeTriangleCGO(PyMOLGlobals* G, int n_tri)
+{
+  auto const vert = MakePoints(3 * n_tri, 30.f);
+  float const normal[3] = {0.f, 0.f, 1.f};
+
+  auto cgo = CGONew(G);
+  for (int i = 0; i < 3 * n_tri; ++i) {
+    if (i % 99 == 0) {
+      if (i)
+        CGOEnd(cgo);
+      CGOBegin(cgo, GL_TRIANGLES);
+    }
+    CGOColor(cgo, (i % 3) * 0.5f, 0.5f, 1.f);
+    CGONormalv(cgo, normal);
+    CGOVertexv(cgo, vert.data() + 3 * i);
+  }
+  CGOEnd(cgo);
+  CGOStop(cgo);
+  return cgo;
+}
+
+BENCHMARK_CASE("CGOCombineBeginEnd", "CGO", 10000, 100000)
+{
+  int const n = state.arg();
+  auto cgo = MakeTriangleCGO(state.G(), n);
+  state.setItemsPerIteration(n);
+
+  while (state.keepRunning()) {
+    auto combined = CGOCombineBeginEnd(cgo);
+    state.pause();
+    CGOFree(combined);
+    state.resume();
+  }
+
+  CGOFree(cgo);
+}
+
+/**
+ * CPU side of CGOOptimizeToVBONotIndexed: packing the combined triangles into
+ * the vertex arrays. Runs without a GL context.
+ */
+BENCHMARK_CASE("CGOGetTriangleArraysNotIndexed", "CGO", 10000, 100000)
+{
+  int const n = state.arg();
+  auto cgo = MakeTriangleCGO(state.G(), n);
+  auto combined = CGOCombineBeginEnd(cgo);
+  CGOFree(cgo);
+  state.setItemsPerIteration(n);
+
+  while (state.keepRunning()) {
+    CGOTriangleArrays arrays;
+    CGOGetTriangleArraysNotIndexed(combined, arrays);
+    doNotOptimize(arrays.data.data());
+    state.pause();
+    arrays = {};
+    state.resume();
+  }
+
+  CGOFree(combined);
+}
+
+BENCHMARK_CASE("CGOOptimizeToVBONotIndexed", "CGO", 10000, 100000)
+{
+  auto G = state.G();
+  if (!G->ShaderMgr || !G->ShaderMgr->IsConfigured()) {
+    state.skip("no OpenGL context (CPU side packing is timed by "
+               "CGOGetTriangleArraysNotIndexed)");
+    return;
+  }
+
+  int const n = state.arg();
+  auto cgo = MakeTriangleCGO(G, n);
+  state.setItemsPerIteration(n);
+
+  while (state.keepRunning()) {
+    auto optimized = CGOOptimizeToVBONotIndexed(cgo);
+    state.pause();
+    CGOFree(optimized);
+    state.resume();
+  }
+
+  CGOFree(cgo);
+}
@@ -0,0 +1,53 @@
+#include "Bench.h"
+
+#include <exception>
+#include <string>
+
+#include "CifFile.h"
+#include "FileStream.h"
+
+using namespace pymol::bench;
+
+BENCHMARK_CASE("cif_file::parse", "CifFile", 10000, 100000)
+{
+  int const n = state.arg();
+  auto const cif = MakeCIFString(n);
+
+  state.setItemsPerIteration(n);
+  state.counter("bytes", cif.size());
+
+  while (state.keepRunning()) {
+    pymol::cif_file cf;
+    cf.parse_string(cif.c_str());
+    doNotOptimize(cf.datablocks().size());
+  }
+}
+
+BENCHMARK_CASE("cif_file::parse_bcif", "CifFile")
+{
+#if defined(_PYMOL_NO_MSGPACKC)
+  state.skip("built without msgpack-c");
+#else
+  auto filename = BcifFilename();
+  if (!filename) {
+    state.skip("no --bcif file given");
+    return;
+  }
+
+  std::string contents;
+  try {
+    contents = pymol::file_get_contents(filename);
+  } catch (const std::exception& e) {
+    state.skip(e.what());
+    return;
+  }
+
+  state.counter("bytes", contents.size());
+
+  while (state.keepRunning()) {
+    pymol::cif_file cf;
+    cf.parse_bcif(contents.data(), contents.size());
+    doNotOptimize(cf.datablocks().size());
+  }
+#endif
+}
@@ -0,0 +1,66 @@
+#include "Bench.h"
+
+#include <cmath>
+
+#include "Isosurf.h"
+
+using namespace pymol::bench;
+
+/**
+ * Isofield of edge length `dim` with a sum of gaussian blobs, spacing of
+ * 0.5 Angstrom
+ */
+static Isofield MakeBlobField(PyMOLGlobals* G, int dim)
+{
+  int const dims[3] = {dim, dim, dim};
+  Isofield field(G, dims);
+
+  auto const centers = MakePoints(32, dim * 0.5f);
+
+  for (int i = 0; i < dim; ++i) {
+    for (int j = 0; j < dim; ++j) {
+      for (int k = 0; k < dim; ++k) {
+        float const xyz[3] = {i * 0.5f, j * 0.5f, k * 0.5f};
+        float value = 0.f;
+        for (int c = 0; c < 32; ++c) {
+          float d2 = 0.f;
+          for (int d = 0; d < 3; ++d) {
+            float const diff = xyz[d] - centers[3 * c + d];
+            d2 += diff * diff;
+          }
+          value += std::exp(-0.5f * d2);
+        }
+        field.data->get<float>(i, j, k) = value;
+        for (int d = 0; d < 3; ++d) {
+          field.points->get<float>(i, j, k, d) = xyz[d];
+        }
+      }
+    }
+  }
+
+  return field;
+}
+
+BENCHMARK_CASE("IsosurfVolume", "Isosurf", 32, 64, 128)
+{
+  auto G = state.G();
+  int const dim = state.arg();
+  auto field = MakeBlobField(G, dim);
+
+  pymol::vla<int> num(1000);
+  pymol::vla<float> vert(1000);
+
+  state.setItemsPerIteration(double(dim) * dim * dim);
+
+  while (state.keepRunning()) {
+    IsosurfVolume(G, nullptr, nullptr, &field, 0.5f, num, vert, nullptr,
+        cIsomeshMode::isomesh, 1, 0.f);
+  }
+
+  // num is a zero terminated list of line strip lengths
+  int n_vert = 0;
+  for (std::size_t i = 0; i < num.size() && num[i]; ++i) {
+    n_vert += num[i];
+  }
+  state.counter("vertices", n_vert);
+}
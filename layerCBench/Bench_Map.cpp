@@ -0,0 +1,36 @@
+#include "Bench.h"
+
+#include <memory>
+
+#include "Map.h"
+
+using namespace pymol::bench;
+
+BENCHMARK_CASE("MapNew", "Map", 1000, 10000, 100000)
+{
+  int const n = state.arg();
+  auto const vert = MakePoints(n);
+  state.setItemsPerIteration(n);
+
+  while (state.keepRunning()) {
+    std::unique_ptr<MapType> map(MapNew(state.G(), 3.f, vert.data(), n));
+    doNotOptimize(map.get());
+  }
+}
+
+BENCHMARK_CASE("MapSetupExpress", "Map", 1000, 10000, 100000)
+{
+  int const n = state.arg();
+  auto const vert = MakePoints(n);
+  state.setItemsPerIteration(n);
+
+  while (state.keepRunning()) {
+    state.pause();
+    std::unique_ptr<MapType> map(MapNew(state.G(), 3.f, vert.data(), n));
+    state.resume();
+    MapSetupExpress(map.get());
+    state.pause();
+    map.reset();
+    state.resume();
+  }
+}
@@ -0,0 +1,32 @@
+#include "Bench.h"
+
+#include <cmath>
+
+#include "Matrix.h"
+
+using namespace pymol::bench;
+
+BENCHMARK_CASE("MatrixFitRMSTTTf", "Matrix", 100, 1000, 100000)
+{
+  int const n = state.arg();
+  auto const v1 = MakePoints(n);
+  auto v2 = v1;
+
+  // rotate around z and translate
+  float const c = std::cos(0.3f), s = std::sin(0.3f);
+  for (int i = 0; i < n; ++i) {
+    float* v = v2.data() + 3 * i;
+    float const x = v[0], y = v[1];
+    v[0] = c * x - s * y + 1.f;
+    v[1] = s * x + c * y - 2.f;
+    v[2] += 0.5f;
+  }
+
+  float ttt[16];
+  state.setItemsPerIteration(n);
+
+  while (state.keepRunning()) {
+    auto rms = MatrixFitRMSTTTf(state.G(), n, v1.data(), v2.data(), nullptr, ttt);
+    doNotOptimize(rms);
+  }
+}
@@ -0,0 +1,70 @@
+#include "Bench.h"
+
+#include <vector>
+
+#include "Ray.h"
+#include "Vector.h"
+
+using namespace pymol::bench;
+
+enum class Prim { sphere, sausage };
+
+/**
+ * Ray trace `state.arg()` primitives in a 30 Angstrom box at 640x480,
+ * orthoscopic, without antialiasing. Building the primitive list is not
+ * timed.
+ */
+static void BenchRayRender(State& state, Prim prim)
+{
+  auto G = state.G();
+  int const n = state.arg();
+  int const width = 640, height = 480;
+
+  auto const vert = MakePoints(n + 1, 30.f);
+  std::vector<unsigned int> image(width * height);
+
+  float modelview[16];
+  identity44f(modelview);
+  modelview[12] = -15.f;
+  modelview[13] = -15.f;
+  modelview[14] = -80.f;
+
+  float const color1[3] = {0.2f, 0.6f, 1.f};
+  float const color2[3] = {1.f, 0.5f, 0.2f};
+
+  state.setItemsPerIteration(double(width) * height);
+
+  while (state.keepRunning()) {
+    state.pause();
+    auto ray = RayNew(G, 0);
+    RayPrepare(ray, -20.f, 20.f, -15.f, 15.f, 40.f, 120.f, 20.f,
+        glm::vec3(0.f, 0.f, -80.f), modelview, glm::mat4(1.f),
+        float(width) / height, width, height, 1.f, true, 1.f, 1.f, 1.f);
+    ray->color3fv(color1);
+    for (int i = 0; i < n; ++i) {
+      const float* v = vert.data() + 3 * i;
+      if (prim == Prim::sphere) {
+        ray->sphere3fv(v, 1.5f);
+      } else {
+        ray->sausage3fv(v, v + 3, 0.25f, color1, color2);
+      }
+    }
+    state.resume();
+
+    RayRender(ray, image.data(), 0.0, 0.f, 0, nullptr);
+
+    state.pause();
+    RayFree(ray);
+    state.resume();
+  }
+}
+
+BENCHMARK_CASE("RayRender.spheres", "Ray", 1000, 10000, 100000)
+{
+  BenchRayRender(state, Prim::sphere);
+}
+
+BENCHMARK_CASE("RayRender.sausages", "Ray", 1000, 10000, 100000)
+{
+  BenchRayRender(state, Prim::sausage);
+}
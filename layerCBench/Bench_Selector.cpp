@@ -0,0 +1,46 @@
+#include "Bench.h"
+
+#include "Executive.h"
+#include "Selector.h"
+
+using namespace pymol::bench;
+
+/**
+ * Evaluate `expr` (through SelectorCreate, which parses and runs
+ * SelectorEvaluate) on a synthetic molecule of state.arg() atoms
+ */
+static void BenchSelect(State& state, const char* expr)
+{
+  auto G = state.G();
+  int const n = state.arg();
+
+  if (!LoadSynthetic(G, "bench_sele_obj", n)) {
+    state.skip("loading synthetic molecule failed");
+    return;
+  }
+
+  state.setItemsPerIteration(n);
+
+  while (state.keepRunning()) {
+    auto result = SelectorCreate(G, "bench_sele", expr, nullptr, true, nullptr);
+    doNotOptimize(result);
+  }
+
+  ExecutiveDelete(G, "bench_sele");
+  ExecutiveDelete(G, "bench_sele_obj");
+}
+
+BENCHMARK_CASE("SelectorEvaluate.properties", "Selector", 10000, 100000)
+{
+  BenchSelect(state, "name CA+CB and resn ALA+LEU+LYS and not chain B");
+}
+
+BENCHMARK_CASE("SelectorEvaluate.within", "Selector", 10000, 100000)
+{
+  BenchSelect(state, "byres (all within 5 of (resi 1-50 and chain A))");
+}
+
+BENCHMARK_CASE("SelectorEvaluate.polymer", "Selector", 10000, 100000)
+{
+  BenchSelect(state, "polymer.protein and not hydro");
+}
@@ -0,0 +1,41 @@
+#include "Bench.h"
+
+#include "CoordSet.h"
+#include "Executive.h"
+#include "ObjectMolecule.h"
+#include "Rep.h"
+#include "RepSurface.h"
+
+using namespace pymol::bench;
+
+/*
+ * SurfaceJobRun is internal to RepSurface.cpp, RepSurfaceNew prepares the
+ * surface job from the coordinate set and runs it.
+ */
+BENCHMARK_CASE("RepSurfaceNew", "Surface", 1000, 5000, 20000)
+{
+  auto G = state.G();
+  int const n = state.arg();
+
+  auto obj = LoadSynthetic(G, "bench_surf_obj", n);
+  if (!obj || !obj->NCSet || !obj->CSet[0]) {
+    state.skip("loading synthetic molecule failed");
+    return;
+  }
+
+  ExecutiveSetRepVisMask(G, "bench_surf_obj", cRepSurfaceBit, cVis_AS);
+
+  // what ObjectMolecule::update() does for single state objects
+  obj->RepVisCache = cRepBitmask;
+
+  state.setItemsPerIteration(n);
+
+  while (state.keepRunning()) {
+    auto rep = RepSurfaceNew(obj->CSet[0], 0);
+    state.pause();
+    delete rep;
+    state.resume();
+  }
+
+  ExecutiveDelete(G, "bench_surf_obj");
+}
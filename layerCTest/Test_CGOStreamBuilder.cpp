@@ -0,0 +1,168 @@
+#include "Test.h"
+
+#include "CGO.h"
+#include "CGOStreamBuilder.h"
+
+using namespace pymol::test;
+
+TEST_CASE("Stream builder converts primitives to triangles", "[CGO]")
+{
+  pymol::PyMOLInstance pymol;
+  auto G = pymol.G();
+
+  const float v[5][3] = {
+      {0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {1, 1, 0}, {0, 2, 0}};
+
+  pymol::CGOStreamBuilder builder(G);
+  REQUIRE(builder.empty());
+
+  // 5 strip vertices: 3 triangles
+  builder.begin(GL_TRIANGLE_STRIP);
+  for (auto const& p : v) {
+    builder.vertex(p);
+  }
+  builder.end();
+  REQUIRE(builder.size() == 9);
+
+  // 5 fan vertices: 3 triangles
+  builder.begin(GL_TRIANGLE_FAN);
+  for (auto const& p : v) {
+    builder.vertex(p);
+  }
+  builder.end();
+  REQUIRE(builder.size() == 18);
+
+  // incomplete triangle is dropped
+  builder.begin(GL_TRIANGLES);
+  for (auto const& p : v) {
+    builder.vertex(p);
+  }
+  builder.end();
+  REQUIRE(builder.size() == 21);
+}
+
+TEST_CASE("Stream builder passes non-triangle operations through", "[CGO]")
+{
+  pymol::PyMOLInstance pymol;
+  auto G = pymol.G();
+
+  const float v[4][3] = {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {1, 1, 0}};
+  const float red[3] = {1, 0, 0};
+
+  CGO src(G);
+  CGOColorv(&src, red);
+  CGOBegin(&src, GL_TRIANGLE_STRIP);
+  for (auto const& p : v) {
+    CGOVertexv(&src, p);
+  }
+  CGOEnd(&src);
+  CGOSphere(&src, v[0], 1.f);
+  CGOBegin(&src, GL_LINES);
+  CGOVertexv(&src, v[0]);
+  CGOVertexv(&src, v[1]);
+  CGOEnd(&src);
+  CGOStop(&src);
+
+  // combined into CGO_DRAW_ARRAYS, same result
+  for (bool combine : {false, true}) {
+    std::unique_ptr<CGO> input(CGOCombineBeginEnd(&src));
+    CGO const* in = combine ? input.get() : &src;
+
+    pymol::CGOStreamBuilder builder(G);
+    CGO leftover(G);
+    REQUIRE(builder.append(in, &leftover));
+    CGOStop(&leftover);
+
+    REQUIRE(builder.size() == 6);
+    REQUIRE(CGOHasOperationsOfType(&leftover, CGO_SPHERE));
+    REQUIRE(CGOHasOperationsOfType(&leftover, CGO_COLOR));
+    REQUIRE(CGOHasOperationsOfType(
+        &leftover, combine ? CGO_DRAW_ARRAYS : CGO_VERTEX));
+  }
+}
+
+/**
+ * Compare the client side arrays of the builder with the triangle packing
+ * of CGOOptimizeToVBONotIndexed
+ */
+static void requireSameArrays(const CGO* src)
+{
+  auto G = src->G;
+
+  CGOTriangleArrays expected;
+  REQUIRE(CGOGetTriangleArraysNotIndexed(src, expected));
+
+  pymol::CGOStreamBuilder builder(G);
+  REQUIRE(builder.append(src));
+
+  auto const n = std::size_t(expected.nverts);
+  REQUIRE(builder.size() == n);
+  REQUIRE(builder.hasNormals() == expected.has_normals);
+  REQUIRE(builder.hasColors() == expected.has_colors);
+
+  auto same = [](auto const& vec, auto const* arr, std::size_t count) {
+    REQUIRE(vec.size() == count);
+    REQUIRE(std::equal(vec.begin(), vec.end(), arr));
+  };
+
+  same(builder.vertexVals(), expected.vertexVals, n * 3);
+
+  if (expected.normalValsC) {
+    same(builder.normalValsC(), expected.normalValsC, n * 3);
+  } else {
+    same(builder.normalVals(), expected.normalVals, n * 3);
+  }
+
+  if (expected.colorValsUC) {
+    same(builder.colorValsUC(), expected.colorValsUC, n * 4);
+  } else {
+    same(builder.colorVals(), expected.colorVals, n * 4);
+  }
+
+  auto const& picks = builder.pickColorVals();
+  REQUIRE(picks.size() == n * 2);
+  for (std::size_t i = 0; i != n; ++i) {
+    REQUIRE(picks[i * 2] == CGO_get_uint(expected.pickColorVals + i * 2));
+    REQUIRE(int(picks[i * 2 + 1]) ==
+            CGO_get_int(expected.pickColorVals + i * 2 + 1));
+  }
+}
+
+TEST_CASE("Stream builder matches CGOOptimizeToVBONotIndexed", "[CGO]")
+{
+  pymol::PyMOLInstance pymol;
+  auto G = pymol.G();
+
+  const float v[5][3] = {
+      {0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {1, 1, 0}, {0, 2, 0}};
+  const float n[5][3] = {
+      {0, 0, 1}, {0, .6f, .8f}, {.6f, 0, .8f}, {0, -.6f, .8f}, {0, 0, -1}};
+  const float c[5][3] = {
+      {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {1, 1, 0}, {.5f, .5f, .5f}};
+
+  CGO src(G);
+  CGOColorv(&src, c[4]);
+  CGOAlpha(&src, .5f);
+  for (int mode : {GL_TRIANGLE_STRIP, GL_TRIANGLE_FAN, GL_TRIANGLES}) {
+    CGOBegin(&src, mode);
+    for (int i = 0; i < 5; ++i) {
+      // differing pick colors per triangle
+      CGOPickColor(&src, i / 2, cPickableAtom);
+      CGONormalv(&src, n[i]);
+      CGOColorv(&src, c[i]);
+      CGOVertexv(&src, v[i]);
+    }
+    CGOEnd(&src);
+  }
+  CGOStop(&src);
+
+  for (bool ub : {false, true}) {
+    SettingSet(G, cSetting_cgo_shader_ub_color, ub);
+    SettingSet(G, cSetting_cgo_shader_ub_normal, ub);
+
+    requireSameArrays(&src);
+
+    std::unique_ptr<CGO> combined(CGOCombineBeginEnd(&src));
+    requireSameArrays(combined.get());
+  }
+}
@@ -2,6 +2,10 @@
 
 #include "CifFile.h"
 
+#ifdef PYMOL_OPENMP
+#include <omp.h>
+#endif
+
 using namespace pymol::test;
 
 const char* SAMPLE_CIF_STR = R"""(
@@ -148,4 +152,64 @@ TEST_CASE("misc", "[CifFile]")
   REQUIRE(blocks.find("baz")->second.get_opt("_typed_float3")->as<double>() == Approx(1.23456789));
 }
 
+/**
+ * Synthetic loop with text fields and quoted values, large enough for the
+ * chunked (parallel) tokenizer, so that values straddle chunk boundaries.
+ */
+static std::string large_cif_str(unsigned nrows)
+{
+  std::string s = "data_large\nloop_\n_x.id\n_x.quoted\n_x.text\n_x.other\n";
+  for (unsigned i = 0; i < nrows; ++i) {
+    auto const id = std::to_string(i);
+    s += id + " 'single " + id + "'\n;text " + id + "\n'not quoted' " + id +
+         "\n;\n\"double " + id + "\"\n";
+  }
+  return s;
+}
+
+static std::vector<std::string> large_cif_values(const std::string& str)
+{
+  pymol::cif_file cf(nullptr, str.c_str());
+  std::vector<std::string> values;
+  auto const& blocks = cf.datablocks();
+  REQUIRE(blocks.size() == 1);
+  auto const& block = blocks.begin()->second;
+  for (auto key : {"_x.id", "_x.quoted", "_x.text", "_x.other"}) {
+    auto const* arr = block.get_arr(key);
+    REQUIRE(arr != nullptr);
+    for (unsigned i = 0, i_end = arr->size(); i != i_end; ++i) {
+      values.emplace_back(arr->as_s(i));
+    }
+  }
+  return values;
+}
+
+TEST_CASE("chunked tokenizer", "[CifFile]")
+{
+  unsigned const nrows = 100000;
+  auto const str = large_cif_str(nrows);
+  REQUIRE(str.size() > (4 << 20));
+
+#ifdef PYMOL_OPENMP
+  int const max_threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+  auto const serial = large_cif_values(str);
+#ifdef PYMOL_OPENMP
+  omp_set_num_threads(std::max(max_threads, 4));
+#endif
+  auto const chunked = large_cif_values(str);
+#ifdef PYMOL_OPENMP
+  omp_set_num_threads(max_threads);
+#endif
+
+  REQUIRE(serial.size() == nrows * 4);
+  REQUIRE(serial == chunked);
+
+  REQUIRE(chunked[nrows - 1] == std::to_string(nrows - 1));
+  REQUIRE(chunked[nrows + 12345] == "single 12345");
+  REQUIRE(chunked[nrows * 2 + 12345] == "text 12345\n'not quoted' 12345");
+  REQUIRE(chunked[nrows * 3 + 12345] == "double 12345");
+}
+
 // vi:sw=2:expandtab
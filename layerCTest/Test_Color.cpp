@@ -0,0 +1,64 @@
+#include "Test.h"
+
+#include "Color.h"
+#include "Executive.h"
+#include "ObjectMolecule.h"
+#include "Setting.h"
+
+using namespace pymol::test;
+
+TEST_CASE("Batched ramp colors match single lookups", "[Color]")
+{
+  pymol::PyMOLInstance pymol;
+  auto G = pymol.G();
+
+  const float pos[3][3] = {{0.f, 0.f, 0.f}, {3.f, 0.f, 0.f}, {0.f, 4.f, 1.f}};
+  for (auto& p : pos) {
+    ExecutivePseudoatom(G, "M1", "", "PS1", "PSD", "1", "P", "PSDO", "PS",
+        -1.0f, 1, 0.0, 0.0, "", p, -1, -1, 2, 1);
+  }
+
+  auto obj = ExecutiveFindObject<ObjectMolecule>(G, "M1");
+  REQUIRE(obj);
+  obj->AtomInfo[0].color = ColorGetIndex(G, "red");
+  obj->AtomInfo[1].color = ColorGetIndex(G, "green");
+  obj->AtomInfo[2].color = ColorGetIndex(G, "blue");
+
+  // atomic color at the surface, white at 5 Angstrom
+  pymol::vla<float> range(2);
+  range[0] = 0.f;
+  range[1] = 5.f;
+  pymol::vla<float> color(6);
+  std::fill_n(color.data(), 6, 1.f);
+  color[0] = cColorAtomic;
+  REQUIRE(ExecutiveRampNew(G, "ramp1", "M1", std::move(range),
+      std::move(color), 0, "", 0.f, 0.f, 0.f, 0, 0, 1));
+
+  int const index = ColorGetIndex(G, "ramp1");
+  REQUIRE(ColorCheckRamped(G, index));
+
+  // enough vertices for the parallel path, off the planes where two atoms
+  // are equally near (ties may resolve differently)
+  int const n = 3000;
+  std::vector<float> vertex(3 * n);
+  for (int i = 0; i < n; ++i) {
+    vertex[i * 3 + 0] = -4.017f + 11.f * ((i * 7) % 101) / 100.f;
+    vertex[i * 3 + 1] = -3.971f + 12.f * ((i * 13) % 97) / 96.f;
+    vertex[i * 3 + 2] = -4.003f + 9.f * ((i * 29) % 89) / 88.f;
+  }
+
+  for (bool blend : {false, true}) {
+    SettingSetGlobal_b(G, cSetting_ramp_blend_nearby_colors, blend);
+
+    std::vector<float> batched(3 * n);
+    REQUIRE(ColorGetRampedN(G, index, n, vertex.data(), batched.data(), 0));
+
+    for (int i = 0; i < n; ++i) {
+      float single[3];
+      ColorGetRamped(G, index, vertex.data() + 3 * i, single, 0);
+      for (int d = 0; d < 3; ++d) {
+        REQUIRE(batched[i * 3 + d] == Approx(single[d]).margin(1e-5));
+      }
+    }
+  }
+}
@@ -0,0 +1,107 @@
+#include "Test.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "Executive.h"
+#include "InstancePool.h"
+#include "PyMOL.h"
+
+using namespace pymol;
+
+static const char* pdb_str =
+    "ATOM      1  CA  GLY A   1       0.000   0.000   0.000  1.00  0.00"
+    "           C\n";
+
+TEST_CASE("InstancePool lease and return", "[InstancePool]")
+{
+  InstancePool pool(2);
+  REQUIRE(pool.capacity() == 2);
+  REQUIRE(pool.size() == 0);
+
+  CPyMOL* first = nullptr;
+  {
+    auto lease = pool.acquire();
+    REQUIRE(lease);
+    first = lease.get();
+    REQUIRE(pool.size() == 1);
+  }
+
+  // returned instance is reused
+  auto lease = pool.acquire();
+  REQUIRE(lease.get() == first);
+  REQUIRE(pool.size() == 1);
+
+  // second instance while the first is leased
+  auto lease2 = pool.acquire();
+  REQUIRE(lease2);
+  REQUIRE(lease2.get() != first);
+  REQUIRE(pool.size() == 2);
+
+  // early release, moved-from leases are empty
+  auto moved = std::move(lease2);
+  REQUIRE(!lease2);
+  moved.release();
+  REQUIRE(!moved);
+  REQUIRE(pool.tryAcquire());
+}
+
+TEST_CASE("InstancePool tryAcquire when full", "[InstancePool]")
+{
+  InstancePool pool(1);
+  pool.prestart(3);
+  REQUIRE(pool.size() == 1);
+
+  auto lease = pool.tryAcquire();
+  REQUIRE(lease);
+  REQUIRE(!pool.tryAcquire());
+  REQUIRE(pool.size() == 1);
+
+  lease.release();
+  REQUIRE(pool.tryAcquire());
+}
+
+TEST_CASE("InstancePool blocks at capacity", "[InstancePool]")
+{
+  InstancePool pool(1);
+  auto lease = pool.acquire();
+  auto const instance = lease.get();
+
+  std::atomic<bool> acquired{false};
+  InstancePool::Lease other;
+
+  // the lease is handed back to this thread, instances are only started and
+  // returned here
+  std::thread waiter([&]() {
+    other = pool.acquire();
+    acquired = true;
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  REQUIRE(!acquired);
+
+  lease.release();
+  waiter.join();
+  REQUIRE(acquired);
+  REQUIRE(other.get() == instance);
+  REQUIRE(pool.size() == 1);
+}
+
+TEST_CASE("InstancePool reinitializes on return", "[InstancePool]")
+{
+  InstancePool pool(1);
+
+  {
+    auto lease = pool.acquire();
+    auto G = PyMOL_GetGlobals(lease.get());
+    REQUIRE(PyMOL_CmdLoad(lease.get(), pdb_str, "string", "pdb", "m1", 0,
+                false, true, true, -1, false)
+                .status == PyMOLstatus_SUCCESS);
+    REQUIRE(ExecutiveFindObjectByName(G, "m1"));
+  }
+
+  auto lease = pool.acquire();
+  auto G = PyMOL_GetGlobals(lease.get());
+  REQUIRE(!ExecutiveFindObjectByName(G, "m1"));
+}
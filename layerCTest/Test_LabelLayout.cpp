@@ -0,0 +1,85 @@
+#include "Test.h"
+
+#include "Character.h"
+#include "LabelLayout.h"
+
+using namespace pymol::test;
+
+static int NewGlyph(PyMOLGlobals* G, unsigned int ch, int width, int height)
+{
+  std::vector<unsigned char> bytemap(width * height, 0xFF);
+  CharFngrprnt fprnt{};
+  fprnt.u.i.text_id = 1;
+  fprnt.u.i.ch = ch;
+  fprnt.u.i.color[0] = 0xFF;
+  fprnt.u.i.color[3] = 0xFF;
+  return CharacterNewFromBytemap(G, width, height, width, bytemap.data(), 0.f,
+      0.f, (float) width, &fprnt);
+}
+
+TEST_CASE("Glyphs combined into one character", "[LabelLayout]")
+{
+  pymol::PyMOLInstance pymol;
+  auto G = pymol.G();
+
+  int const ids[] = {NewGlyph(G, 'a', 4, 5), NewGlyph(G, 'b', 3, 7)};
+  REQUIRE(ids[0]);
+  REQUIRE(ids[1]);
+
+  // second glyph on the next line, below the first
+  float const pen[] = {0.f, 0.f, 1.f, -10.f};
+
+  CharFngrprnt fprnt;
+  int id = CharacterNewFromGlyphs(G, 2, ids, pen, &fprnt);
+  REQUIRE(id);
+  REQUIRE(CharacterFind(G, &fprnt) == id);
+
+  int width, height;
+  float xorig, yorig, advance;
+  CharacterGetGeometry(G, id, &width, &height, &xorig, &yorig, &advance);
+  REQUIRE(width == 4);
+  REQUIRE(height == 15);
+  REQUIRE(xorig == 0.f);
+  REQUIRE(yorig == 10.f);
+
+  // opaque where the glyphs are, transparent in between
+  unsigned char const* buffer = CharacterGetPixmapBuffer(G, id);
+  REQUIRE(buffer[4 * (width * 14 + 0) + 3] > 0);
+  REQUIRE(buffer[4 * (width * 0 + 1) + 3] > 0);
+  REQUIRE(buffer[4 * (width * 8 + 0) + 3] == 0);
+
+  CharacterRelease(G, id);
+  REQUIRE(CharacterFind(G, &fprnt) == 0);
+}
+
+TEST_CASE("Label layout cache", "[LabelLayout]")
+{
+  pymol::PyMOLInstance pymol;
+  auto G = pymol.G();
+
+  int const glyph = NewGlyph(G, 'a', 4, 5);
+  float const pen[] = {0.f, 0.f};
+
+  pymol::LabelLayoutCache cache(G);
+  REQUIRE(cache.find("a") == nullptr);
+
+  pymol::LabelLayout layout;
+  layout.text_width = 4.f;
+  layout.char_id = CharacterNewFromGlyphs(G, 1, &glyph, pen, &layout.fprnt);
+  auto const fprnt = layout.fprnt;
+  cache.insert("a", std::move(layout));
+
+  auto found = cache.find("a");
+  REQUIRE(found);
+  REQUIRE(found->text_width == 4.f);
+  REQUIRE(CharacterFind(G, const_cast<CharFngrprnt*>(&fprnt)) == found->char_id);
+
+  // composite characters are released with the cache
+  cache.clear();
+  REQUIRE(cache.size() == 0);
+  REQUIRE(CharacterFind(G, const_cast<CharFngrprnt*>(&fprnt)) == 0);
+
+  // layouts without a composite character (blank text) stay valid
+  cache.insert(" ", pymol::LabelLayout());
+  REQUIRE(cache.find(" "));
+}
@@ -0,0 +1,42 @@
+#include "Test.h"
+
+#include "LevelOfDetail.h"
+
+using namespace pymol::test;
+
+TEST_CASE("Detail level from projected size", "[LevelOfDetail]")
+{
+  // thresholds at 4 and 1 pixels per Angstrom
+  REQUIRE(pymol::LodSelectLevel(10.f, 4.f, -1) == 0);
+  REQUIRE(pymol::LodSelectLevel(4.f, 4.f, -1) == 0);
+  REQUIRE(pymol::LodSelectLevel(3.f, 4.f, -1) == 1);
+  REQUIRE(pymol::LodSelectLevel(1.f, 4.f, -1) == 1);
+  REQUIRE(pymol::LodSelectLevel(.5f, 4.f, -1) == 2);
+  REQUIRE(pymol::LodSelectLevel(0.f, 4.f, -1) == 2);
+}
+
+TEST_CASE("Detail level hysteresis", "[LevelOfDetail]")
+{
+  // close to a threshold, the current level is kept
+  REQUIRE(pymol::LodSelectLevel(3.8f, 4.f, 0) == 0);
+  REQUIRE(pymol::LodSelectLevel(4.2f, 4.f, 1) == 1);
+  REQUIRE(pymol::LodSelectLevel(.9f, 4.f, 1) == 1);
+  REQUIRE(pymol::LodSelectLevel(1.1f, 4.f, 2) == 2);
+
+  // clearly past it, the level changes
+  REQUIRE(pymol::LodSelectLevel(3.f, 4.f, 0) == 1);
+  REQUIRE(pymol::LodSelectLevel(6.f, 4.f, 1) == 0);
+  REQUIRE(pymol::LodSelectLevel(.5f, 4.f, 0) == 2);
+  REQUIRE(pymol::LodSelectLevel(10.f, 4.f, 2) == 0);
+}
+
+TEST_CASE("Detail level quality", "[LevelOfDetail]")
+{
+  REQUIRE(pymol::LodQuality(10, 0, 3) == 10);
+  REQUIRE(pymol::LodQuality(10, 1, 3) == 5);
+  REQUIRE(pymol::LodQuality(10, 2, 3) == 3);
+  // below the minimum already, coarse levels don't add detail
+  REQUIRE(pymol::LodQuality(2, 0, 3) == 2);
+  REQUIRE(pymol::LodQuality(2, 1, 3) == 2);
+  REQUIRE(pymol::LodQuality(3, 2, 3) == 3);
+}
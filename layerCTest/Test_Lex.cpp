@@ -0,0 +1,90 @@
+#include "Test.h"
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LexConcurrent.h"
+
+using namespace pymol::test;
+
+TEST_CASE("Concurrent interning with staged reference counts", "[Lex]")
+{
+  pymol::PyMOLInstance pymol;
+  auto G = pymol.G();
+
+  int const n_threads = 4;
+  int const n_strings = 50;
+  int const n_repeat = 20;
+
+  auto name = [](int i) { return "lexconc_" + std::to_string(i); };
+
+  std::vector<std::vector<lexidx_t>> ids(n_threads);
+
+  {
+    pymol::LexInterner interner(G);
+    std::vector<pymol::LexStaging> staging;
+    for (int t = 0; t < n_threads; ++t) {
+      staging.emplace_back(interner);
+    }
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < n_threads; ++t) {
+      threads.emplace_back([&, t]() {
+        for (int r = 0; r < n_repeat; ++r) {
+          for (int i = 0; i < n_strings; ++i) {
+            ids[t].push_back(staging[t].idx(name((i + t * 7) % n_strings)));
+          }
+        }
+      });
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    REQUIRE(staging[0].idx("") == 0);
+
+    for (auto& s : staging) {
+      s.merge();
+    }
+  }
+
+  // same string, same id across threads
+  for (int t = 0; t < n_threads; ++t) {
+    for (int k = 0; k < n_strings; ++k) {
+      auto const& str = name((k + t * 7) % n_strings);
+      REQUIRE(LexBorrow(G, str.c_str()) == ids[t][k]);
+      REQUIRE(str == LexStr(G, ids[t][k]));
+    }
+  }
+
+  // every returned id holds one reference
+  for (auto const& thread_ids : ids) {
+    for (auto id : thread_ids) {
+      LexDec(G, id);
+    }
+  }
+
+  for (int i = 0; i < n_strings; ++i) {
+    REQUIRE(LexBorrow(G, name(i).c_str()) == LEX_BORROW_NOTFOUND);
+  }
+}
+
+TEST_CASE("Staged references are discarded on exception", "[Lex]")
+{
+  pymol::PyMOLInstance pymol;
+  auto G = pymol.G();
+
+  try {
+    pymol::LexInterner interner(G);
+    pymol::LexStaging staging(interner);
+    staging.idx("lexconc_unwind");
+    staging.idx("lexconc_unwind");
+    throw std::runtime_error("load failed");
+  } catch (const std::runtime_error&) {
+  }
+
+  REQUIRE(LexBorrow(G, "lexconc_unwind") == LEX_BORROW_NOTFOUND);
+}
@@ -0,0 +1,107 @@
+#include "Test.h"
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "Map.h"
+#include "SpatialIndex.h"
+
+using namespace pymol::test;
+
+static std::vector<float> MakePoints(int n)
+{
+  // deterministic scatter in a 20 Angstrom box
+  std::vector<float> vert(3 * n);
+  unsigned seed = 12345;
+  for (auto& v : vert) {
+    seed = seed * 1103515245u + 12345u;
+    v = ((seed >> 8) % 20000) * 0.001f;
+  }
+  return vert;
+}
+
+static std::vector<int> Neighbors(MapType& map, const float* v, bool excl)
+{
+  std::vector<int> result;
+  for (const auto j : MapEIter(map, v, excl)) {
+    result.push_back(j);
+  }
+  return result;
+}
+
+TEST_CASE("MapEIter CSR matches express list", "[Map]")
+{
+  pymol::PyMOLInstance pymol;
+  auto G = pymol.G();
+
+  int const n = 2000;
+  auto const vert = MakePoints(n);
+
+  std::unique_ptr<MapType> express(MapNew(G, 3.f, vert.data(), n));
+  std::unique_ptr<MapType> csr(MapNew(G, 3.f, vert.data(), n));
+  REQUIRE(MapSetupExpress(express.get()));
+  REQUIRE(MapSetupCSR(csr.get(), vert.data()));
+  REQUIRE(csr->CellItems.size() == n);
+  REQUIRE(csr->CellCoord.size() == 3 * n);
+
+  const float outside[3] = {-50.f, 0.f, 0.f};
+  REQUIRE(Neighbors(*csr, outside, true).empty());
+  REQUIRE(Neighbors(*csr, outside, false) == Neighbors(*express, outside, false));
+
+  for (int i = 0; i < n; i += 7) {
+    const float* v = vert.data() + 3 * i;
+    REQUIRE(Neighbors(*csr, v, true) == Neighbors(*express, v, true));
+    const float q[3] = {v[0] + 0.7f, v[1], v[2] - 0.4f};
+    for (float cutoff : {0.3f, 2.f}) {
+      REQUIRE(MapAnyWithin(*csr, vert.data(), q, cutoff) ==
+              MapAnyWithin(*express, vert.data(), q, cutoff));
+    }
+  }
+}
+
+TEST_CASE("SpatialIndex radius queries", "[Map]")
+{
+  int const n = 2000;
+  auto const vert = MakePoints(n);
+  pymol::SpatialIndex index(vert.data(), n, 7);
+  REQUIRE(index.size() == n);
+  REQUIRE(index.version() == 7);
+
+  for (float cutoff : {0.5f, 3.f, 12.f}) {
+    for (int i = 0; i < n; i += 97) {
+      const float q[3] = {vert[i * 3] + 0.3f, vert[i * 3 + 1], -1.f};
+      std::vector<int> expected;
+      for (int j = 0; j < n; ++j) {
+        const float* v = vert.data() + j * 3;
+        float const dx = v[0] - q[0], dy = v[1] - q[1], dz = v[2] - q[2];
+        if (dx * dx + dy * dy + dz * dz <= cutoff * cutoff) {
+          expected.push_back(j);
+        }
+      }
+      REQUIRE(index.within(q, cutoff) == expected);
+    }
+  }
+
+  pymol::SpatialIndex empty(nullptr, 0);
+  REQUIRE(empty.within(vert.data(), 100.f).empty());
+}
+
+TEST_CASE("SpatialIndex skips non-finite coordinates", "[Map]")
+{
+  float const inf = std::numeric_limits<float>::infinity();
+  float const nan = std::numeric_limits<float>::quiet_NaN();
+  const float vert[] = {
+      0.f, 0.f, 0.f,   //
+      inf, 0.f, 0.f,   //
+      1.f, -inf, 0.f,  //
+      nan, 1.f, 1.f,   //
+      1.f, 1.f, 1.f,   //
+  };
+  pymol::SpatialIndex index(vert, 5);
+  REQUIRE(index.size() == 5);
+
+  const float q[3] = {0.5f, 0.5f, 0.5f};
+  REQUIRE(index.within(q, 1.f) == std::vector<int>{0, 4});
+  REQUIRE(index.within(vert + 3, 1e6f).empty());
+}
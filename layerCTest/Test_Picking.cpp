@@ -1,6 +1,11 @@
 #include "Picking.h"
 #include "Test.h"
 
+#include "CoordSet.h"
+#include "Executive.h"
+#include "ObjectMolecule.h"
+#include "PickBVH.h"
+
 using namespace pymol::test;
 
 TEST_CASE("getTotalBits", "[Picking]")
@@ -123,3 +128,67 @@ TEST_CASE("pickmgr", "[Picking]")
   REQUIRE(!pickmgr.m_valid);
   REQUIRE(pickmgr.getIdentifier(1) == nullptr);
 }
+
+TEST_CASE("PickBVH ray and frustum queries", "[Picking]")
+{
+  pymol::PyMOLInstance pymol;
+  auto G = pymol.G();
+
+  const float pos[2][3] = {{0.f, 0.f, 0.f}, {0.f, 0.f, -5.f}};
+  for (auto& p : pos) {
+    ExecutivePseudoatom(G, "M1", "", "PS1", "PSD", "1", "P", "PSDO", "PS",
+        -1.0f, 1, 0.0, 0.0, "", p, -1, -1, 2, 1);
+  }
+
+  auto obj = ExecutiveFindObject<ObjectMolecule>(G, "M1");
+  REQUIRE(obj);
+  REQUIRE(obj->NAtom == 2);
+  for (int atm = 0; atm < obj->NAtom; ++atm) {
+    obj->AtomInfo[atm].visRep = cRepSphereBit;
+  }
+
+  const CoordSet* cs = obj->CSet[0];
+  pymol::PickBVH bvh(cs);
+
+  auto zOf = [&](int atm) { return cs->coordPtr(cs->atmToIdx(atm))[2]; };
+
+  // looking down -z from z=10, the front atom is hit
+  pymol::PickRay ray{{0.f, 0.f, 10.f}, {0.f, 0.f, -1.f}, 0.f, 100.f, 0.01f,
+      0.f, 2.f};
+  pymol::PickHit hit;
+  REQUIRE(bvh.intersect(cs, ray, hit));
+  REQUIRE(zOf(hit.index) == 0.f);
+  REQUIRE(hit.bond == cPickableAtom);
+  REQUIRE(hit.miss == 0.f);
+  REQUIRE(hit.depth < 10.f);
+
+  // front atom clipped away
+  ray.tmax = 12.f;
+  ray.tmin = 11.f;
+  hit = {};
+  REQUIRE(bvh.intersect(cs, ray, hit));
+  REQUIRE(zOf(hit.index) == -5.f);
+
+  // far off to the side, beyond tolerance
+  ray = {{3.f, 0.f, 10.f}, {0.f, 0.f, -1.f}, 0.f, 100.f, 0.01f, 0.f, 2.f};
+  hit = {};
+  REQUIRE(!bvh.intersect(cs, ray, hit));
+
+  // half space z >= -1
+  const float planes[1][4] = {{0.f, 0.f, 1.f, 1.f}};
+  std::vector<int> atoms;
+  bvh.intersect(cs, planes, 1, atoms);
+  REQUIRE(atoms.size() == 1);
+  REQUIRE(zOf(atoms[0]) == 0.f);
+
+  // masking drops the lazily built tree (it skips masked atoms)
+  auto cs_mut = obj->CSet[0];
+  cs_mut->PickTree = pymol::make_cache<pymol::PickBVH>(cs_mut);
+  REQUIRE(static_cast<bool>(ExecutiveMask(G, "M1")));
+  REQUIRE(!cs_mut->PickTree);
+
+  pymol::PickBVH masked(cs_mut);
+  hit = {};
+  ray = {{0.f, 0.f, 10.f}, {0.f, 0.f, -1.f}, 0.f, 100.f, 0.01f, 0.f, 2.f};
+  REQUIRE(!masked.intersect(cs_mut, ray, hit));
+}
@@ -0,0 +1,61 @@
+#include "Test.h"
+
+#include "Executive.h"
+#include "PyMOL.h"
+
+using namespace pymol;
+
+TEST_CASE("ContentFormatFromFilename", "[PyMOL]")
+{
+  REQUIRE(ContentFormatFromFilename("1abc.pdb") == "pdb");
+  REQUIRE(ContentFormatFromFilename("1ABC.PDB") == "pdb");
+  REQUIRE(ContentFormatFromFilename("1abc.cif") == "cif");
+
+  // numbered extensions
+  REQUIRE(ContentFormatFromFilename("1abc.pdb1") == "pdb");
+  REQUIRE(ContentFormatFromFilename("1abc.pdb12") == "pdb");
+  REQUIRE(ContentFormatFromFilename("traj.xyz_1") == "xyz");
+  REQUIRE(ContentFormatFromFilename("1abc.pdbx") == "pdbx");
+  REQUIRE(ContentFormatFromFilename("traj.xyz_") == "xyz_");
+
+  // aliases
+  REQUIRE(ContentFormatFromFilename("pdb1abc.ent") == "pdb");
+  REQUIRE(ContentFormatFromFilename("1abc.mmcif") == "cif");
+  REQUIRE(ContentFormatFromFilename("1abc.MMCIF") == "cif");
+
+  // dots in directory names
+  REQUIRE(ContentFormatFromFilename("data.v2/1abc.pdb") == "pdb");
+  REQUIRE(ContentFormatFromFilename("data.v2/1abc") == "");
+  REQUIRE(ContentFormatFromFilename("C:\\data.v2\\1abc") == "");
+  REQUIRE(ContentFormatFromFilename("1abc") == "");
+
+  // unknown extensions are passed through (plugins)
+  REQUIRE(ContentFormatFromFilename("md.dcd") == "dcd");
+  REQUIRE(ContentFormatFromFilename("md.GRO") == "gro");
+}
+
+TEST_CASE("ContentLoadType", "[PyMOL]")
+{
+  PyMOLInstance pymol;
+  auto G = pymol.G();
+  const char* plugin = "";
+
+  REQUIRE(ContentLoadType(G, "pdb", true, &plugin) == cLoadTypePDB);
+  REQUIRE(plugin == nullptr);
+  REQUIRE(ContentLoadType(G, "pdb", false, &plugin) == cLoadTypePDBStr);
+  REQUIRE(ContentLoadType(G, "cif", true, &plugin) == cLoadTypeCIF);
+
+  REQUIRE(ContentLoadType(G, "nosuchformat", true, &plugin) ==
+          cLoadTypeUnknown);
+  REQUIRE(plugin == nullptr);
+  REQUIRE(ContentLoadType(G, "", true, &plugin) == cLoadTypeUnknown);
+
+  // plugins only read files
+  REQUIRE(ContentLoadType(G, "dcd", false, &plugin) == cLoadTypeUnknown);
+  REQUIRE(plugin == nullptr);
+
+#ifdef _PYMOL_VMD_PLUGINS
+  REQUIRE(ContentLoadType(G, "dcd", true, &plugin) == cLoadTypePlugin);
+  REQUIRE(plugin != nullptr);
+#endif
+}
@@ -0,0 +1,132 @@
+#include "Test.h"
+
+#include <cstdio>
+
+#ifdef PYMOL_OPENMP
+#include <omp.h>
+#endif
+
+#include "CGO.h"
+#include "Color.h"
+#include "CoordSet.h"
+#include "Executive.h"
+#include "ObjectMolecule.h"
+#include "RepCartoon.h"
+
+using namespace pymol::test;
+
+/**
+ * CA-only PDB with `nchains` helical chains (ideal helix geometry, the
+ * secondary structure gets assigned separately)
+ */
+static std::string cartoon_pdb_str(int nchains, int nres)
+{
+  std::string pdb;
+  char line[100];
+  int serial = 0;
+
+  for (int c = 0; c < nchains; ++c) {
+    for (int r = 0; r < nres; ++r) {
+      double const phi = r * 100.0 * cPI / 180.0;
+      std::snprintf(line, sizeof(line),
+          "ATOM  %5d  CA  ALA %c%4d    %8.3f%8.3f%8.3f  1.00  0.00           C\n",
+          ++serial, 'A' + c, r + 1, 30.0 * c + 2.3 * cos(phi), 2.3 * sin(phi),
+          1.5 * r);
+      pdb += line;
+    }
+    pdb += "TER\n";
+  }
+
+  return pdb;
+}
+
+/**
+ * Compare two CGOs operation by operation. Draw arrays are compared by
+ * their data, not by the data pointer.
+ */
+static void requireSameCGO(const CGO* a, const CGO* b)
+{
+  auto it1 = a->begin();
+  auto it2 = b->begin();
+  std::size_t n_ops = 0, n_diff = 0;
+
+  for (; !it1.is_stop() && !it2.is_stop(); ++it1, ++it2, ++n_ops) {
+    auto const op = it1.op_code();
+    if (op != it2.op_code()) {
+      ++n_diff;
+      break;
+    }
+
+    if (op == CGO_DRAW_ARRAYS) {
+      auto const sp1 = it1.cast<cgo::draw::arrays>();
+      auto const sp2 = it2.cast<cgo::draw::arrays>();
+      if (sp1->mode != sp2->mode || sp1->arraybits != sp2->arraybits ||
+          sp1->nverts != sp2->nverts ||
+          memcmp(sp1->floatdata, sp2->floatdata,
+              sp1->get_data_length() * sizeof(float))) {
+        ++n_diff;
+      }
+    } else if (memcmp(it1.data(), it2.data(), CGO_sz[op] * sizeof(float))) {
+      ++n_diff;
+    }
+  }
+
+  REQUIRE(n_ops > 0);
+  REQUIRE(n_diff == 0);
+  REQUIRE(it1.is_stop());
+  REQUIRE(it2.is_stop());
+}
+
+TEST_CASE("Parallel cartoon extrusion matches serial", "[RepCartoon]")
+{
+  pymol::PyMOLInstance pymol;
+  auto G = pymol.G();
+
+  // enough guide atoms for parallel shards (CARTOON_PARALLEL_MIN)
+  int const nchains = 4, nres = 800;
+  auto const pdb = cartoon_pdb_str(nchains, nres);
+  auto const loaded = ExecutiveLoad(G, nullptr, pdb.c_str(), pdb.size(),
+      cLoadTypePDBStr, "m1", -1, 0, 0, 1, 0, 1, nullptr);
+  REQUIRE(static_cast<bool>(loaded));
+
+  auto obj = ExecutiveFindObjectMoleculeByName(G, "m1");
+  REQUIRE(obj);
+  REQUIRE(obj->NAtom == nchains * nres);
+
+  // helix, loop, strand, loop, ... and a 24-bit color per chain
+  for (int a = 0; a < obj->NAtom; ++a) {
+    auto& ai = obj->AtomInfo[a];
+    int const r = a % nres;
+    ai.ssType[0] = "HLSL"[(r / 10) % 4];
+    ai.ssType[1] = 0;
+    ai.color = cColor_TRGB_Bits | (0x203040 * (a / nres + 1));
+    ai.visRep = cRepCartoonBit;
+  }
+  obj->RepVisCache = cRepBitmask;
+
+  auto cs = obj->CSet[0];
+  REQUIRE(cs);
+
+#ifdef PYMOL_OPENMP
+  int const max_threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+  std::unique_ptr<Rep> serial(RepCartoonNew(cs, 0));
+#ifdef PYMOL_OPENMP
+  omp_set_num_threads(std::max(max_threads, 4));
+#endif
+  std::unique_ptr<Rep> parallel(RepCartoonNew(cs, 0));
+#ifdef PYMOL_OPENMP
+  omp_set_num_threads(max_threads);
+#endif
+
+  REQUIRE(serial);
+  REQUIRE(parallel);
+
+  auto const* cgo1 = static_cast<RepCartoon*>(serial.get())->preshader;
+  auto const* cgo2 = static_cast<RepCartoon*>(parallel.get())->preshader;
+  REQUIRE(cgo1);
+  REQUIRE(cgo2);
+  REQUIRE(cgo1->c == cgo2->c);
+  requireSameCGO(cgo1, cgo2);
+}
@@ -0,0 +1,30 @@
+#include "Test.h"
+
+#include <algorithm>
+
+#include "Executive.h"
+#include "Scene.h"
+#include "Setting.h"
+
+using namespace pymol;
+
+TEST_CASE("SceneObjectDel purge doesn't mark the object changed", "[Scene]")
+{
+  PyMOLInstance pymol;
+  auto G = pymol.G();
+
+  ExecutivePseudoatom(G, "M1", "", "PS1", "PSD", "1", "P", "PSDO", "PS",
+      -1.0f, 1, 0.0, 0.0, "", nullptr, -1, -1, 2, 1);
+  auto obj = ExecutiveFindObjectByName(G, "M1");
+  REQUIRE(obj);
+
+  SettingSetGlobal_i(G, cSetting_defer_builds_mode, 3);
+  SceneObjectDel(G, obj, true);
+
+  auto I = G->Scene;
+  REQUIRE(I->ChangedObjSet.count(obj) == 0);
+  REQUIRE(std::find(I->ChangedObjs.begin(), I->ChangedObjs.end(), obj) ==
+          I->ChangedObjs.end());
+
+  SceneObjectAdd(G, obj);
+}
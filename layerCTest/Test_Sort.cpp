@@ -0,0 +1,90 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+#include "AtomInfo.h"
+#include "Lex.h"
+#include "ObjectMolecule.h"
+#include "RadixSort.h"
+#include "Setting.h"
+
+using namespace pymol::test;
+
+TEST_CASE("Radix sort is a stable sort", "[Sort]")
+{
+  std::mt19937 rng(42);
+
+  for (int nbits : {1, 13, 40, 100}) {
+    int const n = 100000;
+    std::vector<pymol::SortKey> keys(n);
+    for (auto& key : keys) {
+      for (int b = 0; b < nbits; b += 10) {
+        int const w = std::min(10, nbits - b);
+        key.push(rng() & ((1u << w) - 1), w);
+      }
+    }
+
+    std::vector<int> index(n), expected(n);
+    pymol::RadixSortIndex(n, keys.data(), nbits, index.data());
+
+    std::iota(expected.begin(), expected.end(), 0);
+    std::stable_sort(expected.begin(), expected.end(),
+        [&](int a, int b) { return keys[a] < keys[b]; });
+
+    REQUIRE(index == expected);
+  }
+}
+
+TEST_CASE("Atom sort keys order like AtomInfoCompare", "[Sort]")
+{
+  pymol::PyMOLInstance pymol;
+  auto G = pymol.G();
+
+  // the comparison isn't a consistent ordering with interleaved insertions
+  SettingSetGlobal_b(G, cSetting_rank_assisted_sorts, false);
+
+  const char* chains[] = {"A", "B", "a", ""};
+  const char* resns[] = {"ALA", "ala", "GLY", "HOH"};
+  const char* names[] = {"CA", "1HB", "HB", "N", "ca", "C"};
+  const char* inscodes = "\0AbB";
+
+  std::mt19937 rng(7);
+  int const n = 5000;
+  std::vector<AtomInfoType> atoms(n);
+  for (int i = 0; i < n; ++i) {
+    auto& ai = atoms[i];
+    ai.chain = LexIdx(G, chains[rng() % 4]);
+    ai.resn = LexIdx(G, resns[rng() % 4]);
+    ai.name = LexIdx(G, names[rng() % 6]);
+    ai.resv = int(rng() % 20) - 5;
+    ai.hetatm = (rng() % 4) == 0 && ai.resv != 0;
+    ai.inscode = inscodes[rng() % 4];
+    ai.alt[0] = (rng() % 3) ? 0 : 'A' + rng() % 2;
+    ai.priority = rng() % 3;
+    ai.rank = n - i;
+  }
+
+  for (bool hetatm_sort : {false, true}) {
+    SettingSetGlobal_i(G, cSetting_pdb_hetatm_sort, hetatm_sort);
+
+    int* outdex = nullptr;
+    int* index = AtomInfoGetSortedIndex(G, nullptr, atoms.data(), n, &outdex);
+    REQUIRE(index);
+
+    for (int k = 1; k < n; ++k) {
+      auto a = atoms.data() + index[k - 1];
+      auto b = atoms.data() + index[k];
+      REQUIRE((hetatm_sort ? AtomInfoCompare(G, a, b)
+                           : AtomInfoCompareIgnoreHet(G, a, b)) <= 0);
+      REQUIRE(outdex[index[k]] == k);
+    }
+
+    AtomInfoFreeSortedIndexes(G, &index, &outdex);
+  }
+
+  for (auto& ai : atoms) {
+    AtomInfoPurge(G, &ai);
+  }
+}
@@ -0,0 +1,76 @@
+#include "Test.h"
+
+#include <cmath>
+
+#include "Matrix.h"
+#include "Superposition.h"
+#include "Vector.h"
+
+static float RMS(std::size_t n, const float* a, const float* b)
+{
+  double sum = 0.0;
+  for (std::size_t i = 0; i < n * 3; ++i) {
+    sum += (a[i] - b[i]) * (a[i] - b[i]);
+  }
+  return std::sqrt(sum / n);
+}
+
+static pymol::CoordFrames MakeFrames()
+{
+  // frame 0: helix-like points, frame 1: rotated and translated copy,
+  // frame 2: frame 0 with one displaced point
+  std::size_t const n = 20;
+  pymol::CoordFrames frames(3, n);
+  float const c = std::cos(0.7f), s = std::sin(0.7f);
+  for (std::size_t i = 0; i < n; ++i) {
+    float* p0 = frames.frame(0) + i * 3;
+    float* p1 = frames.frame(1) + i * 3;
+    float* p2 = frames.frame(2) + i * 3;
+    p0[0] = 2.3f * std::cos(i * 1.75f);
+    p0[1] = 2.3f * std::sin(i * 1.75f);
+    p0[2] = 1.5f * i;
+    p1[0] = c * p0[0] - s * p0[2] + 4.f;
+    p1[1] = p0[1] - 2.f;
+    p1[2] = s * p0[0] + c * p0[2] + 1.f;
+    copy3f(p0, p2);
+  }
+  frames.frame(2)[0] += 1.f;
+  return frames;
+}
+
+TEST_CASE("QCP fit matches applied TTT", "[Superposition]")
+{
+  auto frames = MakeFrames();
+  std::size_t const n = frames.nAtoms;
+
+  float ttt[16];
+  float rms = pymol::QCPFitRMSTTTf(n, frames.frame(2), frames.frame(1), ttt);
+  REQUIRE(rms > 0.f);
+
+  std::vector<float> moved(n * 3);
+  MatrixTransformTTTfN3f(n, moved.data(), ttt, frames.frame(2));
+  REQUIRE(RMS(n, moved.data(), frames.frame(1)) == Approx(rms).epsilon(1e-4));
+
+  // identical up to rigid motion
+  REQUIRE(pymol::QCPFitRMSTTTf(n, frames.frame(1), frames.frame(0)) == 0.f);
+}
+
+TEST_CASE("RMS matrix and clustering", "[Superposition]")
+{
+  auto frames = MakeFrames();
+
+  auto matrix = pymol::RMSMatrix(frames);
+  REQUIRE(matrix.size() == 9);
+  REQUIRE(matrix[0 * 3 + 1] == 0.f);
+  REQUIRE(matrix[0 * 3 + 2] > 0.f);
+  REQUIRE(matrix[2 * 3 + 0] == matrix[0 * 3 + 2]);
+
+  auto rms = pymol::SuperposeFrames(frames, 0, false);
+  REQUIRE(rms[0] == 0.f);
+  REQUIRE(rms[2] == Approx(std::sqrt(1.f / frames.nAtoms)));
+
+  auto clusters = pymol::ClusterRMSMatrix(matrix, 3, 0.01f);
+  REQUIRE(clusters.size() == 2);
+  REQUIRE(clusters[0] == std::vector<int>{0, 1});
+  REQUIRE(clusters[1] == std::vector<int>{2});
+}
@@ -0,0 +1,63 @@
+#include "Test.h"
+
+#include "Trace.h"
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace pymol::test;
+
+static std::string ReadFile(const char* filename)
+{
+  std::ifstream file(filename);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  return buffer.str();
+}
+
+TEST_CASE("Nothing recorded without a capture", "[Trace]")
+{
+  pymol::trace::start();
+  pymol::trace::stop();
+  REQUIRE(!pymol::trace::enabled());
+
+  {
+    PYMOL_TRACE_SCOPE("idle", "test");
+    pymol::trace::counter("idle counter", 1.0);
+  }
+  REQUIRE(pymol::trace::size() == 0);
+}
+
+TEST_CASE("Spans and counters", "[Trace]")
+{
+  pymol::trace::start();
+  REQUIRE(pymol::trace::enabled());
+
+  {
+    PYMOL_TRACE_SCOPE("outer", "test", "some \"detail\"");
+    pymol::trace::Span inner("inner", "test");
+    inner.end();
+    pymol::trace::counter("items", 42.0);
+  }
+  std::thread([] { PYMOL_TRACE_SCOPE("worker", "test"); }).join();
+
+  pymol::trace::stop();
+  REQUIRE(pymol::trace::size() == 4);
+
+  TmpFILE tmpfile;
+  REQUIRE(pymol::trace::write(tmpfile.getFilename()));
+
+  auto const json = ReadFile(tmpfile.getFilename());
+  REQUIRE(json.find("\"traceEvents\"") != std::string::npos);
+  REQUIRE(json.find("\"name\":\"outer\"") != std::string::npos);
+  REQUIRE(json.find("\"name\":\"inner\"") != std::string::npos);
+  REQUIRE(json.find("\"name\":\"worker\"") != std::string::npos);
+  REQUIRE(json.find("\"detail\":\"some \\\"detail\\\"\"") != std::string::npos);
+  REQUIRE(json.find("\"items\":42") != std::string::npos);
+
+  // a new capture discards the old events
+  pymol::trace::start();
+  pymol::trace::stop();
+  REQUIRE(pymol::trace::size() == 0);
+}
@@ -131,6 +131,7 @@ from .querying import \
       get_names,          \
       get_names_of_type,  \
       get_legal_name,     \
+      get_lod_stats,      \
       get_unused_name,    \
       get_object_matrix,  \
       get_object_ttt,     \
@@ -301,7 +302,10 @@ from .fitting import \
       intra_fit,         \
       intra_rms,         \
       intra_rms_cur,     \
+      rms_matrix,        \
+      rms_cluster,       \
       cealign,          \
+      cealign_batch,    \
       pair_fit
 
 #--------------------------------------------------------------------
@@ -454,13 +458,16 @@ from .experimenting import \
       dump,               \
       get_bond_print,     \
       fast_minimize,      \
+      get_memory_usage,   \
       mem,                \
+      memory_report,      \
       minimize,           \
       spheroid,           \
       focal_blur,         \
       callout,            \
       desaturate,         \
-      test
+      test,               \
+      trace
 
 from .internal import      \
       download_chem_comp, \
@@ -177,9 +177,6 @@ if True:
         _object_update_spawn = internal._object_update_spawn
         _object_update_thread = internal._object_update_thread
         _quit = internal._quit
-        _ray_anti_spawn = internal._ray_anti_spawn
-        _ray_hash_spawn = internal._ray_hash_spawn
-        _ray_spawn = internal._ray_spawn
         _refresh = internal._refresh
         _special = internal._special
         _validate_color_sc = internal._validate_color_sc
@@ -99,6 +99,7 @@ def get_auto_arg_list(self_cmd=cmd):
         'cache'          : [ self_cmd.exporting.cache_action_sc , 'cache mode'   , ', ' ],
         'center'         : aa_sel_e,
         'cealign'        : aa_sel_e,
+        'cealign_batch'  : aa_sel_e,
         'centerofmass'   : aa_sel_e,
         'color'          : [ lambda c=self_cmd:c._get_color_sc(c), 'color'       , ', ' ],
         'color_deep'     : [ lambda c=self_cmd:c._get_color_sc(c), 'color'       , ', ' ],
@@ -166,6 +167,8 @@ def get_auto_arg_list(self_cmd=cmd):
         'rebuild'        : aa_sel_e,
         'reference'      : [ self_cmd.editing.ref_action_sc  , 'action'          , ', ' ],
         'remove'         : aa_sel_e,
+        'rms_cluster'    : aa_sel_e,
+        'rms_matrix'     : aa_sel_e,
         'reinitialize'   : [ self_cmd.commanding.reinit_sc   , 'option'          , ''   ],
         'scene'          : aa_scene_e,
         'sculpt_activate': aa_obj_e,
@@ -212,6 +215,7 @@ def get_auto_arg_list(self_cmd=cmd):
         'button'         : [ self_cmd.controlling.but_mod_sc , 'modifier'        , ', ' ],
         'cache'          : aa_scene_e,
         'cealign'        : aa_sel_e,
+        'cealign_batch'  : aa_sel_e,
         'clean'          : aa_sel_e,
         'color'          : aa_sel_e,
         'color_deep'     : aa_obj_e,
@@ -507,8 +507,14 @@ SEE ALSO
         '''
 DESCRIPTION
 
-    "undo" restores the previous conformation of the object currently
-    being edited.
+    "undo" reverts the object currently being edited to its previous
+    undo checkpoint, restoring coordinates, atom properties (b, q, vdw,
+    color, representations, ...) and bonds.
+
+    Checkpoints are only recorded by editing operations (dragging,
+    torsions, inverting) and by "push_undo". Commands like "alter",
+    "bond", "unbond" or "color" do not record one, call "push_undo"
+    before them to make their changes undoable.
 
 USAGE
 
@@ -531,8 +537,10 @@ SEE ALSO
         '''
 DESCRIPTION
 
-    "push_undo" stores the current conformations of objects in the
-    selection onto their individual undo rings.
+    "push_undo" records all changes to objects in the selection since
+    their previous "push_undo" as one step in their individual undo
+    histories. Only changed atoms are stored, the total size of each
+    history is limited by the "undo_max_memory" setting (in MB).
 
     Notice: This command is only partly implemented in open-source PyMOL.
 
@@ -560,7 +568,7 @@ SEE ALSO
         '''
 DESCRIPTION
 
-    "redo" reapplies the conformational change of the object currently
+    "redo" reapplies the last undone change of the object currently
     being edited.
 
 USAGE
@@ -20,6 +20,7 @@ if True:
     cmd = __import__("sys").modules["pymol.cmd"]
     import threading
     import pymol
+    from pymol.shortcut import Shortcut
     import string
 
     def get_bond_print(obj,max_bond,max_type,_self=cmd):
@@ -70,6 +71,66 @@ DESCRIPTION
         return r
 
 
+    def get_memory_usage(name="all", quiet=1, _self=cmd):
+        '''
+DESCRIPTION
+
+    "get_memory_usage" returns the memory held by objects, per state and
+    per category, as a nested dictionary:
+
+        {object: {state: {category: (host_bytes, gpu_bytes)}}}
+
+    State 0 holds data which doesn't belong to a state (atoms, bonds,
+    undo history, object level settings). Categories are atoms, bonds,
+    coords, settings, selections, undo, map, other, and one per
+    representation (e.g. "rep:cartoon", including its GPU buffers).
+
+    If name is "all", the selection and setting stores are reported
+    under the object name "" (without the parts owned by objects).
+
+USAGE
+
+    get_memory_usage [ name [, quiet ]]
+
+SEE ALSO
+
+    memory_report
+        '''
+        with _self.lockcm:
+            records = _cmd.get_memory_accounting(_self._COb, str(name))
+        usage = {}
+        for (obj, state, category, host, gpu) in records:
+            usage.setdefault(obj, {}).setdefault(state + 1, {})[category] = (host, gpu)
+        if not int(quiet):
+            print(" get_memory_usage: %d bytes host, %d bytes GPU" % (
+                sum(r[3] for r in records), sum(r[4] for r in records)))
+        return usage
+
+    def memory_report(name="all", limit=20, _self=cmd):
+        '''
+DESCRIPTION
+
+    "memory_report" prints the memory held by objects, by category and
+    by object, followed by the largest object/state/category entries.
+
+USAGE
+
+    memory_report [ name [, limit ]]
+
+ARGUMENTS
+
+    name = str: object name pattern {default: all}
+
+    limit = int: number of largest entries to list, -1 for all {default: 20}
+
+SEE ALSO
+
+    get_memory_usage
+        '''
+        with _self.lockcm:
+            report = _cmd.memory_report(_self._COb, str(name), int(limit))
+        print(report.rstrip())
+
     def check(selection=None, preserve=0):
         '''
 DESCRIPTION
@@ -206,6 +267,51 @@ DESCRIPTION
         if _self._raising(r,_self): raise pymol.CmdException
         return r
 
+    trace_action_dict = {'status': 0, 'start': 1, 'stop': 2}
+    trace_action_sc = Shortcut(trace_action_dict.keys())
+
+    def trace(action="status", filename="", quiet=0, _self=cmd):
+        '''
+DESCRIPTION
+
+    "trace" records a timeline of where PyMOL spends its time (scene
+    updates, representation builds, ray tracing phases and threads,
+    selections, file loading). The timeline is written in the Chrome
+    trace event format, which can be opened in chrome://tracing or
+    https://ui.perfetto.dev
+
+    This is a debugging feature, not an official part of the API.
+
+USAGE
+
+    trace [ action [, filename ]]
+
+ARGUMENTS
+
+    action = start, stop or status {default: status}
+
+    filename = str: write the recorded events to this file {default:
+    don't write}
+
+EXAMPLE
+
+    trace start
+    fetch 1ubq, async=0
+    as surface
+    ray
+    trace stop, trace.json
+
+    '''
+        action = trace_action_dict[trace_action_sc.auto_err(action, 'action')]
+        with _self.lockcm:
+            running, count = _cmd.trace(_self._COb, action, str(filename))
+        if not int(quiet):
+            print(" Trace: %s, %d events recorded." %
+                    ("running" if running else "stopped", count))
+            if filename:
+                print(" Trace: wrote '%s'." % filename)
+        return count
+
     def load_coords(model, oname, state=1): # UNSUPPORTED
         '''
         WARNING: buggy argument list, state get's decremented twice!
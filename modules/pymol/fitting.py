@@ -134,6 +134,86 @@ SEE ALSO
                 if _self._raising(r,_self): raise pymol.CmdException
                 return ( {"alignment_length": aliLen, "RMSD" : RMSD, "rotation_matrix" : rotMat } )
 
+        def cealign_batch(target, mobile, target_state=1, mobile_state=1,
+                          quiet=1, guide=1, d0=3.0, d1=4.0, window=8,
+                          gap_max=30, transform=0, *, _self=cmd):
+                '''
+DESCRIPTION
+
+    "cealign_batch" aligns every object in "mobile" onto "target" using
+    the CE algorithm. The pairs are aligned in parallel and the target
+    is only prepared once, which makes this much faster than calling
+    "cealign" in a loop when screening a large set of structures.
+
+USAGE
+
+    cealign_batch target, mobile [, target_state [, mobile_state [,
+        quiet [, guide [, d0 [, d1 [, window [, gap_max [, transform ]]]]]]]]]
+
+ARGUMENTS
+
+    target = string: atom selection of the target
+
+    mobile = string: atom selection spanning any number of objects
+
+    transform = 0/1: transform the mobile objects {default: 0}
+
+    See "cealign" for the other arguments.
+
+PYMOL API
+
+    cmd.cealign_batch(...) returns a list of dictionaries with keys
+    "object", "alignment_length", "RMSD" and "rotation_matrix" (None
+    for objects which could not be aligned)
+
+SEE ALSO
+
+    cealign, extra_fit, alignto
+                '''
+                quiet = int(quiet)
+                window = int(window)
+                guide = "" if int(guide)==0 else "and guide"
+
+                if window < 3:
+                        raise pymol.CmdException("window size must be an integer greater than 2.")
+                if int(gap_max) < 0:
+                        raise pymol.CmdException("gap_max must be a positive integer.")
+
+                target = selector.process("(%s) %s" % (target, guide))
+                mobile = selector.process("(%s) %s" % (mobile, guide))
+
+                sel1 = _self.get_model(target, state=target_state).get_coord_list()
+                if len(sel1) < 2 * window:
+                        raise pymol.CmdException("Your target selection is too short.")
+
+                models = _self.get_object_list(mobile)
+                sels2 = [_self.get_model("(%s) and ?%s" % (mobile, model),
+                                         state=mobile_state).get_coord_list()
+                         for model in models]
+
+                with _self.lockcm:
+                        r = _cmd.cealign_batch(_self._COb, sel1, sels2,
+                                float(d0), float(d1), window, int(gap_max))
+
+                results = []
+                for model, ri in zip(models, r):
+                        if ri is None:
+                                if not quiet:
+                                        print(" CEalign-Error: alignment of %s failed" % model)
+                                results.append({"object": model, "alignment_length": 0,
+                                                "RMSD": None, "rotation_matrix": None})
+                                continue
+
+                        (aliLen, RMSD, rotMat, i1, i2) = ri
+                        if not quiet:
+                                print(" %-20s RMSD %f over %i residues" % (model, RMSD, aliLen))
+                        if int(transform):
+                                _self.transform_object(model, rotMat, state=0)
+                        results.append({"object": model, "alignment_length": aliLen,
+                                        "RMSD": RMSD, "rotation_matrix": rotMat})
+
+                return results
+
         def extra_fit(selection='(all)', reference='', method='align', zoom=1,
                 quiet=0, *, _self=cmd, **kwargs):
             '''
@@ -540,6 +620,102 @@ SEE ALSO
                 if _self._raising(r,_self): raise pymol.CmdException
                 return r
 
+        def _parse_states(states):
+                '''
+    Convert a states argument (0 for all, sequence of states, or string
+    like "1-10 15") to a list of 0-based state indices.
+                '''
+                if isinstance(states, str):
+                        parsed = []
+                        for tok in states.replace(',', ' ').split():
+                                first, _, last = tok.partition('-')
+                                parsed.extend(range(int(first), int(last or first) + 1))
+                        states = parsed
+                elif not isinstance(states, (list, tuple)):
+                        states = [states] if int(states) > 0 else []
+                return [int(s) - 1 for s in states]
+
+        def rms_matrix(selection, states=0, fit=1, quiet=1, *, _self=cmd):
+                '''
+DESCRIPTION
+
+    "rms_matrix" calculates the all-vs-all RMSD matrix of the states
+    of an object over an atom selection. All states must contain all
+    selected atoms.
+
+USAGE
+
+    rms_matrix selection [, states [, fit ]]
+
+ARGUMENTS
+
+    selection = string: atoms to compare (within one object)
+
+    states = int, list or str: states to compare, e.g. "1-100" {default: 0 (all)}
+
+    fit = 0/1: RMSD after superposition of each pair, or in place {default: 1}
+
+PYTHON EXAMPLE
+
+    from pymol import cmd
+    m = cmd.rms_matrix("name CA")
+
+SEE ALSO
+
+    rms_cluster, intra_rms, intra_rms_cur
+                '''
+                selection = selector.process(selection)
+                with _self.lockcm:
+                        states, matrix = _cmd.rms_matrix(_self._COb, selection,
+                                _parse_states(states), int(fit))
+                if not int(quiet):
+                        print(" rms_matrix: %d states, max RMSD %.3f" % (len(states),
+                                max((max(row) for row in matrix), default=0.0)))
+                return matrix
+
+        def rms_cluster(selection, cutoff=1.0, states=0, fit=1, quiet=1, *, _self=cmd):
+                '''
+DESCRIPTION
+
+    "rms_cluster" clusters the states of an object by RMSD over an atom
+    selection (Daura et al. 1999): The state with the most neighbors
+    within "cutoff" becomes a cluster center, it is removed together with
+    its neighbors, and this is repeated until no states are left.
+
+USAGE
+
+    rms_cluster selection [, cutoff [, states [, fit ]]]
+
+ARGUMENTS
+
+    selection = string: atoms to compare (within one object)
+
+    cutoff = float: RMSD cutoff for neighbors {default: 1.0}
+
+    states = int, list or str: states to cluster {default: 0 (all)}
+
+    fit = 0/1: RMSD after superposition {default: 1}
+
+RETURNS
+
+    List of clusters (largest first), each a list of states with the
+    cluster center first.
+
+SEE ALSO
+
+    rms_matrix
+                '''
+                selection = selector.process(selection)
+                with _self.lockcm:
+                        r = _cmd.rms_cluster(_self._COb, selection,
+                                _parse_states(states), int(fit), float(cutoff))
+                clusters = [[s + 1 for s in cluster] for cluster in r]
+                if not int(quiet):
+                        for i, cluster in enumerate(clusters, 1):
+                                print(" rms_cluster: cluster %d: %d states, center %d" % (
+                                        i, len(cluster), cluster[0]))
+                return clusters
+
         def fit(mobile, target, mobile_state=0, target_state=0,
 		quiet=1, matchmaker=0, cutoff=2.0, cycles=0, object=None, *, _self=cmd):
             '''
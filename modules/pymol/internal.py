@@ -127,55 +127,6 @@ def _cache_set(new_entry, max_size, _self=cmd):
             traceback.print_exc()
     return r
 
-# ray tracing threads
-
-def _ray_anti_spawn(thread_info,_self=cmd):
-    # WARNING: internal routine, subject to change
-    # internal routine to support multithreaded raytracing
-    thread_list = []
-    for a in thread_info[1:]:
-        t = threading.Thread(target=_cmd.ray_anti_thread,
-                                    args=(_self._COb,a))
-        t.setDaemon(1)
-        thread_list.append(t)
-    for t in thread_list:
-        t.start()
-    _cmd.ray_anti_thread(_self._COb,thread_info[0])
-    for t in thread_list:
-        t.join()
-
-def _ray_hash_spawn(thread_info,_self=cmd):
-    # WARNING: internal routine, subject to change
-    # internal routine to support multithreaded raytracing
-    thread_list = []
-    for a in thread_info[1:]:
-        if a is not None:
-            t = threading.Thread(target=_cmd.ray_hash_thread,
-                                 args=(_self._COb,a))
-            t.setDaemon(1)
-            thread_list.append(t)
-    for t in thread_list:
-        t.start()
-    if thread_info[0] is not None:
-        _cmd.ray_hash_thread(_self._COb,thread_info[0])
-    for t in thread_list:
-        t.join()
-
-def _ray_spawn(thread_info,_self=cmd):
-    # WARNING: internal routine, subject to change
-    # internal routine to support multithreaded raytracing
-    thread_list = []
-    for a in thread_info[1:]:
-        t = threading.Thread(target=_cmd.ray_trace_thread,
-                                    args=(_self._COb,a))
-        t.setDaemon(1)
-        thread_list.append(t)
-    for t in thread_list:
-        t.start()
-    _cmd.ray_trace_thread(_self._COb,thread_info[0])
-    for t in thread_list:
-        t.join()
-
 def _coordset_update_thread(list_lock,thread_info,_self=cmd):
     # WARNING: internal routine, subject to change
     while 1:
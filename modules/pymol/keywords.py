@@ -35,6 +35,7 @@ def get_command_keywords(self_cmd=cmd):
         'cartoon'       : [ self_cmd.cartoon           , 0 , 0 , ''  , parsing.STRICT ],
         'capture'       : [ self_cmd.capture           , 0 , 0 , ''  , parsing.STRICT ],
         'cealign'       : [ self_cmd.cealign	       , 0 , 0 , ''  , parsing.STRICT ],
+        'cealign_batch' : [ self_cmd.cealign_batch     , 0 , 0 , ''  , parsing.STRICT ],
         'centerofmass'  : [ self_cmd.centerofmass      , 0 , 0 , ''  , parsing.STRICT ],
         'cd'            : [ self_cmd.cd                , 0 , 0 , ''  , parsing.STRICT ],
         'center'        : [ self_cmd.center            , 0 , 0 , ''  , parsing.STRICT ],
@@ -107,6 +108,8 @@ def get_command_keywords(self_cmd=cmd):
         'get_dihedral'  : [ self_cmd.get_dihedral      , 0 , 0 , ''  , parsing.STRICT ],
         'get_distance'  : [ self_cmd.get_distance      , 0 , 0 , ''  , parsing.STRICT ],
         'get_extent'    : [ self_cmd.get_extent        , 0 , 0 , ''  , parsing.STRICT ],
+        'get_lod_stats' : [ self_cmd.get_lod_stats     , 0 , 0 , ''  , parsing.STRICT ],
+        'get_memory_usage' : [ self_cmd.get_memory_usage , 0 , 0 , ''  , parsing.STRICT ],
         'get_position'  : [ self_cmd.get_position      , 0 , 0 , ''  , parsing.STRICT ],
         'get_sasa_relative' : [ self_cmd.get_sasa_relative , 0 , 0 , ''  , parsing.STRICT ],
         'get_symmetry'  : [ self_cmd.get_symmetry      , 0 , 0 , ''  , parsing.STRICT ],
@@ -169,6 +172,7 @@ def get_command_keywords(self_cmd=cmd):
         'mcopy'         : [ self_cmd.mcopy             , 0 , 0 , ''  , parsing.STRICT ],
         'mdelete'       : [ self_cmd.mdelete           , 0 , 0 , ''  , parsing.STRICT ],
         'mem'           : [ self_cmd.mem               , 0 , 0 , ''  , parsing.STRICT ],
+        'memory_report' : [ self_cmd.memory_report     , 0 , 0 , ''  , parsing.STRICT ],
         'meter_reset'   : [ self_cmd.meter_reset       , 0 , 0 , ''  , parsing.STRICT ],
         'minsert'       : [ self_cmd.minsert           , 0 , 0 , ''  , parsing.STRICT ],
         'mmove'         : [ self_cmd.mmove             , 0 , 0 , ''  , parsing.STRICT ],
@@ -232,6 +236,8 @@ def get_command_keywords(self_cmd=cmd):
         'run'           : [ self_cmd.run               , 0 , 0 , ',' , parsing.SECURE ], # insecure
         'rms'           : [ self_cmd.rms               , 0 , 0 , ''  , parsing.STRICT ],
         'rms_cur'       : [ self_cmd.rms_cur           , 0 , 0 , ''  , parsing.STRICT ],
+        'rms_cluster'   : [ self_cmd.rms_cluster       , 0 , 0 , ''  , parsing.STRICT ],
+        'rms_matrix'    : [ self_cmd.rms_matrix        , 0 , 0 , ''  , parsing.STRICT ],
         'save'          : [ self_cmd.save              , 0 , 0 , ''  , parsing.SECURE ],
         'scene'         : [ self_cmd.scene             , 0 , 0 , ''  , parsing.STRICT ],
         'scene_order'   : [ self_cmd.scene_order       , 0 , 0 , ''  , parsing.STRICT ],
@@ -270,6 +276,7 @@ def get_command_keywords(self_cmd=cmd):
         'system'        : [ self_cmd.system            , 0 , 0 , ''  , parsing.LITERAL ],
         'toggle'        : [ self_cmd.toggle            , 0 , 0 , ''  , parsing.STRICT ],
         'torsion'       : [ self_cmd.torsion           , 0 , 0 , ''  , parsing.STRICT ], # vs toggle_object
+        'trace'         : [ self_cmd.trace             , 0 , 0 , ''  , parsing.STRICT ],
         'translate'     : [ self_cmd.translate         , 0 , 0 , ''  , parsing.STRICT ],
         'try'           : [ self_cmd.python_help       , 0 , 0 , ''  , parsing.PYTHON ],
         'turn'          : [ self_cmd.turn              , 0 , 0 , ''  , parsing.STRICT ],
@@ -403,6 +403,9 @@ NOTES
     will be ray-traced.  Note that this can take many hours for a long
     movie with complex content displayed.
 
+    On Linux, the "movie_workers" setting can be used to ray-trace
+    several frames in parallel with forked worker processes.
+
     Also, be sure to avoid setting "cache_frames" when rendering a
     long movie to avoid running out of memory.
     
@@ -870,6 +870,34 @@ DESCRIPTION
 
         return r
 
+    def get_lod_stats(quiet=1, *, _self=cmd):
+        '''
+DESCRIPTION
+
+    "get_lod_stats" reports how many representation chunks and
+    triangles were rendered at each detail level in the last frame
+    (drawn or ray traced). See the "level_of_detail" setting.
+
+USAGE
+
+    get_lod_stats
+
+PYMOL API
+
+    cmd.get_lod_stats(quiet=1)
+
+    Returns a list of (chunks, triangles) tuples, indexed by level
+    (0 = full detail).
+        '''
+        with _self.lockcm:
+            r = _cmd.get_lod_stats(_self._COb)
+
+        if not int(quiet):
+            for level, (chunks, triangles) in enumerate(r):
+                print(" Level %d: %d chunks, %d triangles" % (level, chunks, triangles))
+
+        return r
+
     def get_phipsi(selection="(name CA)", state=CURRENT_STATE, *, _self=cmd):
         # preprocess selections
         selection = selector.process(selection)
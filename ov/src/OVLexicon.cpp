@@ -247,6 +247,20 @@ OVstatus OVLexicon_IncRef(OVLexicon * uk, ov_word id)
   }
 }
 
+OVstatus OVLexicon_IncRefN(OVLexicon * uk, ov_word id, ov_word n)
+{
+  if((!uk->entry) || (id < 1) || (id > (ov_word) uk->n_entry)) {        /* range checking */
+    return_OVstatus_NOT_FOUND;
+  } else {
+    lex_entry *entry = uk->entry + id;
+    if(entry->ref_cnt < 1) {    /* only for live entries, like OVLexicon_IncRef */
+      return_OVstatus_INVALID_REF_CNT;
+    }
+    entry->ref_cnt += n;
+    return_OVstatus_SUCCESS;
+  }
+}
+
 OVreturn_word OVLexicon_GetFromCString(OVLexicon * uk, const ov_char8 * str)
 {
   ov_word hash = _GetCStringHash((ov_uchar8 *) str);
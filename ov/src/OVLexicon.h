@@ -23,6 +23,7 @@ void OVLexicon_Del(OVLexicon * I);
 OVreturn_word OVLexicon_GetFromCString(OVLexicon * uk, const ov_char8 * str);
 
 OVstatus OVLexicon_IncRef(OVLexicon * uk, ov_word id);
+OVstatus OVLexicon_IncRefN(OVLexicon * uk, ov_word id, ov_word n);
 OVstatus OVLexicon_DecRef(OVLexicon * uk, ov_word id);
 
 ov_char8 *OVLexicon_FetchCString(OVLexicon * uk, ov_word id);
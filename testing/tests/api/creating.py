@@ -264,6 +264,63 @@ class TestCreating(testing.PyMOLTestCase):
             self.assertEquals(cmd.get_state(), 2)
             self.assertImageHasColor(gradcolor)
 
+    def _brute_force_coulomb(self, mapname, selection, cutoff=0.0):
+        import numpy
+        model = cmd.get_model(selection)
+        xyz = numpy.array([a.coord for a in model.atom])
+        q = numpy.array([a.partial_charge * a.q for a in model.atom])
+        q *= cmd.get_setting_float('coulomb_units_factor') / \
+             cmd.get_setting_float('coulomb_dielectric')
+
+        field = cmd.get_volume_field(mapname)
+        lo, hi = cmd.get_extent(mapname)
+        axes = [numpy.linspace(lo[i], hi[i], field.shape[i]) for i in range(3)]
+        grid = numpy.stack(numpy.meshgrid(*axes, indexing='ij'), -1)
+
+        d = numpy.linalg.norm(grid[..., None, :] - xyz, axis=-1)
+        with numpy.errstate(divide='ignore'):
+            pot = numpy.where(d > 1e-4, q / d, 0.0)
+        if cutoff > 0.0:
+            pot = numpy.where(d < cutoff, pot * (1.0 - (d / cutoff)**2), 0.0)
+        return field, pot.sum(-1)
+
+    @testing.requires_version('3.1')
+    def testMapNewCoulomb(self):
+        import numpy
+        cmd.fragment('arg', 'm1')
+        cmd.fragment('glu', 'm2')
+        cmd.translate([4., 0., 0.], 'm2')
+
+        cmd.map_new('map1', 'coulomb', 0.7, 'm1 m2', 3.0)
+        field, ref = self._brute_force_coulomb('map1', 'm1 m2')
+        self.assertTrue(numpy.allclose(field, ref, rtol=1e-3, atol=1e-3))
+
+        cutoff = cmd.get_setting_float('coulomb_cutoff')
+        cmd.map_new('map2', 'coulomb_local', 0.7, 'm1 m2', 3.0)
+        field, ref = self._brute_force_coulomb('map2', 'm1 m2', cutoff)
+        self.assertTrue(numpy.allclose(field, ref, rtol=1e-3, atol=1e-3))
+
+    @testing.requires_version('3.1')
+    def testMapNewCoulombMesh(self):
+        import numpy
+        cmd.fragment('arg', 'm1')
+        cmd.fragment('glu', 'm2')
+        cmd.translate([4., 0., 0.], 'm2')
+
+        # small split distance, so the coarse grid part matters
+        cmd.set('coulomb_cutoff', 4.0)
+        cmd.map_new('map1', 'coulomb_mesh', 0.7, 'm1 m2', 3.0)
+        field, ref = self._brute_force_coulomb('map1', 'm1 m2')
+        rms_err = numpy.sqrt(numpy.mean((field - ref)**2))
+        rms_ref = numpy.sqrt(numpy.mean(ref**2))
+        self.assertLess(rms_err, 0.01 * rms_ref)
+
+        # no split distance, falls back to the exact sum
+        cmd.set('coulomb_cutoff', 0.0)
+        cmd.map_new('map2', 'coulomb_mesh', 0.7, 'm1 m2', 3.0)
+        field, ref = self._brute_force_coulomb('map2', 'm1 m2')
+        self.assertTrue(numpy.allclose(field, ref, rtol=1e-3, atol=1e-3))
+
     def testCopy(self):
         cmd.fragment('ala', 'm1')
         cmd.copy('m2', 'm1')
@@ -531,12 +531,79 @@ class TestEditing(testing.PyMOLTestCase):
         self.assertEqual([1.,1.,1.], cmd.get_atom_coords('m1`2'))
 
     def test_push_undo(self):
-        cmd.push_undo
-        self.skipTest("TODO")
+        cmd.fragment('ala', 'm1')
+        xyz = get_coord_list('m1')
+        nbond = len(cmd.get_model('m1').bond)
+        b = cmd.get_model('m1 & name CA').atom[0].b
+
+        cmd.push_undo('m1')
+        cmd.translate([1., 0., 0.], 'm1 & name CB')
+        cmd.alter('m1 & name CA', 'b = 10.')
+        cmd.unbond('m1 & name CA', 'm1 & name CB')
+        self.assertEqual(nbond - 1, len(cmd.get_model('m1').bond))
+
+        cmd.undo()
+        self.assertEqual(xyz, get_coord_list('m1'))
+        self.assertEqual(b, cmd.get_model('m1 & name CA').atom[0].b)
+        self.assertEqual(nbond, len(cmd.get_model('m1').bond))
+
+        # nothing left to undo
+        cmd.undo()
+        self.assertEqual(xyz, get_coord_list('m1'))
 
     def test_redo(self):
-        cmd.redo
-        self.skipTest("TODO")
+        cmd.fragment('ala', 'm1')
+        xyz0 = get_coord_list('m1')
+        cmd.push_undo('m1')
+        cmd.alter_state(1, 'm1', 'x = x + 1.')
+        xyz1 = get_coord_list('m1')
+        cmd.push_undo('m1')
+        cmd.alter_state(1, 'm1', 'y = y + 1.')
+        xyz2 = get_coord_list('m1')
+
+        cmd.undo()
+        self.assertEqual(xyz1, get_coord_list('m1'))
+        cmd.undo()
+        self.assertEqual(xyz0, get_coord_list('m1'))
+        cmd.redo()
+        self.assertEqual(xyz1, get_coord_list('m1'))
+        cmd.redo()
+        self.assertEqual(xyz2, get_coord_list('m1'))
+
+        # new edits discard the redo history
+        cmd.undo()
+        cmd.alter_state(1, 'm1', 'z = z + 1.')
+        xyz3 = get_coord_list('m1')
+        cmd.redo()
+        self.assertEqual(xyz3, get_coord_list('m1'))
+
+    def test_undo_max_memory(self):
+        cmd.set('undo_max_memory', 0)
+        cmd.fragment('ala', 'm1')
+        cmd.push_undo('m1')
+        cmd.alter_state(1, 'm1', 'x = x + 1.')
+        xyz1 = get_coord_list('m1')
+        cmd.push_undo('m1')
+        cmd.alter_state(1, 'm1', 'y = y + 1.')
+
+        # only the most recent step is kept
+        cmd.undo()
+        cmd.undo()
+        self.assertEqual(xyz1, get_coord_list('m1'))
+
+    def test_undo_after_sort(self):
+        cmd.fragment('ala', 'm1')
+        cmd.push_undo('m1')
+        cmd.translate([1., 0., 0.], 'm1 & name CB')
+        xyz = {a.name: a.coord for a in cmd.get_model('m1').atom}
+
+        # same number of atoms, different order
+        cmd.alter('m1 & name CB', 'resi = "0"')
+        cmd.sort('m1')
+
+        # reordering invalidates the history, must not scramble coordinates
+        cmd.undo()
+        self.assertEqual(xyz, {a.name: a.coord for a in cmd.get_model('m1').atom})
 
     def test_reference(self):
         # undocumented
@@ -35,3 +35,68 @@ class TestExperimenting(testing.PyMOLTestCase):
         cmd.viewport(100, 100)
         cmd.fragment('gly', 'm1')
         cmd.focal_blur(4.0, 3)
+
+    def testTrace(self):
+        import json
+        cmd.trace('start', quiet=1)
+        cmd.fragment('gly', 'm1')
+        cmd.show_as('sticks')
+        cmd.select('s1', 'elem C')
+        with testing.mktemp('.json') as filename:
+            count = cmd.trace('stop', filename, quiet=1)
+            self.assertTrue(count > 0)
+            with open(filename) as handle:
+                events = json.load(handle)['traceEvents']
+        names = set(event['name'] for event in events)
+        self.assertTrue('SelectorSelect' in names)
+        # nothing recorded after stop
+        cmd.select('s2', 'elem N')
+        self.assertEqual(count, cmd.trace(quiet=1))
+
+    def testGetMemoryUsage(self):
+        cmd.fragment('trp', 'm1')
+        cmd.create('m1', 'm1', 1, 2)
+        usage = cmd.get_memory_usage('m1')
+        self.assertEqual(set(usage), {'m1'})
+        m1 = usage['m1']
+        self.assertTrue(m1[0]['atoms'][0] > 0)
+        self.assertTrue(m1[0]['bonds'][0] > 0)
+        self.assertTrue(m1[1]['coords'][0] > 0)
+        self.assertTrue(m1[2]['coords'][0] > 0)
+        # global stores only reported for "all"
+        self.assertTrue('' in cmd.get_memory_usage())
+
+    def testGetMemoryUsageOtherObjects(self):
+        cmd.fragment('trp', 'm1')
+        cmd.map_new('map1', 'gaussian', 0.5, 'm1')
+        cmd.slice_new('slice1', 'map1')
+        cmd.ramp_new('ramp1', 'map1')
+        cmd.refresh()
+        usage = cmd.get_memory_usage()
+        self.assertTrue(usage['ramp1'][0]['other'][0] > 0)
+        self.assertTrue(usage['ramp1'][1]['coords'][0] > 0)
+        self.assertTrue('rep:slice' in usage['slice1'][1])
+
+    def testMemoryReport(self):
+        import contextlib
+        import io
+
+        def host_total():
+            usage = cmd.get_memory_usage()
+            return sum(cat[0]
+                    for states in usage.values()
+                    for categories in states.values()
+                    for cat in categories.values())
+
+        cmd.fragment('gly', 'm1')
+        total = host_total()
+        self.assertTrue(total > 0)
+
+        out = io.StringIO()
+        with contextlib.redirect_stdout(out):
+            cmd.memory_report()
+            cmd.memory_report('m1', -1)
+        self.assertTrue('m1' in out.getvalue())
+
+        cmd.delete('m1')
+        self.assertTrue(host_total() < total)
@@ -27,6 +27,18 @@ class TestFitting(testing.PyMOLTestCase):
         self.assertEqual(alen, 40)
         self.assertEqual(alen, cmd.count_atoms("aln") / 2)
 
+    def testCealignBatch(self):
+        cmd.load(self.datafile("1oky-frag.pdb"), "m1")
+        cmd.load(self.datafile("1t46-frag.pdb"), "m2")
+        cmd.create("m3", "m1")
+        r = cmd.cealign_batch("m2", "m1 m3")
+        self.assertEqual([x["object"] for x in r], ["m1", "m3"])
+        for x in r:
+            self.assertAlmostEqual(x["RMSD"], 1.90375, delta=1e-4)
+            self.assertEqual(x["alignment_length"], 40)
+        ref = cmd.cealign("m2", "m1", transform=0)
+        self.assertArrayEqual(r[0]["rotation_matrix"], ref["rotation_matrix"], delta=1e-4)
+
     def testFit(self):
         cmd.fragment("gly", "m1")
         cmd.create("m2", "m1")
@@ -47,6 +59,25 @@ class TestFitting(testing.PyMOLTestCase):
         rms_list = cmd.intra_rms_cur("m1")
         self.assertArrayEqual(rms_list, [-1.0, 0.0])
 
+    def testIntraFitBatchMatchesFallback(self):
+        # m1 has no unit cell and takes the batch path, m2 has a cell which
+        # is large enough to not wrap anything and takes the per-state path
+        cmd.fragment("trp", "m1")
+        for state in range(2, 5):
+            cmd.create("m1", "m1", 1, state)
+            cmd.rotate("x", 20 * state, "m1", state=state, camera=0)
+            cmd.translate([state, 0.5, -1.0], "m1", state=state, camera=0)
+        cmd.alter_state(3, "m1 and name CZ2", "x = x + 0.7")
+        cmd.copy("m2", "m1")
+        cmd.set_symmetry("m2", 500, 500, 500, 90, 90, 90, "P 1")
+        rms1 = cmd.intra_fit("m1")
+        rms2 = cmd.intra_fit("m2")
+        self.assertArrayEqual(rms1, rms2, delta=1e-4)
+        for state in range(1, 5):
+            self.assertArrayEqual(
+                cmd.get_coords("m1", state),
+                cmd.get_coords("m2", state), delta=1e-3)
+
     def testIntraRms(self):
         # see intra_fit
         pass
@@ -55,6 +86,24 @@ class TestFitting(testing.PyMOLTestCase):
         # see intra_fit
         pass
 
+    def testRmsMatrix(self):
+        cmd.fragment("trp", "m1")
+        cmd.create("m1", "m1", 1, 2)
+        cmd.create("m1", "m1", 1, 3)
+        cmd.rotate("x", 40, "m1", state=3, camera=0)
+        cmd.translate([1.0, 2.0, 3.0], "m1", state=3, camera=0)
+        cmd.alter_state(2, "m1 and name CZ2", "x = x + 1.0")
+        m = cmd.rms_matrix("m1")
+        self.assertEqual(len(m), 3)
+        self.assertAlmostEqual(m[0][2], 0.0, delta=1e-3)
+        self.assertAlmostEqual(m[0][1], m[1][0], delta=1e-6)
+        self.assertAlmostEqual(m[0][1], cmd.intra_rms("m1", 1)[1], delta=1e-3)
+        m = cmd.rms_matrix("m1", states="1-2", fit=0)
+        self.assertEqual(len(m), 2)
+        self.assertAlmostEqual(m[0][1], (1.0 / cmd.count_atoms("m1")) ** 0.5, delta=1e-4)
+        clusters = cmd.rms_cluster("m1", 0.1)
+        self.assertEqual(clusters, [[1, 3], [2]])
+
     def testPairFit(self):
         cmd.fragment('trp')
         cmd.fragment('his')
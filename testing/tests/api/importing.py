@@ -445,6 +445,32 @@ class TestImporting(testing.PyMOLTestCase):
         cmd.read_pdbstr(pdbstr, 'm1')
         self.assertEqual(2, cmd.count_states())
 
+    def testReadPdbstrEnsemble(self):
+        atoms = pdbstr.splitlines()[:-1]
+        models = []
+        for m in range(6):
+            lines = ['MODEL     %4d' % (m + 1)]
+            for i, line in enumerate(atoms):
+                if m == 3 and i == 2:
+                    continue  # not the same atoms, general reader
+                x = float(line[30:38]) + m
+                lines.append(line[:30] + '%8.3f' % x + line[38:60] +
+                             '%6.2f' % m + line[66:])
+            lines.append('ENDMDL')
+            models.append('\n'.join(lines))
+        cmd.read_pdbstr('\n'.join(models) + '\nEND\n', 'm1')
+
+        self.assertEqual(6, cmd.count_states('m1'))
+        self.assertEqual(7, cmd.count_atoms('m1'))
+        self.assertEqual(6, cmd.count_atoms('m1', state=4))
+        for state in range(1, 7):
+            xyz = cmd.get_coords('name CA', state)
+            self.assertAlmostEqual(xyz[0][0], 0.230 + state - 1, delta=1e-4)
+            self.assertAlmostEqual(xyz[0][1], 0.318, delta=1e-4)
+
+        # B-factors from the last model, like before
+        self.assertAlmostEqual(cmd.get_model('name CA').atom[0].b, 5.0)
+
     def testReadSdfstr(self):
         sdfstr = molstr + '$$$$\n'
 
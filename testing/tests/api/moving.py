@@ -221,6 +221,33 @@ class TestMoving(testing.PyMOLTestCase):
             self.assertEqual(img.shape[:2], shape2)
             self.assertImageHasColor('blue', img)
 
+    def testMpngWorkers(self):
+        import glob, os, sys
+        if not sys.platform.startswith('linux'):
+            self.skipTest('requires fork')
+
+        shape2 = (40, 30)
+        cmd.pseudoatom('m1')
+        cmd.show_as('spheres')
+        cmd.mset("1x5")
+        cmd.mdo(1, 'bg_color red')
+        cmd.mdo(4, 'bg_color blue')
+        cmd.set('movie_workers', 2)
+
+        with testing.mkdtemp() as dirname:
+            cmd.mpng(os.path.join(dirname, 'image'), width=shape2[0],
+                     height=shape2[1], mode=2)
+            filenames = glob.glob(os.path.join(dirname, 'image*.png'))
+            filenames.sort()
+
+            self.assertEqual(5, len(filenames))
+
+            # cumulative frame commands are replayed in every worker
+            for i, color in enumerate(['red'] * 3 + ['blue'] * 2):
+                img = self.get_imagearray(filenames[i])
+                self.assertEqual(img.shape[:2], shape2[::-1])
+                self.assertImageHasColor(color, img)
+
     def testMset(self):
         # basic tet
         self.prep_movie()
@@ -183,6 +183,26 @@ class TestQuerying(testing.PyMOLTestCase):
     def testGetLegalName(self):
         self.assertEqual(cmd.get_legal_name("foo bar baz"), "foo_bar_baz")
 
+    def testGetLodStats(self):
+        cmd.load(self.datafile('1oky-frag.pdb'), 'm1')
+        cmd.show_as('cartoon')
+        cmd.orient()
+
+        cmd.ray(100, 100)
+        full = cmd.get_lod_stats()
+        self.assertEqual(len(full), 3)
+        self.assertTrue(full[0][0] > 0)
+        self.assertTrue(full[0][1] > 0)
+
+        # far away, coarsest level
+        cmd.set('level_of_detail')
+        cmd.move('z', -2000)
+        cmd.ray(100, 100)
+        r = cmd.get_lod_stats()
+        self.assertEqual(r[0], (0, 0))
+        self.assertTrue(r[2][0] > 0)
+        self.assertTrue(0 < r[2][1] < full[0][1])
+
     def testGetModalDraw(self):
         self.assertEqual(cmd.get_modal_draw(), 0)
 
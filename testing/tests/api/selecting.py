@@ -370,6 +370,17 @@ class TestSelecting(testing.PyMOLTestCase):
         # same result as the test_dummy_selectors test, but numbers are
         # different!
 
+    def test_around_after_move(self):
+        # spatial index must follow coordinate changes, any cutoff
+        cmd.pseudoatom('p1', pos=(0, 0, 0))
+        cmd.pseudoatom('p2', pos=(3, 0, 0))
+        self.assertEqual(cmd.count_atoms('p1 around 2'), 0)
+        self.assertEqual(cmd.count_atoms('p1 around 20'), 1)
+        cmd.translate([-1.5, 0, 0], 'p2', camera=0)
+        self.assertEqual(cmd.count_atoms('p1 around 2'), 1)
+        self.assertEqual(cmd.count_atoms('p1 around 1'), 0)
+        self.assertEqual(cmd.count_atoms('p2 within 1.6 of p1'), 1)
+
     # don't select center/origin with "all" keyword
     def test_no_all_dummy_selection(self):
         cmd.pseudoatom('p1', pos=(-1, 0, 0))
@@ -253,3 +253,26 @@ class TestSetting(testing.PyMOLTestCase):
             for o_set in b_level_values:
                 for b_set in o_set[1]:
                     self.assertEqual(None, b_set[2], msg=sname + ' ' + o_set[0] + ' ' + str(b_set))
+
+    def testSetRebuildsChangedObject(self):
+        # only the changed objects get updated, among many unchanged ones
+        for i in range(20):
+            cmd.pseudoatom('p%02d' % i, pos=(i * 3, 0, 0))
+        cmd.show_as('spheres')
+        cmd.color('white')
+        cmd.bg_color('black')
+        cmd.orient()
+        img = self.get_imagearray(width=100, height=100, ray=1)
+        self.assertImageHasNotColor('red', img)
+
+        cmd.set('sphere_color', 'red', 'p10')
+        img = self.get_imagearray(width=100, height=100, ray=1)
+        self.assertImageHasColor('red', img)
+
+        # changed while not in the scene
+        cmd.disable('p05')
+        cmd.set('sphere_color', 'blue', 'p05')
+        cmd.enable('p05')
+        img = self.get_imagearray(width=100, height=100, ray=1)
+        self.assertImageHasColor('blue', img)
+        self.assertImageHasColor('red', img)
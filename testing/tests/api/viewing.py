@@ -423,6 +423,55 @@ class TestViewing(testing.PyMOLTestCase):
         # tested in many other tests
         pass
 
+    def testRayLabelLayout(self):
+        cmd.pseudoatom('m1', label='WW\nW')
+        cmd.hide('everything')
+        cmd.show('labels')
+        cmd.set('label_color', 'red')
+        cmd.set('label_size', 20)
+        cmd.set('label_position', (0, 0, 0))
+        cmd.bg_color('white')
+        cmd.zoom(buffer=5)
+
+        # second image uses the cached layout
+        img1 = self.get_imagearray(width=100, height=100, ray=1)
+        img2 = self.get_imagearray(width=100, height=100, ray=1)
+        self.assertImageHasColor('red', img1, delta=30)
+        self.assertImageEqual(img1, img2)
+
+        # new text, new layout
+        cmd.label('m1', '"W"')
+        img3 = self.get_imagearray(width=100, height=100, ray=1)
+        self.assertImageHasColor('red', img3, delta=30)
+        self.assertFalse((img1 == img3).all())
+
+    def testRayRetainPrimitives(self):
+        cmd.fragment('trp')
+        cmd.show_as('sticks')
+        cmd.show('spheres', 'elem N')
+        cmd.set('sphere_scale', 0.3)
+        cmd.orient()
+
+        def ray_turned():
+            cmd.turn('y', 30)
+            return self.get_imagearray(width=100, height=100, ray=1)
+
+        # reuse of the primitives with a changed camera
+        cmd.set('ray_retain_primitives')
+        ray_turned()
+        img_retained = ray_turned()
+        cmd.turn('y', -60)
+        cmd.set('ray_retain_primitives', 0)
+        ray_turned()
+        img = ray_turned()
+        self.assertImageEqual(img, img_retained)
+
+        # changed rep
+        cmd.set('ray_retain_primitives')
+        ray_turned()
+        cmd.color('red', 'elem N')
+        self.assertImageHasColor('red', ray_turned())
+
     def testRefresh(self):
         cmd.refresh
         self.skipTest('TODO')
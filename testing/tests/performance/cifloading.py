@@ -0,0 +1,19 @@
+'''
+mmCIF loading (tokenizer and atom_site)
+'''
+
+from pymol import cmd, testing
+
+@testing.requires('no_run_all')
+class StressCIFLoading(testing.PyMOLTestCase):
+
+    def testMMCIFLoad(self):
+        # ~60k atoms, ~5 MB of text: large enough for the parallel tokenizer
+        cmd.load(self.datafile('1aon.pdb.gz'), 'm1')
+        natoms = cmd.count_atoms('m1')
+        with testing.mktemp('.cif') as filename:
+            cmd.save(filename, 'm1')
+            cmd.delete('*')
+            with self.timing('load_cif'):
+                cmd.load(filename, 'm2')
+        self.assertEqual(cmd.count_atoms('m2'), natoms)
@@ -0,0 +1,28 @@
+'''
+Map generation from atoms (map_new)
+'''
+
+from pymol import cmd, testing
+
+@testing.requires('no_run_all')
+class StressMapNew(testing.PyMOLTestCase):
+
+    def _load(self):
+        cmd.load(self.datafile('1oky.pdb.gz'), 'm1')
+        cmd.remove('solvent or hydro')
+        cmd.alter('m1', 'partial_charge = 0.5 if index % 2 else -0.5')
+
+    def testCoulomb(self):
+        self._load()
+        with self.timing('coulomb'):
+            cmd.map_new('map1', 'coulomb', 1.0, 'm1', 5.0)
+
+    def testCoulombLocal(self):
+        self._load()
+        with self.timing('coulomb_local'):
+            cmd.map_new('map1', 'coulomb_local', 0.5, 'm1', 5.0)
+
+    def testGaussian(self):
+        self._load()
+        with self.timing('gaussian'):
+            cmd.map_new('map1', 'gaussian', 0.5, 'm1', 5.0)
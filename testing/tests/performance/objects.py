@@ -0,0 +1,45 @@
+'''
+Sessions with many objects (object lookup and validation)
+'''
+
+from pymol import cmd, testing
+
+@testing.requires('no_run_all')
+class StressManyObjects(testing.PyMOLTestCase):
+
+    def testTenThousandObjects(self):
+        n = 10000
+
+        with self.timing('create'):
+            for i in range(n):
+                cmd.pseudoatom('ps%05d' % i, pos=(i % 100, i // 100, 0))
+
+        self.assertEqual(n, len(cmd.get_object_list()))
+
+        # every ramp colored atom validates the ramp's source object
+        cmd.ramp_new('rmp', 'ps00000', [0, 50], ['blue', 'red'])
+        cmd.show_as('spheres', 'ps*')
+        cmd.color('rmp', 'ps*')
+
+        with self.timing('ramp color', max=10.0):
+            cmd.ray(100, 100)
+
+        with self.timing('lookup'):
+            for i in range(0, n, 10):
+                cmd.get_object_matrix('ps%05d' % i)
+
+        with self.timing('delete'):
+            cmd.delete('ps*')
+
+        self.assertEqual(0, len(cmd.get_object_list()))
+
+@testing.requires('no_run_all')
+class StressCartoon(testing.PyMOLTestCase):
+
+    def testLargeAssembly(self):
+        # one object with many chains, extruded in parallel shards
+        cmd.load(self.datafile('1aon.pdb.gz'))
+        cmd.show_as('cartoon')
+
+        with self.timing('cartoon'):
+            cmd.ray(100, 100)
@@ -17,3 +17,13 @@ class StressPDBLoading(testing.PyMOLTestCase):
             cmd.load(self.datafile(dfile))
             tm.append(time.time() - start)
         print("min time('", dfile, "')=", min(tm))
+
+    def testEnsembleLoad(self):
+        cmd.load(self.datafile('1rx1.pdb'), 'm1')
+        for state in range(2, 501):
+            cmd.create('m1', 'm1', 1, state)
+        pdbstr = cmd.get_pdbstr('m1', state=0)
+        cmd.delete('*')
+        with self.timing('read_pdbstr_ensemble'):
+            cmd.read_pdbstr(pdbstr, 'm2')
+        self.assertEqual(cmd.count_states('m2'), 500)
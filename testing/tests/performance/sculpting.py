@@ -0,0 +1,26 @@
+'''
+Sculpting throughput (cycles per second)
+'''
+
+import time
+from pymol import cmd, testing
+
+@testing.requires('no_run_all')
+class StressSculpting(testing.PyMOLTestCase):
+
+    @testing.foreach('1rx1.pdb', '2cas.pdb.gz')
+    def testSculptCyclesPerSecond(self, dfile):
+        cmd.load(self.datafile(dfile), 'm1')
+        cmd.remove('solvent')
+        cmd.sculpt_activate('m1')
+
+        n_cycle = 100
+        cmd.sculpt_iterate('m1', cycles=1)  # warm up (pair list build)
+
+        with self.timing('%s' % dfile):
+            start = time.time()
+            cmd.sculpt_iterate('m1', cycles=n_cycle)
+            delta = time.time() - start
+
+        print(' %s: %d atoms, %.1f cycles/s' % (dfile,
+            cmd.count_atoms('m1'), n_cycle / delta))